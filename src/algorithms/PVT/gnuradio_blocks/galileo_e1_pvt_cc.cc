@@ -36,6 +36,7 @@
 #include <sstream>
 #include <vector>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
@@ -98,16 +99,24 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, boost::shared_ptr<g
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    // one record per solution, with the pseudoranges of all the channels
+                    Gnss_Dump_Schema schema("galileo_e1_pvt_raw");
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            const std::string channel = "ch" + boost::lexical_cast<std::string>(i) + ".";
+                            schema.add_field(channel + "Pseudorange_m", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "Pseudorange_symbol_shift", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "rx_time", Gnss_Dump_Schema::FLOAT64);
+                        }
+                    d_dump_record.resize(3 * d_nchannels);
+                    if (d_dump_file.open(d_dump_filename, schema))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Unable to open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -234,22 +243,13 @@ int galileo_e1_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_it
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_record[3 * i] = in[i][0].Pseudorange_m;
+                            d_dump_record[3 * i + 1] = 0;
+                            d_dump_record[3 * i + 2] = d_rx_time;
+                        }
+                    d_dump_file.write(&d_dump_record[0]);
                 }
         }
 
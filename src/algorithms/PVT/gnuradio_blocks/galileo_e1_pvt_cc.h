@@ -35,6 +35,7 @@
 #include <queue>
 #include <utility>
 #include <string>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -47,6 +48,7 @@
 #include "kml_printer.h"
 #include "rinex_printer.h"
 #include "galileo_e1_ls_pvt.h"
+#include "gnss_dump_writer.h"
 #include "GPS_L1_CA.h"
 #include "Galileo_E1.h"
 
@@ -99,7 +101,8 @@ private:
     Rinex_Printer *rp;
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
+    std::vector<double> d_dump_record;  // pseudoranges of all the channels in an epoch
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
@@ -35,11 +35,13 @@
 #include <sstream>
 #include <vector>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
+#include "gnss_navigation_aiding.h"
 #include "concurrent_map.h"
 #include "sbas_telemetry_data.h"
 #include "sbas_ionospheric_correction.h"
@@ -113,16 +115,24 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    // one record per solution, with the pseudoranges of all the channels
+                    Gnss_Dump_Schema schema("gps_l1_ca_pvt_raw");
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            const std::string channel = "ch" + boost::lexical_cast<std::string>(i) + ".";
+                            schema.add_field(channel + "Pseudorange_m", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "Pseudorange_symbol_shift", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "rx_time", Gnss_Dump_Schema::FLOAT64);
+                        }
+                    d_dump_record.resize(3 * d_nchannels);
+                    if (d_dump_file.open(d_dump_filename, schema))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(INFO) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(INFO) << "Unable to open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -237,6 +247,11 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_ite
                     pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
                     if (pvt_result == true)
                         {
+                            // share the position with the tracking blocks. The receiver time of the
+                            // epoch is the one of any of the channels, within a code period
+                            const double position_ecef_m[3] = {d_ls_pvt->d_x_m, d_ls_pvt->d_y_m, d_ls_pvt->d_z_m};
+                            Gnss_Navigation_Aiding::instance().set_solution(d_rx_time,
+                                    gnss_pseudoranges_map.begin()->second.Tracking_timestamp_secs, position_ecef_m);
                             d_kml_dump.print_position(d_ls_pvt, d_flag_averaging);
                             d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
 
@@ -288,22 +303,13 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_ite
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels ; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels ; i++)
+                        {
+                            d_dump_record[3 * i] = in[i][0].Pseudorange_m;
+                            d_dump_record[3 * i + 1] = 0;
+                            d_dump_record[3 * i + 2] = d_rx_time;
+                        }
+                    d_dump_file.write(&d_dump_record[0]);
                 }
         }
 
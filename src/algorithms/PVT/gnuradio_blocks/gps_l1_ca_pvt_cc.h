@@ -34,6 +34,7 @@
 #include <queue>
 #include <utility>
 #include <string>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -46,6 +47,7 @@
 #include "kml_printer.h"
 #include "rinex_printer.h"
 #include "gps_l1_ca_ls_pvt.h"
+#include "gnss_dump_writer.h"
 #include "GPS_L1_CA.h"
 
 class gps_l1_ca_pvt_cc;
@@ -99,7 +101,8 @@ private:
     Rinex_Printer *rp;
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
+    std::vector<double> d_dump_record;  // pseudoranges of all the channels in an epoch
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
@@ -51,16 +51,23 @@ galileo_e1_ls_pvt::galileo_e1_ls_pvt(int nchannels, std::string dump_filename, b
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    Gnss_Dump_Schema schema("galileo_e1_ls_pvt");
+                    schema.add_field("Galileo_current_time", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("X_m", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("Y_m", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("Z_m", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("clock_offset", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("latitude_deg", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("longitude_deg", Gnss_Dump_Schema::FLOAT64);
+                    schema.add_field("height_m", Gnss_Dump_Schema::FLOAT64);
+                    if (d_dump_file.open(d_dump_filename, schema))
+                        {
                             LOG(INFO) << "PVT lib dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT lib dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Unable to open PVT lib dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -398,38 +405,24 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
             if(d_flag_dump_enabled == true)
                 {
                     // MULTIPLEXED FILE RECORDING - Record results to file
-                    try
-                    {
-                            double tmp_double;
-                            //  PVT GPS time
-                            tmp_double = galileo_current_time;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position East [m]
-                            tmp_double = mypos(0);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position North [m]
-                            tmp_double = mypos(1);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position Up [m]
-                            tmp_double = mypos(2);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // User clock offset [s]
-                            tmp_double = mypos(3);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Latitude [deg]
-                            tmp_double = d_latitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Longitude [deg]
-                            tmp_double = d_longitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Height [m]
-                            tmp_double = d_height_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing PVT LS dump file "<< e.what();
-                    }
+                    double record[8];
+                    //  PVT GPS time
+                    record[0] = galileo_current_time;
+                    // ECEF User Position East [m]
+                    record[1] = mypos(0);
+                    // ECEF User Position North [m]
+                    record[2] = mypos(1);
+                    // ECEF User Position Up [m]
+                    record[3] = mypos(2);
+                    // User clock offset [s]
+                    record[4] = mypos(3);
+                    // GEO user position Latitude [deg]
+                    record[5] = d_latitude_d;
+                    // GEO user position Longitude [deg]
+                    record[6] = d_longitude_d;
+                    // GEO user position Height [m]
+                    record[7] = d_height_m;
+                    d_dump_file.write(record);
                 }
 
             // MOVING AVERAGE PVT
@@ -47,6 +47,7 @@
 #include "GPS_L1_CA.h"
 #include "galileo_navigation_message.h"
 #include "gnss_synchro.h"
+#include "gnss_dump_writer.h"
 #include "galileo_ephemeris.h"
 #include "galileo_utc_model.h"
 
@@ -111,7 +112,7 @@ public:
     bool d_flag_averaging;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     void set_averaging_depth(int depth);
 
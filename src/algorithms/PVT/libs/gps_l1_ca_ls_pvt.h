@@ -44,6 +44,7 @@
 #include <armadillo>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "gnss_synchro.h"
+#include "gnss_dump_writer.h"
 #include "GPS_L1_CA.h"
 #include "gps_ephemeris.h"
 #include "gps_navigation_message.h"
@@ -119,7 +120,7 @@ public:
     bool d_flag_averaging;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     void set_averaging_depth(int depth);
 
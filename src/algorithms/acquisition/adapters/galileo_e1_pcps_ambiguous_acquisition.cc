@@ -33,6 +33,7 @@
 #include <iostream>
 #include <boost/lexical_cast.hpp>
 #include <boost/math/distributions/exponential.hpp>
+#include <boost/math/distributions/gamma.hpp>
 #include <glog/logging.h>
 #include "galileo_e1_signal_processing.h"
 #include "Galileo_E1.h"
@@ -72,6 +73,14 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
 
     bit_transition_flag_ = configuration_->property(role + ".bit_transition_flag", false);
 
+    doppler_bin_rotation_ = configuration_->property(role + ".doppler_bin_rotation", false);
+
+    decimation_factor_ = configuration_->property(role + ".decimation_factor", 1);
+
+    fast_fft_size_ = configuration_->property(role + ".fast_fft_size", false);
+
+    noncoherent_dwells_ = configuration_->property(role + ".noncoherent_dwells", 1);
+
     if (!bit_transition_flag_)
         {
             max_dwells_ = configuration_->property(role + ".max_dwells", 1);
@@ -97,6 +106,15 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
 
     vector_length_ = sampled_ms_ * samples_per_ms;
 
+    if (decimation_factor_ == 0 || samples_per_ms % decimation_factor_ != 0
+            || code_length_ % decimation_factor_ != 0)
+        {
+            LOG(WARNING) << role << ".decimation_factor " << decimation_factor_
+                         << " does not divide " << samples_per_ms << " samples per ms and "
+                         << code_length_ << " samples per code. Acquisition will not decimate";
+            decimation_factor_ = 1;
+        }
+
     code_ = new gr_complex[vector_length_];
 
     if (item_type_.compare("gr_complex") == 0)
@@ -104,7 +122,8 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_make_acquisition_cc(sampled_ms_, max_dwells_,
                     shift_resolution_, if_, fs_in_, samples_per_ms, code_length_,
-                    bit_transition_flag_, queue_, dump_, dump_filename_);
+                    bit_transition_flag_, doppler_bin_rotation_, decimation_factor_,
+                    fast_fft_size_, noncoherent_dwells_, queue_, dump_, dump_filename_);
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
                     << stream_to_vector_->unique_id() << ")";
@@ -240,15 +259,17 @@ GalileoE1PcpsAmbiguousAcquisition::set_local_code()
                     "Acquisition" + boost::lexical_cast<std::string>(channel_)
                             + ".cboc", false);
 
-            std::complex<float> * code = new std::complex<float>[code_length_];
+            // The block searches at fs_in_ / decimation_factor_
+            unsigned int code_length = code_length_ / decimation_factor_;
+            std::complex<float> * code = new std::complex<float>[code_length];
 
             galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
-                    cboc, gnss_synchro_->PRN, fs_in_, 0, false);
+                    cboc, gnss_synchro_->PRN, fs_in_ / decimation_factor_, 0, false);
 
             for (unsigned int i = 0; i < sampled_ms_/4; i++)
                 {
-                    memcpy(&(code_[i*code_length_]), code,
-                           sizeof(gr_complex)*code_length_);
+                    memcpy(&(code_[i*code_length]), code,
+                           sizeof(gr_complex)*code_length);
                 }
 
             acquisition_cc_->set_local_code(code_);
@@ -277,12 +298,24 @@ float GalileoE1PcpsAmbiguousAcquisition::calculate_threshold(float pfa)
 
 	DLOG(INFO) <<"Channel "<<channel_<<"  Pfa = "<< pfa;
 
-    unsigned int ncells = vector_length_*frequency_bins;
+    // The search runs on vector_length_ / decimation_factor_ samples
+    unsigned int search_length = vector_length_ / decimation_factor_;
+    unsigned int ncells = search_length*frequency_bins;
 	double exponent = 1/(double)ncells;
 	double val = pow(1.0-pfa,exponent);
-    double lambda = double(vector_length_);
-	boost::math::exponential_distribution<double> mydist (lambda);
-	float threshold = (float)quantile(mydist,val);
+    double lambda = double(search_length);
+    float threshold;
+    if (noncoherent_dwells_ > 1)
+        {
+            // Mean of noncoherent_dwells_ exponential variables
+            boost::math::gamma_distribution<double> mydist (noncoherent_dwells_, 1.0 / (lambda * noncoherent_dwells_));
+            threshold = (float)quantile(mydist,val);
+        }
+    else
+        {
+            boost::math::exponential_distribution<double> mydist (lambda);
+            threshold = (float)quantile(mydist,val);
+        }
 
     return threshold;
 }
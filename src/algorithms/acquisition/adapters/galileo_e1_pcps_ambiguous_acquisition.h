@@ -138,6 +138,10 @@ private:
     unsigned int vector_length_;
     unsigned int code_length_;
     bool bit_transition_flag_;
+    bool doppler_bin_rotation_;
+    unsigned int decimation_factor_;
+    bool fast_fft_size_;
+    unsigned int noncoherent_dwells_;
     unsigned int channel_;
     float threshold_;
     unsigned int doppler_max_;
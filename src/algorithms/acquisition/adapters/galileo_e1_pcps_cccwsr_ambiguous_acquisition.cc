@@ -72,6 +72,8 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::GalileoE1PcpsCccwsrAmbiguousAcquisition
 
     max_dwells_ = configuration_->property(role + ".max_dwells", 1);
 
+    noncoherent_dwells_ = configuration_->property(role + ".noncoherent_dwells", 1);
+
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
 
@@ -94,7 +96,7 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::GalileoE1PcpsCccwsrAmbiguousAcquisition
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_cccwsr_make_acquisition_cc(sampled_ms_, max_dwells_,
                     shift_resolution_, if_, fs_in_, samples_per_ms, code_length_,
-                    queue_, dump_, dump_filename_);
+                    noncoherent_dwells_, queue_, dump_, dump_filename_);
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
                     << stream_to_vector_->unique_id() << ")";
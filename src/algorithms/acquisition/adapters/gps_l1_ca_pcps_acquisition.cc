@@ -37,6 +37,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <boost/math/distributions/exponential.hpp>
+#include <boost/math/distributions/gamma.hpp>
 #include <glog/logging.h>
 #include <gnuradio/msg_queue.h>
 #include "gps_sdr_signal_processing.h"
@@ -69,6 +70,20 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
 
     bit_transition_flag_ = configuration_->property(role + ".bit_transition_flag", false);
 
+    doppler_bin_rotation_ = configuration_->property(role + ".doppler_bin_rotation", false);
+
+    decimation_factor_ = configuration_->property(role + ".decimation_factor", 1);
+
+    fast_fft_size_ = configuration_->property(role + ".fast_fft_size", false);
+
+    noncoherent_dwells_ = configuration_->property(role + ".noncoherent_dwells", 1);
+
+    reacquisition_max_dwells_ = configuration_->property(role + ".reacquisition_max_dwells", 0);
+
+    reacquisition_doppler_bins_ = configuration_->property(role + ".reacquisition_doppler_bins", 2);
+
+    reacquisition_code_chips_ = configuration_->property(role + ".reacquisition_code_chips", 2.0);
+
     if (!bit_transition_flag_)
         {
             max_dwells_ = configuration_->property(role + ".max_dwells", 1);
@@ -87,14 +102,25 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
 
     vector_length_ = code_length_ * sampled_ms_;
 
+    if (decimation_factor_ == 0 || code_length_ % decimation_factor_ != 0)
+        {
+            LOG(WARNING) << role << ".decimation_factor " << decimation_factor_
+                         << " does not divide " << code_length_
+                         << " samples per code. Acquisition will not decimate";
+            decimation_factor_ = 1;
+        }
+
     code_= new gr_complex[vector_length_];
 
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
         item_size_ = sizeof(gr_complex);
         acquisition_cc_ = pcps_make_acquisition_cc(sampled_ms_, max_dwells_,
                 shift_resolution_, if_, fs_in_, code_length_, code_length_,
-                bit_transition_flag_, queue_, dump_, dump_filename_);
+                bit_transition_flag_, doppler_bin_rotation_, decimation_factor_,
+                    fast_fft_size_, noncoherent_dwells_, queue_, dump_, dump_filename_);
+        acquisition_cc_->set_reacquisition(reacquisition_max_dwells_, reacquisition_doppler_bins_,
+                reacquisition_code_chips_ * (double)code_length_ / GPS_L1_CA_CODE_LENGTH_CHIPS);
 
         stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
 
@@ -102,6 +128,16 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
                 << ")";
         DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id()
                 << ")";
+
+        if (item_type_.compare("cshort") == 0)
+            {
+                // The channel carries integer samples for the int16 tracking
+                // blocks: the acquisition converts them for its FFTs
+                item_size_ = sizeof(lv_16sc_t);
+                cshort_to_gr_complex_ = make_cshort_to_gr_complex();
+                DLOG(INFO) << "cshort_to_gr_complex(" << cshort_to_gr_complex_->unique_id()
+                        << ")";
+            }
     }
     else
     {
@@ -120,7 +156,7 @@ GpsL1CaPcpsAcquisition::~GpsL1CaPcpsAcquisition()
 void GpsL1CaPcpsAcquisition::set_channel(unsigned int channel)
 {
     channel_ = channel;
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
         acquisition_cc_->set_channel(channel_);
     }
@@ -146,7 +182,7 @@ void GpsL1CaPcpsAcquisition::set_threshold(float threshold)
 
 	DLOG(INFO) <<"Channel "<<channel_<<" Threshold = " << threshold_;
 
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
         acquisition_cc_->set_threshold(threshold_);
     }
@@ -156,7 +192,7 @@ void GpsL1CaPcpsAcquisition::set_threshold(float threshold)
 void GpsL1CaPcpsAcquisition::set_doppler_max(unsigned int doppler_max)
 {
     doppler_max_ = doppler_max;
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
         acquisition_cc_->set_doppler_max(doppler_max_);
     }
@@ -166,7 +202,7 @@ void GpsL1CaPcpsAcquisition::set_doppler_max(unsigned int doppler_max)
 void GpsL1CaPcpsAcquisition::set_doppler_step(unsigned int doppler_step)
 {
     doppler_step_ = doppler_step;
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
         {
             acquisition_cc_->set_doppler_step(doppler_step_);
         }
@@ -178,7 +214,7 @@ void GpsL1CaPcpsAcquisition::set_channel_queue(
         concurrent_queue<int> *channel_internal_queue)
 {
     channel_internal_queue_ = channel_internal_queue;
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
         {
             acquisition_cc_->set_channel_queue(channel_internal_queue_);
         }
@@ -188,7 +224,7 @@ void GpsL1CaPcpsAcquisition::set_channel_queue(
 void GpsL1CaPcpsAcquisition::set_gnss_synchro(Gnss_Synchro* gnss_synchro)
 {
     gnss_synchro_ = gnss_synchro;
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
         {
             acquisition_cc_->set_gnss_synchro(gnss_synchro_);
         }
@@ -197,7 +233,7 @@ void GpsL1CaPcpsAcquisition::set_gnss_synchro(Gnss_Synchro* gnss_synchro)
 
 signed int GpsL1CaPcpsAcquisition::mag()
 {
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
         {
             return acquisition_cc_->mag();
         }
@@ -217,16 +253,18 @@ void GpsL1CaPcpsAcquisition::init()
 
 void GpsL1CaPcpsAcquisition::set_local_code()
 {
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
-        std::complex<float>* code = new std::complex<float>[code_length_];
+        // The block searches at fs_in_ / decimation_factor_
+        unsigned int code_length = code_length_ / decimation_factor_;
+        std::complex<float>* code = new std::complex<float>[code_length];
 
-        gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+        gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_ / decimation_factor_, 0);
 
         for (unsigned int i = 0; i < sampled_ms_; i++)
             {
-                memcpy(&(code_[i*code_length_]), code,
-                       sizeof(gr_complex)*code_length_);
+                memcpy(&(code_[i*code_length]), code,
+                       sizeof(gr_complex)*code_length);
             }
 
         acquisition_cc_->set_local_code(code_);
@@ -238,7 +276,7 @@ void GpsL1CaPcpsAcquisition::set_local_code()
 
 void GpsL1CaPcpsAcquisition::reset()
 {
-    if (item_type_.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0 or item_type_.compare("cshort") == 0)
     {
         acquisition_cc_->set_active(true);
     }
@@ -254,12 +292,24 @@ float GpsL1CaPcpsAcquisition::calculate_threshold(float pfa)
             frequency_bins++;
         }
     DLOG(INFO) << "Channel " << channel_<< "  Pfa = " << pfa;
-    unsigned int ncells = vector_length_*frequency_bins;
+    // The search runs on vector_length_ / decimation_factor_ samples
+    unsigned int search_length = vector_length_ / decimation_factor_;
+    unsigned int ncells = search_length*frequency_bins;
     double exponent = 1/(double)ncells;
     double val = pow(1.0 - pfa, exponent);
-    double lambda = double(vector_length_);
-    boost::math::exponential_distribution<double> mydist (lambda);
-    float threshold = (float)quantile(mydist,val);
+    double lambda = double(search_length);
+    float threshold;
+    if (noncoherent_dwells_ > 1)
+        {
+            // Mean of noncoherent_dwells_ exponential variables
+            boost::math::gamma_distribution<double> mydist (noncoherent_dwells_, 1.0 / (lambda * noncoherent_dwells_));
+            threshold = (float)quantile(mydist,val);
+        }
+    else
+        {
+            boost::math::exponential_distribution<double> mydist (lambda);
+            threshold = (float)quantile(mydist,val);
+        }
 
     return threshold;
 }
@@ -271,7 +321,11 @@ void GpsL1CaPcpsAcquisition::connect(gr::top_block_sptr top_block)
         {
             top_block->connect(stream_to_vector_, 0, acquisition_cc_, 0);
         }
-
+    else if (item_type_.compare("cshort") == 0)
+        {
+            top_block->connect(cshort_to_gr_complex_, 0, stream_to_vector_, 0);
+            top_block->connect(stream_to_vector_, 0, acquisition_cc_, 0);
+        }
 }
 
 
@@ -281,11 +335,20 @@ void GpsL1CaPcpsAcquisition::disconnect(gr::top_block_sptr top_block)
     {
         top_block->disconnect(stream_to_vector_, 0, acquisition_cc_, 0);
     }
+    else if (item_type_.compare("cshort") == 0)
+    {
+        top_block->disconnect(cshort_to_gr_complex_, 0, stream_to_vector_, 0);
+        top_block->disconnect(stream_to_vector_, 0, acquisition_cc_, 0);
+    }
 }
 
 
 gr::basic_block_sptr GpsL1CaPcpsAcquisition::get_left_block()
 {
+    if (item_type_.compare("cshort") == 0)
+        {
+            return cshort_to_gr_complex_;
+        }
     return stream_to_vector_;
 }
 
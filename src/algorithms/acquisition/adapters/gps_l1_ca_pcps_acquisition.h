@@ -39,9 +39,11 @@
 #include <string>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/blocks/stream_to_vector.h>
+#include <volk/volk_complex.h>
 #include "gnss_synchro.h"
 #include "acquisition_interface.h"
 #include "pcps_acquisition_cc.h"
+#include "cshort_to_gr_complex.h"
 
 
 
@@ -138,11 +140,19 @@ private:
     ConfigurationInterface* configuration_;
     pcps_acquisition_cc_sptr acquisition_cc_;
     gr::blocks::stream_to_vector::sptr stream_to_vector_;
+    boost::shared_ptr<gr::block> cshort_to_gr_complex_;
     size_t item_size_;
     std::string item_type_;
     unsigned int vector_length_;
     unsigned int code_length_;
     bool bit_transition_flag_;
+    bool doppler_bin_rotation_;
+    unsigned int decimation_factor_;
+    bool fast_fft_size_;
+    unsigned int noncoherent_dwells_;
+    unsigned int reacquisition_max_dwells_;
+    unsigned int reacquisition_doppler_bins_;
+    double reacquisition_code_chips_;
     unsigned int channel_;
     float threshold_;
     unsigned int doppler_max_;
@@ -0,0 +1,276 @@
+/*!
+ * \file gps_l1_ca_pcps_hierarchical_acquisition.cc
+ * \brief Adapts the coarse-to-fine PCPS acquisition block to an
+ *  AcquisitionInterface for GPS L1 C/A signals
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_pcps_hierarchical_acquisition.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/math/distributions/exponential.hpp>
+#include <glog/logging.h>
+#include <gnuradio/msg_queue.h>
+#include "gps_sdr_signal_processing.h"
+#include "GPS_L1_CA.h"
+#include "configuration_interface.h"
+
+
+using google::LogMessage;
+
+GpsL1CaPcpsHierarchicalAcquisition::GpsL1CaPcpsHierarchicalAcquisition(
+        ConfigurationInterface* configuration, std::string role,
+        unsigned int in_streams, unsigned int out_streams,
+        gr::msg_queue::sptr queue) :
+    role_(role), in_streams_(in_streams), out_streams_(out_streams), queue_(queue)
+{
+    configuration_ = configuration;
+    std::string default_item_type = "gr_complex";
+    std::string default_dump_filename = "./data/acquisition.dat";
+
+    DLOG(INFO) << "role " << role;
+
+    item_type_ = configuration_->property(role + ".item_type",
+            default_item_type);
+
+    fs_in_ = configuration_->property("GNSS-SDR.internal_fs_hz", 2048000);
+    if_ = configuration_->property(role + ".ifreq", 0);
+    dump_ = configuration_->property(role + ".dump", false);
+    sampled_ms_ = configuration_->property(role + ".coherent_integration_time_ms", 1);
+    fine_sampled_ms_ = configuration_->property(role + ".fine_coherent_integration_time_ms", 4);
+
+    // By default, a fine Doppler step of 2/(3*T) for a coherent integration time T
+    fine_doppler_step_ = configuration_->property(role + ".fine_doppler_step",
+            (unsigned int)round(2000.0 / (3.0 * fine_sampled_ms_)));
+    candidates_ = configuration_->property(role + ".candidates", 4);
+    max_dwells_ = configuration_->property(role + ".max_dwells", 1);
+
+    dump_filename_ = configuration_->property(role + ".dump_filename",
+            default_dump_filename);
+
+    //--- Find number of samples per spreading code -------------------------
+    code_length_ = round(fs_in_
+            / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+
+    // The decision is taken on the fine search
+    vector_length_ = code_length_ * fine_sampled_ms_;
+
+    code_= new gr_complex[code_length_];
+
+    channel_ = 0;
+    doppler_max_ = 0;
+    doppler_step_ = 0;
+
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        item_size_ = sizeof(gr_complex);
+        acquisition_cc_ = pcps_make_hierarchical_acquisition_cc(sampled_ms_,
+                fine_sampled_ms_, fine_doppler_step_, candidates_, max_dwells_,
+                0, if_, fs_in_, code_length_, code_length_, queue_, dump_,
+                dump_filename_);
+
+        DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id()
+                << ")";
+    }
+    else
+    {
+        LOG(WARNING) << item_type_
+                << " unknown acquisition item type";
+    }
+}
+
+
+GpsL1CaPcpsHierarchicalAcquisition::~GpsL1CaPcpsHierarchicalAcquisition()
+{
+    delete[] code_;
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_channel(unsigned int channel)
+{
+    channel_ = channel;
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        acquisition_cc_->set_channel(channel_);
+    }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_threshold(float threshold)
+{
+    float pfa = configuration_->property(role_ + boost::lexical_cast<std::string>(channel_) + ".pfa", 0.0);
+
+    if(pfa == 0.0)
+        {
+            pfa = configuration_->property(role_+".pfa", 0.0);
+        }
+    if(pfa == 0.0)
+        {
+            threshold_ = threshold;
+        }
+    else
+        {
+            threshold_ = calculate_threshold(pfa);
+        }
+
+    DLOG(INFO) <<"Channel "<<channel_<<" Threshold = " << threshold_;
+
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        acquisition_cc_->set_threshold(threshold_);
+    }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_doppler_max(unsigned int doppler_max)
+{
+    doppler_max_ = doppler_max;
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        acquisition_cc_->set_doppler_max(doppler_max_);
+    }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_doppler_step(unsigned int doppler_step)
+{
+    doppler_step_ = doppler_step;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_doppler_step(doppler_step_);
+        }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_channel_queue(
+        concurrent_queue<int> *channel_internal_queue)
+{
+    channel_internal_queue_ = channel_internal_queue;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_channel_queue(channel_internal_queue_);
+        }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_gnss_synchro(Gnss_Synchro* gnss_synchro)
+{
+    gnss_synchro_ = gnss_synchro;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_gnss_synchro(gnss_synchro_);
+        }
+}
+
+
+signed int GpsL1CaPcpsHierarchicalAcquisition::mag()
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return acquisition_cc_->mag();
+        }
+    else
+        {
+            return 0;
+        }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::init()
+{
+    acquisition_cc_->init();
+    set_local_code();
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::set_local_code()
+{
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        // The block replicates the code period over each integration time
+        gps_l1_ca_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_, 0);
+
+        acquisition_cc_->set_local_code(code_);
+    }
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::reset()
+{
+    if (item_type_.compare("gr_complex") == 0)
+    {
+        acquisition_cc_->set_active(true);
+    }
+}
+
+
+float GpsL1CaPcpsHierarchicalAcquisition::calculate_threshold(float pfa)
+{
+    // The fine search tests, for each candidate, the Doppler bins within one
+    // coarse step and three code phases
+    unsigned int fine_step = fine_doppler_step_;
+    if (fine_step == 0 || fine_step > doppler_step_)
+        {
+            fine_step = doppler_step_;
+        }
+    unsigned int frequency_bins = 0;
+    for (int doppler = -(int)doppler_step_ / 2; doppler <= (int)doppler_step_ / 2; doppler += fine_step)
+        {
+            frequency_bins++;
+        }
+    DLOG(INFO) << "Channel " << channel_<< "  Pfa = " << pfa;
+    unsigned int ncells = candidates_ * frequency_bins * 3;
+    double exponent = 1/(double)ncells;
+    double val = pow(1.0 - pfa, exponent);
+    double lambda = double(vector_length_);
+    boost::math::exponential_distribution<double> mydist (lambda);
+    float threshold = (float)quantile(mydist,val);
+
+    return threshold;
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::connect(gr::top_block_sptr top_block)
+{
+    // nothing to connect: the block takes the sample stream directly
+}
+
+
+void GpsL1CaPcpsHierarchicalAcquisition::disconnect(gr::top_block_sptr top_block)
+{
+    // nothing to disconnect
+}
+
+
+gr::basic_block_sptr GpsL1CaPcpsHierarchicalAcquisition::get_left_block()
+{
+    return acquisition_cc_;
+}
+
+
+gr::basic_block_sptr GpsL1CaPcpsHierarchicalAcquisition::get_right_block()
+{
+    return acquisition_cc_;
+}
@@ -33,6 +33,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <boost/math/distributions/exponential.hpp>
+#include <boost/math/distributions/gamma.hpp>
 #include <glog/logging.h>
 #include <gnuradio/msg_queue.h>
 #include "gps_sdr_signal_processing.h"
@@ -65,6 +66,8 @@ GpsL1CaPcpsMultithreadAcquisition::GpsL1CaPcpsMultithreadAcquisition(
 
     bit_transition_flag_ = configuration_->property("Acquisition.bit_transition_flag", false);
 
+    noncoherent_dwells_ = configuration_->property(role + ".noncoherent_dwells", 1);
+
     if (!bit_transition_flag_)
         {
             max_dwells_ = configuration_->property(role + ".max_dwells", 1);
@@ -90,7 +93,7 @@ GpsL1CaPcpsMultithreadAcquisition::GpsL1CaPcpsMultithreadAcquisition(
         item_size_ = sizeof(gr_complex);
         acquisition_cc_ = pcps_make_multithread_acquisition_cc(sampled_ms_, max_dwells_,
                 shift_resolution_, if_, fs_in_, code_length_, code_length_,
-                bit_transition_flag_, queue_, dump_, dump_filename_);
+                bit_transition_flag_, noncoherent_dwells_, queue_, dump_, dump_filename_);
 
         stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
 
@@ -256,8 +259,18 @@ float GpsL1CaPcpsMultithreadAcquisition::calculate_threshold(float pfa)
 	double exponent = 1/(double)ncells;
 	double val = pow(1.0-pfa,exponent);
 	double lambda = double(vector_length_);
-	boost::math::exponential_distribution<double> mydist (lambda);
-	float threshold = (float)quantile(mydist,val);
+	float threshold;
+	if (noncoherent_dwells_ > 1)
+	    {
+	        // Mean of noncoherent_dwells_ exponential variables
+	        boost::math::gamma_distribution<double> mydist (noncoherent_dwells_, 1.0 / (lambda * noncoherent_dwells_));
+	        threshold = (float)quantile(mydist,val);
+	    }
+	else
+	    {
+	        boost::math::exponential_distribution<double> mydist (lambda);
+	        threshold = (float)quantile(mydist,val);
+	    }
 
 	return threshold;
 }
@@ -146,6 +146,7 @@ private:
     unsigned int shift_resolution_;
     unsigned int sampled_ms_;
     unsigned int max_dwells_;
+    unsigned int noncoherent_dwells_;
     long fs_in_;
     long if_;
     bool dump_;
@@ -35,6 +35,7 @@
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 #include "control_message_factory.h"
 
 using google::LogMessage;
@@ -80,15 +81,13 @@ galileo_pcps_8ms_acquisition_cc::galileo_pcps_8ms_acquisition_cc(
     d_num_doppler_bins = 0;
 
     //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&d_fft_code_A, 16, d_fft_size * sizeof(gr_complex)) == 0){};
-    if (posix_memalign((void**)&d_fft_code_B, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = new Gnss_Fft(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
@@ -97,17 +96,6 @@ galileo_pcps_8ms_acquisition_cc::galileo_pcps_8ms_acquisition_cc(
 
 galileo_pcps_8ms_acquisition_cc::~galileo_pcps_8ms_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    free(d_fft_code_A);
-    free(d_fft_code_B);
     free(d_magnitude);
 
     delete d_ifft;
@@ -121,37 +109,21 @@ galileo_pcps_8ms_acquisition_cc::~galileo_pcps_8ms_acquisition_cc()
 
 void galileo_pcps_8ms_acquisition_cc::set_local_code(std::complex<float> * code)
 {
-   // code A: two replicas of a primary code
-   memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_code_A,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_code_A,d_fft_if->get_outbuf(),d_fft_size);
-        }
+    // The conjugated code spectra are shared by all the channels
+    // code A: two replicas of a primary code
+    d_fft_code_A = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            code, d_fft_if);
 
     // code B: two replicas of a primary code; the second replica is inverted.
+    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_samples_per_code);
     volk_32fc_s32fc_multiply_32fc_a(&(d_fft_if->get_inbuf())[d_samples_per_code],
                                     &code[d_samples_per_code], gr_complex(-1,0),
                                     d_samples_per_code);
 
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_code_B,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_code_B,d_fft_if->get_outbuf(),d_fft_size);
-        }
+    d_fft_code_B = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            d_fft_if->get_inbuf(), d_fft_if);
 }
 
 void galileo_pcps_8ms_acquisition_cc::init()
@@ -162,26 +134,10 @@ void galileo_pcps_8ms_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
-
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
-        {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
-        }
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_fft_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
 }
 
 int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
@@ -253,7 +209,7 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
                     doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
                     volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                                d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_fft_size);
 
                     // 3- Perform the FFT-based convolution  (parallel time search)
                     // Compute the FFT of the carrier wiped--off incoming signal
@@ -263,7 +219,7 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
                     // with the local FFT'd code A reference using SIMD operations with
                     // VOLK library
                     volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_A, d_fft_size);
+                                d_fft_if->get_outbuf(), d_fft_code_A.get(), d_fft_size);
 
                     // compute the inverse FFT
                     d_ifft->execute();
@@ -279,7 +235,7 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
                     // with the local FFT'd code B reference using SIMD operations with
                     // VOLK library
                     volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_B, d_fft_size);
+                                d_fft_if->get_outbuf(), d_fft_code_B.get(), d_fft_size);
 
                     // compute the inverse FFT
                     d_ifft->execute();
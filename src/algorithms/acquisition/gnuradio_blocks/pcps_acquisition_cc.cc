@@ -34,34 +34,47 @@
 
 #include "pcps_acquisition_cc.h"
 #include <sys/time.h>
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
+#include "gnss_overload_controller.h"
 #include "control_message_factory.h"
 
+// Longest loss of lock after which the last state in lock is still used [s]
+#define REACQUISITION_MAX_OUTAGE 10.0
+
 using google::LogMessage;
 
 pcps_acquisition_cc_sptr pcps_make_acquisition_cc(
                                  unsigned int sampled_ms, unsigned int max_dwells,
                                  unsigned int doppler_max, long freq, long fs_in,
                                  int samples_per_ms, int samples_per_code,
-                                 bool bit_transition_flag,
+                                 bool bit_transition_flag, bool doppler_bin_rotation,
+                                 unsigned int decimation_factor, bool fast_fft_size,
+                                 unsigned int noncoherent_dwells,
                                  gr::msg_queue::sptr queue, bool dump,
                                  std::string dump_filename)
 {
 
     return pcps_acquisition_cc_sptr(
             new pcps_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
-                                     samples_per_code, bit_transition_flag, queue, dump, dump_filename));
+                                     samples_per_code, bit_transition_flag, doppler_bin_rotation,
+                                     decimation_factor, fast_fft_size, noncoherent_dwells,
+                                     queue, dump, dump_filename));
 }
 
 pcps_acquisition_cc::pcps_acquisition_cc(
                          unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
-                         bool bit_transition_flag,
+                         bool bit_transition_flag, bool doppler_bin_rotation,
+                         unsigned int decimation_factor, bool fast_fft_size,
+                         unsigned int noncoherent_dwells,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename) :
     gr::block("pcps_acquisition_cc",
@@ -72,29 +85,79 @@ pcps_acquisition_cc::pcps_acquisition_cc(
     d_active = false;
     d_state = 0;
     d_queue = queue;
-    d_freq = freq;
-    d_fs_in = fs_in;
-    d_samples_per_ms = samples_per_ms;
-    d_samples_per_code = samples_per_code;
+
+    // The search runs at fs_in / d_decimation_factor
+    d_decimation_factor = decimation_factor;
+    if (d_decimation_factor == 0 || samples_per_ms % decimation_factor != 0
+            || samples_per_code % decimation_factor != 0)
+        {
+            LOG(WARNING) << "decimation_factor " << decimation_factor << " does not divide "
+                         << samples_per_ms << " samples per ms and " << samples_per_code
+                         << " samples per code. Acquisition will not decimate";
+            d_decimation_factor = 1;
+        }
+    d_input_size = sampled_ms * samples_per_ms;
+    d_input_samples_per_code = samples_per_code;
+    d_freq = d_decimation_factor > 1 ? 0 : freq; // the IF is wiped off before decimation
+    d_fs_in = fs_in / d_decimation_factor;
+    d_samples_per_ms = samples_per_ms / d_decimation_factor;
+    d_samples_per_code = samples_per_code / d_decimation_factor;
     d_sampled_ms = sampled_ms;
     d_max_dwells = max_dwells;
     d_well_count = 0;
     d_doppler_max = doppler_max;
-    d_fft_size = d_sampled_ms * d_samples_per_ms;
+    d_signal_size = d_sampled_ms * d_samples_per_ms;
+    d_fft_size = d_signal_size;
+    d_search_size = d_fft_size;
+    if (fast_fft_size && next_fast_fft_size(d_signal_size, false) != d_signal_size)
+        {
+            // Room for one code period of lags without wrapping around the
+            // zero padding
+            d_fft_size = next_fast_fft_size(d_signal_size + d_samples_per_code - 1, false);
+            d_search_size = d_samples_per_code;
+            DLOG(INFO) << "Acquisition FFT size " << d_fft_size << " for "
+                       << d_signal_size << " samples";
+        }
     d_mag = 0;
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
+    d_doppler_first = 0;
+    d_doppler_last = 0;
+    d_reacquisition_max_dwells = 0;
+    d_reacquisition_doppler_bins = 0;
+    d_reacquisition_code_samples = 0.0;
+    d_reacquisition = false;
+    d_reacquisition_code_phase = 0.0;
     d_bit_transition_flag = bit_transition_flag;
+    d_doppler_bin_rotation = doppler_bin_rotation;
+    d_noncoherent_dwells = noncoherent_dwells > 0 ? noncoherent_dwells : 1;
+    d_noncoherent_power = 0.0;
 
     //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
+    d_if_wipeoff = 0;
+    d_if_buffer = 0;
+    d_decimated = 0;
+    if (d_decimation_factor > 1)
+        {
+            if (freq != 0)
+                {
+                    if (posix_memalign((void**)&d_if_wipeoff, 16, d_input_size * sizeof(gr_complex)) == 0){};
+                    if (posix_memalign((void**)&d_if_buffer, 16, d_input_size * sizeof(gr_complex)) == 0){};
+                    complex_exp_gen_conj(d_if_wipeoff, freq, fs_in, d_input_size);
+                }
+            if (posix_memalign((void**)&d_decimated, 16, d_signal_size * sizeof(gr_complex)) == 0){};
+        }
+
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = new Gnss_Fft(d_fft_size, false);
+
+    // The zero padding of the input is never overwritten by the carrier wipeoff
+    std::fill_n(d_fft_if->get_inbuf(), d_fft_size, gr_complex(0.0, 0.0));
 
     // For dumping samples into a file
     d_dump = dump;
@@ -103,17 +166,11 @@ pcps_acquisition_cc::pcps_acquisition_cc(
 
 pcps_acquisition_cc::~pcps_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    free(d_fft_codes);
+    free_doppler_bin_rotation();
     free(d_magnitude);
+    free(d_if_wipeoff);
+    free(d_if_buffer);
+    free(d_decimated);
 
     delete d_ifft;
     delete d_fft_if;
@@ -126,19 +183,29 @@ pcps_acquisition_cc::~pcps_acquisition_cc()
 
 void pcps_acquisition_cc::set_local_code(std::complex<float> * code)
 {
-    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
+    const gr_complex* replica = code;
+    if (d_fft_size != d_signal_size)
         {
-            volk_32fc_conjugate_32fc_u(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
+            // Lag l correlates input sample n with code sample n - l: the
+            // code goes at the beginning of the buffer and, for the negative
+            // indexes, one code period before its end
+            gr_complex* padded = d_fft_if->get_inbuf();
+            std::fill_n(padded, d_fft_size, gr_complex(0.0, 0.0));
+            memcpy(padded, code, sizeof(gr_complex) * d_signal_size);
+            for (unsigned int i = 1; i < (unsigned int)d_samples_per_code; i++)
+                {
+                    padded[d_fft_size - i] = code[d_samples_per_code - i];
+                }
+            replica = padded;
         }
+
+    // The conjugated code spectrum is shared by all the channels
+    d_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            replica, d_fft_if);
+
+    // Restore the zero padding of the input
+    std::fill_n(d_fft_if->get_inbuf() + d_signal_size, d_fft_size - d_signal_size, gr_complex(0.0, 0.0));
 }
 
 void pcps_acquisition_cc::init()
@@ -149,28 +216,262 @@ void pcps_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_signal_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
+    d_doppler_first = 0;
+    d_doppler_last = d_num_doppler_bins > 0 ? d_num_doppler_bins - 1 : 0;
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
+    if (d_noncoherent_dwells > 1)
+        {
+            d_grid.resize(d_num_doppler_bins, d_search_size);
+        }
+
+    if (d_doppler_bin_rotation)
+        {
+            init_doppler_bin_rotation();
+        }
+}
+
+
+void pcps_acquisition_cc::init_doppler_bin_rotation()
+{
+    free_doppler_bin_rotation();
+
+    // Split the carrier frequency of each Doppler bin into an integer number
+    // of FFT bins, applied as a circular rotation of the input spectrum, and
+    // a fractional residual, wiped off in time domain. Bins sharing the same
+    // residual share the same forward FFT.
+    double fft_bin_hz = (double)d_fs_in / (double)d_fft_size;
+    std::vector<double> residuals_hz;
+    d_doppler_bin_shift.resize(d_num_doppler_bins);
+    d_doppler_bin_residual.resize(d_num_doppler_bins);
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
+            double carrier_hz = (double)d_freq + (double)d_grid_doppler_wipeoffs->doppler(doppler_index);
+            long fft_bins = (long)round(carrier_hz / fft_bin_hz);
+            double residual_hz = carrier_hz - (double)fft_bins * fft_bin_hz;
+
+            unsigned int residual_index = 0;
+            while (residual_index < residuals_hz.size()
+                   && std::abs(residuals_hz[residual_index] - residual_hz) > 1e-6)
+                {
+                    residual_index++;
+                }
+            if (residual_index == residuals_hz.size())
+                {
+                    residuals_hz.push_back(residual_hz);
+                }
+            d_doppler_bin_residual[doppler_index] = residual_index;
+            d_doppler_bin_shift[doppler_index] = (unsigned int)(((fft_bins % (long)d_fft_size)
+                    + (long)d_fft_size) % (long)d_fft_size);
+        }
+
+    for (unsigned int i = 0; i < residuals_hz.size(); i++)
+        {
+            gr_complex* wipeoff = 0;
+            if (std::abs(residuals_hz[i]) > 1e-6)
+                {
+                    if (posix_memalign((void**)&wipeoff, 16, d_signal_size * sizeof(gr_complex)) == 0){};
+                    complex_exp_gen_conj(wipeoff, residuals_hz[i], d_fs_in, d_signal_size);
+                }
+            d_residual_wipeoffs.push_back(wipeoff);
+
+            gr_complex* spectrum = 0;
+            if (posix_memalign((void**)&spectrum, 16, d_fft_size * sizeof(gr_complex)) == 0){};
+            d_residual_spectra.push_back(spectrum);
+        }
+
+    DLOG(INFO) << "Channel " << d_channel << ": Doppler bin rotation uses "
+               << residuals_hz.size() << " forward FFTs for " << d_num_doppler_bins
+               << " Doppler bins";
+    if (residuals_hz.size() == d_num_doppler_bins && d_num_doppler_bins > 1)
+        {
+            LOG(WARNING) << "doppler_bin_rotation brings no gain: the Doppler step should be a multiple"
+                         << " of fs_in / fft_size = " << fft_bin_hz << " Hz or a simple fraction of it";
+        }
+}
+
+
+void pcps_acquisition_cc::free_doppler_bin_rotation()
+{
+    for (unsigned int i = 0; i < d_residual_spectra.size(); i++)
+        {
+            free(d_residual_wipeoffs[i]);
+            free(d_residual_spectra[i]);
+        }
+    d_residual_wipeoffs.clear();
+    d_residual_spectra.clear();
+    d_doppler_bin_shift.clear();
+    d_doppler_bin_residual.clear();
+}
+
+const gr_complex* pcps_acquisition_cc::decimate(const gr_complex* in)
+{
+    if (d_decimation_factor == 1)
+        {
+            return in;
+        }
 
-            int doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
+    // Bring the signal to baseband, so that the low-pass filter keeps it
+    const gr_complex* baseband = in;
+    if (d_if_wipeoff != 0)
+        {
+            volk_32fc_x2_multiply_32fc_a(d_if_buffer, in, d_if_wipeoff, d_input_size);
+            baseband = d_if_buffer;
         }
+
+    // Integrate and dump: moving average over d_decimation_factor samples
+    // (first null at the output sampling frequency) and decimation
+    for (unsigned int k = 0; k < d_signal_size; k++)
+        {
+            gr_complex sum = baseband[k * d_decimation_factor];
+            for (unsigned int j = 1; j < d_decimation_factor; j++)
+                {
+                    sum += baseband[k * d_decimation_factor + j];
+                }
+            d_decimated[k] = sum;
+        }
+    return d_decimated;
 }
 
+
+double pcps_acquisition_cc::interpolate_code_phase(unsigned int indext, const float* magnitude)
+{
+    if (d_decimation_factor == 1)
+        {
+            return (double)(indext % d_samples_per_code);
+        }
+
+    // Parabolic interpolation of the correlation peak, mapped back to
+    // samples at the input rate. Decimated sample k integrates the input
+    // samples k*D .. k*D+D-1, so its lag is centred (D-1)/2 samples before
+    // the lag of the local code sampled at the decimated rate
+    float y0 = magnitude[(indext + d_search_size - 1) % d_search_size];
+    float y1 = magnitude[indext];
+    float y2 = magnitude[(indext + 1) % d_search_size];
+    float denominator = y0 - 2.0 * y1 + y2;
+    double delta = 0.0;
+    if (denominator != 0.0)
+        {
+            delta = 0.5 * (y0 - y2) / denominator;
+        }
+    double code_phase = fmod(((double)indext + delta) * (double)d_decimation_factor
+            - 0.5 * (double)(d_decimation_factor - 1), (double)d_input_samples_per_code);
+    if (code_phase < 0.0)
+        {
+            code_phase += (double)d_input_samples_per_code;
+        }
+    return code_phase;
+}
+
+void pcps_acquisition_cc::record_peak(float magt, unsigned int indext, int doppler,
+        const float* magnitude)
+{
+    if (d_mag < magt)
+        {
+            d_mag = magt;
+
+            // In case that d_bit_transition_flag = true, we compare the potentially
+            // new maximum test statistics (d_mag/d_input_power) with the value in
+            // d_test_statistics. When the second dwell is being processed, the value
+            // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
+            // the maximum test statistics in the previous dwell is greater than
+            // current d_mag/d_input_power). Note that d_test_statistics is not
+            // restarted between consecutive dwells in multidwell operation.
+            if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
+            {
+                d_gnss_synchro->Acq_delay_samples = interpolate_code_phase(indext, magnitude);
+                d_gnss_synchro->Acq_doppler_hz = (double)doppler;
+                d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+
+                // 5- Compute the test statistics and compare to the threshold
+                //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
+                d_test_statistics = d_mag / d_input_power;
+            }
+        }
+}
+
+
+void pcps_acquisition_cc::start_reacquisition()
+{
+    d_reacquisition = false;
+    d_doppler_first = 0;
+    d_doppler_last = d_num_doppler_bins > 0 ? d_num_doppler_bins - 1 : 0;
+    if (d_reacquisition_max_dwells > 0 && d_gnss_synchro->Flag_reacquisition
+            && d_gnss_synchro->Reacq_code_period_samples > 0.0)
+        {
+            const double outage_s = std::abs((double)d_sample_counter - (double)d_gnss_synchro->Reacq_samplestamp_samples)
+                    / ((double)d_fs_in * (double)d_decimation_factor);
+            if (outage_s < REACQUISITION_MAX_OUTAGE)
+                {
+                    d_reacquisition = true;
+                    LOG(INFO) << "Channel " << d_channel << ": reacquisition of satellite "
+                              << d_gnss_synchro->System << " " << d_gnss_synchro->PRN
+                              << " around Doppler " << d_gnss_synchro->Reacq_doppler_hz << " [Hz], "
+                              << outage_s << " [s] after the loss of lock";
+                }
+        }
+    // The last state in lock is only used by the first acquisition after the loss of lock
+    d_gnss_synchro->Flag_reacquisition = false;
+}
+
+
+void pcps_acquisition_cc::predict_reacquisition_window(unsigned long int snapshot_start)
+{
+    const double fs_input = (double)d_fs_in * (double)d_decimation_factor;
+    const double elapsed_samples = (double)snapshot_start - (double)d_gnss_synchro->Reacq_samplestamp_samples;
+
+    // Doppler bins around the Doppler extrapolated with the Doppler rate
+    const double doppler_hz = d_gnss_synchro->Reacq_doppler_hz
+            + d_gnss_synchro->Reacq_doppler_rate_hz_s * elapsed_samples / fs_input;
+    const int center = (int)round((doppler_hz + (double)d_doppler_max) / (double)d_doppler_step);
+    const int first = std::max(center - (int)d_reacquisition_doppler_bins, 0);
+    const int last = std::min(center + (int)d_reacquisition_doppler_bins, (int)d_num_doppler_bins - 1);
+    if (first > last)
+        {
+            // The prediction is out of the grid
+            d_reacquisition = false;
+            d_doppler_first = 0;
+            d_doppler_last = d_num_doppler_bins > 0 ? d_num_doppler_bins - 1 : 0;
+            return;
+        }
+    d_doppler_first = first;
+    d_doppler_last = last;
+
+    // A code period starts every Reacq_code_period_samples from
+    // Reacq_samplestamp_samples: the code phase is the lag of the first
+    // one in the snapshot
+    const double period_samples = d_gnss_synchro->Reacq_code_period_samples;
+    double code_phase = fmod(-elapsed_samples, period_samples);
+    if (code_phase < 0.0)
+        {
+            code_phase += period_samples;
+        }
+    // Lag of the decimated search (see interpolate_code_phase)
+    d_reacquisition_code_phase = (code_phase + 0.5 * (double)(d_decimation_factor - 1))
+            / (double)d_decimation_factor;
+}
+
+
+void pcps_acquisition_cc::mask_code_phases(float* magnitude)
+{
+    // The lags out of the predicted window cannot be the peak
+    const double period = (double)d_samples_per_code;
+    const double window = d_reacquisition_code_samples / (double)d_decimation_factor;
+    for (unsigned int i = 0; i < d_search_size; i++)
+        {
+            double distance = fmod(std::abs((double)i - d_reacquisition_code_phase), period);
+            distance = std::min(distance, period - distance);
+            if (distance > window)
+                {
+                    magnitude[i] = 0.0;
+                }
+        }
+}
+
+
 int pcps_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items)
@@ -192,7 +493,8 @@ int pcps_acquisition_cc::general_work(int noutput_items,
     {
     case 0:
         {
-            if (d_active)
+            // under overload, the new searches wait until the receiver is relieved
+            if (d_active and !Gnss_Overload_Controller::instance().acquisition_paused())
                 {
                     //restart acquisition variables
                     d_gnss_synchro->Acq_delay_samples = 0.0;
@@ -202,11 +504,13 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    d_grid.reset();
+                    start_reacquisition();
 
                     d_state = 1;
                 }
 
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += d_input_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
             break;
@@ -218,14 +522,24 @@ int pcps_acquisition_cc::general_work(int noutput_items,
             int doppler;
             unsigned int indext = 0;
             float magt = 0.0;
-            const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
-            float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
+            const gr_complex *in = decimate((const gr_complex *)input_items[0]); //Get the input samples pointer
+            float fft_normalization_factor = (float)d_fft_size * (float)d_signal_size;
             d_input_power = 0.0;
             d_mag = 0.0;
 
-            d_sample_counter += d_fft_size; // sample counter
+            d_sample_counter += d_input_size; // sample counter
 
-            d_well_count++;
+            if (d_reacquisition)
+                {
+                    predict_reacquisition_window(d_sample_counter - d_input_size);
+                }
+
+            if (d_grid.dwells() == 0)
+                {
+                    // First snapshot of the dwell
+                    d_well_count++;
+                    d_noncoherent_power = 0.0;
+                }
 
             DLOG(INFO) << "Channel: " << d_channel
                     << " , doing acquisition of satellite: " << d_gnss_synchro->System << " "<< d_gnss_synchro->PRN
@@ -234,61 +548,88 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     << ", doppler_step: " << d_doppler_step;
 
             // 1- Compute the input signal power estimation
-            volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
-            volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
-            d_input_power /= (float)d_fft_size;
+            volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_signal_size);
+            volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_signal_size);
+            d_input_power /= (float)d_signal_size;
+
+            // With Doppler bin rotation, compute the FFT of the incoming signal
+            // once for each fractional residual of the Doppler grid
+            for (unsigned int i = 0; i < d_residual_spectra.size(); i++)
+                {
+                    if (d_residual_wipeoffs[i] != 0)
+                        {
+                            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                        d_residual_wipeoffs[i], d_signal_size);
+                        }
+                    else
+                        {
+                            memcpy(d_fft_if->get_inbuf(), in, sizeof(gr_complex)*d_signal_size);
+                        }
+                    d_fft_if->execute();
+                    memcpy(d_residual_spectra[i], d_fft_if->get_outbuf(), sizeof(gr_complex)*d_fft_size);
+                }
 
             // 2- Doppler frequency search loop
-            for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
+            for (unsigned int doppler_index = d_doppler_first; doppler_index <= d_doppler_last && doppler_index < d_num_doppler_bins; doppler_index++)
                 {
                     // doppler search steps
 
                     doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
-                    volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                    if (d_doppler_bin_rotation)
+                        {
+                            // 3- Perform the FFT-based convolution  (parallel time search)
+                            // The carrier wipeoff by an integer number of FFT bins is a
+                            // circular rotation of the input spectrum
+                            const gr_complex* spectrum = d_residual_spectra[d_doppler_bin_residual[doppler_index]];
+                            unsigned int shift = d_doppler_bin_shift[doppler_index];
+                            volk_32fc_x2_multiply_32fc_u(d_ifft->get_inbuf(),
+                                        spectrum + shift, d_fft_codes.get(), d_fft_size - shift);
+                            if (shift > 0)
+                                {
+                                    volk_32fc_x2_multiply_32fc_u(d_ifft->get_inbuf() + d_fft_size - shift,
+                                                spectrum, d_fft_codes.get() + d_fft_size - shift, shift);
+                                }
+                        }
+                    else
+                        {
+                            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                        d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_signal_size);
 
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
+                            // 3- Perform the FFT-based convolution  (parallel time search)
+                            // Compute the FFT of the carrier wiped--off incoming signal
+                            d_fft_if->execute();
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                            // Multiply carrier wiped--off, Fourier transformed incoming signal
+                            // with the local FFT'd code reference using SIMD operations with VOLK library
+                            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                        d_fft_if->get_outbuf(), d_fft_codes.get(), d_fft_size);
+                        }
 
                     // compute the inverse FFT
                     d_ifft->execute();
 
                     // Search maximum
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-                    volk_32f_index_max_16u_a(&indext, d_magnitude, d_fft_size);
+                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_search_size);
+                    if (d_reacquisition)
+                        {
+                            mask_code_phases(d_magnitude);
+                        }
+                    if (d_noncoherent_dwells > 1)
+                        {
+                            // Non-coherent integration: the peak is searched once the
+                            // dwell is complete
+                            d_grid.accumulate(doppler_index, d_magnitude);
+                        }
+                    else
+                        {
+                            volk_32f_index_max_16u_a(&indext, d_magnitude, d_search_size);
 
-                    // Normalize the maximum value to correct the scale factor introduced by FFTW
-                    magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+                            // Normalize the maximum value to correct the scale factor introduced by FFTW
+                            magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
 
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
-                        {
-                            d_mag = magt;
-
-                            // In case that d_bit_transition_flag = true, we compare the potentially
-                            // new maximum test statistics (d_mag/d_input_power) with the value in
-                            // d_test_statistics. When the second dwell is being processed, the value
-                            // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
-                            // the maximum test statistics in the previous dwell is greater than
-                            // current d_mag/d_input_power). Note that d_test_statistics is not
-                            // restarted between consecutive dwells in multidwell operation.
-                            if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
-                            {
-                                d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
-                                d_gnss_synchro->Acq_doppler_hz = (double)doppler;
-                                d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
-
-                                // 5- Compute the test statistics and compare to the threshold
-                                //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
-                                d_test_statistics = d_mag / d_input_power;
-                            }
+                            // 4- record the maximum peak and the associated synchronization parameters
+                            record_peak(magt, indext, doppler, d_magnitude);
                         }
 
                     // Record results to file if required
@@ -306,20 +647,43 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
+            if (d_noncoherent_dwells > 1)
+                {
+                    d_noncoherent_power += d_input_power;
+                    d_grid.add_dwell();
+                    if (d_grid.dwells() < d_noncoherent_dwells)
+                        {
+                            consume_each(1);
+                            break;
+                        }
+
+                    // Test the mean of the accumulated magnitudes against the mean
+                    // input power. The code phase is the same in every snapshot,
+                    // since they span an integer number of code periods.
+                    unsigned int doppler_index = 0;
+                    magt = d_grid.max(doppler_index, indext) / (fft_normalization_factor
+                            * fft_normalization_factor * (float)d_noncoherent_dwells);
+                    d_input_power = d_noncoherent_power / (float)d_noncoherent_dwells;
+                    doppler = -(int)d_doppler_max + d_doppler_step * doppler_index;
+                    record_peak(magt, indext, doppler, d_grid.bin(doppler_index));
+                    d_grid.reset();
+                }
+
+            const unsigned int max_dwells = d_reacquisition ? d_reacquisition_max_dwells : d_max_dwells;
             if (!d_bit_transition_flag)
                 {
                     if (d_test_statistics > d_threshold)
                         {
                             d_state = 2; // Positive acquisition
                         }
-                    else if (d_well_count == d_max_dwells)
+                    else if (d_well_count == max_dwells)
                         {
                             d_state = 3; // Negative acquisition
                         }
                 }
             else
                 {
-                    if (d_well_count == d_max_dwells) // d_max_dwells = 2
+                    if (d_well_count == max_dwells) // d_max_dwells = 2
                         {
                             if (d_test_statistics > d_threshold)
                                 {
@@ -332,6 +696,22 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
+            if (d_state == 3 && d_reacquisition)
+                {
+                    // Not found around the prediction: search the whole grid
+                    LOG(INFO) << "Channel " << d_channel << ": reacquisition of satellite "
+                              << d_gnss_synchro->System << " " << d_gnss_synchro->PRN
+                              << " failed, searching the whole grid";
+                    d_reacquisition = false;
+                    d_doppler_first = 0;
+                    d_doppler_last = d_num_doppler_bins > 0 ? d_num_doppler_bins - 1 : 0;
+                    d_well_count = 0;
+                    d_mag = 0.0;
+                    d_test_statistics = 0.0;
+                    d_grid.reset();
+                    d_state = 1;
+                }
+
             consume_each(1);
 
             break;
@@ -349,11 +729,17 @@ int pcps_acquisition_cc::general_work(int noutput_items,
             DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
             DLOG(INFO) << "magnitude " << d_mag;
             DLOG(INFO) << "input signal power " << d_input_power;
+            if (d_reacquisition)
+                {
+                    LOG(INFO) << "Channel " << d_channel << ": satellite " << d_gnss_synchro->System
+                              << " " << d_gnss_synchro->PRN << " reacquired in " << d_well_count << " dwells";
+                    d_reacquisition = false;
+                }
 
             d_active = false;
             d_state = 0;
 
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += d_input_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
             acquisition_message = 1;
@@ -378,7 +764,7 @@ int pcps_acquisition_cc::general_work(int noutput_items,
             d_active = false;
             d_state = 0;
 
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += d_input_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
             acquisition_message = 2;
@@ -53,14 +53,18 @@
 #include <fstream>
 #include <queue>
 #include <string>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/fft/fft.h>
+#include "gnss_acquisition_grid.h"
+#include "gnss_fft_plan_cache.h"
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "gnss_doppler_wipeoff_store.h"
 
 class pcps_acquisition_cc;
 
@@ -70,7 +74,9 @@ pcps_acquisition_cc_sptr
 pcps_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
-                         bool bit_transition_flag,
+                         bool bit_transition_flag, bool doppler_bin_rotation,
+                         unsigned int decimation_factor, bool fast_fft_size,
+                         unsigned int noncoherent_dwells,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename);
 
@@ -79,6 +85,35 @@ pcps_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
  *
  * Check \ref Navitec2012 "An Open Source Galileo E1 Software Receiver",
  * Algorithm 1, for a pseudocode description of this implementation.
+ *
+ * If doppler_bin_rotation is set, the Doppler bins that differ by an integer
+ * number of FFT bins (fs_in / fft_size) are not wiped off in time domain:
+ * the input spectrum is computed once for each distinct fractional residual
+ * and circularly rotated against the code spectrum.
+ *
+ * With a decimation_factor D > 1, the input vectors (sampled_ms *
+ * samples_per_ms samples at fs_in) are brought to baseband, low-pass
+ * filtered by integrate-and-dump over D samples and decimated before the
+ * search, so that the FFTs run on fft_size / D samples at fs_in / D. The
+ * local code must then be sampled at fs_in / D. The code phase is
+ * interpolated around the correlation peak and reported in samples at
+ * fs_in.
+ *
+ * With fast_fft_size, a vector length that FFTW transforms slowly (e.g.
+ * 16368 samples) is zero-padded to the next product of powers of 2, 3 and
+ * 5 not lower than the vector length plus one code period. The local code
+ * is extended periodically at both ends of the FFT buffer, so that the
+ * correlation over the code phases of one period stays exact.
+ *
+ * With noncoherent_dwells N > 1, each dwell accumulates the squared
+ * correlation magnitudes of N consecutive input vectors in a search grid,
+ * and the test statistics of its maximum (mean magnitude over mean input
+ * power) is compared to the threshold once, at the end of the dwell.
+ * With the reacquisition enabled, an acquisition started after a loss of
+ * lock of the tracking first searches a few Doppler bins and code phases
+ * around the ones predicted from the last state in lock (the reacquisition
+ * data of the Gnss_Synchro), for a limited number of dwells, and only then
+ * the whole grid.
  */
 class pcps_acquisition_cc: public gr::block
 {
@@ -87,20 +122,33 @@ private:
     pcps_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
-            bool bit_transition_flag,
+            bool bit_transition_flag, bool doppler_bin_rotation,
+            unsigned int decimation_factor, bool fast_fft_size,
+            unsigned int noncoherent_dwells,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
     pcps_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
-            bool bit_transition_flag,
+            bool bit_transition_flag, bool doppler_bin_rotation,
+            unsigned int decimation_factor, bool fast_fft_size,
+            unsigned int noncoherent_dwells,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
     void calculate_magnitudes(gr_complex* fft_begin, int doppler_shift,
             int doppler_offset);
 
+    void init_doppler_bin_rotation();
+    void free_doppler_bin_rotation();
+    const gr_complex* decimate(const gr_complex* in);
+    double interpolate_code_phase(unsigned int indext, const float* magnitude);
+    void record_peak(float magt, unsigned int indext, int doppler, const float* magnitude);
+    void start_reacquisition();
+    void predict_reacquisition_window(unsigned long int snapshot_start);
+    void mask_code_phases(float* magnitude);
+
     long d_fs_in;
     long d_freq;
     int d_samples_per_ms;
@@ -114,12 +162,24 @@ private:
     unsigned int d_max_dwells;
     unsigned int d_well_count;
     unsigned int d_fft_size;
+    unsigned int d_signal_size;  // samples of the (decimated) input vector
+    unsigned int d_search_size;  // correlation lags searched for the peak
+    unsigned int d_noncoherent_dwells;
+    float d_noncoherent_power;   // input power summed over the dwell
+    Gnss_Acquisition_Grid d_grid;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
-    gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
+    unsigned int d_doppler_first;      // Doppler bins searched
+    unsigned int d_doppler_last;
+    unsigned int d_reacquisition_max_dwells;   // 0 disables the reacquisition
+    unsigned int d_reacquisition_doppler_bins; // Doppler bins searched at each side of the prediction
+    double d_reacquisition_code_samples;       // code phases searched at each side of the prediction, at the input rate
+    bool d_reacquisition;              // the dwells search the predicted window
+    double d_reacquisition_code_phase; // predicted code phase in the current snapshot, at the search rate
+    boost::shared_ptr<const gr_complex> d_fft_codes;
+    Gnss_Fft* d_fft_if;
+    Gnss_Fft* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -128,6 +188,17 @@ private:
     float d_input_power;
     float d_test_statistics;
     bool d_bit_transition_flag;
+    bool d_doppler_bin_rotation;
+    std::vector<unsigned int> d_doppler_bin_shift;    // FFT bin rotation of each Doppler bin
+    std::vector<unsigned int> d_doppler_bin_residual; // residual wipeoff used by each Doppler bin
+    std::vector<gr_complex*> d_residual_wipeoffs;     // 0 for a 0 Hz residual
+    std::vector<gr_complex*> d_residual_spectra;      // input spectrum after each residual wipeoff
+    unsigned int d_decimation_factor;
+    unsigned int d_input_size;         // samples per input vector, at the input rate
+    int d_input_samples_per_code;      // samples per code period, at the input rate
+    gr_complex* d_if_wipeoff;          // input rate IF wipeoff, 0 if not decimating
+    gr_complex* d_if_buffer;           // input vector after the IF wipeoff
+    gr_complex* d_decimated;           // decimated input vector
     gr::msg_queue::sptr d_queue;
     concurrent_queue<int> *d_channel_internal_queue;
     std::ofstream d_dump_file;
@@ -168,7 +239,7 @@ public:
 
      /*!
       * \brief Sets local code for PCPS acquisition algorithm.
-      * \param code - Pointer to the PRN code.
+      * \param code - Pointer to the PRN code, sampled at fs_in / decimation_factor.
       */
      void set_local_code(std::complex<float> * code);
 
@@ -220,6 +291,24 @@ public:
      }
 
 
+     /*!
+      * \brief Enables the reacquisition after a loss of lock of the
+      * tracking.
+      * \param max_dwells - Dwells searching the predicted window before the
+      * whole grid is searched (0 disables the reacquisition).
+      * \param doppler_bins - Doppler bins searched at each side of the
+      * predicted Doppler.
+      * \param code_window_samples - Code phases searched at each side of
+      * the predicted one [samples].
+      */
+     void set_reacquisition(unsigned int max_dwells, unsigned int doppler_bins,
+             double code_window_samples)
+     {
+         d_reacquisition_max_dwells = max_dwells;
+         d_reacquisition_doppler_bins = doppler_bins;
+         d_reacquisition_code_samples = code_window_samples;
+     }
+
      /*!
       * \brief Set tracking channel internal queue.
       * \param channel_internal_queue - Channel's internal blocks information queue.
@@ -36,9 +36,10 @@
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
-#include "nco_lib.h"
+#include "carrier_nco.h"
 #include "concurrent_map.h"
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 #include "gps_sdr_signal_processing.h"
 #include "control_message_factory.h"
 
@@ -83,14 +84,13 @@ pcps_acquisition_fine_doppler_cc::pcps_acquisition_fine_doppler_cc(
 	d_state=0;
 	//todo: do something if posix_memalign fails
 	if (posix_memalign((void**)&d_carrier, 16, d_fft_size * sizeof(gr_complex)) == 0){};
-	if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
 	// Direct FFT
-	d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+	d_fft_if = new Gnss_Fft(d_fft_size, true);
 
 	// Inverse FFT
-	d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+	d_ifft = new Gnss_Fft(d_fft_size, false);
 
 	// For dumping samples into a file
 	d_dump = dump;
@@ -128,7 +128,6 @@ void pcps_acquisition_fine_doppler_cc::free_grid_memory()
 pcps_acquisition_fine_doppler_cc::~pcps_acquisition_fine_doppler_cc()
 {
 	free(d_carrier);
-	free(d_fft_codes);
 	delete d_ifft;
 	delete d_fft_if;
 	if (d_dump)
@@ -142,12 +141,10 @@ pcps_acquisition_fine_doppler_cc::~pcps_acquisition_fine_doppler_cc()
 
 void pcps_acquisition_fine_doppler_cc::set_local_code(std::complex<float> * code)
 {
-
-	memcpy(d_fft_if->get_inbuf(),code,sizeof(gr_complex)*d_fft_size);
-	d_fft_if->execute(); // We need the FFT of local code
-	//Conjugate the local code
-	volk_32fc_conjugate_32fc_a(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
-
+	// The conjugated code spectrum is shared by all the channels
+	d_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+			d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+			code, d_fft_if);
 }
 
 void pcps_acquisition_fine_doppler_cc::init()
@@ -193,7 +190,7 @@ void pcps_acquisition_fine_doppler_cc::update_carrier_wipeoff()
 	    phase_step_rad = (float)GPS_TWO_PI*doppler_hz / (float)d_fs_in;
 
 	    d_grid_doppler_wipeoffs[doppler_index]=new gr_complex[d_fft_size];
-	    fxp_nco(d_grid_doppler_wipeoffs[doppler_index], d_fft_size,0, phase_step_rad);
+	    carrier_nco(d_grid_doppler_wipeoffs[doppler_index], d_fft_size,0, phase_step_rad);
 	}
 }
 
@@ -296,7 +293,7 @@ int pcps_acquisition_fine_doppler_cc::compute_and_accumulate_grid(gr_vector_cons
 
 		// Multiply carrier wiped--off, Fourier transformed incoming signal
 		// with the local FFT'd code reference using SIMD operations with VOLK library
-		volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+		volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes.get(), d_fft_size);
 
 		// compute the inverse FFT
 		d_ifft->execute();
@@ -319,7 +316,7 @@ int pcps_acquisition_fine_doppler_cc::estimate_Doppler(gr_vector_const_void_star
 	// Direct FFT
 	int zero_padding_factor=16;
 	int fft_size_extended=d_fft_size*zero_padding_factor;
-	gr::fft::fft_complex *fft_operator=new gr::fft::fft_complex(fft_size_extended,true);
+	Gnss_Fft *fft_operator=new Gnss_Fft(fft_size_extended,true);
 	//zero padding the entire vector
 	memset(fft_operator->get_inbuf(),0,fft_size_extended*sizeof(gr_complex));
 
@@ -35,9 +35,10 @@
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
-#include "nco_lib.h"
+#include "carrier_nco.h"
 #include "concurrent_map.h"
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 #include "control_message_factory.h"
 #include "gps_acq_assist.h"
 
@@ -84,13 +85,12 @@ pcps_assisted_acquisition_cc::pcps_assisted_acquisition_cc(
     d_disable_assist = false;
     //todo: do something if posix_memalign fails
     if (posix_memalign((void**)&d_carrier, 16, d_fft_size * sizeof(gr_complex)) == 0){};
-    if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = new Gnss_Fft(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
@@ -110,10 +110,9 @@ void pcps_assisted_acquisition_cc::free_grid_memory()
 {
     for (int i = 0; i < d_num_doppler_points; i++)
         {
-            delete[] d_grid_data[i];
             delete[] d_grid_doppler_wipeoffs[i];
         }
-    delete d_grid_data;
+    delete[] d_grid_doppler_wipeoffs;
 }
 
 
@@ -121,7 +120,6 @@ void pcps_assisted_acquisition_cc::free_grid_memory()
 pcps_assisted_acquisition_cc::~pcps_assisted_acquisition_cc()
 {
     free(d_carrier);
-    free(d_fft_codes);
     delete d_ifft;
     delete d_fft_if;
     if (d_dump)
@@ -134,7 +132,10 @@ pcps_assisted_acquisition_cc::~pcps_assisted_acquisition_cc()
 
 void pcps_assisted_acquisition_cc::set_local_code(std::complex<float> * code)
 {
-    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
+    // The conjugated code spectrum is shared by all the channels
+    d_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            code, d_fft_if);
 }
 
 
@@ -146,11 +147,6 @@ void pcps_assisted_acquisition_cc::init()
     d_gnss_synchro->Acq_samplestamp_samples = 0;
     d_input_power = 0.0;
     d_state = 0;
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc_a(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
 }
 
 
@@ -195,13 +191,7 @@ void pcps_assisted_acquisition_cc::get_assistance()
 void pcps_assisted_acquisition_cc::reset_grid()
 {
     d_well_count = 0;
-    for (int i = 0; i < d_num_doppler_points; i++)
-        {
-            for (unsigned int j = 0; j < d_fft_size; j++)
-                {
-                    d_grid_data[i][j] = 0.0;
-                }
-        }
+    d_grid.reset();
 }
 
 
@@ -215,12 +205,7 @@ void pcps_assisted_acquisition_cc::redefine_grid()
         }
     // Create the search grid array
     d_num_doppler_points = floor(std::abs(d_doppler_max-d_doppler_min)/d_doppler_step);
-
-    d_grid_data = new float*[d_num_doppler_points];
-    for (int i = 0; i < d_num_doppler_points; i++)
-        {
-            d_grid_data[i] = new float[d_fft_size];
-        }
+    d_grid.resize(d_num_doppler_points, d_fft_size);
 
     // create the carrier Doppler wipeoff signals
     int doppler_hz;
@@ -233,7 +218,7 @@ void pcps_assisted_acquisition_cc::redefine_grid()
             // compute the carrier doppler wipe-off signal and store it
             phase_step_rad = (float)GPS_TWO_PI*doppler_hz / (float)d_fs_in;
             d_grid_doppler_wipeoffs[doppler_index] = new gr_complex[d_fft_size];
-            fxp_nco(d_grid_doppler_wipeoffs[doppler_index], d_fft_size, 0, phase_step_rad);
+            carrier_nco(d_grid_doppler_wipeoffs[doppler_index], d_fft_size, 0, phase_step_rad);
         }
 }
 
@@ -243,20 +228,10 @@ double pcps_assisted_acquisition_cc::search_maximum()
 {
     float magt = 0.0;
     float fft_normalization_factor;
-    int index_doppler = 0;
-    unsigned int tmp_intex_t;
+    unsigned int index_doppler = 0;
     unsigned int index_time = 0;
 
-    for (int i=0;i<d_num_doppler_points;i++)
-        {
-            volk_32f_index_max_16u_a(&tmp_intex_t,d_grid_data[i],d_fft_size);
-            if (d_grid_data[i][tmp_intex_t] > magt)
-                {
-                    magt = d_grid_data[i][index_time];
-                    index_doppler = i;
-                    index_time = tmp_intex_t;
-                }
-        }
+    magt = d_grid.max(index_doppler, index_time);
 
     // Normalize the maximum value to correct the scale factor introduced by FFTW
     fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
@@ -274,13 +249,13 @@ double pcps_assisted_acquisition_cc::search_maximum()
     if (d_dump)
         {
             std::stringstream filename;
-            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
+            std::streamsize n = sizeof(float) * (d_fft_size); // accumulated |abs(x)|^2 of the bin
             filename.str("");
             filename << "../data/test_statistics_" << d_gnss_synchro->System
                      << "_" << d_gnss_synchro->Signal << "_sat_"
                      << d_gnss_synchro->PRN << "_doppler_" <<  d_gnss_synchro->Acq_doppler_hz << ".dat";
             d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-            d_dump_file.write((char*)d_grid_data[index_doppler], n); //write directly |abs(x)|^2 in this Doppler bin?
+            d_dump_file.write((char*)d_grid.bin(index_doppler), n); //write directly |abs(x)|^2 in this Doppler bin?
             d_dump_file.close();
         }
 
@@ -333,15 +308,14 @@ int pcps_assisted_acquisition_cc::compute_and_accumulate_grid(gr_vector_const_vo
 
             // Multiply carrier wiped--off, Fourier transformed incoming signal
             // with the local FFT'd code reference using SIMD operations with VOLK library
-            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes.get(), d_fft_size);
 
             // compute the inverse FFT
             d_ifft->execute();
 
             // save the grid matrix delay file
             volk_32fc_magnitude_squared_32f_a(p_tmp_vector, d_ifft->get_outbuf(), d_fft_size);
-            const float*  old_vector = d_grid_data[doppler_index];
-            volk_32f_x2_add_32f_a(d_grid_data[doppler_index], old_vector, p_tmp_vector, d_fft_size);
+            d_grid.accumulate(doppler_index, p_tmp_vector);
         }
     free(p_tmp_vector);
     return d_fft_size;
@@ -53,11 +53,13 @@
 #include <string>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/fft/fft.h>
+#include "gnss_fft_plan_cache.h"
 #include "concurrent_queue.h"
+#include "gnss_acquisition_grid.h"
 #include "gnss_synchro.h"
 
 class pcps_assisted_acquisition_cc;
@@ -120,13 +122,13 @@ private:
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
     gr_complex* d_carrier;
-    gr_complex* d_fft_codes;
+    boost::shared_ptr<const gr_complex> d_fft_codes;
 
-    float** d_grid_data;
+    Gnss_Acquisition_Grid d_grid;   // accumulated over the d_max_dwells snapshots
     gr_complex** d_grid_doppler_wipeoffs;
 
-    gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
+    Gnss_Fft* d_fft_if;
+    Gnss_Fft* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
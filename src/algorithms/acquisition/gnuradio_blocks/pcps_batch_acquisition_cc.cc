@@ -0,0 +1,475 @@
+/*!
+ * \file pcps_batch_acquisition_cc.cc
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * engine shared by several channels, which searches all the pending
+ * satellites on the same snapshot.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_batch_acquisition_cc.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "gnss_code_fft_cache.h"
+
+using google::LogMessage;
+
+pcps_batch_acquisition_cc_sptr pcps_make_batch_acquisition_cc(
+                                 unsigned int sampled_ms, unsigned int max_dwells,
+                                 long freq, long fs_in, int samples_per_ms,
+                                 int samples_per_code, bool bit_transition_flag,
+                                 gr::msg_queue::sptr queue, bool dump,
+                                 std::string dump_filename)
+{
+    return pcps_batch_acquisition_cc_sptr(
+            new pcps_batch_acquisition_cc(sampled_ms, max_dwells, freq, fs_in,
+                                          samples_per_ms, samples_per_code,
+                                          bit_transition_flag, queue, dump,
+                                          dump_filename));
+}
+
+
+pcps_batch_acquisition_cc::Request::Request()
+{
+    gnss_synchro = 0;
+    channel_internal_queue = 0;
+    threshold = 0.0;
+    doppler_max = 0;
+    doppler_step = 0;
+    active = false;
+    searching = false;
+    epoch = 0;
+    well_count = 0;
+    mag = 0.0;
+    test_statistics = 0.0;
+}
+
+
+pcps_batch_acquisition_cc::pcps_batch_acquisition_cc(
+                         unsigned int sampled_ms, unsigned int max_dwells,
+                         long freq, long fs_in, int samples_per_ms,
+                         int samples_per_code, bool bit_transition_flag,
+                         gr::msg_queue::sptr queue, bool dump,
+                         std::string dump_filename) :
+    gr::block("pcps_batch_acquisition_cc",
+    gr::io_signature::make(1, 1, sizeof(gr_complex) * sampled_ms * samples_per_ms),
+    gr::io_signature::make(0, 0, sizeof(gr_complex) * sampled_ms * samples_per_ms))
+{
+    d_sample_counter = 0;    // SAMPLE COUNTER
+    d_queue = queue;
+    d_freq = freq;
+    d_fs_in = fs_in;
+    d_samples_per_ms = samples_per_ms;
+    d_samples_per_code = samples_per_code;
+    d_sampled_ms = sampled_ms;
+    d_max_dwells = max_dwells;
+    d_fft_size = d_sampled_ms * d_samples_per_ms;
+    d_bit_transition_flag = bit_transition_flag;
+
+    //todo: do something if posix_memalign fails
+    if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
+
+    // Direct FFT
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
+
+    // Inverse FFT
+    d_ifft = new Gnss_Fft(d_fft_size, false);
+
+    // Direct FFT for the local codes, so that channels can set their code
+    // while a snapshot is being processed
+    d_fft_code = new Gnss_Fft(d_fft_size, true);
+
+    // For dumping samples into a file
+    d_dump = dump;
+    d_dump_filename = dump_filename;
+}
+
+
+pcps_batch_acquisition_cc::~pcps_batch_acquisition_cc()
+{
+    free(d_magnitude);
+
+    delete d_ifft;
+    delete d_fft_if;
+    delete d_fft_code;
+
+    if (d_dump)
+        {
+            d_dump_file.close();
+        }
+}
+
+
+void pcps_batch_acquisition_cc::set_gnss_synchro(unsigned int channel, Gnss_Synchro* p_gnss_synchro)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests[channel].gnss_synchro = p_gnss_synchro;
+}
+
+
+unsigned int pcps_batch_acquisition_cc::mag(unsigned int channel)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_requests[channel].mag;
+}
+
+
+void pcps_batch_acquisition_cc::set_threshold(unsigned int channel, float threshold)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests[channel].threshold = threshold;
+}
+
+
+void pcps_batch_acquisition_cc::set_doppler_max(unsigned int channel, unsigned int doppler_max)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests[channel].doppler_max = doppler_max;
+}
+
+
+void pcps_batch_acquisition_cc::set_doppler_step(unsigned int channel, unsigned int doppler_step)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests[channel].doppler_step = doppler_step;
+}
+
+
+void pcps_batch_acquisition_cc::set_channel_queue(unsigned int channel,
+        concurrent_queue<int> *channel_internal_queue)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests[channel].channel_internal_queue = channel_internal_queue;
+}
+
+
+void pcps_batch_acquisition_cc::remove_channel(unsigned int channel)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_requests.erase(channel);
+    update_grid();
+}
+
+
+void pcps_batch_acquisition_cc::set_local_code(unsigned int channel, std::complex<float> * code)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Request& request = d_requests[channel];
+
+    // The conjugated code spectrum is shared with the other channels
+    request.fft_code = Gnss_Code_Fft_Cache::instance().get(request.gnss_synchro->System,
+            request.gnss_synchro->Signal, request.gnss_synchro->PRN, d_fs_in, d_fft_size,
+            code, d_fft_code);
+}
+
+
+void pcps_batch_acquisition_cc::init(unsigned int channel)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Request& request = d_requests[channel];
+
+    request.gnss_synchro->Acq_delay_samples = 0.0;
+    request.gnss_synchro->Acq_doppler_hz = 0.0;
+    request.gnss_synchro->Acq_samplestamp_samples = 0;
+    request.mag = 0.0;
+    request.test_statistics = 0.0;
+
+    update_grid();
+}
+
+
+void pcps_batch_acquisition_cc::update_grid()
+{
+    // The grid covers the widest range with the finest step of all the channels
+    unsigned int doppler_max = 0;
+    unsigned int doppler_step = 0;
+    std::map<unsigned int, Request>::iterator it;
+    for (it = d_requests.begin(); it != d_requests.end(); ++it)
+        {
+            if (it->second.doppler_step == 0) continue;
+            if (it->second.doppler_max > doppler_max) doppler_max = it->second.doppler_max;
+            if (doppler_step == 0 || it->second.doppler_step < doppler_step)
+                {
+                    doppler_step = it->second.doppler_step;
+                }
+        }
+    if (doppler_step == 0)
+        {
+            return;
+        }
+
+    for (it = d_requests.begin(); it != d_requests.end(); ++it)
+        {
+            if (it->second.doppler_step != 0 && it->second.doppler_step != doppler_step)
+                {
+                    LOG(WARNING) << "Channel " << it->first << ": batch acquisition searches with a Doppler step of "
+                                 << doppler_step << " Hz instead of " << it->second.doppler_step << " Hz";
+                }
+        }
+
+    // The carrier Doppler wipeoff signals are shared with the other acquisition blocks
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, doppler_max, doppler_step, d_fft_size);
+}
+
+
+void pcps_batch_acquisition_cc::set_active(unsigned int channel, bool active)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Request& request = d_requests[channel];
+    request.active = active;
+    request.searching = false;
+    request.epoch++;
+}
+
+
+int pcps_batch_acquisition_cc::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    /*
+     * Acquisition strategy (Kay Borre book + CFAR threshold), shared by all
+     * the pending requests:
+     * 1. Compute the input signal power estimation
+     * 2. Doppler serial search loop, with one forward FFT per Doppler bin
+     * 3. For each request, perform the FFT-based circular convolution
+     * 4. Record the maximum peak and the associated synchronization parameters
+     * 5. Compute the test statistics and compare to the threshold
+     * 6. Declare positive or negative acquisition using the channel queues
+     */
+
+    // Take the pending requests and the grid they are searched on
+    std::vector<Job> jobs;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> grid;
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        grid = d_grid_doppler_wipeoffs;
+        std::map<unsigned int, Request>::iterator it;
+        for (it = d_requests.begin(); it != d_requests.end(); ++it)
+            {
+                Request& request = it->second;
+                if (!request.active || !request.fft_code || !grid) continue;
+                if (!request.searching)
+                    {
+                        //restart acquisition variables
+                        request.gnss_synchro->Acq_delay_samples = 0.0;
+                        request.gnss_synchro->Acq_doppler_hz = 0.0;
+                        request.gnss_synchro->Acq_samplestamp_samples = 0;
+                        request.well_count = 0;
+                        request.mag = 0.0;
+                        request.test_statistics = 0.0;
+                        request.searching = true;
+                    }
+                Job job;
+                job.channel = it->first;
+                job.epoch = request.epoch;
+                job.gnss_synchro = request.gnss_synchro;
+                job.fft_code = request.fft_code;
+                job.doppler_max = (int)request.doppler_max;
+                job.mag = 0.0;
+                job.code_phase = 0;
+                job.doppler = 0;
+                jobs.push_back(job);
+            }
+    }
+
+    if (jobs.empty())
+        {
+            // Standby: discard the samples
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+            return 0;
+        }
+
+    int doppler;
+    unsigned int indext = 0;
+    float magt = 0.0;
+    float input_power = 0.0;
+    const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+    float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
+
+    d_sample_counter += d_fft_size; // sample counter
+
+    DLOG(INFO) << "Batch acquisition of " << jobs.size() << " satellites"
+               << ", sample stamp: " << d_sample_counter;
+
+    // 1- Compute the input signal power estimation
+    volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
+    volk_32f_accumulator_s32f_a(&input_power, d_magnitude, d_fft_size);
+    input_power /= (float)d_fft_size;
+
+    // 2- Doppler frequency search loop
+    for (unsigned int doppler_index = 0; doppler_index < grid->size(); doppler_index++)
+        {
+            // doppler search steps
+            doppler = grid->doppler(doppler_index);
+
+            bool searched = false;
+            for (unsigned int i = 0; i < jobs.size(); i++)
+                {
+                    if (std::abs(doppler) > jobs[i].doppler_max) continue;
+
+                    if (!searched)
+                        {
+                            // Compute the FFT of the carrier wiped--off incoming
+                            // signal once for all the satellites
+                            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                        grid->wipeoff(doppler_index), d_fft_size);
+                            d_fft_if->execute();
+                            searched = true;
+                        }
+
+                    // 3- Perform the FFT-based convolution  (parallel time search)
+                    // Multiply carrier wiped--off, Fourier transformed incoming signal
+                    // with the local FFT'd code reference using SIMD operations with VOLK library
+                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                d_fft_if->get_outbuf(), jobs[i].fft_code.get(), d_fft_size);
+
+                    // compute the inverse FFT
+                    d_ifft->execute();
+
+                    // Search maximum
+                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
+                    volk_32f_index_max_16u_a(&indext, d_magnitude, d_fft_size);
+
+                    // Normalize the maximum value to correct the scale factor introduced by FFTW
+                    magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+
+                    // 4- record the maximum peak and the associated synchronization parameters
+                    if (jobs[i].mag < magt)
+                        {
+                            jobs[i].mag = magt;
+                            jobs[i].code_phase = indext % d_samples_per_code;
+                            jobs[i].doppler = doppler;
+                        }
+
+                    // Record results to file if required
+                    if (d_dump)
+                        {
+                            std::stringstream filename;
+                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
+                            filename.str("");
+                            filename << "../data/test_statistics_" << jobs[i].gnss_synchro->System
+                                     <<"_" << jobs[i].gnss_synchro->Signal << "_sat_"
+                                     << jobs[i].gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
+                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
+                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
+                            d_dump_file.close();
+                        }
+                }
+        }
+
+    // 5-6- Decide and notify the channels
+    finish_dwell(jobs, input_power);
+
+    // Consecutive dwells use consecutive snapshots. When no request needs a
+    // further dwell, skip the samples buffered meanwhile, as the
+    // single-channel blocks do after a decision.
+    if (jobs.empty())
+        {
+            d_sample_counter += d_fft_size * (ninput_items[0] - 1); // sample counter
+            consume_each(ninput_items[0]);
+        }
+    else
+        {
+            consume_each(1);
+        }
+
+    return 0;
+}
+
+
+void pcps_batch_acquisition_cc::finish_dwell(std::vector<Job>& jobs, float input_power)
+{
+    // On return, jobs only holds the requests that need a further dwell
+    std::vector<Job> pending;
+    boost::mutex::scoped_lock lock(d_mutex);
+    for (unsigned int i = 0; i < jobs.size(); i++)
+        {
+            std::map<unsigned int, Request>::iterator it = d_requests.find(jobs[i].channel);
+            if (it == d_requests.end()) continue;
+            Request& request = it->second;
+
+            // The channel restarted or cancelled the acquisition meanwhile
+            if (request.epoch != jobs[i].epoch || !request.searching) continue;
+
+            request.well_count++;
+            request.mag = jobs[i].mag;
+
+            // With d_bit_transition_flag = true, keep the best test statistics
+            // of consecutive dwells (see pcps_acquisition_cc)
+            float test_statistics = jobs[i].mag / input_power;
+            if (request.test_statistics < test_statistics || !d_bit_transition_flag)
+                {
+                    request.gnss_synchro->Acq_delay_samples = (double)jobs[i].code_phase;
+                    request.gnss_synchro->Acq_doppler_hz = (double)jobs[i].doppler;
+                    request.gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                    request.test_statistics = test_statistics;
+                }
+
+            int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
+            if (!d_bit_transition_flag)
+                {
+                    if (request.test_statistics > request.threshold)
+                        {
+                            acquisition_message = 1; // Positive acquisition
+                        }
+                    else if (request.well_count == d_max_dwells)
+                        {
+                            acquisition_message = 2; // Negative acquisition
+                        }
+                }
+            else if (request.well_count == d_max_dwells) // d_max_dwells = 2
+                {
+                    acquisition_message = request.test_statistics > request.threshold ? 1 : 2;
+                }
+
+            if (acquisition_message == -1)
+                {
+                    pending.push_back(jobs[i]);
+                    continue;
+                }
+
+            DLOG(INFO) << (acquisition_message == 1 ? "positive" : "negative") << " acquisition";
+            DLOG(INFO) << "channel " << jobs[i].channel;
+            DLOG(INFO) << "satellite " << request.gnss_synchro->System << " " << request.gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << request.test_statistics;
+            DLOG(INFO) << "test statistics threshold " << request.threshold;
+            DLOG(INFO) << "code phase " << request.gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << request.gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << request.mag;
+            DLOG(INFO) << "input signal power " << input_power;
+
+            request.active = false;
+            request.searching = false;
+            request.channel_internal_queue->push(acquisition_message);
+        }
+    jobs.swap(pending);
+}
@@ -0,0 +1,241 @@
+/*!
+ * \file pcps_batch_acquisition_cc.h
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * engine shared by several channels, which searches all the pending
+ * satellites on the same snapshot.
+ *
+ *  Acquisition strategy (Kay Borre book + CFAR threshold), run once per
+ *  snapshot for all the channels with an acquisition request.
+ *  <ol>
+ *  <li> Compute the input signal power estimation
+ *  <li> Doppler serial search loop. For each Doppler bin, the carrier is
+ *       wiped off and the input spectrum is computed only once
+ *  <li> For each pending satellite, multiply by its code spectrum and
+ *       perform the inverse FFT (parallel time search)
+ *  <li> Record the maximum peak and the associated synchronization parameters
+ *  <li> Compute the test statistics and compare to the threshold
+ *  <li> Declare positive or negative acquisition using the internal queue
+ *       of each channel
+ *  </ol>
+ *
+ * Kay Borre book: K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
+ * "A Software-Defined GPS and Galileo Receiver. A Single-Frequency
+ * Approach", Birkha user, 2007. pp 81-84
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_BATCH_ACQUISITION_CC_H_
+#define GNSS_SDR_PCPS_BATCH_ACQUISITION_CC_H_
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/block.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/gr_complex.h>
+#include "gnss_fft_plan_cache.h"
+#include "concurrent_queue.h"
+#include "gnss_synchro.h"
+#include "gnss_doppler_wipeoff_store.h"
+
+class pcps_batch_acquisition_cc;
+
+typedef boost::shared_ptr<pcps_batch_acquisition_cc> pcps_batch_acquisition_cc_sptr;
+
+pcps_batch_acquisition_cc_sptr
+pcps_make_batch_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+                               long freq, long fs_in, int samples_per_ms,
+                               int samples_per_code, bool bit_transition_flag,
+                               gr::msg_queue::sptr queue, bool dump,
+                               std::string dump_filename);
+
+/*!
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * that serves all the channels at once.
+ *
+ * Instead of one acquisition block per channel, each one computing the
+ * carrier wipeoff and the forward FFT of its own snapshot for every Doppler
+ * bin, a single block receives the samples and keeps one acquisition
+ * request per channel. On each snapshot, the forward FFTs are computed once
+ * per Doppler bin and shared by all the pending requests, so that only the
+ * code multiplication and the inverse FFT are done per satellite.
+ *
+ * Every request keeps its own threshold and Doppler range. The Doppler grid
+ * spans the widest range and the finest step of all the registered
+ * channels; each request only considers the bins within its own range.
+ * Results are written to the Gnss_Synchro object of the channel and
+ * notified through its internal queue, as the per-channel blocks do.
+ */
+class pcps_batch_acquisition_cc: public gr::block
+{
+private:
+    friend pcps_batch_acquisition_cc_sptr
+    pcps_make_batch_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            long freq, long fs_in, int samples_per_ms, int samples_per_code,
+            bool bit_transition_flag, gr::msg_queue::sptr queue, bool dump,
+            std::string dump_filename);
+
+    pcps_batch_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            long freq, long fs_in, int samples_per_ms, int samples_per_code,
+            bool bit_transition_flag, gr::msg_queue::sptr queue, bool dump,
+            std::string dump_filename);
+
+    /*!
+     * \brief Acquisition state of one channel.
+     */
+    struct Request
+    {
+        Gnss_Synchro* gnss_synchro;
+        concurrent_queue<int>* channel_internal_queue;
+        boost::shared_ptr<const gr_complex> fft_code;
+        float threshold;
+        unsigned int doppler_max;
+        unsigned int doppler_step;
+        bool active;              // acquisition requested by the channel
+        bool searching;           // dwells in progress
+        unsigned int epoch;       // incremented on each new request
+        unsigned int well_count;
+        float mag;
+        float test_statistics;
+        Request();
+    };
+
+    /*!
+     * \brief Snapshot of a request taken at the beginning of a dwell, so that
+     * the search runs without holding the lock.
+     */
+    struct Job
+    {
+        unsigned int channel;
+        unsigned int epoch;
+        Gnss_Synchro* gnss_synchro;
+        boost::shared_ptr<const gr_complex> fft_code;
+        int doppler_max;
+        float mag;
+        unsigned int code_phase;
+        int doppler;
+    };
+
+    void update_grid();
+    void finish_dwell(std::vector<Job>& jobs, float input_power);
+
+    long d_fs_in;
+    long d_freq;
+    int d_samples_per_ms;
+    int d_samples_per_code;
+    unsigned int d_sampled_ms;
+    unsigned int d_max_dwells;
+    unsigned int d_fft_size;
+    unsigned long int d_sample_counter;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
+    Gnss_Fft* d_fft_if;
+    Gnss_Fft* d_ifft;
+    Gnss_Fft* d_fft_code;  // used by set_local_code(), under d_mutex
+    float* d_magnitude;
+    bool d_bit_transition_flag;
+    std::map<unsigned int, Request> d_requests;
+    boost::mutex d_mutex;
+    gr::msg_queue::sptr d_queue;
+    std::ofstream d_dump_file;
+    bool d_dump;
+    std::string d_dump_filename;
+
+public:
+    /*!
+     * \brief Default destructor.
+     */
+     ~pcps_batch_acquisition_cc();
+
+     /*!
+      * \brief Set acquisition/tracking common Gnss_Synchro object pointer
+      * of a channel.
+      * \param channel - receiver channel.
+      * \param p_gnss_synchro Satellite information shared by the processing blocks.
+      */
+     void set_gnss_synchro(unsigned int channel, Gnss_Synchro* p_gnss_synchro);
+
+     /*!
+      * \brief Returns the maximum peak of the last grid search of a channel.
+      */
+     unsigned int mag(unsigned int channel);
+
+     /*!
+      * \brief Initializes the acquisition of a channel and rebuilds the
+      * Doppler grid if its range or step changed.
+      */
+     void init(unsigned int channel);
+
+     /*!
+      * \brief Sets the local code of the satellite searched by a channel.
+      * \param channel - receiver channel.
+      * \param code - Pointer to the PRN code.
+      */
+     void set_local_code(unsigned int channel, std::complex<float> * code);
+
+     /*!
+      * \brief Starts or cancels the acquisition of a channel. A started
+      * acquisition joins the batch on the next snapshot.
+      */
+     void set_active(unsigned int channel, bool active);
+
+     /*!
+      * \brief Set statistics threshold of a channel.
+      */
+     void set_threshold(unsigned int channel, float threshold);
+
+     /*!
+      * \brief Set maximum Doppler grid search of a channel [Hz].
+      */
+     void set_doppler_max(unsigned int channel, unsigned int doppler_max);
+
+     /*!
+      * \brief Set Doppler steps for the grid search of a channel [Hz].
+      */
+     void set_doppler_step(unsigned int channel, unsigned int doppler_step);
+
+     /*!
+      * \brief Set the internal queue of a channel.
+      */
+     void set_channel_queue(unsigned int channel,
+             concurrent_queue<int> *channel_internal_queue);
+
+     /*!
+      * \brief Forgets a channel. Its pending acquisition, if any, is dropped.
+      */
+     void remove_channel(unsigned int channel);
+
+     /*!
+      * \brief Batch Parallel Code Phase Search Acquisition signal processing.
+      */
+     int general_work(int noutput_items, gr_vector_int &ninput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_PCPS_BATCH_ACQUISITION_CC_H_*/
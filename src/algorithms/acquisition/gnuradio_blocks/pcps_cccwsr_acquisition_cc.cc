@@ -40,6 +40,7 @@
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 #include "control_message_factory.h"
 
 
@@ -49,6 +50,7 @@ pcps_cccwsr_acquisition_cc_sptr pcps_cccwsr_make_acquisition_cc(
                                 unsigned int sampled_ms, unsigned int max_dwells,
                                 unsigned int doppler_max, long freq, long fs_in,
                                 int samples_per_ms, int samples_per_code,
+                                unsigned int noncoherent_dwells,
                                 gr::msg_queue::sptr queue, bool dump,
                                 std::string dump_filename)
 
@@ -56,13 +58,15 @@ pcps_cccwsr_acquisition_cc_sptr pcps_cccwsr_make_acquisition_cc(
 
     return pcps_cccwsr_acquisition_cc_sptr(
             new pcps_cccwsr_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in,
-                    samples_per_ms, samples_per_code, queue, dump, dump_filename));
+                    samples_per_ms, samples_per_code, noncoherent_dwells, queue, dump,
+                    dump_filename));
 }
 
 pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
                     unsigned int sampled_ms, unsigned int max_dwells,
                     unsigned int doppler_max, long freq, long fs_in,
                     int samples_per_ms, int samples_per_code,
+                    unsigned int noncoherent_dwells,
                     gr::msg_queue::sptr queue, bool dump,
                     std::string dump_filename) :
     gr::block("pcps_cccwsr_acquisition_cc",
@@ -85,21 +89,22 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
     d_mag = 0;
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
+    d_noncoherent_dwells = noncoherent_dwells > 0 ? noncoherent_dwells : 1;
+    d_noncoherent_power = 0.0;
 
     //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&d_fft_code_data, 16, d_fft_size * sizeof(gr_complex)) == 0){};
-    if (posix_memalign((void**)&d_fft_code_pilot, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_data_correlation, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_pilot_correlation, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_correlation_plus, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_correlation_minus, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
+    if (posix_memalign((void**)&d_magnitude_minus, 16, d_fft_size * sizeof(float)) == 0){};
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = new Gnss_Fft(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
@@ -108,22 +113,12 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
 
 pcps_cccwsr_acquisition_cc::~pcps_cccwsr_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    free(d_fft_code_data);
-    free(d_fft_code_pilot);
     free(d_data_correlation);
     free(d_pilot_correlation);
     free(d_correlation_plus);
     free(d_correlation_minus);
     free(d_magnitude);
+    free(d_magnitude_minus);
 
     delete d_ifft;
     delete d_fft_if;
@@ -137,35 +132,14 @@ pcps_cccwsr_acquisition_cc::~pcps_cccwsr_acquisition_cc()
 void pcps_cccwsr_acquisition_cc::set_local_code(std::complex<float> * code_data,
                                            std::complex<float> * code_pilot)
 {
+    // The conjugated code spectra are shared by all the channels
     // Data code (E1B)
-    memcpy(d_fft_if->get_inbuf(), code_data, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_code_data,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_code_data,d_fft_if->get_outbuf(),d_fft_size);
-        }
+    d_fft_code_data = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            "1B", d_gnss_synchro->PRN, d_fs_in, d_fft_size, code_data, d_fft_if);
 
     // Pilot code (E1C)
-    memcpy(d_fft_if->get_inbuf(), code_pilot, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code,
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_code_pilot,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_code_pilot,d_fft_if->get_outbuf(),d_fft_size);
-        }
+    d_fft_code_pilot = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            "1C", d_gnss_synchro->PRN, d_fs_in, d_fft_size, code_pilot, d_fft_if);
 }
 
 void pcps_cccwsr_acquisition_cc::init()
@@ -176,25 +150,13 @@ void pcps_cccwsr_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
-
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_fft_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
+    if (d_noncoherent_dwells > 1)
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
+            d_grid.resize(d_num_doppler_bins, d_fft_size);
         }
 }
 
@@ -219,6 +181,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    d_grid.reset();
 
                     d_state = 1;
                 }
@@ -243,7 +206,12 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size; // sample counter
 
-            d_well_count++;
+            if (d_grid.dwells() == 0)
+                {
+                    // First snapshot of the dwell
+                    d_well_count++;
+                    d_noncoherent_power = 0.0;
+                }
 
             DLOG(INFO) << "Channel: " << d_channel
                     << " , doing acquisition of satellite: " << d_gnss_synchro->System << " "<< d_gnss_synchro->PRN
@@ -264,7 +232,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
                     volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                                d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_fft_size);
 
                     // 3- Perform the FFT-based convolution  (parallel time search)
                     // Compute the FFT of the carrier wiped--off incoming signal
@@ -274,7 +242,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     // with the local FFT'd data code reference (E1B) using SIMD operations
                     // with VOLK library
                     volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_data, d_fft_size);
+                                d_fft_if->get_outbuf(), d_fft_code_data.get(), d_fft_size);
 
                     // compute the inverse FFT
                     d_ifft->execute();
@@ -287,7 +255,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     // with the local FFT'd pilot code reference (E1C) using SIMD operations
                     // with VOLK library
                     volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_pilot, d_fft_size);
+                                d_fft_if->get_outbuf(), d_fft_code_pilot.get(), d_fft_size);
 
                     // Compute the inverse FFT
                     d_ifft->execute();
@@ -307,32 +275,44 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                                                      d_data_correlation[i].imag() - d_pilot_correlation[i].real());
                         }
 
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_plus, d_fft_size);
-                    volk_32f_index_max_16u_a(&indext_plus, d_magnitude, d_fft_size);
-                    magt_plus = d_magnitude[indext_plus] / (fft_normalization_factor * fft_normalization_factor);
-
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_minus, d_fft_size);
-                    volk_32f_index_max_16u_a(&indext_minus, d_magnitude, d_fft_size);
-                    magt_minus = d_magnitude[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
-
-                    if (magt_plus >= magt_minus)
-                    {
-                        magt = magt_plus;
-                        indext = indext_plus;
-                    }
+                    if (d_noncoherent_dwells > 1)
+                        {
+                            // Non-coherent integration of the best sign hypothesis of
+                            // each cell: the peak is searched once the dwell is complete
+                            volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_plus, d_fft_size);
+                            volk_32fc_magnitude_squared_32f_a(d_magnitude_minus, d_correlation_minus, d_fft_size);
+                            volk_32f_x2_max_32f_a(d_magnitude, d_magnitude, d_magnitude_minus, d_fft_size);
+                            d_grid.accumulate(doppler_index, d_magnitude);
+                        }
                     else
-                    {
-                        magt = magt_minus;
-                        indext = indext_minus;
-                    }
-
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
                         {
-                            d_mag = magt;
-                            d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
-                            d_gnss_synchro->Acq_doppler_hz = (double)doppler;
-                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                            volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_plus, d_fft_size);
+                            volk_32f_index_max_16u_a(&indext_plus, d_magnitude, d_fft_size);
+                            magt_plus = d_magnitude[indext_plus] / (fft_normalization_factor * fft_normalization_factor);
+
+                            volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_minus, d_fft_size);
+                            volk_32f_index_max_16u_a(&indext_minus, d_magnitude, d_fft_size);
+                            magt_minus = d_magnitude[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
+
+                            if (magt_plus >= magt_minus)
+                            {
+                                magt = magt_plus;
+                                indext = indext_plus;
+                            }
+                            else
+                            {
+                                magt = magt_minus;
+                                indext = indext_minus;
+                            }
+
+                            // 4- record the maximum peak and the associated synchronization parameters
+                            if (d_mag < magt)
+                                {
+                                    d_mag = magt;
+                                    d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
+                                    d_gnss_synchro->Acq_doppler_hz = (double)doppler;
+                                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                                }
                         }
 
                     // Record results to file if required
@@ -350,6 +330,33 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
+            if (d_noncoherent_dwells > 1)
+                {
+                    d_noncoherent_power += d_input_power;
+                    d_grid.add_dwell();
+                    if (d_grid.dwells() < d_noncoherent_dwells)
+                        {
+                            consume_each(1);
+                            break;
+                        }
+
+                    // Test the mean of the accumulated magnitudes against the mean
+                    // input power. The code phase is the same in every snapshot,
+                    // since they span an integer number of code periods.
+                    unsigned int doppler_index = 0;
+                    magt = d_grid.max(doppler_index, indext) / (fft_normalization_factor
+                            * fft_normalization_factor * (float)d_noncoherent_dwells);
+                    d_input_power = d_noncoherent_power / (float)d_noncoherent_dwells;
+                    if (d_mag < magt)
+                        {
+                            d_mag = magt;
+                            d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
+                            d_gnss_synchro->Acq_doppler_hz = (double)(-(int)d_doppler_max + d_doppler_step * doppler_index);
+                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                        }
+                    d_grid.reset();
+                }
+
             // 5- Compute the test statistics and compare to the threshold
             //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
             d_test_statistics = d_mag / d_input_power;
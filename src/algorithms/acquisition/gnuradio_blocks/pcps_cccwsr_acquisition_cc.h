@@ -42,13 +42,16 @@
 #include <string>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/fft/fft.h>
+#include "gnss_fft_plan_cache.h"
 #include "concurrent_queue.h"
+#include "gnss_acquisition_grid.h"
 #include "gnss_synchro.h"
+#include "gnss_doppler_wipeoff_store.h"
 
 
 class pcps_cccwsr_acquisition_cc;
@@ -59,12 +62,19 @@ pcps_cccwsr_acquisition_cc_sptr
 pcps_cccwsr_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
+                         unsigned int noncoherent_dwells,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename);
 
 /*!
  * \brief This class implements a Parallel Code Phase Search Acquisition with
  * Coherent Channel Combining With Sign Recovery scheme.
+ *
+ * With noncoherent_dwells N > 1, each dwell accumulates in a search grid,
+ * for N consecutive input vectors, the squared magnitude of the best of
+ * the two sign hypotheses of every cell, since the data symbol can change
+ * between vectors. The maximum of the grid is tested once, at the end of
+ * the dwell.
  */
 class pcps_cccwsr_acquisition_cc: public gr::block
 {
@@ -73,6 +83,7 @@ private:
     pcps_cccwsr_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
+            unsigned int noncoherent_dwells,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
@@ -80,6 +91,7 @@ private:
     pcps_cccwsr_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
+            unsigned int noncoherent_dwells,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
@@ -100,22 +112,26 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_code_data;
-    gr_complex* d_fft_code_pilot;
-    gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
+    boost::shared_ptr<const gr_complex> d_fft_code_data;
+    boost::shared_ptr<const gr_complex> d_fft_code_pilot;
+    Gnss_Fft* d_fft_if;
+    Gnss_Fft* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
     float d_mag;
     float* d_magnitude;
+    float* d_magnitude_minus;
     gr_complex* d_data_correlation;
     gr_complex* d_pilot_correlation;
     gr_complex* d_correlation_plus;
     gr_complex* d_correlation_minus;
     float d_input_power;
+    unsigned int d_noncoherent_dwells;
+    float d_noncoherent_power;   // input power summed over the dwell
+    Gnss_Acquisition_Grid d_grid;
     float d_test_statistics;
     gr::msg_queue::sptr d_queue;
     concurrent_queue<int> *d_channel_internal_queue;
@@ -0,0 +1,476 @@
+/*!
+ * \file pcps_hierarchical_acquisition_cc.cc
+ * \brief This class implements a coarse-to-fine Parallel Code Phase Search
+ * Acquisition.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_hierarchical_acquisition_cc.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
+
+using google::LogMessage;
+
+pcps_hierarchical_acquisition_cc_sptr pcps_make_hierarchical_acquisition_cc(
+                                 unsigned int coarse_ms, unsigned int fine_ms,
+                                 unsigned int fine_doppler_step, unsigned int candidates,
+                                 unsigned int max_dwells, unsigned int doppler_max,
+                                 long freq, long fs_in, int samples_per_ms,
+                                 int samples_per_code, gr::msg_queue::sptr queue,
+                                 bool dump, std::string dump_filename)
+{
+    return pcps_hierarchical_acquisition_cc_sptr(
+            new pcps_hierarchical_acquisition_cc(coarse_ms, fine_ms, fine_doppler_step,
+                    candidates, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
+                    samples_per_code, queue, dump, dump_filename));
+}
+
+
+pcps_hierarchical_acquisition_cc::pcps_hierarchical_acquisition_cc(
+                         unsigned int coarse_ms, unsigned int fine_ms,
+                         unsigned int fine_doppler_step, unsigned int candidates,
+                         unsigned int max_dwells, unsigned int doppler_max,
+                         long freq, long fs_in, int samples_per_ms,
+                         int samples_per_code, gr::msg_queue::sptr queue,
+                         bool dump, std::string dump_filename) :
+    gr::block("pcps_hierarchical_acquisition_cc",
+    gr::io_signature::make(1, 1, sizeof(gr_complex)),
+    gr::io_signature::make(0, 0, sizeof(gr_complex)))
+{
+    d_sample_counter = 0;    // SAMPLE COUNTER
+    d_active = false;
+    d_state = 0;
+    d_queue = queue;
+    d_freq = freq;
+    d_fs_in = fs_in;
+    d_samples_per_ms = samples_per_ms;
+    d_samples_per_code = samples_per_code;
+    d_max_dwells = max_dwells;
+    d_well_count = 0;
+    d_doppler_max = doppler_max;
+    d_doppler_step = 0;
+    d_fine_doppler_step = fine_doppler_step;
+    d_num_candidates = candidates > 0 ? candidates : 1;
+    d_coarse_fft_size = coarse_ms * d_samples_per_ms;
+    d_fine_fft_size = fine_ms * d_samples_per_ms;
+    d_threshold = 0.0;
+    d_mag = 0.0;
+    d_input_power = 0.0;
+    d_test_statistics = 0.0;
+
+    unsigned int max_size = std::max(d_coarse_fft_size, d_fine_fft_size);
+
+    //todo: do something if posix_memalign fails
+    if (posix_memalign((void**)&d_in, 16, max_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&d_fine_wipeoff, 16, d_fine_fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&d_magnitude, 16, max_size * sizeof(float)) == 0){};
+
+    // Direct and inverse FFTs of each stage
+    d_coarse_fft_if = new Gnss_Fft(d_coarse_fft_size, true);
+    d_coarse_ifft = new Gnss_Fft(d_coarse_fft_size, false);
+    d_fine_fft_if = new Gnss_Fft(d_fine_fft_size, true);
+    d_fine_ifft = new Gnss_Fft(d_fine_fft_size, false);
+
+    // For dumping samples into a file
+    d_dump = dump;
+    d_dump_filename = dump_filename;
+}
+
+
+pcps_hierarchical_acquisition_cc::~pcps_hierarchical_acquisition_cc()
+{
+    free(d_in);
+    free(d_fine_wipeoff);
+    free(d_magnitude);
+
+    delete d_coarse_fft_if;
+    delete d_coarse_ifft;
+    delete d_fine_fft_if;
+    delete d_fine_ifft;
+
+    if (d_dump)
+        {
+            d_dump_file.close();
+        }
+}
+
+
+void pcps_hierarchical_acquisition_cc::set_local_code(std::complex<float> * code)
+{
+    // Replicate the code period over each coherent integration time. The
+    // conjugated code spectra are shared by all the channels.
+    gr_complex* replica = d_coarse_fft_if->get_inbuf();
+    for (unsigned int i = 0; i < d_coarse_fft_size; i++)
+        {
+            replica[i] = code[i % d_samples_per_code];
+        }
+    d_coarse_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_coarse_fft_size,
+            replica, d_coarse_fft_if);
+
+    replica = d_fine_fft_if->get_inbuf();
+    for (unsigned int i = 0; i < d_fine_fft_size; i++)
+        {
+            replica[i] = code[i % d_samples_per_code];
+        }
+    d_fine_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fine_fft_size,
+            replica, d_fine_fft_if);
+}
+
+
+void pcps_hierarchical_acquisition_cc::init()
+{
+    d_gnss_synchro->Acq_delay_samples = 0.0;
+    d_gnss_synchro->Acq_doppler_hz = 0.0;
+    d_gnss_synchro->Acq_samplestamp_samples = 0;
+    d_mag = 0.0;
+    d_input_power = 0.0;
+
+    // The coarse carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_coarse_fft_size);
+
+    if (d_fine_doppler_step == 0 || d_fine_doppler_step > d_doppler_step)
+        {
+            d_fine_doppler_step = d_doppler_step;
+        }
+
+    DLOG(INFO) << "Channel " << d_channel << ": coarse search of "
+               << d_grid_doppler_wipeoffs->size() << " Doppler bins, fine search of "
+               << d_num_candidates << " x " << (d_doppler_step / d_fine_doppler_step + 1)
+               << " Doppler bins";
+}
+
+
+void pcps_hierarchical_acquisition_cc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    // Enough samples for either stage
+    ninput_items_required[0] = std::max(d_coarse_fft_size, d_fine_fft_size);
+}
+
+
+float pcps_hierarchical_acquisition_cc::input_power(const gr_complex* in, unsigned int length)
+{
+    float power = 0.0;
+    volk_32fc_magnitude_squared_32f_a(d_magnitude, in, length);
+    volk_32f_accumulator_s32f_a(&power, d_magnitude, length);
+    return power / (float)length;
+}
+
+
+bool pcps_hierarchical_acquisition_cc::stronger(const Candidate& a, const Candidate& b)
+{
+    return a.mag > b.mag;
+}
+
+
+void pcps_hierarchical_acquisition_cc::add_candidate(float mag, unsigned int code_phase, int doppler)
+{
+    // A peak leaks into the neighbouring Doppler bins at the same code
+    // phase: keep only the strongest cell of each neighbourhood
+    for (unsigned int i = 0; i < d_candidates.size(); i++)
+        {
+            unsigned int distance = std::abs((int)d_candidates[i].code_phase - (int)code_phase);
+            distance = std::min(distance, (unsigned int)d_samples_per_code - distance);
+            if (std::abs(d_candidates[i].doppler - doppler) <= (int)d_doppler_step && distance <= 1)
+                {
+                    if (mag > d_candidates[i].mag)
+                        {
+                            d_candidates[i].mag = mag;
+                            d_candidates[i].code_phase = code_phase;
+                            d_candidates[i].doppler = doppler;
+                            std::sort(d_candidates.begin(), d_candidates.end(), stronger);
+                        }
+                    return;
+                }
+        }
+
+    Candidate candidate;
+    candidate.mag = mag;
+    candidate.code_phase = code_phase;
+    candidate.doppler = doppler;
+    if (d_candidates.size() < d_num_candidates)
+        {
+            d_candidates.push_back(candidate);
+        }
+    else if (mag > d_candidates.back().mag)
+        {
+            d_candidates.back() = candidate;
+        }
+    else
+        {
+            return;
+        }
+    std::sort(d_candidates.begin(), d_candidates.end(), stronger);
+}
+
+
+void pcps_hierarchical_acquisition_cc::coarse_search(const gr_complex* in)
+{
+    unsigned int indext = 0;
+    float magt = 0.0;
+    float fft_normalization_factor = (float)d_coarse_fft_size * (float)d_coarse_fft_size;
+    float power = input_power(in, d_coarse_fft_size);
+
+    d_candidates.clear();
+
+    for (unsigned int doppler_index = 0; doppler_index < d_grid_doppler_wipeoffs->size(); doppler_index++)
+        {
+            volk_32fc_x2_multiply_32fc_a(d_coarse_fft_if->get_inbuf(), in,
+                        d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_coarse_fft_size);
+            d_coarse_fft_if->execute();
+            volk_32fc_x2_multiply_32fc_a(d_coarse_ifft->get_inbuf(),
+                        d_coarse_fft_if->get_outbuf(), d_coarse_fft_codes.get(), d_coarse_fft_size);
+            d_coarse_ifft->execute();
+
+            // Strongest code phase of this Doppler bin
+            volk_32fc_magnitude_squared_32f_a(d_magnitude, d_coarse_ifft->get_outbuf(), d_coarse_fft_size);
+            volk_32f_index_max_16u_a(&indext, d_magnitude, d_coarse_fft_size);
+
+            // Normalize the maximum value to correct the scale factor introduced by FFTW
+            magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+
+            add_candidate(magt / power, indext % d_samples_per_code,
+                    d_grid_doppler_wipeoffs->doppler(doppler_index));
+        }
+
+    DLOG(INFO) << "Channel " << d_channel << ": coarse search kept " << d_candidates.size()
+               << " candidates, strongest at code phase " << d_candidates[0].code_phase
+               << ", doppler " << d_candidates[0].doppler << " Hz, test statistics "
+               << d_candidates[0].mag;
+}
+
+
+void pcps_hierarchical_acquisition_cc::fine_search(const gr_complex* in)
+{
+    float fft_normalization_factor = (float)d_fine_fft_size * (float)d_fine_fft_size;
+    const gr_complex* correlation = d_fine_ifft->get_outbuf();
+    int half_span = (int)d_doppler_step / 2;
+
+    d_input_power = input_power(in, d_fine_fft_size);
+    d_mag = 0.0;
+
+    for (unsigned int i = 0; i < d_candidates.size(); i++)
+        {
+            for (int doppler = d_candidates[i].doppler - half_span;
+                 doppler <= d_candidates[i].doppler + half_span;
+                 doppler += d_fine_doppler_step)
+                {
+                    complex_exp_gen_conj(d_fine_wipeoff, d_freq + doppler, d_fs_in, d_fine_fft_size);
+                    volk_32fc_x2_multiply_32fc_a(d_fine_fft_if->get_inbuf(), in,
+                                d_fine_wipeoff, d_fine_fft_size);
+                    d_fine_fft_if->execute();
+                    volk_32fc_x2_multiply_32fc_a(d_fine_ifft->get_inbuf(),
+                                d_fine_fft_if->get_outbuf(), d_fine_fft_codes.get(), d_fine_fft_size);
+                    d_fine_ifft->execute();
+
+                    // Only the code phases next to the coarse estimate
+                    for (int k = -1; k <= 1; k++)
+                        {
+                            unsigned int index = (d_candidates[i].code_phase + d_samples_per_code + k)
+                                    % d_samples_per_code;
+                            float magt = std::norm(correlation[index])
+                                    / (fft_normalization_factor * fft_normalization_factor);
+                            if (d_mag < magt)
+                                {
+                                    d_mag = magt;
+                                    d_gnss_synchro->Acq_delay_samples = (double)index;
+                                    d_gnss_synchro->Acq_doppler_hz = (double)doppler;
+                                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                                }
+                        }
+
+                    // Record results to file if required
+                    if (d_dump)
+                        {
+                            std::stringstream filename;
+                            std::streamsize n = 2 * sizeof(float) * (d_fine_fft_size); // complex file write
+                            filename.str("");
+                            filename << "../data/test_statistics_" << d_gnss_synchro->System
+                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
+                                     << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
+                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
+                            d_dump_file.write((char*)correlation, n);
+                            d_dump_file.close();
+                        }
+                }
+        }
+
+    d_test_statistics = d_mag / d_input_power;
+}
+
+
+int pcps_hierarchical_acquisition_cc::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    /*
+     * Acquisition strategy:
+     * 1. Coarse PCPS over the whole Doppler range, short coherent integration
+     * 2. Keep the strongest candidates
+     * 3. Fine PCPS around each candidate on the next snapshot, longer
+     *    coherent integration and finer Doppler step
+     * 4. Compute the test statistics and compare to the threshold
+     * 5. Declare positive or negative acquisition using a message queue
+     */
+
+    const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
+
+    switch (d_state)
+    {
+    case 0:
+        {
+            if (d_active)
+                {
+                    //restart acquisition variables
+                    d_gnss_synchro->Acq_delay_samples = 0.0;
+                    d_gnss_synchro->Acq_doppler_hz = 0.0;
+                    d_gnss_synchro->Acq_samplestamp_samples = 0;
+                    d_well_count = 0;
+                    d_mag = 0.0;
+                    d_input_power = 0.0;
+                    d_test_statistics = 0.0;
+
+                    d_state = 1;
+                }
+
+            d_sample_counter += ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            break;
+        }
+
+    case 1:
+        {
+            if (ninput_items[0] < (int)d_coarse_fft_size) break;
+
+            DLOG(INFO) << "Channel: " << d_channel
+                    << " , doing acquisition of satellite: " << d_gnss_synchro->System << " "<< d_gnss_synchro->PRN
+                    << " ,sample stamp: " << d_sample_counter << ", threshold: "
+                    << d_threshold << ", doppler_max: " << d_doppler_max
+                    << ", doppler_step: " << d_doppler_step
+                    << ", fine_doppler_step: " << d_fine_doppler_step;
+
+            memcpy(d_in, in, sizeof(gr_complex) * d_coarse_fft_size);
+            d_sample_counter += d_coarse_fft_size; // sample counter
+            coarse_search(d_in);
+            d_state = 2;
+
+            consume_each(d_coarse_fft_size);
+
+            break;
+        }
+
+    case 2:
+        {
+            if (ninput_items[0] < (int)d_fine_fft_size) break;
+
+            memcpy(d_in, in, sizeof(gr_complex) * d_fine_fft_size);
+            d_sample_counter += d_fine_fft_size; // sample counter
+            fine_search(d_in);
+            d_well_count++;
+
+            if (d_test_statistics > d_threshold)
+                {
+                    d_state = 3; // Positive acquisition
+                }
+            else if (d_well_count == d_max_dwells)
+                {
+                    d_state = 4; // Negative acquisition
+                }
+            else
+                {
+                    d_state = 1; // Next dwell
+                }
+
+            consume_each(d_fine_fft_size);
+
+            break;
+        }
+
+    case 3:
+        {
+            // Declare positive acquisition using a message queue
+            DLOG(INFO) << "positive acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+
+            d_sample_counter += ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            acquisition_message = 1;
+            d_channel_internal_queue->push(acquisition_message);
+
+            break;
+        }
+
+    case 4:
+        {
+            // Declare negative acquisition using a message queue
+            DLOG(INFO) << "negative acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+
+            d_sample_counter += ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            acquisition_message = 2;
+            d_channel_internal_queue->push(acquisition_message);
+
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*!
+ * \file pcps_hierarchical_acquisition_cc.h
+ * \brief This class implements a coarse-to-fine Parallel Code Phase Search
+ * Acquisition.
+ *
+ *  Acquisition strategy:
+ *  <ol>
+ *  <li> Coarse search: PCPS over the whole Doppler range with a short
+ *       coherent integration and a wide Doppler step
+ *  <li> Keep the K strongest (code phase, Doppler) candidates
+ *  <li> Fine search: PCPS with a longer coherent integration and a finer
+ *       Doppler step, only around each candidate
+ *  <li> Compute the test statistics of the best refined cell and compare
+ *       to the threshold
+ *  <li> Declare positive or negative acquisition using a message queue
+ *  </ol>
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_HIERARCHICAL_ACQUISITION_CC_H_
+#define GNSS_SDR_PCPS_HIERARCHICAL_ACQUISITION_CC_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/block.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/gr_complex.h>
+#include "gnss_fft_plan_cache.h"
+#include "concurrent_queue.h"
+#include "gnss_synchro.h"
+#include "gnss_doppler_wipeoff_store.h"
+
+class pcps_hierarchical_acquisition_cc;
+
+typedef boost::shared_ptr<pcps_hierarchical_acquisition_cc> pcps_hierarchical_acquisition_cc_sptr;
+
+pcps_hierarchical_acquisition_cc_sptr
+pcps_make_hierarchical_acquisition_cc(unsigned int coarse_ms, unsigned int fine_ms,
+                         unsigned int fine_doppler_step, unsigned int candidates,
+                         unsigned int max_dwells, unsigned int doppler_max,
+                         long freq, long fs_in, int samples_per_ms,
+                         int samples_per_code, gr::msg_queue::sptr queue,
+                         bool dump, std::string dump_filename);
+
+/*!
+ * \brief This class implements a coarse-to-fine Parallel Code Phase Search
+ * Acquisition.
+ *
+ * The coarse search covers [-doppler_max, doppler_max] with the Doppler
+ * step set by the channel and coarse_ms of coherent integration. The
+ * \p candidates strongest cells, at most one per code phase and Doppler
+ * neighbourhood, are then refined on the following fine_ms of signal over
+ * +-doppler_step/2 around their Doppler with fine_doppler_step, looking
+ * only at the code phases next to the coarse estimate. The decision is
+ * taken on the refined test statistics, so the threshold must be set for
+ * the fine coherent integration time.
+ *
+ * The block takes a stream of samples, since both stages use snapshots of
+ * different length.
+ */
+class pcps_hierarchical_acquisition_cc: public gr::block
+{
+private:
+    friend pcps_hierarchical_acquisition_cc_sptr
+    pcps_make_hierarchical_acquisition_cc(unsigned int coarse_ms, unsigned int fine_ms,
+            unsigned int fine_doppler_step, unsigned int candidates,
+            unsigned int max_dwells, unsigned int doppler_max,
+            long freq, long fs_in, int samples_per_ms,
+            int samples_per_code, gr::msg_queue::sptr queue,
+            bool dump, std::string dump_filename);
+
+    pcps_hierarchical_acquisition_cc(unsigned int coarse_ms, unsigned int fine_ms,
+            unsigned int fine_doppler_step, unsigned int candidates,
+            unsigned int max_dwells, unsigned int doppler_max,
+            long freq, long fs_in, int samples_per_ms,
+            int samples_per_code, gr::msg_queue::sptr queue,
+            bool dump, std::string dump_filename);
+
+    /*!
+     * \brief A (code phase, Doppler) cell kept by the coarse search.
+     */
+    struct Candidate
+    {
+        float mag;
+        unsigned int code_phase;
+        int doppler;
+    };
+
+    static bool stronger(const Candidate& a, const Candidate& b);
+    void coarse_search(const gr_complex* in);
+    void add_candidate(float mag, unsigned int code_phase, int doppler);
+    void fine_search(const gr_complex* in);
+    float input_power(const gr_complex* in, unsigned int length);
+
+    long d_fs_in;
+    long d_freq;
+    int d_samples_per_ms;
+    int d_samples_per_code;
+    float d_threshold;
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    unsigned int d_fine_doppler_step;
+    unsigned int d_num_candidates;
+    unsigned int d_max_dwells;
+    unsigned int d_well_count;
+    unsigned int d_coarse_fft_size;
+    unsigned int d_fine_fft_size;
+    unsigned long int d_sample_counter;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
+    boost::shared_ptr<const gr_complex> d_coarse_fft_codes;
+    boost::shared_ptr<const gr_complex> d_fine_fft_codes;
+    Gnss_Fft* d_coarse_fft_if;
+    Gnss_Fft* d_coarse_ifft;
+    Gnss_Fft* d_fine_fft_if;
+    Gnss_Fft* d_fine_ifft;
+    gr_complex* d_in;              // aligned copy of the current snapshot
+    gr_complex* d_fine_wipeoff;
+    float* d_magnitude;
+    std::vector<Candidate> d_candidates;
+    Gnss_Synchro *d_gnss_synchro;
+    float d_mag;
+    float d_input_power;
+    float d_test_statistics;
+    gr::msg_queue::sptr d_queue;
+    concurrent_queue<int> *d_channel_internal_queue;
+    std::ofstream d_dump_file;
+    bool d_active;
+    int d_state;
+    bool d_dump;
+    unsigned int d_channel;
+    std::string d_dump_filename;
+
+public:
+    /*!
+     * \brief Default destructor.
+     */
+     ~pcps_hierarchical_acquisition_cc();
+
+     /*!
+      * \brief Set acquisition/tracking common Gnss_Synchro object pointer
+      * to exchange synchronization data between acquisition and tracking blocks.
+      * \param p_gnss_synchro Satellite information shared by the processing blocks.
+      */
+     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+     {
+         d_gnss_synchro = p_gnss_synchro;
+     }
+
+     /*!
+      * \brief Returns the maximum peak of the fine search.
+      */
+     unsigned int mag()
+     {
+         return d_mag;
+     }
+
+     /*!
+      * \brief Initializes acquisition algorithm.
+      */
+     void init();
+
+     /*!
+      * \brief Sets local code for PCPS acquisition algorithm.
+      * \param code - Pointer to one period of the PRN code (samples_per_code samples).
+      */
+     void set_local_code(std::complex<float> * code);
+
+     /*!
+      * \brief Starts acquisition algorithm, turning from standby mode to
+      * active mode
+      * \param active - bool that activates/deactivates the block.
+      */
+     void set_active(bool active)
+     {
+         d_active = active;
+     }
+
+     /*!
+      * \brief Set acquisition channel unique ID
+      * \param channel - receiver channel.
+      */
+     void set_channel(unsigned int channel)
+     {
+         d_channel = channel;
+     }
+
+     /*!
+      * \brief Set statistics threshold of the fine search.
+      */
+     void set_threshold(float threshold)
+     {
+         d_threshold = threshold;
+     }
+
+     /*!
+      * \brief Set maximum Doppler grid search
+      * \param doppler_max - Maximum Doppler shift considered in the grid search [Hz].
+      */
+     void set_doppler_max(unsigned int doppler_max)
+     {
+         d_doppler_max = doppler_max;
+     }
+
+     /*!
+      * \brief Set Doppler steps for the coarse grid search
+      * \param doppler_step - Frequency bin of the coarse search grid [Hz].
+      */
+     void set_doppler_step(unsigned int doppler_step)
+     {
+         d_doppler_step = doppler_step;
+     }
+
+     /*!
+      * \brief Set tracking channel internal queue.
+      * \param channel_internal_queue - Channel's internal blocks information queue.
+      */
+     void set_channel_queue(concurrent_queue<int> *channel_internal_queue)
+     {
+         d_channel_internal_queue = channel_internal_queue;
+     }
+
+     /*!
+      * \brief Coarse-to-fine Parallel Code Phase Search Acquisition signal processing.
+      */
+     int general_work(int noutput_items, gr_vector_int &ninput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+     void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+};
+
+#endif /* GNSS_SDR_PCPS_HIERARCHICAL_ACQUISITION_CC_H_*/
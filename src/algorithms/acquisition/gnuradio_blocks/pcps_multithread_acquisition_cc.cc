@@ -34,10 +34,12 @@
 
 #include "pcps_multithread_acquisition_cc.h"
 #include <sstream>
+#include <boost/bind.hpp>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 #include "control_message_factory.h"
 
 using google::LogMessage;
@@ -47,13 +49,15 @@ pcps_multithread_acquisition_cc_sptr pcps_make_multithread_acquisition_cc(
                                  unsigned int doppler_max, long freq, long fs_in,
                                  int samples_per_ms, int samples_per_code,
                                  bool bit_transition_flag,
+                                 unsigned int noncoherent_dwells,
                                  gr::msg_queue::sptr queue, bool dump,
                                  std::string dump_filename)
 {
 
     return pcps_multithread_acquisition_cc_sptr(
             new pcps_multithread_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
-                                     samples_per_code, bit_transition_flag, queue, dump, dump_filename));
+                                     samples_per_code, bit_transition_flag, noncoherent_dwells,
+                                     queue, dump, dump_filename));
 }
 
 pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
@@ -61,6 +65,7 @@ pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
                          bool bit_transition_flag,
+                         unsigned int noncoherent_dwells,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename) :
     gr::block("pcps_multithread_acquisition_cc",
@@ -86,24 +91,34 @@ pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
     d_num_doppler_bins = 0;
     d_bit_transition_flag = bit_transition_flag;
     d_in_dwell_count = 0;
-
-    d_in_buffer = new gr_complex*[d_max_dwells];
+    d_pending_bins = 0;
+    d_dwell_in = 0;
+    d_dwell_samplestamp = 0;
+    d_dwell_mag = 0.0;
+    d_dwell_indext = 0;
+    d_dwell_doppler_index = 0;
+    d_noncoherent_dwells = noncoherent_dwells > 0 ? noncoherent_dwells : 1;
+    d_snapshot_count = 0;
+    d_noncoherent_power = 0.0;
+
+    // Every dwell takes d_noncoherent_dwells consecutive input blocks
+    d_in_buffer_size = d_max_dwells * d_noncoherent_dwells;
+    d_in_buffer = new gr_complex*[d_in_buffer_size];
 
     //todo: do something if posix_memalign fails
-    for (unsigned int i = 0; i < d_max_dwells; i++)
+    for (unsigned int i = 0; i < d_in_buffer_size; i++)
         {
             if (posix_memalign((void**)&d_in_buffer[i], 16,
                         d_fft_size * sizeof(gr_complex)) == 0){};
 
         }
-    if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
-    // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    // Direct FFT, used for the local code
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // The Doppler bins are searched with the FFT scratch of the pool workers
+    d_pool = &Gnss_Thread_Pool::instance();
 
     // For dumping samples into a file
     d_dump = dump;
@@ -112,25 +127,23 @@ pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
 
 pcps_multithread_acquisition_cc::~pcps_multithread_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
+    // Wait for the bins still queued in the pool
+    {
+        boost::mutex::scoped_lock lock(d_core_mutex);
+        while (d_core_working)
+            {
+                d_core_cond.wait(lock);
+            }
+    }
 
-    for (unsigned int i = 0; i < d_max_dwells; i++)
+    for (unsigned int i = 0; i < d_in_buffer_size; i++)
         {
             free(d_in_buffer[i]);
         }
     delete[] d_in_buffer;
 
-    free(d_fft_codes);
     free(d_magnitude);
 
-    delete d_ifft;
     delete d_fft_if;
 
     if (d_dump)
@@ -147,59 +160,42 @@ void pcps_multithread_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
-
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_fft_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
+    if (d_noncoherent_dwells > 1)
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
+            d_grid.resize(d_num_doppler_bins, d_fft_size);
         }
 }
 
 void pcps_multithread_acquisition_cc::set_local_code(std::complex<float> * code)
 {
-    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
-        }
+    // The conjugated code spectrum is shared by all the channels
+    d_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            code, d_fft_if);
 }
 
 void pcps_multithread_acquisition_cc::acquisition_core()
 {
-    // initialize acquisition algorithm
-    int doppler;
-    unsigned int indext = 0;
-    float magt = 0.0;
-    float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
-    gr_complex* in = d_in_buffer[d_well_count];
-    unsigned long int samplestamp = d_sample_counter_buffer[d_well_count];
+    d_dwell_in = d_in_buffer[d_snapshot_count];
+    d_dwell_samplestamp = d_sample_counter_buffer[d_snapshot_count];
+    d_snapshot_count++;
+    d_dwell_mag = 0.0;
+    d_dwell_indext = 0;
+    d_dwell_doppler_index = 0;
 
     d_input_power = 0.0;
     d_mag = 0.0;
 
-    d_well_count++;
+    if (d_grid.dwells() == 0)
+        {
+            // First input block of the dwell
+            d_well_count++;
+            d_noncoherent_power = 0.0;
+        }
 
     DLOG(INFO) << "Channel: " << d_channel
             << " , doing acquisition of satellite: " << d_gnss_synchro->System << " "<< d_gnss_synchro->PRN
@@ -208,76 +204,143 @@ void pcps_multithread_acquisition_cc::acquisition_core()
             << ", doppler_step: " << d_doppler_step;
 
     // 1- Compute the input signal power estimation
-    volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
+    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_dwell_in, d_fft_size);
     volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
     d_input_power /= (float)d_fft_size;
 
-    // 2- Doppler frequency search loop
-    for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
+    // 2- Doppler frequency search loop, one task per Doppler bin
+    std::vector<Gnss_Thread_Pool::Task> tasks;
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
-            // doppler search steps
+            tasks.push_back(boost::bind(&pcps_multithread_acquisition_cc::search_doppler_bin,
+                    this, doppler_index, _1));
+        }
+    {
+        boost::mutex::scoped_lock lock(d_core_mutex);
+        d_pending_bins = d_num_doppler_bins;
+    }
+    d_pool->submit(tasks);
+}
 
-            doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
+void pcps_multithread_acquisition_cc::search_doppler_bin(unsigned int doppler_index,
+        unsigned int worker)
+{
+    Gnss_Fft_Scratch& scratch = d_pool->scratch(worker, d_fft_size);
+    Gnss_Fft* fft_if = &scratch.fft;
+    Gnss_Fft* ifft = &scratch.ifft;
+    float* magnitude = scratch.magnitude;
+    unsigned int indext = 0;
+    float magt = 0.0;
+    float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
 
-            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                        d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+    // doppler search steps
+    int doppler = -(int)d_doppler_max + d_doppler_step * doppler_index;
 
-            // 3- Perform the FFT-based convolution  (parallel time search)
-            // Compute the FFT of the carrier wiped--off incoming signal
-            d_fft_if->execute();
+    volk_32fc_x2_multiply_32fc_a(fft_if->get_inbuf(), d_dwell_in,
+                d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_fft_size);
 
-            // Multiply carrier wiped--off, Fourier transformed incoming signal
-            // with the local FFT'd code reference using SIMD operations with VOLK library
-            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                        d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+    // 3- Perform the FFT-based convolution  (parallel time search)
+    // Compute the FFT of the carrier wiped--off incoming signal
+    fft_if->execute();
 
-            // compute the inverse FFT
-            d_ifft->execute();
+    // Multiply carrier wiped--off, Fourier transformed incoming signal
+    // with the local FFT'd code reference using SIMD operations with VOLK library
+    volk_32fc_x2_multiply_32fc_a(ifft->get_inbuf(),
+                fft_if->get_outbuf(), d_fft_codes.get(), d_fft_size);
 
-            // Search maximum
-            volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-            volk_32f_index_max_16u_a(&indext, d_magnitude, d_fft_size);
+    // compute the inverse FFT
+    ifft->execute();
+
+    // Search maximum
+    volk_32fc_magnitude_squared_32f_a(magnitude, ifft->get_outbuf(), d_fft_size);
+    if (d_noncoherent_dwells > 1)
+        {
+            // Non-coherent integration: every task adds to its own Doppler
+            // bin, and the peak is searched once the dwell is complete
+            d_grid.accumulate(doppler_index, magnitude);
+        }
+    else
+        {
+            volk_32f_index_max_16u_a(&indext, magnitude, d_fft_size);
 
             // Normalize the maximum value to correct the scale factor introduced by FFTW
-            magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+            magt = magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+        }
+
+    // Record results to file if required
+    if (d_dump)
+        {
+            std::stringstream filename;
+            std::ofstream dump_file;
+            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
+            filename.str("");
+            filename << "../data/test_statistics_" << d_gnss_synchro->System
+                     <<"_" << d_gnss_synchro->Signal << "_sat_"
+                     << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
+            dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
+            dump_file.write((char*)ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
+            dump_file.close();
+        }
 
-            // 4- record the maximum peak and the associated synchronization parameters
-            if (d_mag < magt)
+    // 4- record the maximum peak of the dwell. Ties are resolved in favour of
+    // the lowest Doppler bin, as in the serial search.
+    boost::mutex::scoped_lock lock(d_core_mutex);
+    if (d_noncoherent_dwells == 1 && (d_dwell_mag < magt
+            || (d_dwell_mag == magt && doppler_index < d_dwell_doppler_index)))
+        {
+            d_dwell_mag = magt;
+            d_dwell_indext = indext;
+            d_dwell_doppler_index = doppler_index;
+        }
+    d_pending_bins--;
+    if (d_pending_bins == 0)
+        {
+            if (d_noncoherent_dwells > 1)
                 {
-                    d_mag = magt;
-
-                    // In case that d_bit_transition_flag = true, we compare the potentially
-                    // new maximum test statistics (d_mag/d_input_power) with the value in
-                    // d_test_statistics. When the second dwell is being processed, the value
-                    // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
-                    // the maximum test statistics in the previous dwell is greater than
-                    // current d_mag/d_input_power). Note that d_test_statistics is not
-                    // restarted between consecutive dwells in multidwell operation.
-                    if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
-                    {
-                        d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
-                        d_gnss_synchro->Acq_doppler_hz = (double)doppler;
-                        d_gnss_synchro->Acq_samplestamp_samples = samplestamp;
-
-                        // 5- Compute the test statistics and compare to the threshold
-                        //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
-                        d_test_statistics = d_mag / d_input_power;
-                    }
+                    d_noncoherent_power += d_input_power;
+                    d_grid.add_dwell();
                 }
-
-            // Record results to file if required
-            if (d_dump)
+            if (d_noncoherent_dwells == 1 || d_grid.dwells() == d_noncoherent_dwells)
                 {
-                    std::stringstream filename;
-                    std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                    filename.str("");
-                    filename << "../data/test_statistics_" << d_gnss_synchro->System
-                             <<"_" << d_gnss_synchro->Signal << "_sat_"
-                             << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                    d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                    d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                    d_dump_file.close();
+                    finish_dwell();
                 }
+            d_core_working = false;
+            d_core_cond.notify_all();
+        }
+}
+
+void pcps_multithread_acquisition_cc::finish_dwell()
+{
+    if (d_noncoherent_dwells > 1)
+        {
+            // Test the mean of the accumulated magnitudes against the mean
+            // input power. The code phase is the same in every input block,
+            // since they span an integer number of code periods.
+            float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
+            d_dwell_mag = d_grid.max(d_dwell_doppler_index, d_dwell_indext)
+                    / (fft_normalization_factor * fft_normalization_factor * (float)d_noncoherent_dwells);
+            d_input_power = d_noncoherent_power / (float)d_noncoherent_dwells;
+            d_grid.reset();
+        }
+
+    d_mag = d_dwell_mag;
+
+    // In case that d_bit_transition_flag = true, we compare the potentially
+    // new maximum test statistics (d_mag/d_input_power) with the value in
+    // d_test_statistics. When the second dwell is being processed, the value
+    // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
+    // the maximum test statistics in the previous dwell is greater than
+    // current d_mag/d_input_power). Note that d_test_statistics is not
+    // restarted between consecutive dwells in multidwell operation.
+    if (d_mag > 0.0 && (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag))
+        {
+            d_gnss_synchro->Acq_delay_samples = (double)(d_dwell_indext % d_samples_per_code);
+            d_gnss_synchro->Acq_doppler_hz = (double)(-(int)d_doppler_max + d_doppler_step * d_dwell_doppler_index);
+            d_gnss_synchro->Acq_samplestamp_samples = d_dwell_samplestamp;
+
+            // 5- Compute the test statistics and compare to the threshold
+            //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
+            d_test_statistics = d_mag / d_input_power;
         }
 
     if (!d_bit_transition_flag)
@@ -305,8 +368,6 @@ void pcps_multithread_acquisition_cc::acquisition_core()
                         }
                 }
         }
-
-    d_core_working = false;
 }
 
 int pcps_multithread_acquisition_cc::general_work(int noutput_items,
@@ -316,7 +377,14 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
 
     int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
 
-    switch (d_state)
+    // d_state is also written by the pool workers when a dwell is finished
+    int state;
+    {
+        boost::mutex::scoped_lock lock(d_core_mutex);
+        state = d_state;
+    }
+
+    switch (state)
     {
     case 0:
         {
@@ -331,6 +399,8 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
                     d_in_dwell_count = 0;
+                    d_snapshot_count = 0;
+                    d_grid.reset();
                     d_sample_counter_buffer.clear();
 
                     d_state = 1;
@@ -343,15 +413,16 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
 
     case 1:
         {
-            if (d_in_dwell_count < d_max_dwells)
+            if (d_in_dwell_count < d_in_buffer_size)
                 {
-                    // Fill internal buffer with d_max_dwells signal blocks. This step ensures that
+                    // Fill internal buffer with d_in_buffer_size signal blocks. This step ensures that
                     // consecutive signal blocks will be processed in multi-dwell operation. This is
                     // essential when d_bit_transition_flag = true.
-                    unsigned int num_dwells = std::min((int)(d_max_dwells-d_in_dwell_count),ninput_items[0]);
+                    unsigned int num_dwells = std::min((int)(d_in_buffer_size-d_in_dwell_count),ninput_items[0]);
+                    const gr_complex* in = (const gr_complex*)input_items[0]; // one input block per item
                     for (unsigned int i = 0; i < num_dwells; i++)
                         {
-                            memcpy(d_in_buffer[d_in_dwell_count++], (gr_complex*)input_items[i],
+                            memcpy(d_in_buffer[d_in_dwell_count++], in + i * d_fft_size,
                                     sizeof(gr_complex)*d_fft_size);
                             d_sample_counter += d_fft_size;
                             d_sample_counter_buffer.push_back(d_sample_counter);
@@ -364,24 +435,33 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
                 }
             else
                 {
-                    // We already have d_max_dwells consecutive blocks in the internal buffer,
+                    // We already have d_in_buffer_size consecutive blocks in the internal buffer,
                     // just skip input blocks.
                     d_sample_counter += d_fft_size * ninput_items[0];
                 }
 
-            // We create a new thread to process next block if the following
+            // We queue the Doppler bins of the next block in the thread pool if the following
             // conditions are fulfilled:
             //   1. There are new blocks in d_in_buffer that have not been processed yet
-            //      (d_well_count < d_in_dwell_count).
-            //   2. No other acquisition_core thead is working (!d_core_working).
+            //      (d_snapshot_count < d_in_dwell_count).
+            //   2. No other dwell is being searched (!d_core_working).
             //   3. d_state==1. We need to check again d_state because it can be modified at any
             //      moment by the external thread (may have changed since checked in the switch()).
             //      If the external thread has already declared positive (d_state=2) or negative
             //      (d_state=3) acquisition, we don't have to process next block!!
-            if ((d_well_count < d_in_dwell_count) && !d_core_working && d_state==1)
+            bool start_core = false;
+            if (d_snapshot_count < d_in_dwell_count)
+                {
+                    boost::mutex::scoped_lock lock(d_core_mutex);
+                    if (!d_core_working && d_state==1)
+                        {
+                            d_core_working = true;
+                            start_core = true;
+                        }
+                }
+            if (start_core)
                 {
-                    d_core_working = true;
-                    boost::thread(&pcps_multithread_acquisition_cc::acquisition_core, this);
+                    acquisition_core();
                 }
 
             break;
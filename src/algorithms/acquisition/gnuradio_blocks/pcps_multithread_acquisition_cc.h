@@ -55,14 +55,18 @@
 #include <queue>
 #include <string>
 #include <vector>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/fft/fft.h>
+#include "gnss_fft_plan_cache.h"
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "gnss_acquisition_grid.h"
+#include "gnss_doppler_wipeoff_store.h"
+#include "gnss_thread_pool.h"
 
 class pcps_multithread_acquisition_cc;
 
@@ -73,6 +77,7 @@ pcps_make_multithread_acquisition_cc(unsigned int sampled_ms, unsigned int max_d
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
                          bool bit_transition_flag,
+                         unsigned int noncoherent_dwells,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename);
 
@@ -81,6 +86,16 @@ pcps_make_multithread_acquisition_cc(unsigned int sampled_ms, unsigned int max_d
  *
  * Check \ref Navitec2012 "An Open Source Galileo E1 Software Receiver",
  * Algorithm 1, for a pseudocode description of this implementation.
+ *
+ * The Doppler bins of each dwell are searched concurrently as tasks of the
+ * receiver-wide Gnss_Thread_Pool. The bins run on the FFT scratch of the
+ * pool worker, shared by all the channels with the same FFT size, so that
+ * no thread is created and no lock is taken while a bin is processed.
+ *
+ * With noncoherent_dwells N > 1, each dwell accumulates the squared
+ * correlation magnitudes of N consecutive input vectors in a search grid,
+ * each bin task adding to its own Doppler bin, and the maximum of the grid
+ * is tested once, at the end of the dwell, as in pcps_acquisition_cc.
  */
 class pcps_multithread_acquisition_cc: public gr::block
 {
@@ -90,6 +105,7 @@ private:
                              unsigned int doppler_max, long freq, long fs_in,
                              int samples_per_ms, int samples_per_code,
                              bool bit_transition_flag,
+                             unsigned int noncoherent_dwells,
                              gr::msg_queue::sptr queue, bool dump,
                              std::string dump_filename);
 
@@ -98,12 +114,16 @@ private:
                         unsigned int doppler_max, long freq, long fs_in,
                         int samples_per_ms, int samples_per_code,
                         bool bit_transition_flag,
+                        unsigned int noncoherent_dwells,
                         gr::msg_queue::sptr queue, bool dump,
                         std::string dump_filename);
 
     void calculate_magnitudes(gr_complex* fft_begin, int doppler_shift,
             int doppler_offset);
 
+    void search_doppler_bin(unsigned int doppler_index, unsigned int worker);
+    void finish_dwell();
+
 
 	long d_fs_in;
 	long d_freq;
@@ -119,11 +139,11 @@ private:
     unsigned int d_well_count;
 	unsigned int d_fft_size;
 	unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
-	gr_complex* d_fft_codes;
-	gr::fft::fft_complex* d_fft_if;
-	gr::fft::fft_complex* d_ifft;
+	boost::shared_ptr<const gr_complex> d_fft_codes;
+	Gnss_Fft* d_fft_if;
+    Gnss_Thread_Pool* d_pool;
     Gnss_Synchro *d_gnss_synchro;
 	unsigned int d_code_phase;
 	float d_doppler_freq;
@@ -144,6 +164,19 @@ private:
     gr_complex** d_in_buffer;
     std::vector<unsigned long int> d_sample_counter_buffer;
     unsigned int d_in_dwell_count;
+    boost::mutex d_core_mutex;
+    boost::condition_variable d_core_cond;
+    unsigned int d_pending_bins;         // bins of the current dwell not searched yet
+    gr_complex* d_dwell_in;              // input block of the current dwell
+    unsigned long int d_dwell_samplestamp;
+    float d_dwell_mag;                   // maximum of the current dwell
+    unsigned int d_dwell_indext;
+    unsigned int d_dwell_doppler_index;
+    unsigned int d_noncoherent_dwells;
+    unsigned int d_in_buffer_size;       // input blocks: d_max_dwells * d_noncoherent_dwells
+    unsigned int d_snapshot_count;       // input blocks of d_in_buffer searched
+    float d_noncoherent_power;           // input power summed over the dwell
+    Gnss_Acquisition_Grid d_grid;
 
 public:
     /*!
@@ -244,6 +277,10 @@ public:
             gr_vector_const_void_star &input_items,
             gr_vector_void_star &output_items);
 
+    /*!
+     * \brief Searches the next buffered dwell. The Doppler bins are queued
+     * in the thread pool and the decision is taken by the last bin searched.
+     */
     void acquisition_core();
 };
 
@@ -136,10 +136,10 @@ pcps_opencl_acquisition_cc::pcps_opencl_acquisition_cc(
     if (d_opencl != 0)
     {
         // Direct FFT
-        d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+        d_fft_if = new Gnss_Fft(d_fft_size, true);
 
         // Inverse FFT
-        d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+        d_ifft = new Gnss_Fft(d_fft_size, false);
     }
 
     // For dumping samples into a file
@@ -152,15 +152,6 @@ pcps_opencl_acquisition_cc::pcps_opencl_acquisition_cc(
 
 pcps_opencl_acquisition_cc::~pcps_opencl_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
     for (unsigned int i = 0; i < d_max_dwells; i++)
         {
             free(d_in_buffer[i]);
@@ -300,17 +291,11 @@ void pcps_opencl_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_fft_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
     if (d_opencl == 0)
         {
             d_cl_buffer_grid_doppler_wipeoffs = new cl::Buffer*[d_num_doppler_bins];
@@ -318,13 +303,6 @@ void pcps_opencl_acquisition_cc::init()
 
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler= -(int)d_doppler_max + d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
-
             if (d_opencl == 0)
                 {
                     d_cl_buffer_grid_doppler_wipeoffs[doppler_index] =
@@ -332,7 +310,7 @@ void pcps_opencl_acquisition_cc::init()
 
                     d_cl_queue->enqueueWriteBuffer(*(d_cl_buffer_grid_doppler_wipeoffs[doppler_index]),
                                                    CL_TRUE, 0, sizeof(gr_complex)*d_fft_size,
-                                                   d_grid_doppler_wipeoffs[doppler_index]);
+                                                   d_grid_doppler_wipeoffs->wipeoff(doppler_index));
                 }
         }
 
@@ -422,7 +400,7 @@ void pcps_opencl_acquisition_cc::acquisition_core_volk()
 
 
             volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                        d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                        d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_fft_size);
 
             // 3- Perform the FFT-based convolution  (parallel time search)
             // Compute the FFT of the carrier wiped--off incoming signal
@@ -57,13 +57,15 @@
 #include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/fft/fft.h>
+#include "gnss_fft_plan_cache.h"
 #include "concurrent_queue.h"
 #include "fft_internal.h"
 #include "gnss_synchro.h"
+#include "gnss_doppler_wipeoff_store.h"
 
 #ifdef __APPLE__
    #include "cl.hpp"
@@ -128,11 +130,11 @@ private:
     unsigned int d_fft_size_pow2;
     int* d_max_doppler_indexs;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
     gr_complex* d_fft_codes;
-    gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
+    Gnss_Fft* d_fft_if;
+    Gnss_Fft* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
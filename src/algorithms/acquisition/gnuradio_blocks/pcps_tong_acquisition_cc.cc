@@ -55,6 +55,7 @@
 #include <volk/volk.h>
 #include "control_message_factory.h"
 #include "gnss_signal_processing.h"
+#include "gnss_code_fft_cache.h"
 
 using google::LogMessage;
 
@@ -100,14 +101,13 @@ pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
     d_num_doppler_bins = 0;
 
     //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = new Gnss_Fft(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = new Gnss_Fft(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
@@ -116,18 +116,6 @@ pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
 
 pcps_tong_acquisition_cc::~pcps_tong_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                    free(d_grid_data[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-            delete[] d_grid_data;
-        }
-
-    free(d_fft_codes);
     free(d_magnitude);
 
     delete d_ifft;
@@ -141,19 +129,10 @@ pcps_tong_acquisition_cc::~pcps_tong_acquisition_cc()
 
 void pcps_tong_acquisition_cc::set_local_code(std::complex<float> * code)
 {
-    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    if (is_unaligned())
-        {
-            volk_32fc_conjugate_32fc_u(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-        }
-    else
-        {
-            volk_32fc_conjugate_32fc_a(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-        }
+    // The conjugated code spectrum is shared by all the channels
+    d_fft_codes = Gnss_Code_Fft_Cache::instance().get(d_gnss_synchro->System,
+            d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fs_in, d_fft_size,
+            code, d_fft_if);
 }
 
 void pcps_tong_acquisition_cc::init()
@@ -164,36 +143,13 @@ void pcps_tong_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
-    // Count the number of bins
-    d_num_doppler_bins = 0;
-    for (int doppler = (int)(-d_doppler_max);
-         doppler <= (int)d_doppler_max;
-         doppler += d_doppler_step)
-    {
-        d_num_doppler_bins++;
-    }
-
-    // Create the carrier Doppler wipeoff signals and allocate data grid.
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    d_grid_data = new float*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
+    // The carrier Doppler wipeoff signals are shared with the other channels
+    d_grid_doppler_wipeoffs = Gnss_Doppler_Wipeoff_Store::instance().get(d_freq,
+            d_fs_in, d_doppler_max, d_doppler_step, d_fft_size);
+    d_num_doppler_bins = d_grid_doppler_wipeoffs->size();
 
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
-
-            if (posix_memalign((void**)&(d_grid_data[doppler_index]), 16,
-                               d_fft_size * sizeof(float)) == 0){};
-
-            for (unsigned int i = 0; i < d_fft_size; i++)
-                {
-                    d_grid_data[doppler_index][i] = 0;
-                }
-        }
+    // Allocate data grid.
+    d_grid.resize(d_num_doppler_bins, d_fft_size);
 }
 
 int pcps_tong_acquisition_cc::general_work(int noutput_items,
@@ -218,13 +174,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
 
-                    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-                        {
-                            for (unsigned int i = 0; i < d_fft_size; i++)
-                                {
-                                    d_grid_data[doppler_index][i] = 0;
-                                }
-                        }
+                    d_grid.reset();
 
                     d_state = 1;
                 }
@@ -269,7 +219,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                     doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
 
                     volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                                d_grid_doppler_wipeoffs->wipeoff(doppler_index), d_fft_size);
 
                     // 3- Perform the FFT-based convolution  (parallel time search)
                     // Compute the FFT of the carrier wiped--off incoming signal
@@ -278,7 +228,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                     // Multiply carrier wiped--off, Fourier transformed incoming signal
                     // with the local FFT'd code reference using SIMD operations with VOLK library
                     volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                                d_fft_if->get_outbuf(), d_fft_codes.get(), d_fft_size);
 
                     // compute the inverse FFT
                     d_ifft->execute();
@@ -286,18 +236,13 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                     // Compute magnitude
                     volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
 
-                    // Compute vector of test statistics corresponding to current doppler index.
-                    volk_32f_s32f_multiply_32f_a(d_magnitude, d_magnitude,
-                                                1/(fft_normalization_factor*fft_normalization_factor*d_input_power),
-                                                d_fft_size);
-
-                    // Accumulate test statistics in d_grid_data.
-                    volk_32f_x2_add_32f_a(d_grid_data[doppler_index], d_magnitude, d_grid_data[doppler_index], d_fft_size);
+                    // Accumulate the vector of test statistics corresponding to current
+                    // doppler index in the data grid.
+                    d_grid.accumulate(doppler_index, d_magnitude,
+                                      1/(fft_normalization_factor*fft_normalization_factor*d_input_power));
 
                     // Search maximum
-                    volk_32f_index_max_16u_a(&indext, d_grid_data[doppler_index], d_fft_size);
-
-                    magt = d_grid_data[doppler_index][indext];
+                    magt = d_grid.bin_max(doppler_index, indext);
 
                     // 4- record the maximum peak and the associated synchronization parameters
                     if (d_mag < magt)
@@ -63,6 +63,7 @@ Channel::Channel(ConfigurationInterface *configuration, unsigned int channel,
     nav_->set_channel(channel_);
 
     gnss_synchro_.Channel_ID = channel_;
+    gnss_synchro_.Flag_reacquisition = false;
     acq_->set_gnss_synchro(&gnss_synchro_);
     trk_->set_gnss_synchro(&gnss_synchro_);
 
@@ -179,6 +180,7 @@ void Channel::set_signal(Gnss_Signal gnss_signal)
     gnss_synchro_.Signal[2] = 0; // make sure that string length is only two characters
     gnss_synchro_.PRN = gnss_signal_.get_satellite().get_PRN();
     gnss_synchro_.System = gnss_signal_.get_satellite().get_system_short().c_str()[0];
+    gnss_synchro_.Flag_reacquisition = false; // the tracking history belongs to the previous satellite
     acq_->set_local_code();
     nav_->set_satellite(gnss_signal_.get_satellite());
 }
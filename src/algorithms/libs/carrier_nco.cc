@@ -0,0 +1,98 @@
+/*!
+ * \file carrier_nco.cc
+ * \brief Carrier NCO shared by the tracking, acquisition and signal
+ * generator blocks, with SIMD versions selected at run time.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "carrier_nco.h"
+#include <cmath>
+#include <iostream>
+
+
+void carrier_nco_generic(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad)
+{
+    const float rot_real = cos(phase_step_rad);
+    const float rot_imag = -sin(phase_step_rad);
+    for (int first = 0; first < n_samples; first += CARRIER_NCO_RENORMALIZATION_SAMPLES)
+        {
+            // restart the rotator from the exact phase
+            const double phase_rad = start_phase_rad + first * phase_step_rad;
+            float real = cos(phase_rad);
+            float imag = -sin(phase_rad);
+            int last = first + CARRIER_NCO_RENORMALIZATION_SAMPLES;
+            if (last > n_samples) last = n_samples;
+            for (int i = first; i < last; i++)
+                {
+                    dest[i] = std::complex<float>(real, imag);
+                    const float next_real = real * rot_real - imag * rot_imag;
+                    imag = real * rot_imag + imag * rot_real;
+                    real = next_real;
+                }
+        }
+}
+
+
+carrier_nco_kernel carrier_nco_best_kernel(std::string& name)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef HAVE_CARRIER_NCO_AVX512
+    if (__builtin_cpu_supports("avx512f"))
+        {
+            name = "avx512";
+            return carrier_nco_avx512;
+        }
+#endif
+#ifdef HAVE_CARRIER_NCO_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            name = "avx2";
+            return carrier_nco_avx2;
+        }
+#endif
+#endif
+    name = "generic";
+    return carrier_nco_generic;
+}
+
+
+static carrier_nco_kernel select_carrier_nco_kernel()
+{
+    std::string name;
+    carrier_nco_kernel kernel = carrier_nco_best_kernel(name);
+    std::cout << "Selected architecture for the carrier NCO is " << name << std::endl;
+    return kernel;
+}
+
+
+void carrier_nco(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad)
+{
+    static const carrier_nco_kernel kernel = select_carrier_nco_kernel();
+    kernel(dest, n_samples, start_phase_rad, phase_step_rad);
+}
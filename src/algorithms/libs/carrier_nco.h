@@ -0,0 +1,87 @@
+/*!
+ * \file carrier_nco.h
+ * \brief Carrier NCO shared by the tracking, acquisition and signal
+ * generator blocks, with SIMD versions selected at run time.
+ *
+ * The carrier is generated by a phase rotator: each output sample is the
+ * previous one multiplied by the complex phase step, which costs a complex
+ * multiplication instead of a sine and a cosine per sample. The rotator is
+ * restarted from the exact phase (computed in double precision) every
+ * CARRIER_NCO_RENORMALIZATION_SAMPLES samples, so that neither its
+ * amplitude nor its phase drift with the length of the vector.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CARRIER_NCO_H_
+#define GNSS_SDR_CARRIER_NCO_H_
+
+#include <complex>
+#include <string>
+
+/*!
+ * \brief Samples generated by the rotator between two restarts from the
+ * exact phase. The rounding error of the rotator grows linearly with this
+ * number, to about 1e-5 for 256 samples.
+ */
+#define CARRIER_NCO_RENORMALIZATION_SAMPLES 256
+
+/*!
+ * \brief Generates the complex conjugate exponential
+ * dest[i] = exp(-j * (start_phase_rad + i * phase_step_rad)), i = 0..n_samples-1,
+ * the same vector as fxp_nco() and the other functions of nco_lib.h.
+ * \p dest does not need to be aligned.
+ */
+typedef void (*carrier_nco_kernel)(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad);
+
+void carrier_nco_generic(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad);
+
+#ifdef HAVE_CARRIER_NCO_AVX2
+void carrier_nco_avx2(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad);
+#endif
+
+#ifdef HAVE_CARRIER_NCO_AVX512
+void carrier_nco_avx512(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad);
+#endif
+
+/*!
+ * \brief Returns the fastest carrier NCO supported by the processor, and
+ * its name in \p name.
+ */
+carrier_nco_kernel carrier_nco_best_kernel(std::string& name);
+
+/*!
+ * \brief Generates the complex conjugate exponential
+ * dest[i] = exp(-j * (start_phase_rad + i * phase_step_rad)) with the kernel
+ * returned by carrier_nco_best_kernel(), which is selected on the first call.
+ */
+void carrier_nco(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad);
+
+#endif /* GNSS_SDR_CARRIER_NCO_H_ */
@@ -0,0 +1,72 @@
+/*!
+ * \file carrier_nco_avx512.cc
+ * \brief AVX-512 version of the carrier NCO, built with the AVX-512 flags
+ * and only called when the processor supports them.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "carrier_nco.h"
+#include <cmath>
+#include <immintrin.h>
+
+// Complex samples per vector
+#define CARRIER_NCO_AVX512_LANES 8
+
+
+void carrier_nco_avx512(std::complex<float>* dest, int n_samples,
+        double start_phase_rad, double phase_step_rad)
+{
+    // Each lane rotates by 8 phase steps per vector
+    const std::complex<float> rot(cos(CARRIER_NCO_AVX512_LANES * phase_step_rad),
+            -sin(CARRIER_NCO_AVX512_LANES * phase_step_rad));
+    const __m512 rot_real = _mm512_set1_ps(rot.real());
+    const __m512 rot_imag = _mm512_set1_ps(rot.imag());
+    const int vector_samples = (n_samples / CARRIER_NCO_AVX512_LANES) * CARRIER_NCO_AVX512_LANES;
+    for (int first = 0; first < vector_samples; first += CARRIER_NCO_RENORMALIZATION_SAMPLES)
+        {
+            // restart the rotator of every lane from the exact phase
+            __attribute__((aligned(64))) std::complex<float> lanes[CARRIER_NCO_AVX512_LANES];
+            for (int j = 0; j < CARRIER_NCO_AVX512_LANES; j++)
+                {
+                    const double phase_rad = start_phase_rad + (first + j) * phase_step_rad;
+                    lanes[j] = std::complex<float>(cos(phase_rad), -sin(phase_rad));
+                }
+            __m512 p = _mm512_load_ps((const float*)lanes);
+            int last = first + CARRIER_NCO_RENORMALIZATION_SAMPLES;
+            if (last > vector_samples) last = vector_samples;
+            for (int i = first; i < last; i += CARRIER_NCO_AVX512_LANES)
+                {
+                    _mm512_storeu_ps((float*)(dest + i), p);
+                    const __m512 p_swap = _mm512_permute_ps(p, 0xB1);
+                    p = _mm512_fmaddsub_ps(p, rot_real, _mm512_mul_ps(p_swap, rot_imag));
+                }
+        }
+    if (vector_samples < n_samples)
+        {
+            carrier_nco_generic(dest + vector_samples, n_samples - vector_samples,
+                    start_phase_rad + vector_samples * phase_step_rad, phase_step_rad);
+        }
+}
@@ -0,0 +1,69 @@
+/*!
+ * \file code_nco.cc
+ * \brief Fixed-point Numeric Controlled Oscillator (NCO) of the code phase,
+ * used to resample the spreading code replicas
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "code_nco.h"
+#include <cmath>
+
+
+void Code_Nco::set_phase(double phase)
+{
+    const double code_length = (double)(d_wrap >> CODE_NCO_FRACTIONAL_BITS);
+    phase = fmod(phase, code_length);
+    if (phase < 0.0) phase += code_length;
+    d_phase = to_fixed_point(phase);
+    // Rounding to the fixed point may reach the end of the table
+    if (d_phase >= d_wrap) d_phase -= d_wrap;
+}
+
+
+void Code_Nco::generate(std::complex<float>* dest, const std::complex<float>* code, int n_samples)
+{
+    uint64_t phase = d_phase;
+    for (int i = 0; i < n_samples; i++)
+        {
+            dest[i] = code[phase >> CODE_NCO_FRACTIONAL_BITS];
+            phase += d_phase_step;
+            if (phase >= d_wrap) phase -= d_wrap;
+        }
+    d_phase = phase;
+}
+
+
+void Code_Nco::generate(int16_t* dest, const int16_t* code, int n_samples)
+{
+    uint64_t phase = d_phase;
+    for (int i = 0; i < n_samples; i++)
+        {
+            dest[i] = code[phase >> CODE_NCO_FRACTIONAL_BITS];
+            phase += d_phase_step;
+            if (phase >= d_wrap) phase -= d_wrap;
+        }
+    d_phase = phase;
+}
@@ -0,0 +1,138 @@
+/*!
+ * \file code_nco.h
+ * \brief Fixed-point Numeric Controlled Oscillator (NCO) of the code phase,
+ * used to resample the spreading code replicas
+ *
+ * The code phase is a 64-bit accumulator in units of code table entries
+ * (chips, or half chips for sampled BOC replicas) with 32 fractional bits.
+ * Advancing it is one integer addition and one comparison per sample, and
+ * the table entry is the integer part, instead of the fmod() and round()
+ * on doubles that the replica generation needed per sample.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CODE_NCO_H_
+#define GNSS_SDR_CODE_NCO_H_
+
+#include <stdint.h>
+#include <complex>
+
+/*!
+ * \brief Number of fractional bits of the code NCO phase
+ */
+#define CODE_NCO_FRACTIONAL_BITS 32
+
+/*!
+ * \brief Code phase accumulator over a code table of code_length entries.
+ * The phase is kept in [0, code_length) entries.
+ */
+class Code_Nco
+{
+public:
+    Code_Nco()
+    {
+        d_phase = 0;
+        d_phase_step = 0;
+        d_wrap = 0;
+    }
+
+    /*!
+     * \brief Converts \p value entries to the fixed-point representation
+     */
+    static uint64_t to_fixed_point(double value)
+    {
+        return (uint64_t)(value * (double)((uint64_t)1 << CODE_NCO_FRACTIONAL_BITS) + 0.5);
+    }
+
+    /*!
+     * \brief Sets the number of entries of the code table
+     */
+    void set_code_length(unsigned int code_length)
+    {
+        d_wrap = (uint64_t)code_length << CODE_NCO_FRACTIONAL_BITS;
+    }
+
+    /*!
+     * \brief Sets the phase, in entries. Any value is wrapped to the code
+     * table. The current entry is the one that contains the phase: add 0.5
+     * to take the nearest entry instead.
+     */
+    void set_phase(double phase);
+
+    /*!
+     * \brief Sets the phase advance per sample, in entries (less than the
+     * code length).
+     */
+    void set_phase_step(double phase_step)
+    {
+        d_phase_step = to_fixed_point(phase_step);
+    }
+
+    uint64_t phase() const
+    {
+        return d_phase;
+    }
+
+    uint64_t phase_step() const
+    {
+        return d_phase_step;
+    }
+
+    /*!
+     * \brief Index of the current code table entry
+     */
+    unsigned int index() const
+    {
+        return (unsigned int)(d_phase >> CODE_NCO_FRACTIONAL_BITS);
+    }
+
+    /*!
+     * \brief Advances the phase by one sample
+     */
+    void advance()
+    {
+        d_phase += d_phase_step;
+        if (d_phase >= d_wrap) d_phase -= d_wrap;
+    }
+
+    /*!
+     * \brief Writes in \p dest the entries of \p code for the next
+     * \p n_samples samples, advancing the phase.
+     */
+    void generate(std::complex<float>* dest, const std::complex<float>* code, int n_samples);
+
+    /*!
+     * \brief The same, for a table of integer (e.g. +1/-1) entries
+     */
+    void generate(int16_t* dest, const int16_t* code, int n_samples);
+
+private:
+    uint64_t d_phase;
+    uint64_t d_phase_step;
+    uint64_t d_wrap;
+};
+
+#endif /* GNSS_SDR_CODE_NCO_H_ */
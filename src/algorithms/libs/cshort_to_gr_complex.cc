@@ -0,0 +1,57 @@
+/*!
+ * \file cshort_to_gr_complex.cc
+ * \brief Converts a stream of complex 16-bit samples to gr_complex
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "cshort_to_gr_complex.h"
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+cshort_to_gr_complex::cshort_to_gr_complex() : gr::sync_block("cshort_to_gr_complex",
+                gr::io_signature::make(1, 1, sizeof(lv_16sc_t)),
+                gr::io_signature::make(1, 1, sizeof(gr_complex)))
+{}
+
+
+
+boost::shared_ptr<gr::block> make_cshort_to_gr_complex()
+{
+    return boost::shared_ptr<cshort_to_gr_complex> (new cshort_to_gr_complex());
+}
+
+
+
+int cshort_to_gr_complex::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    const int16_t* in = (const int16_t*)input_items[0];
+    float* out = (float*)output_items[0];
+    // The I and Q components are converted as one real vector
+    volk_16i_s32f_convert_32f(out, in, 1.0, 2 * noutput_items);
+    return noutput_items;
+}
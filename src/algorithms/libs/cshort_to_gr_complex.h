@@ -0,0 +1,56 @@
+/*!
+ * \file cshort_to_gr_complex.h
+ * \brief Converts a stream of complex 16-bit samples to gr_complex, so that
+ * the blocks without an integer implementation can share the stream of the
+ * integer tracking blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CSHORT_TO_GR_COMPLEX_H_
+#define GNSS_SDR_CSHORT_TO_GR_COMPLEX_H_
+
+#include <gnuradio/sync_block.h>
+#include <boost/shared_ptr.hpp>
+
+
+boost::shared_ptr<gr::block> make_cshort_to_gr_complex();
+
+/*!
+ * \brief GNU Radio block that converts complex 16-bit samples (lv_16sc_t)
+ * to gr_complex, keeping their scale.
+ */
+class cshort_to_gr_complex : public gr::sync_block
+{
+    friend boost::shared_ptr<gr::block> make_cshort_to_gr_complex();
+    cshort_to_gr_complex();
+
+public:
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_CSHORT_TO_GR_COMPLEX_H_ */
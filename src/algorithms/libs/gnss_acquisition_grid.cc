@@ -0,0 +1,126 @@
+/*!
+ * \file gnss_acquisition_grid.cc
+ * \brief Search grid of the acquisition blocks, where the squared
+ * correlation magnitudes of several dwells are accumulated.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gnss_acquisition_grid.h"
+#include <cstdlib>
+#include <cstring>
+#include <volk/volk.h>
+
+// Floats per cache line: every Doppler bin starts on a cache line
+#define GRID_ALIGNMENT_FLOATS 16
+
+
+Gnss_Acquisition_Grid::Gnss_Acquisition_Grid()
+{
+    d_grid = 0;
+    d_capacity = 0;
+    d_num_doppler_bins = 0;
+    d_num_code_phases = 0;
+    d_stride = 0;
+    d_dwells = 0;
+}
+
+
+Gnss_Acquisition_Grid::~Gnss_Acquisition_Grid()
+{
+    free(d_grid);
+}
+
+
+void Gnss_Acquisition_Grid::resize(unsigned int num_doppler_bins, unsigned int num_code_phases)
+{
+    d_num_doppler_bins = num_doppler_bins;
+    d_num_code_phases = num_code_phases;
+    d_stride = ((num_code_phases + GRID_ALIGNMENT_FLOATS - 1) / GRID_ALIGNMENT_FLOATS) * GRID_ALIGNMENT_FLOATS;
+    unsigned int size = d_stride * d_num_doppler_bins;
+    if (size > d_capacity)
+        {
+            free(d_grid);
+            d_grid = 0;
+            //todo: do something if posix_memalign fails
+            if (posix_memalign((void**)&d_grid, GRID_ALIGNMENT_FLOATS * sizeof(float), size * sizeof(float)) == 0){};
+            d_capacity = size;
+        }
+    reset();
+}
+
+
+void Gnss_Acquisition_Grid::reset()
+{
+    if (d_grid != 0)
+        {
+            memset(d_grid, 0, d_stride * d_num_doppler_bins * sizeof(float));
+        }
+    d_dwells = 0;
+}
+
+
+void Gnss_Acquisition_Grid::accumulate(unsigned int doppler_index, const float* magnitude)
+{
+    float* row = d_grid + doppler_index * d_stride;
+    volk_32f_x2_add_32f_a(row, row, magnitude, d_num_code_phases);
+}
+
+
+void Gnss_Acquisition_Grid::accumulate(unsigned int doppler_index, float* magnitude, float scale)
+{
+    volk_32f_s32f_multiply_32f_a(magnitude, magnitude, scale, d_num_code_phases);
+    accumulate(doppler_index, magnitude);
+}
+
+
+float Gnss_Acquisition_Grid::bin_max(unsigned int doppler_index, unsigned int& code_phase) const
+{
+    const float* row = d_grid + doppler_index * d_stride;
+    unsigned int index = 0;
+    volk_32f_index_max_16u_a(&index, row, d_num_code_phases);
+    code_phase = index;
+    return row[index];
+}
+
+
+float Gnss_Acquisition_Grid::max(unsigned int& doppler_index, unsigned int& code_phase) const
+{
+    float max_value = 0.0;
+    doppler_index = 0;
+    code_phase = 0;
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            unsigned int index = 0;
+            float value = bin_max(i, index);
+            if (value > max_value)
+                {
+                    max_value = value;
+                    doppler_index = i;
+                    code_phase = index;
+                }
+        }
+    return max_value;
+}
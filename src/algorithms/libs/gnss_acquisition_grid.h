@@ -0,0 +1,127 @@
+/*!
+ * \file gnss_acquisition_grid.h
+ * \brief Search grid of the acquisition blocks, where the squared
+ * correlation magnitudes of several dwells are accumulated.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_ACQUISITION_GRID_H_
+#define GNSS_SDR_GNSS_ACQUISITION_GRID_H_
+
+/*!
+ * \brief Doppler x code phase grid of floats.
+ *
+ * The grid is stored bin-major in a single buffer: the code phases of a
+ * Doppler bin are contiguous, and every bin starts on a cache line, so that
+ * the accumulation of a bin and its peak search stream through memory with
+ * aligned VOLK kernels. The buffer is only reallocated when the grid grows.
+ */
+class Gnss_Acquisition_Grid
+{
+public:
+    Gnss_Acquisition_Grid();
+    ~Gnss_Acquisition_Grid();
+
+    /*!
+     * \brief Sets the grid dimensions and zeroes it.
+     */
+    void resize(unsigned int num_doppler_bins, unsigned int num_code_phases);
+
+    /*!
+     * \brief Zeroes the grid and the dwell count.
+     */
+    void reset();
+
+    /*!
+     * \brief Adds \p magnitude (num_code_phases values, 16-byte aligned) to
+     * the Doppler bin \p doppler_index.
+     */
+    void accumulate(unsigned int doppler_index, const float* magnitude);
+
+    /*!
+     * \brief Adds \p magnitude scaled by \p scale to the Doppler bin
+     * \p doppler_index. \p magnitude is used as scratch.
+     */
+    void accumulate(unsigned int doppler_index, float* magnitude, float scale);
+
+    /*!
+     * \brief Counts one more dwell accumulated on the whole grid.
+     */
+    void add_dwell()
+    {
+        d_dwells++;
+    }
+
+    /*!
+     * \brief Number of dwells accumulated since the last reset().
+     */
+    unsigned int dwells() const
+    {
+        return d_dwells;
+    }
+
+    /*!
+     * \brief Values of the Doppler bin \p doppler_index.
+     */
+    const float* bin(unsigned int doppler_index) const
+    {
+        return d_grid + doppler_index * d_stride;
+    }
+
+    /*!
+     * \brief Returns the maximum of the Doppler bin \p doppler_index and
+     * its code phase in \p code_phase.
+     */
+    float bin_max(unsigned int doppler_index, unsigned int& code_phase) const;
+
+    /*!
+     * \brief Returns the maximum of the grid and its cell.
+     */
+    float max(unsigned int& doppler_index, unsigned int& code_phase) const;
+
+    unsigned int num_doppler_bins() const
+    {
+        return d_num_doppler_bins;
+    }
+
+    unsigned int num_code_phases() const
+    {
+        return d_num_code_phases;
+    }
+
+private:
+    Gnss_Acquisition_Grid(const Gnss_Acquisition_Grid&);
+    Gnss_Acquisition_Grid& operator=(const Gnss_Acquisition_Grid&);
+
+    float* d_grid;
+    unsigned int d_capacity;  // floats allocated
+    unsigned int d_num_doppler_bins;
+    unsigned int d_num_code_phases;
+    unsigned int d_stride;    // floats between consecutive Doppler bins
+    unsigned int d_dwells;
+};
+
+#endif /* GNSS_SDR_GNSS_ACQUISITION_GRID_H_ */
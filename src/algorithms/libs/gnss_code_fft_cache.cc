@@ -0,0 +1,143 @@
+/*!
+ * \file gnss_code_fft_cache.cc
+ * \brief Process-wide cache of conjugated local code spectra shared by all
+ * the PCPS acquisition blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gnss_code_fft_cache.h"
+#include <cstdlib>
+#include <cstring>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+
+Gnss_Code_Fft_Key::Gnss_Code_Fft_Key(char system_, const char* signal_,
+        unsigned int prn_, long fs_in_, unsigned int fft_size_,
+        const gr_complex* code)
+{
+    system = system_;
+    signal = std::string(signal_);
+    prn = prn_;
+    fs_in = fs_in_;
+    fft_size = fft_size_;
+
+    // 64-bit FNV-1a over the sampled replica. It is much cheaper than the
+    // FFT it saves and tells apart replicas that only differ in options
+    // unknown to the acquisition block.
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(code);
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < fft_size * sizeof(gr_complex); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    fingerprint = hash;
+}
+
+
+bool Gnss_Code_Fft_Key::operator<(const Gnss_Code_Fft_Key& other) const
+{
+    if (fingerprint != other.fingerprint) return fingerprint < other.fingerprint;
+    if (system != other.system) return system < other.system;
+    if (prn != other.prn) return prn < other.prn;
+    if (fs_in != other.fs_in) return fs_in < other.fs_in;
+    if (fft_size != other.fft_size) return fft_size < other.fft_size;
+    return signal < other.signal;
+}
+
+
+Gnss_Code_Fft_Cache::Gnss_Code_Fft_Cache()
+{}
+
+
+Gnss_Code_Fft_Cache& Gnss_Code_Fft_Cache::instance()
+{
+    static Gnss_Code_Fft_Cache cache;
+    return cache;
+}
+
+
+boost::shared_ptr<const gr_complex> Gnss_Code_Fft_Cache::get(char system,
+        const char* signal, unsigned int prn, long fs_in, unsigned int fft_size,
+        const gr_complex* code, Gnss_Fft* fft)
+{
+    Gnss_Code_Fft_Key key(system, signal, prn, fs_in, fft_size, code);
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<Gnss_Code_Fft_Key, boost::shared_ptr<const gr_complex> >::iterator it = d_spectra.find(key);
+    if (it != d_spectra.end())
+        {
+            return it->second;
+        }
+    lock.unlock();
+
+    // Cache miss: compute the spectrum outside the lock with the caller's plan
+    gr_complex* spectrum = 0;
+    if (posix_memalign((void**)&spectrum, 16, fft_size * sizeof(gr_complex)) != 0)
+        {
+            LOG(ERROR) << "Unable to allocate the code spectrum for "
+                       << system << " " << signal << " PRN " << prn;
+            return boost::shared_ptr<const gr_complex>();
+        }
+    if (code != fft->get_inbuf())
+        {
+            memcpy(fft->get_inbuf(), code, sizeof(gr_complex) * fft_size);
+        }
+    fft->execute(); // We need the FFT of local code
+
+    //Conjugate the local code
+    volk_32fc_conjugate_32fc_a(spectrum, fft->get_outbuf(), fft_size);
+
+    boost::shared_ptr<const gr_complex> entry(spectrum, free);
+
+    // Another channel may have inserted the same spectrum meanwhile; the
+    // first one wins so that every channel shares the same buffer.
+    lock.lock();
+    std::pair<std::map<Gnss_Code_Fft_Key, boost::shared_ptr<const gr_complex> >::iterator, bool> inserted =
+            d_spectra.insert(std::make_pair(key, entry));
+    DLOG(INFO) << "Code spectrum cache: " << system << " " << signal << " PRN " << prn
+               << ", fs " << fs_in << ", fft_size " << fft_size
+               << (inserted.second ? " computed" : " already present")
+               << ", " << d_spectra.size() << " entries";
+    return inserted.first->second;
+}
+
+
+unsigned int Gnss_Code_Fft_Cache::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_spectra.size();
+}
+
+
+void Gnss_Code_Fft_Cache::clear()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_spectra.clear();
+}
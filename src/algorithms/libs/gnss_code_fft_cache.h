@@ -0,0 +1,118 @@
+/*!
+ * \file gnss_code_fft_cache.h
+ * \brief Process-wide cache of conjugated local code spectra shared by all
+ * the PCPS acquisition blocks.
+ *
+ * Every acquisition channel needs, for each satellite it searches, the
+ * complex conjugate of the FFT of the sampled local replica. Since all the
+ * channels cycle through the same PRN list, the spectra are computed only
+ * once per (system, signal, PRN, sampling frequency, FFT size, replica) and
+ * then handed out as read-only buffers to every channel.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_CODE_FFT_CACHE_H_
+#define GNSS_SDR_GNSS_CODE_FFT_CACHE_H_
+
+#include <map>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/gr_complex.h>
+#include "gnss_fft_plan_cache.h"
+
+/*!
+ * \brief Identifies a conjugated code spectrum in the cache.
+ *
+ * The fingerprint is computed over the sampled time-domain replica, so that
+ * any option that changes the replica (chip shift, CBOC or BOC modulation,
+ * number of code periods, inverted secondary chips...) yields a different
+ * entry even for the same satellite and signal.
+ */
+class Gnss_Code_Fft_Key
+{
+public:
+    char system;
+    std::string signal;
+    unsigned int prn;
+    long fs_in;
+    unsigned int fft_size;
+    unsigned long long fingerprint;
+
+    Gnss_Code_Fft_Key(char system_, const char* signal_, unsigned int prn_,
+            long fs_in_, unsigned int fft_size_, const gr_complex* code);
+
+    bool operator<(const Gnss_Code_Fft_Key& other) const;
+};
+
+
+/*!
+ * \brief Thread-safe store of conjugated code spectra.
+ *
+ * Entries are immutable once inserted and are returned through shared
+ * pointers, so a channel may keep using a spectrum even after clear() is
+ * called.
+ */
+class Gnss_Code_Fft_Cache
+{
+public:
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Code_Fft_Cache& instance();
+
+    /*!
+     * \brief Returns the conjugated FFT of \p code (\p fft_size samples).
+     *
+     * On a cache miss the spectrum is computed with \p fft, a forward
+     * Gnss_Fft of size \p fft_size owned by the caller, so that no
+     * buffers are allocated here. \p code may point to the input buffer
+     * of \p fft.
+     */
+    boost::shared_ptr<const gr_complex> get(char system, const char* signal,
+            unsigned int prn, long fs_in, unsigned int fft_size,
+            const gr_complex* code, Gnss_Fft* fft);
+
+    /*!
+     * \brief Number of spectra currently held by the cache.
+     */
+    unsigned int size();
+
+    /*!
+     * \brief Drops all the cached spectra.
+     */
+    void clear();
+
+private:
+    Gnss_Code_Fft_Cache();
+    Gnss_Code_Fft_Cache(const Gnss_Code_Fft_Cache&);
+    Gnss_Code_Fft_Cache& operator=(const Gnss_Code_Fft_Cache&);
+
+    std::map<Gnss_Code_Fft_Key, boost::shared_ptr<const gr_complex> > d_spectra;
+    boost::mutex d_mutex;
+};
+
+#endif /* GNSS_SDR_GNSS_CODE_FFT_CACHE_H_ */
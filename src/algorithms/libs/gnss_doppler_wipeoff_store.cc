@@ -0,0 +1,156 @@
+/*!
+ * \file gnss_doppler_wipeoff_store.cc
+ * \brief Reference-counted store of carrier Doppler wipeoff grids shared by
+ * the acquisition blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gnss_doppler_wipeoff_store.h"
+#include <cstdlib>
+#include <glog/logging.h>
+#include "gnss_signal_processing.h"
+
+using google::LogMessage;
+
+
+Gnss_Doppler_Wipeoff_Grid::Gnss_Doppler_Wipeoff_Grid(long freq, long fs_in,
+        unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int fft_size)
+{
+    d_doppler_max = doppler_max;
+    d_doppler_step = doppler_step;
+    d_fft_size = fft_size;
+
+    // Count the number of bins
+    unsigned int num_doppler_bins = 0;
+    for (int doppler = (int)(-doppler_max);
+         doppler <= (int)doppler_max;
+         doppler += doppler_step)
+        {
+            num_doppler_bins++;
+        }
+
+    // Create the carrier Doppler wipeoff signals
+    d_wipeoffs.resize(num_doppler_bins, 0);
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            if (posix_memalign((void**)&(d_wipeoffs[doppler_index]), 16,
+                               fft_size * sizeof(gr_complex)) != 0)
+                {
+                    LOG(ERROR) << "Unable to allocate the Doppler wipeoff grid";
+                    d_wipeoffs[doppler_index] = 0;
+                    continue;
+                }
+            complex_exp_gen_conj(d_wipeoffs[doppler_index],
+                                 freq + doppler(doppler_index), fs_in, fft_size);
+        }
+}
+
+
+Gnss_Doppler_Wipeoff_Grid::~Gnss_Doppler_Wipeoff_Grid()
+{
+    for (unsigned int i = 0; i < d_wipeoffs.size(); i++)
+        {
+            free(d_wipeoffs[i]);
+        }
+}
+
+
+bool Gnss_Doppler_Wipeoff_Store::Key::operator<(const Key& other) const
+{
+    if (freq != other.freq) return freq < other.freq;
+    if (fs_in != other.fs_in) return fs_in < other.fs_in;
+    if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+    if (doppler_step != other.doppler_step) return doppler_step < other.doppler_step;
+    return fft_size < other.fft_size;
+}
+
+
+Gnss_Doppler_Wipeoff_Store::Gnss_Doppler_Wipeoff_Store()
+{}
+
+
+Gnss_Doppler_Wipeoff_Store& Gnss_Doppler_Wipeoff_Store::instance()
+{
+    static Gnss_Doppler_Wipeoff_Store store;
+    return store;
+}
+
+
+boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> Gnss_Doppler_Wipeoff_Store::get(
+        long freq, long fs_in, unsigned int doppler_max,
+        unsigned int doppler_step, unsigned int fft_size)
+{
+    Key key;
+    key.freq = freq;
+    key.fs_in = fs_in;
+    key.doppler_max = doppler_max;
+    key.doppler_step = doppler_step;
+    key.fft_size = fft_size;
+
+    // The grid is built with the lock held, so that channels initialised at
+    // the same time wait for the first one instead of building copies.
+    boost::mutex::scoped_lock lock(d_mutex);
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> grid = d_grids[key].lock();
+    if (!grid)
+        {
+            grid.reset(new Gnss_Doppler_Wipeoff_Grid(freq, fs_in, doppler_max,
+                    doppler_step, fft_size));
+            d_grids[key] = grid;
+            DLOG(INFO) << "Doppler wipeoff grid built: IF " << freq << " Hz, fs "
+                       << fs_in << " Hz, doppler_max " << doppler_max
+                       << " Hz, doppler_step " << doppler_step << " Hz, "
+                       << grid->size() << " bins of " << fft_size << " samples";
+        }
+
+    // Forget the grids that no block is using anymore
+    std::map<Key, boost::weak_ptr<const Gnss_Doppler_Wipeoff_Grid> >::iterator it = d_grids.begin();
+    while (it != d_grids.end())
+        {
+            if (it->second.expired())
+                {
+                    d_grids.erase(it++);
+                }
+            else
+                {
+                    ++it;
+                }
+        }
+    return grid;
+}
+
+
+unsigned int Gnss_Doppler_Wipeoff_Store::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int alive = 0;
+    std::map<Key, boost::weak_ptr<const Gnss_Doppler_Wipeoff_Grid> >::iterator it;
+    for (it = d_grids.begin(); it != d_grids.end(); ++it)
+        {
+            if (!it->second.expired()) alive++;
+        }
+    return alive;
+}
@@ -0,0 +1,146 @@
+/*!
+ * \file gnss_doppler_wipeoff_store.h
+ * \brief Reference-counted store of carrier Doppler wipeoff grids shared by
+ * the acquisition blocks.
+ *
+ * For a given intermediate frequency, sampling frequency, Doppler search
+ * range, Doppler step and FFT size, the set of conjugate complex exponentials
+ * used to wipe off the carrier in each Doppler bin is the same for every
+ * acquisition channel. The store builds each grid once and hands it out to
+ * every channel with the same configuration. A grid is released as soon as
+ * the last channel using it is destroyed or switches to another grid.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_DOPPLER_WIPEOFF_STORE_H_
+#define GNSS_SDR_GNSS_DOPPLER_WIPEOFF_STORE_H_
+
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Read-only grid of carrier Doppler wipeoff signals.
+ *
+ * Bin i wipes off a carrier of freq + (-doppler_max + i * doppler_step) Hz.
+ */
+class Gnss_Doppler_Wipeoff_Grid
+{
+public:
+    Gnss_Doppler_Wipeoff_Grid(long freq, long fs_in, unsigned int doppler_max,
+            unsigned int doppler_step, unsigned int fft_size);
+    ~Gnss_Doppler_Wipeoff_Grid();
+
+    /*!
+     * \brief Number of Doppler bins in the grid.
+     */
+    unsigned int size() const
+    {
+        return d_wipeoffs.size();
+    }
+
+    /*!
+     * \brief Returns the 16-byte aligned wipeoff signal of bin \p doppler_index.
+     */
+    const gr_complex* wipeoff(unsigned int doppler_index) const
+    {
+        return d_wipeoffs[doppler_index];
+    }
+
+    /*!
+     * \brief Doppler shift [Hz] of bin \p doppler_index.
+     */
+    int doppler(unsigned int doppler_index) const
+    {
+        return -static_cast<int>(d_doppler_max) + static_cast<int>(d_doppler_step * doppler_index);
+    }
+
+    unsigned int fft_size() const
+    {
+        return d_fft_size;
+    }
+
+private:
+    Gnss_Doppler_Wipeoff_Grid(const Gnss_Doppler_Wipeoff_Grid&);
+    Gnss_Doppler_Wipeoff_Grid& operator=(const Gnss_Doppler_Wipeoff_Grid&);
+
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    unsigned int d_fft_size;
+    std::vector<gr_complex*> d_wipeoffs;
+};
+
+
+/*!
+ * \brief Thread-safe, reference-counted store of Doppler wipeoff grids.
+ *
+ * The store only keeps weak references: grids live as long as at least one
+ * acquisition block holds the returned shared pointer.
+ */
+class Gnss_Doppler_Wipeoff_Store
+{
+public:
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Doppler_Wipeoff_Store& instance();
+
+    /*!
+     * \brief Returns the grid for the given configuration, building it if no
+     * other block is currently using it.
+     */
+    boost::shared_ptr<const Gnss_Doppler_Wipeoff_Grid> get(long freq, long fs_in,
+            unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int fft_size);
+
+    /*!
+     * \brief Number of grids currently alive.
+     */
+    unsigned int size();
+
+private:
+    Gnss_Doppler_Wipeoff_Store();
+    Gnss_Doppler_Wipeoff_Store(const Gnss_Doppler_Wipeoff_Store&);
+    Gnss_Doppler_Wipeoff_Store& operator=(const Gnss_Doppler_Wipeoff_Store&);
+
+    struct Key
+    {
+        long freq;
+        long fs_in;
+        unsigned int doppler_max;
+        unsigned int doppler_step;
+        unsigned int fft_size;
+        bool operator<(const Key& other) const;
+    };
+
+    std::map<Key, boost::weak_ptr<const Gnss_Doppler_Wipeoff_Grid> > d_grids;
+    boost::mutex d_mutex;
+};
+
+#endif /* GNSS_SDR_GNSS_DOPPLER_WIPEOFF_STORE_H_ */
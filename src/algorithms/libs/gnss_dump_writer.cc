@@ -0,0 +1,280 @@
+/*!
+ * \file gnss_dump_writer.cc
+ * \brief Binary dump files of the processing blocks, written by a background
+ * thread from a ring buffer of fixed-size records per file.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gnss_dump_writer.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <glog/logging.h>
+
+// Size of the ring of records of each file [bytes]
+#define DUMP_RING_BYTES (4 * 1024 * 1024)
+// Size of the stream buffer of each file [bytes]
+#define DUMP_FILE_BUFFER_BYTES (1024 * 1024)
+// Period of the writer thread [ms]
+#define DUMP_WRITER_PERIOD_MS 50
+
+
+Gnss_Dump_Schema::Gnss_Dump_Schema(const std::string& name)
+{
+    d_name = name;
+    d_record_bytes = 0;
+}
+
+
+void Gnss_Dump_Schema::add_field(const std::string& name, Field_Type type)
+{
+    d_fields.push_back(std::make_pair(name, type));
+    d_record_bytes += (type == FLOAT32) ? 4 : 8;
+}
+
+
+std::string Gnss_Dump_Schema::header() const
+{
+    std::stringstream header;
+    header << "GNSS-SDR dump 1\n";
+    header << "name " << d_name << "\n";
+    header << "record_bytes " << d_record_bytes << "\n";
+    for (unsigned int i = 0; i < d_fields.size(); i++)
+        {
+            switch (d_fields[i].second)
+            {
+            case FLOAT32:
+                header << "field float32 ";
+                break;
+            case FLOAT64:
+                header << "field float64 ";
+                break;
+            default:
+                header << "field uint64 ";
+                break;
+            }
+            header << d_fields[i].first << "\n";
+        }
+    header << "end_header\n";
+    return header.str();
+}
+
+
+
+Gnss_Dump_File::Gnss_Dump_File() : d_head(0), d_tail(0)
+{
+    d_open = false;
+    d_record_bytes = 0;
+    d_capacity = 0;
+    d_dropped_records = 0;
+}
+
+
+Gnss_Dump_File::~Gnss_Dump_File()
+{
+    close();
+}
+
+
+bool Gnss_Dump_File::open(const std::string& filename, const Gnss_Dump_Schema& schema)
+{
+    close();
+    d_filename = filename;
+    d_record_bytes = std::max(schema.record_bytes(), 1u);
+    // the largest power of two of records that fits in the ring size
+    d_capacity = 1;
+    while (d_capacity * 2 * d_record_bytes <= DUMP_RING_BYTES)
+        {
+            d_capacity *= 2;
+        }
+    d_ring.assign(d_capacity * d_record_bytes, 0);
+    d_head = 0;
+    d_tail = 0;
+    d_dropped_records = 0;
+
+    d_file_buffer.resize(DUMP_FILE_BUFFER_BYTES);
+    d_file.rdbuf()->pubsetbuf(&d_file_buffer[0], d_file_buffer.size());
+    try
+    {
+            d_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            d_file.open(d_filename.c_str(), std::ios::out | std::ios::binary);
+            const std::string header = schema.header();
+            d_file.write(header.c_str(), header.size());
+    }
+    catch (const std::ofstream::failure& e)
+    {
+            LOG(WARNING) << "Exception opening dump file " << d_filename << " " << e.what();
+            return false;
+    }
+    d_open = true;
+    Gnss_Dump_Writer::instance().add(this);
+    return true;
+}
+
+
+bool Gnss_Dump_File::write(const void* record)
+{
+    const unsigned long int head = d_head.load(std::memory_order_relaxed);
+    if (head - d_tail.load(std::memory_order_acquire) >= d_capacity)
+        {
+            d_dropped_records++;
+            return false;
+        }
+    std::memcpy(&d_ring[(head & (d_capacity - 1)) * d_record_bytes], record, d_record_bytes);
+    d_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+
+void Gnss_Dump_File::close()
+{
+    if (!d_open)
+        {
+            return;
+        }
+    Gnss_Dump_Writer::instance().remove(this);
+    try
+    {
+            d_file.close();
+    }
+    catch (const std::ofstream::failure& e)
+    {
+            LOG(WARNING) << "Exception closing dump file " << d_filename << " " << e.what();
+    }
+    if (d_dropped_records > 0)
+        {
+            LOG(WARNING) << d_dropped_records << " records were dropped from the dump file " << d_filename;
+        }
+    d_open = false;
+}
+
+
+void Gnss_Dump_File::drain()
+{
+    unsigned long int tail = d_tail.load(std::memory_order_relaxed);
+    const unsigned long int head = d_head.load(std::memory_order_acquire);
+    try
+    {
+            // at most two writes, before and after the end of the ring
+            while (tail != head)
+                {
+                    const unsigned long int index = tail & (d_capacity - 1);
+                    const unsigned long int records = std::min(head - tail, d_capacity - index);
+                    d_file.write(&d_ring[index * d_record_bytes], records * d_record_bytes);
+                    tail += records;
+                }
+    }
+    catch (const std::ofstream::failure& e)
+    {
+            LOG(WARNING) << "Exception writing dump file " << d_filename << " " << e.what();
+            tail = head;
+    }
+    d_tail.store(tail, std::memory_order_release);
+}
+
+
+
+Gnss_Dump_Writer& Gnss_Dump_Writer::instance()
+{
+    static Gnss_Dump_Writer writer;
+    return writer;
+}
+
+
+Gnss_Dump_Writer::Gnss_Dump_Writer()
+{
+    d_running = false;
+}
+
+
+Gnss_Dump_Writer::~Gnss_Dump_Writer()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_running = false;
+        for (unsigned int i = 0; i < d_files.size(); i++)
+            {
+                d_files[i]->drain();
+            }
+    }
+    if (d_thread.joinable())
+        {
+            d_thread.interrupt();
+            d_thread.join();
+        }
+}
+
+
+void Gnss_Dump_Writer::add(Gnss_Dump_File* file)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_files.push_back(file);
+    if (!d_running)
+        {
+            d_running = true;
+            d_thread = boost::thread(&Gnss_Dump_Writer::run, this);
+        }
+}
+
+
+void Gnss_Dump_Writer::remove(Gnss_Dump_File* file)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::vector<Gnss_Dump_File*>::iterator it = std::find(d_files.begin(), d_files.end(), file);
+    if (it != d_files.end())
+        {
+            file->drain();
+            d_files.erase(it);
+        }
+}
+
+
+void Gnss_Dump_Writer::run()
+{
+    try
+    {
+            while (true)
+                {
+                    {
+                        boost::mutex::scoped_lock lock(d_mutex);
+                        if (!d_running)
+                            {
+                                break;
+                            }
+                        for (unsigned int i = 0; i < d_files.size(); i++)
+                            {
+                                d_files[i]->drain();
+                            }
+                    }
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(DUMP_WRITER_PERIOD_MS));
+                }
+    }
+    catch (const boost::thread_interrupted&)
+    {
+            // the writer is being destroyed
+    }
+}
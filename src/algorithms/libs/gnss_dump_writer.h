@@ -0,0 +1,208 @@
+/*!
+ * \file gnss_dump_writer.h
+ * \brief Binary dump files of the processing blocks, written by a background
+ * thread from a ring buffer of fixed-size records per file.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_GNSS_DUMP_WRITER_H_
+#define GNSS_SDR_GNSS_DUMP_WRITER_H_
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+/*!
+ * \brief Layout of the records of a dump file.
+ *
+ * The fields are packed with no padding, in the order they are added.
+ * The schema is written as a text header at the start of the file:
+ *
+ *     GNSS-SDR dump 1
+ *     name <name of the dump>
+ *     record_bytes <bytes of a record>
+ *     field <type> <name>
+ *     ...
+ *     end_header
+ *
+ * with one line per field, and the records follow. The types are
+ * float32, float64 and uint64. The MATLAB scripts in utils/matlab skip the
+ * header with gnss_sdr_read_dump_header.m.
+ */
+class Gnss_Dump_Schema
+{
+public:
+    enum Field_Type
+    {
+        FLOAT32,
+        FLOAT64,
+        UINT64
+    };
+
+    explicit Gnss_Dump_Schema(const std::string& name);
+
+    void add_field(const std::string& name, Field_Type type);
+
+    unsigned int record_bytes() const
+    {
+        return d_record_bytes;
+    }
+
+    /*!
+     * \brief Text header of the dump files with this schema.
+     */
+    std::string header() const;
+
+private:
+    std::string d_name;
+    std::vector<std::pair<std::string, Field_Type> > d_fields;
+    unsigned int d_record_bytes;
+};
+
+
+/*!
+ * \brief Dump file of a processing block.
+ *
+ * The block queues its records with write(), which only copies them to a
+ * ring buffer, and Gnss_Dump_Writer writes them to the file from its own
+ * thread with large buffered writes. The ring has a single producer, the
+ * thread of the block, and a single consumer, the writer thread, so it
+ * needs no lock. If the writer falls behind and the ring is full, the
+ * record is dropped and counted instead of blocking the block.
+ */
+class Gnss_Dump_File
+{
+public:
+    Gnss_Dump_File();
+
+    /*!
+     * \brief Closes the file, after writing the queued records.
+     */
+    ~Gnss_Dump_File();
+
+    /*!
+     * \brief Creates \p filename, writes the header of \p schema and
+     * starts queuing records. Returns false if the file cannot be created.
+     */
+    bool open(const std::string& filename, const Gnss_Dump_Schema& schema);
+
+    bool is_open() const
+    {
+        return d_open;
+    }
+
+    /*!
+     * \brief Queues the record at \p record, of schema.record_bytes()
+     * bytes. Only one thread may write to a file. Returns false if the
+     * record was dropped because the ring is full.
+     */
+    bool write(const void* record);
+
+    /*!
+     * \brief Writes the queued records and closes the file.
+     */
+    void close();
+
+    unsigned long int dropped_records() const
+    {
+        return d_dropped_records;
+    }
+
+private:
+    friend class Gnss_Dump_Writer;
+
+    Gnss_Dump_File(const Gnss_Dump_File&);
+    Gnss_Dump_File& operator=(const Gnss_Dump_File&);
+
+    /*!
+     * \brief Writes the records queued so far to the file. Called by the
+     * writer thread.
+     */
+    void drain();
+
+    std::string d_filename;
+    std::ofstream d_file;
+    std::vector<char> d_file_buffer;
+    bool d_open;
+
+    // ring of d_capacity records (a power of two)
+    std::vector<char> d_ring;
+    unsigned int d_record_bytes;
+    unsigned long int d_capacity;
+    std::atomic<unsigned long int> d_head;  // records queued since the file was opened
+    std::atomic<unsigned long int> d_tail;  // records written since the file was opened
+    unsigned long int d_dropped_records;
+};
+
+
+/*!
+ * \brief Receiver-wide writer thread of the Gnss_Dump_File objects.
+ *
+ * The thread is started with the first file, and wakes up periodically to
+ * write the queued records of all the open files.
+ */
+class Gnss_Dump_Writer
+{
+public:
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Dump_Writer& instance();
+
+    /*!
+     * \brief Stops the thread, after writing the queued records.
+     */
+    ~Gnss_Dump_Writer();
+
+    /*!
+     * \brief Starts writing the records of \p file.
+     */
+    void add(Gnss_Dump_File* file);
+
+    /*!
+     * \brief Writes the queued records of \p file and stops writing it.
+     */
+    void remove(Gnss_Dump_File* file);
+
+private:
+    Gnss_Dump_Writer();
+    Gnss_Dump_Writer(const Gnss_Dump_Writer&);
+    Gnss_Dump_Writer& operator=(const Gnss_Dump_Writer&);
+
+    void run();
+
+    boost::mutex d_mutex;
+    std::vector<Gnss_Dump_File*> d_files;
+    boost::thread d_thread;
+    bool d_running;
+};
+
+#endif /* GNSS_SDR_GNSS_DUMP_WRITER_H_ */
@@ -0,0 +1,244 @@
+/*!
+ * \file gnss_fft_plan_cache.cc
+ * \brief Receiver-wide FFTW plan cache with persistent wisdom, and the
+ * complex FFT object used by the acquisition blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gnss_fft_plan_cache.h"
+#include <cstdlib>
+#include <algorithm>
+#include <fftw3.h>
+#include <glog/logging.h>
+#include <gnuradio/fft/fft.h>
+
+using google::LogMessage;
+
+
+Gnss_Fft_Plan_Key::Gnss_Fft_Plan_Key(unsigned int fft_size_, bool forward_,
+        int in_alignment_, int out_alignment_)
+{
+    fft_size = fft_size_;
+    forward = forward_;
+    in_alignment = in_alignment_;
+    out_alignment = out_alignment_;
+}
+
+
+bool Gnss_Fft_Plan_Key::operator<(const Gnss_Fft_Plan_Key& other) const
+{
+    if (fft_size != other.fft_size) return fft_size < other.fft_size;
+    if (forward != other.forward) return forward < other.forward;
+    if (in_alignment != other.in_alignment) return in_alignment < other.in_alignment;
+    return out_alignment < other.out_alignment;
+}
+
+
+Gnss_Fft_Plan_Cache::Gnss_Fft_Plan_Cache()
+{
+    const char* home = getenv("HOME");
+    if (home != 0)
+        {
+            d_wisdom_filename = std::string(home) + "/.gnss-sdr_fftw_wisdom";
+        }
+    d_planner_flags = FFTW_MEASURE;
+    d_wisdom_loaded = false;
+    d_wisdom_changed = false;
+}
+
+
+Gnss_Fft_Plan_Cache::~Gnss_Fft_Plan_Cache()
+{
+    for (std::map<Gnss_Fft_Plan_Key, void*>::iterator it = d_plans.begin(); it != d_plans.end(); ++it)
+        {
+            fftwf_destroy_plan((fftwf_plan)it->second);
+        }
+}
+
+
+Gnss_Fft_Plan_Cache& Gnss_Fft_Plan_Cache::instance()
+{
+    static Gnss_Fft_Plan_Cache cache;
+    return cache;
+}
+
+
+void Gnss_Fft_Plan_Cache::configure(const std::string& wisdom_filename, const std::string& planner)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (planner.compare("estimate") == 0)
+        {
+            d_planner_flags = FFTW_ESTIMATE;
+        }
+    else if (planner.compare("measure") == 0)
+        {
+            d_planner_flags = FFTW_MEASURE;
+        }
+    else if (planner.compare("patient") == 0)
+        {
+            d_planner_flags = FFTW_PATIENT;
+        }
+    else if (planner.compare("exhaustive") == 0)
+        {
+            d_planner_flags = FFTW_EXHAUSTIVE;
+        }
+    else
+        {
+            LOG(WARNING) << "Unknown FFTW planner " << planner << ". Using measure";
+            d_planner_flags = FFTW_MEASURE;
+        }
+    d_wisdom_filename = wisdom_filename;
+    d_wisdom_loaded = false;
+    load_wisdom();
+}
+
+
+std::string Gnss_Fft_Plan_Cache::wisdom_filename()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_wisdom_filename;
+}
+
+
+void Gnss_Fft_Plan_Cache::load_wisdom()
+{
+    // Called with d_mutex held
+    d_wisdom_loaded = true;
+    if (d_wisdom_filename.empty())
+        {
+            return;
+        }
+    gr::fft::planner::scoped_lock planner_lock(gr::fft::planner::mutex());
+    if (fftwf_import_wisdom_from_filename(d_wisdom_filename.c_str()) != 0)
+        {
+            LOG(INFO) << "FFTW wisdom loaded from " << d_wisdom_filename;
+        }
+    else
+        {
+            LOG(INFO) << "No FFTW wisdom read from " << d_wisdom_filename;
+        }
+}
+
+
+void Gnss_Fft_Plan_Cache::save_wisdom()
+{
+    std::string wisdom_filename;
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        if (!d_wisdom_changed || d_wisdom_filename.empty())
+            {
+                return;
+            }
+        d_wisdom_changed = false;
+        wisdom_filename = d_wisdom_filename;
+    }
+
+    // The file is written without holding the cache: only the FFTW
+    // planner is locked while the wisdom is exported
+    gr::fft::planner::scoped_lock planner_lock(gr::fft::planner::mutex());
+    if (fftwf_export_wisdom_to_filename(wisdom_filename.c_str()) == 0)
+        {
+            LOG(WARNING) << "Unable to write the FFTW wisdom to " << wisdom_filename;
+        }
+    else
+        {
+            LOG(INFO) << "FFTW wisdom saved to " << wisdom_filename;
+        }
+}
+
+
+void* Gnss_Fft_Plan_Cache::get(unsigned int fft_size, bool forward, gr_complex* in, gr_complex* out)
+{
+    Gnss_Fft_Plan_Key key(fft_size, forward, fftwf_alignment_of((float*)in),
+            fftwf_alignment_of((float*)out));
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<Gnss_Fft_Plan_Key, void*>::iterator it = d_plans.find(key);
+    if (it != d_plans.end())
+        {
+            return it->second;
+        }
+    if (!d_wisdom_loaded)
+        {
+            load_wisdom();
+        }
+
+    // The FFTW planner is not thread-safe: share the GNU Radio planner lock
+    // with the blocks that still use gr::fft
+    gr::fft::planner::scoped_lock planner_lock(gr::fft::planner::mutex());
+    fftwf_plan plan = fftwf_plan_dft_1d(fft_size, reinterpret_cast<fftwf_complex*>(in),
+            reinterpret_cast<fftwf_complex*>(out), forward ? FFTW_FORWARD : FFTW_BACKWARD,
+            d_planner_flags);
+    if (plan == 0)
+        {
+            LOG(ERROR) << "Unable to create the FFTW plan of size " << fft_size;
+            return 0;
+        }
+    d_wisdom_changed = true;
+    d_plans.insert(std::make_pair(key, (void*)plan));
+    DLOG(INFO) << "FFT plan cache: " << (forward ? "forward" : "inverse") << " FFT of size "
+               << fft_size << " planned, " << d_plans.size() << " plans";
+    return plan;
+}
+
+
+unsigned int Gnss_Fft_Plan_Cache::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_plans.size();
+}
+
+
+Gnss_Fft::Gnss_Fft(unsigned int fft_size, bool forward)
+{
+    d_fft_size = fft_size;
+    d_inbuf = static_cast<gr_complex*>(fftwf_malloc(sizeof(gr_complex) * fft_size));
+    d_outbuf = static_cast<gr_complex*>(fftwf_malloc(sizeof(gr_complex) * fft_size));
+    if (d_inbuf == 0 || d_outbuf == 0)
+        {
+            LOG(ERROR) << "Unable to allocate the buffers of an FFT of size " << fft_size;
+        }
+    d_plan = Gnss_Fft_Plan_Cache::instance().get(fft_size, forward, d_inbuf, d_outbuf);
+
+    // Planning may have used the buffers
+    std::fill_n(d_inbuf, d_fft_size, gr_complex(0.0, 0.0));
+    std::fill_n(d_outbuf, d_fft_size, gr_complex(0.0, 0.0));
+}
+
+
+Gnss_Fft::~Gnss_Fft()
+{
+    fftwf_free(d_inbuf);
+    fftwf_free(d_outbuf);
+}
+
+
+void Gnss_Fft::execute()
+{
+    // New-array execution of the shared plan: thread-safe
+    fftwf_execute_dft((fftwf_plan)d_plan, reinterpret_cast<fftwf_complex*>(d_inbuf),
+            reinterpret_cast<fftwf_complex*>(d_outbuf));
+}
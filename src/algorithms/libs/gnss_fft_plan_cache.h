@@ -0,0 +1,180 @@
+/*!
+ * \file gnss_fft_plan_cache.h
+ * \brief Receiver-wide FFTW plan cache with persistent wisdom, and the
+ * complex FFT object used by the acquisition blocks.
+ *
+ * Every acquisition channel needs the same few transforms (the forward and
+ * inverse FFTs of its dwell length). Instead of planning them again in each
+ * block, plans are created once per (size, direction, alignment), with the
+ * planner effort set in the configuration, and executed by every block on
+ * its own buffers. The FFTW wisdom is loaded from and saved to a file, so
+ * that a restart reuses the plans measured before and gets the same
+ * transform performance.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_FFT_PLAN_CACHE_H_
+#define GNSS_SDR_GNSS_FFT_PLAN_CACHE_H_
+
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Identifies a plan in the cache. FFTW only allows executing a plan
+ * on buffers with the alignment of the ones it was created with.
+ */
+class Gnss_Fft_Plan_Key
+{
+public:
+    unsigned int fft_size;
+    bool forward;
+    int in_alignment;
+    int out_alignment;
+
+    Gnss_Fft_Plan_Key(unsigned int fft_size_, bool forward_,
+            int in_alignment_, int out_alignment_);
+
+    bool operator<(const Gnss_Fft_Plan_Key& other) const;
+};
+
+
+/*!
+ * \brief Thread-safe store of single precision complex FFTW plans.
+ *
+ * Plans are never destroyed while the receiver runs, so the pointers
+ * returned by get() stay valid and can be executed concurrently on
+ * different buffers.
+ */
+class Gnss_Fft_Plan_Cache
+{
+public:
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Fft_Plan_Cache& instance();
+
+    /*!
+     * \brief Sets the wisdom file and the planner effort ("estimate",
+     * "measure", "patient" or "exhaustive") and loads the wisdom. Plans
+     * already in the cache are kept. An empty \p wisdom_filename disables
+     * the wisdom persistence.
+     */
+    void configure(const std::string& wisdom_filename, const std::string& planner);
+
+    /*!
+     * \brief Wisdom file in use, by default ~/.gnss-sdr_fftw_wisdom.
+     */
+    std::string wisdom_filename();
+
+    /*!
+     * \brief Returns the plan (an fftwf_plan) of an out-of-place transform
+     * of \p fft_size samples from \p in to \p out. On a cache miss the plan
+     * is created on these buffers, overwriting their contents.
+     */
+    void* get(unsigned int fft_size, bool forward, gr_complex* in, gr_complex* out);
+
+    /*!
+     * \brief Writes the wisdom file if plans were created since the last
+     * save. Planning is slow enough without a file write per plan, so the
+     * receiver calls it once, when the flowgraph stops.
+     */
+    void save_wisdom();
+
+    /*!
+     * \brief Number of plans currently held by the cache.
+     */
+    unsigned int size();
+
+private:
+    Gnss_Fft_Plan_Cache();
+    ~Gnss_Fft_Plan_Cache();
+    Gnss_Fft_Plan_Cache(const Gnss_Fft_Plan_Cache&);
+    Gnss_Fft_Plan_Cache& operator=(const Gnss_Fft_Plan_Cache&);
+
+    void load_wisdom();
+
+    std::map<Gnss_Fft_Plan_Key, void*> d_plans;
+    boost::mutex d_mutex;
+    std::string d_wisdom_filename;
+    unsigned int d_planner_flags;
+    bool d_wisdom_loaded;
+    bool d_wisdom_changed;  // plans created since the last save_wisdom()
+};
+
+
+/*!
+ * \brief Out-of-place complex FFT with SIMD-aligned buffers, executed with
+ * a plan shared through Gnss_Fft_Plan_Cache. Drop-in replacement of
+ * gr::fft::fft_complex for the acquisition blocks.
+ *
+ * Each object owns its buffers, so different objects of the same size can
+ * be executed at the same time from different threads.
+ */
+class Gnss_Fft
+{
+public:
+    Gnss_Fft(unsigned int fft_size, bool forward = true);
+    ~Gnss_Fft();
+
+    gr_complex* get_inbuf() const
+    {
+        return d_inbuf;
+    }
+
+    gr_complex* get_outbuf() const
+    {
+        return d_outbuf;
+    }
+
+    unsigned int inbuf_length() const
+    {
+        return d_fft_size;
+    }
+
+    unsigned int outbuf_length() const
+    {
+        return d_fft_size;
+    }
+
+    /*!
+     * \brief Computes the transform of the input buffer into the output
+     * buffer. It is not normalized.
+     */
+    void execute();
+
+private:
+    Gnss_Fft(const Gnss_Fft&);
+    Gnss_Fft& operator=(const Gnss_Fft&);
+
+    unsigned int d_fft_size;
+    gr_complex* d_inbuf;
+    gr_complex* d_outbuf;
+    void* d_plan;
+};
+
+#endif /* GNSS_SDR_GNSS_FFT_PLAN_CACHE_H_ */
@@ -0,0 +1,88 @@
+/*!
+ * \file gnss_navigation_aiding.cc
+ * \brief Latest position solution of the receiver, published by the PVT
+ * block for the tracking blocks that aid their loops with it.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gnss_navigation_aiding.h"
+
+
+Gnss_Navigation_Aiding& Gnss_Navigation_Aiding::instance()
+{
+    static Gnss_Navigation_Aiding aiding;
+    return aiding;
+}
+
+
+Gnss_Navigation_Aiding::Gnss_Navigation_Aiding()
+{
+    d_valid = false;
+    d_gps_time_s = 0.0;
+    d_rx_time_s = 0.0;
+    for (int i = 0; i < 3; i++)
+        {
+            d_position_ecef_m[i] = 0.0;
+        }
+}
+
+
+void Gnss_Navigation_Aiding::set_solution(double gps_time_s, double rx_time_s, const double* position_ecef_m)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_gps_time_s = gps_time_s;
+    d_rx_time_s = rx_time_s;
+    for (int i = 0; i < 3; i++)
+        {
+            d_position_ecef_m[i] = position_ecef_m[i];
+        }
+    d_valid = true;
+}
+
+
+bool Gnss_Navigation_Aiding::get_solution(double& gps_time_s, double& rx_time_s, double* position_ecef_m)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_valid)
+        {
+            return false;
+        }
+    gps_time_s = d_gps_time_s;
+    rx_time_s = d_rx_time_s;
+    for (int i = 0; i < 3; i++)
+        {
+            position_ecef_m[i] = d_position_ecef_m[i];
+        }
+    return true;
+}
+
+
+void Gnss_Navigation_Aiding::reset()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_valid = false;
+}
@@ -0,0 +1,84 @@
+/*!
+ * \file gnss_navigation_aiding.h
+ * \brief Latest position solution of the receiver, published by the PVT
+ * block for the tracking blocks that aid their loops with it.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_GNSS_NAVIGATION_AIDING_H_
+#define GNSS_SDR_GNSS_NAVIGATION_AIDING_H_
+
+#include <boost/thread/mutex.hpp>
+
+/*!
+ * \brief Receiver-wide store of the last valid position solution.
+ *
+ * The solution is tagged with its GPS time and with the receiver time
+ * of the same epoch (the Tracking_timestamp_secs of the observables), so
+ * that a tracking block can tell the GPS time of the samples it is
+ * processing, which runs ahead of the PVT by the latency of the telemetry
+ * decoders and the observables.
+ */
+class Gnss_Navigation_Aiding
+{
+public:
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Navigation_Aiding& instance();
+
+    Gnss_Navigation_Aiding();
+
+    /*!
+     * \brief Stores a solution: the ECEF position in \p position_ecef_m
+     * (X, Y, Z) at the GPS time of week \p gps_time_s, which corresponds to
+     * the receiver time \p rx_time_s.
+     */
+    void set_solution(double gps_time_s, double rx_time_s, const double* position_ecef_m);
+
+    /*!
+     * \brief Copies the last solution. Returns false if there is none.
+     */
+    bool get_solution(double& gps_time_s, double& rx_time_s, double* position_ecef_m);
+
+    /*!
+     * \brief Forgets the solution.
+     */
+    void reset();
+
+private:
+    Gnss_Navigation_Aiding(const Gnss_Navigation_Aiding&);
+    Gnss_Navigation_Aiding& operator=(const Gnss_Navigation_Aiding&);
+
+    boost::mutex d_mutex;
+    bool d_valid;
+    double d_gps_time_s;
+    double d_rx_time_s;
+    double d_position_ecef_m[3];
+};
+
+#endif /* GNSS_SDR_GNSS_NAVIGATION_AIDING_H_ */
@@ -0,0 +1,294 @@
+/*!
+ * \file gnss_overload_controller.cc
+ * \brief Receiver-wide overload protection: degrades the processing of the
+ * channels when the tracking blocks fall behind the signal source.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gnss_overload_controller.h"
+#include <algorithm>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <glog/logging.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+
+// Input buffer fill above which the receiver is overloaded
+#define OVERLOAD_HIGH_BUFFER_FILL 0.75
+// Input buffer fill below which the receiver is relieved
+#define OVERLOAD_LOW_BUFFER_FILL 0.25
+// Consecutive relieved intervals before going back one level
+#define OVERLOAD_RESTORE_INTERVALS 5
+// Satellites in track that are never dropped, for the PVT
+#define OVERLOAD_MIN_TRACKED_SATELLITES 4
+
+
+Gnss_Overload_Controller& Gnss_Overload_Controller::instance()
+{
+    static Gnss_Overload_Controller controller;
+    return controller;
+}
+
+
+Gnss_Overload_Controller::Gnss_Overload_Controller()
+{
+    d_enabled = false;
+    d_high_load = 0.9;
+    d_low_load = 0.6;
+    d_evaluation_interval_s = 1.0;
+    d_cores = std::max(boost::thread::hardware_concurrency(), 1u);
+    d_level = NORMAL;
+    d_load = 0.0;
+    d_buffer_fill = 0.0;
+    d_interval_start_s = 0.0;
+    d_relieved_intervals = 0;
+    d_dropped_satellites = 0;
+    d_dumps = 0;
+}
+
+
+void Gnss_Overload_Controller::configure(bool enabled, double high_load, double low_load, double evaluation_interval_s)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_enabled = enabled;
+    d_high_load = high_load;
+    d_low_load = std::min(low_load, high_load);
+    d_evaluation_interval_s = evaluation_interval_s > 0.0 ? evaluation_interval_s : 1.0;
+    d_interval_start_s = now_s();
+    if (d_enabled)
+        {
+            LOG(INFO) << "Overload protection enabled: high load " << d_high_load << ", low load "
+                      << d_low_load << ", " << d_cores << " cores";
+        }
+}
+
+
+double Gnss_Overload_Controller::now_s()
+{
+    static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+    return (double)(boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds() * 1e-6;
+}
+
+
+double Gnss_Overload_Controller::input_buffer_fill(const gr::block& block, int items_available)
+{
+    if (!block.detail())
+        {
+            return 0.0;
+        }
+    const int buffer_size = block.detail()->input(0)->buffer()->bufsize();
+    return buffer_size > 0 ? std::min((double)items_available / (double)buffer_size, 1.0) : 0.0;
+}
+
+
+int Gnss_Overload_Controller::report_work(long reporter, double work_time_s, double signal_time_s, double buffer_fill)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_enabled)
+        {
+            return d_level;
+        }
+    Work_Report& report = d_work_reports[reporter];
+    report.work_time_s += work_time_s;
+    report.signal_time_s += signal_time_s;
+    report.buffer_fill = std::max(report.buffer_fill, buffer_fill);
+
+    const double now = now_s();
+    if (now - d_interval_start_s >= d_evaluation_interval_s)
+        {
+            evaluate(now);
+        }
+    return d_level;
+}
+
+
+bool Gnss_Overload_Controller::report_cn0(unsigned int channel, double cn0_db_hz)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (cn0_db_hz > 0.0)
+        {
+            d_cn0_db_hz[channel] = cn0_db_hz;
+        }
+    else
+        {
+            d_cn0_db_hz.erase(channel);
+        }
+    std::map<unsigned int, bool>::iterator request = d_drop_requests.find(channel);
+    if (request == d_drop_requests.end())
+        {
+            return false;
+        }
+    d_drop_requests.erase(request);
+    // the satellite may have been lost since the request
+    return cn0_db_hz > 0.0;
+}
+
+
+void Gnss_Overload_Controller::add_dump()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_dumps++;
+}
+
+
+void Gnss_Overload_Controller::remove_dump()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_dumps > 0)
+        {
+            d_dumps--;
+        }
+}
+
+
+double Gnss_Overload_Controller::load()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_load;
+}
+
+
+double Gnss_Overload_Controller::buffer_fill()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_buffer_fill;
+}
+
+
+unsigned int Gnss_Overload_Controller::dropped_satellites()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_dropped_satellites;
+}
+
+
+void Gnss_Overload_Controller::reset()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_level = NORMAL;
+    d_load = 0.0;
+    d_buffer_fill = 0.0;
+    d_interval_start_s = now_s();
+    d_relieved_intervals = 0;
+    d_dropped_satellites = 0;
+    d_work_reports.clear();
+    d_cn0_db_hz.clear();
+    d_drop_requests.clear();
+}
+
+
+void Gnss_Overload_Controller::evaluate(double now_s)
+{
+    double max_ratio = 0.0;
+    double sum_ratio = 0.0;
+    double max_fill = 0.0;
+    for (std::map<long, Work_Report>::iterator it = d_work_reports.begin(); it != d_work_reports.end(); ++it)
+        {
+            Work_Report& report = it->second;
+            if (report.signal_time_s > 0.0)
+                {
+                    const double ratio = report.work_time_s / report.signal_time_s;
+                    max_ratio = std::max(max_ratio, ratio);
+                    sum_ratio += ratio;
+                }
+            max_fill = std::max(max_fill, report.buffer_fill);
+            report.work_time_s = 0.0;
+            report.signal_time_s = 0.0;
+            report.buffer_fill = 0.0;
+        }
+    d_load = std::max(max_ratio, sum_ratio / (double)d_cores);
+    d_buffer_fill = max_fill;
+    d_interval_start_s = now_s;
+    DLOG(INFO) << "Overload level " << d_level << ", load " << d_load << ", input buffer fill " << d_buffer_fill;
+
+    const bool overloaded = d_load > d_high_load or d_buffer_fill > OVERLOAD_HIGH_BUFFER_FILL;
+    const bool relieved = d_load < d_low_load and d_buffer_fill < OVERLOAD_LOW_BUFFER_FILL;
+    if (overloaded)
+        {
+            d_relieved_intervals = 0;
+            if (d_level < SHEDDING)
+                {
+                    d_level++;
+                    if (d_level == REDUCED_COST and d_dumps == 0)
+                        {
+                            // no dump to stop, so the level would shed nothing
+                            d_level++;
+                        }
+                    LOG(WARNING) << "Receiver overloaded: load " << d_load << ", input buffer fill "
+                                 << d_buffer_fill << ". Overload level raised to " << d_level;
+                }
+            else
+                {
+                    shed_weakest();
+                }
+        }
+    else if (relieved and d_level > NORMAL)
+        {
+            d_relieved_intervals++;
+            if (d_relieved_intervals >= OVERLOAD_RESTORE_INTERVALS)
+                {
+                    d_relieved_intervals = 0;
+                    d_level--;
+                    if (d_level == REDUCED_COST and d_dumps == 0)
+                        {
+                            d_level--;
+                        }
+                    LOG(INFO) << "Receiver relieved: load " << d_load << ", input buffer fill "
+                              << d_buffer_fill << ". Overload level lowered to " << d_level;
+                }
+        }
+    else
+        {
+            d_relieved_intervals = 0;
+        }
+}
+
+
+void Gnss_Overload_Controller::shed_weakest()
+{
+    if (d_cn0_db_hz.size() <= OVERLOAD_MIN_TRACKED_SATELLITES)
+        {
+            return;
+        }
+    std::map<unsigned int, double>::iterator weakest = d_cn0_db_hz.end();
+    for (std::map<unsigned int, double>::iterator it = d_cn0_db_hz.begin(); it != d_cn0_db_hz.end(); ++it)
+        {
+            if (d_drop_requests.count(it->first) == 0 and (weakest == d_cn0_db_hz.end() or it->second < weakest->second))
+                {
+                    weakest = it;
+                }
+        }
+    if (weakest == d_cn0_db_hz.end())
+        {
+            return;
+        }
+    LOG(WARNING) << "Receiver overloaded: load " << d_load << ". Dropping the satellite of channel "
+                 << weakest->first << ", CN0 = " << weakest->second << " [dB-Hz]";
+    d_drop_requests[weakest->first] = true;
+    d_cn0_db_hz.erase(weakest);
+    d_dropped_satellites++;
+}
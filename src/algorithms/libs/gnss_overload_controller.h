@@ -0,0 +1,209 @@
+/*!
+ * \file gnss_overload_controller.h
+ * \brief Receiver-wide overload protection: degrades the processing of the
+ * channels when the tracking blocks fall behind the signal source.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_GNSS_OVERLOAD_CONTROLLER_H_
+#define GNSS_SDR_GNSS_OVERLOAD_CONTROLLER_H_
+
+#include <atomic>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/block.h>
+
+/*!
+ * \brief Receiver-wide overload controller.
+ *
+ * The tracking blocks report the wall time spent in each call to
+ * general_work, the signal time processed in it and the fill of their
+ * input buffer, together with the CN0 of their channels. Once per
+ * evaluation interval, the controller computes the load as the largest
+ * ratio of work time to signal time of a block, or the sum of these
+ * ratios divided by the number of processor cores if it is larger. A load
+ * above 1 means the receiver does not keep up with a real-time source.
+ *
+ * While the load or the buffer fill are above the high thresholds, the
+ * controller raises the overload level by one step per interval:
+ *
+ *  - REDUCED_COST: the tracking blocks stop recording their dump files,
+ *    which relieves the dump writer thread and the disk. The level is
+ *    skipped when no tracking dump file is open, since it sheds nothing.
+ *  - ACQUISITION_PAUSED: the acquisition blocks do not start new
+ *    searches, so the channels in standby wait.
+ *  - SHEDDING: the weakest satellite in track, by CN0, is dropped at each
+ *    interval, keeping a minimum number of them for the PVT.
+ *
+ * The level goes back one step after a few consecutive intervals below
+ * the low thresholds. The changes of level are logged, and the last load
+ * and buffer fill can be read at any time. The level and the enabled flag
+ * are published in atomics, so that the blocks read them without locking.
+ */
+class Gnss_Overload_Controller
+{
+public:
+    enum Level
+    {
+        NORMAL = 0,
+        REDUCED_COST = 1,
+        ACQUISITION_PAUSED = 2,
+        SHEDDING = 3
+    };
+
+    /*!
+     * \brief Returns the receiver-wide instance.
+     */
+    static Gnss_Overload_Controller& instance();
+
+    Gnss_Overload_Controller();
+
+    /*!
+     * \brief Enables the overload protection, with the load above which
+     * the receiver is overloaded and the load below which it is relieved,
+     * evaluated every \p evaluation_interval_s seconds of wall time.
+     */
+    void configure(bool enabled, double high_load, double low_load, double evaluation_interval_s);
+
+    bool enabled() const
+    {
+        return d_enabled.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Wall time [s], to measure the work time of the blocks.
+     */
+    static double now_s();
+
+    /*!
+     * \brief Fill of the first input buffer of \p block, which has
+     * \p items_available items to read, between 0 and 1.
+     */
+    static double input_buffer_fill(const gr::block& block, int items_available);
+
+    /*!
+     * \brief Adds a call to general_work of the block \p reporter (its
+     * unique_id()): \p work_time_s of wall time to process
+     * \p signal_time_s of signal, with its input buffer at
+     * \p buffer_fill. Returns the overload level.
+     */
+    int report_work(long reporter, double work_time_s, double signal_time_s, double buffer_fill);
+
+    /*!
+     * \brief Updates the CN0 of the satellite tracked by \p channel, 0 if
+     * it is not tracking. Returns true if the channel has to drop its
+     * satellite to shed load.
+     */
+    bool report_cn0(unsigned int channel, double cn0_db_hz);
+
+    /*!
+     * \brief Counts a tracking dump file that the REDUCED_COST level stops
+     * while it is open. Called when the file is opened and closed.
+     */
+    void add_dump();
+    void remove_dump();
+
+    /*!
+     * \brief Overload level, from NORMAL to SHEDDING.
+     */
+    int level() const
+    {
+        return d_level.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief True while the acquisitions must not start new searches.
+     */
+    bool acquisition_paused() const
+    {
+        return d_level.load(std::memory_order_relaxed) >= ACQUISITION_PAUSED;
+    }
+
+    /*!
+     * \brief Load of the last evaluation interval.
+     */
+    double load();
+
+    /*!
+     * \brief Largest input buffer fill of the last evaluation interval.
+     */
+    double buffer_fill();
+
+    /*!
+     * \brief Satellites dropped to shed load since the start.
+     */
+    unsigned int dropped_satellites();
+
+    /*!
+     * \brief Goes back to the NORMAL level and forgets the reports.
+     */
+    void reset();
+
+private:
+    Gnss_Overload_Controller(const Gnss_Overload_Controller&);
+    Gnss_Overload_Controller& operator=(const Gnss_Overload_Controller&);
+
+    struct Work_Report
+    {
+        double work_time_s;
+        double signal_time_s;
+        double buffer_fill;   // largest fill seen in the interval
+    };
+
+    /*!
+     * \brief Computes the load of the interval and updates the level.
+     * Called with d_mutex locked.
+     */
+    void evaluate(double now_s);
+
+    /*!
+     * \brief Asks the channel with the weakest satellite in track to drop
+     * it. Called with d_mutex locked.
+     */
+    void shed_weakest();
+
+    boost::mutex d_mutex;
+    std::atomic<bool> d_enabled;      // written with d_mutex locked, read without it
+    double d_high_load;
+    double d_low_load;
+    double d_evaluation_interval_s;
+    unsigned int d_cores;
+
+    std::atomic<int> d_level;         // written with d_mutex locked, read without it
+    double d_load;
+    double d_buffer_fill;
+    double d_interval_start_s;
+    int d_relieved_intervals;         // consecutive intervals below the low thresholds
+    unsigned int d_dropped_satellites;
+    unsigned int d_dumps;             // tracking dump files open
+
+    std::map<long, Work_Report> d_work_reports;   // by block
+    std::map<unsigned int, double> d_cn0_db_hz;    // by channel, of the satellites in track
+    std::map<unsigned int, bool> d_drop_requests;  // by channel
+};
+
+#endif /* GNSS_SDR_GNSS_OVERLOAD_CONTROLLER_H_ */
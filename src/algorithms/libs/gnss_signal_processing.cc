@@ -32,40 +32,19 @@
  */
 
 #include "gnss_signal_processing.h"
-#include <gnuradio/fxpt.h>  // fixed point sine and cosine
+#include "carrier_nco.h"
 
 
 void complex_exp_gen(std::complex<float>* _dest, double _f, double _fs, unsigned int _samps)
 {
-    int phase_i = 0;
-    int phase_step_i;
-    float phase_step_f = (float)((GPS_TWO_PI * _f) / _fs);
-    phase_step_i = gr::fxpt::float_to_fixed(phase_step_f);
-    float sin_f, cos_f;
-
-    for(unsigned int i = 0; i < _samps; i++)
-        {
-            gr::fxpt::sincos(phase_i, &sin_f, &cos_f);
-            _dest[i] = std::complex<float>(cos_f, sin_f);
-            phase_i += phase_step_i;
-        }
+    // the carrier NCO generates the conjugate exponential
+    carrier_nco(_dest, _samps, 0.0, -(GPS_TWO_PI * _f) / _fs);
 }
 
 
 void complex_exp_gen_conj(std::complex<float>* _dest, double _f, double _fs, unsigned int _samps)
 {
-    int phase_i = 0;
-    int phase_step_i;
-    float phase_step_f = (float)((GPS_TWO_PI * _f) / _fs);
-    phase_step_i = gr::fxpt::float_to_fixed(phase_step_f);
-    float sin_f, cos_f;
-
-    for(unsigned int i = 0; i < _samps; i++)
-        {
-            gr::fxpt::sincos(phase_i, &sin_f, &cos_f);
-            _dest[i] = std::complex<float>(cos_f, -sin_f);
-            phase_i += phase_step_i;
-        }
+    carrier_nco(_dest, _samps, 0.0, (GPS_TWO_PI * _f) / _fs);
 }
 
 
@@ -197,3 +176,24 @@ void resampler(std::complex<float>* _from, std::complex<float>* _dest, float _fs
                 }
         }
 }
+
+
+unsigned int next_fast_fft_size(unsigned int _size, bool _power_of_two)
+{
+    unsigned int _fast_size = _size > 0 ? _size : 1;
+    while (true)
+        {
+            unsigned int _remainder = _fast_size;
+            while (_remainder % 2 == 0) _remainder /= 2;
+            if (!_power_of_two)
+                {
+                    while (_remainder % 3 == 0) _remainder /= 3;
+                    while (_remainder % 5 == 0) _remainder /= 5;
+                }
+            if (_remainder == 1)
+                {
+                    return _fast_size;
+                }
+            _fast_size++;
+        }
+}
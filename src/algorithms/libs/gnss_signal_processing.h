@@ -69,4 +69,12 @@ void resampler(std::complex<float>* _from, std::complex<float>* _dest,
         float _fs_in, float _fs_out, unsigned int _length_in,
         unsigned int _length_out);
 
+/*!
+ * \brief This function returns the smallest FFT length not lower than
+ * _size that FFTW transforms efficiently: a power of two if _power_of_two
+ * is set, or a product of powers of 2, 3 and 5 otherwise.
+ *
+ */
+unsigned int next_fast_fft_size(unsigned int _size, bool _power_of_two);
+
 #endif /* GNSS_SDR_GNSS_SIGNAL_PROCESSING_H_ */
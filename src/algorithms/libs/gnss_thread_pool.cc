@@ -0,0 +1,197 @@
+/*!
+ * \file gnss_thread_pool.cc
+ * \brief Persistent, receiver-wide work-stealing thread pool for the
+ * signal processing blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gnss_thread_pool.h"
+#include <cstdlib>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Gnss_Fft_Scratch::Gnss_Fft_Scratch(unsigned int fft_size) :
+    fft(fft_size, true), ifft(fft_size, false)
+{
+    magnitude = 0;
+    if (posix_memalign((void**)&magnitude, 16, fft_size * sizeof(float)) == 0){};
+}
+
+
+Gnss_Fft_Scratch::~Gnss_Fft_Scratch()
+{
+    free(magnitude);
+}
+
+
+Gnss_Thread_Pool& Gnss_Thread_Pool::instance()
+{
+    static Gnss_Thread_Pool pool(boost::thread::hardware_concurrency());
+    return pool;
+}
+
+
+Gnss_Thread_Pool::Gnss_Thread_Pool(unsigned int num_workers)
+{
+    if (num_workers == 0)
+        {
+            num_workers = 1;
+        }
+    d_pending = 0;
+    d_next = 0;
+    d_stop = false;
+    for (unsigned int i = 0; i < num_workers; i++)
+        {
+            d_workers.push_back(new Worker());
+        }
+    for (unsigned int i = 0; i < num_workers; i++)
+        {
+            d_threads.create_thread(boost::bind(&Gnss_Thread_Pool::run, this, i));
+        }
+    DLOG(INFO) << "Thread pool started with " << num_workers << " workers";
+}
+
+
+Gnss_Thread_Pool::~Gnss_Thread_Pool()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_cond.notify_all();
+    d_threads.join_all();
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        {
+            std::map<unsigned int, Gnss_Fft_Scratch*>& scratch = d_workers[i]->scratch;
+            for (std::map<unsigned int, Gnss_Fft_Scratch*>::iterator it = scratch.begin(); it != scratch.end(); ++it)
+                {
+                    delete it->second;
+                }
+            delete d_workers[i];
+        }
+}
+
+
+void Gnss_Thread_Pool::push(const Task& task)
+{
+    // Called with d_mutex held: spread the tasks over the worker queues
+    Worker* worker = d_workers[d_next];
+    d_next = (d_next + 1) % d_workers.size();
+    boost::mutex::scoped_lock lock(worker->mutex);
+    worker->tasks.push_back(task);
+    d_pending++;
+}
+
+
+void Gnss_Thread_Pool::submit(const Task& task)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        push(task);
+    }
+    d_cond.notify_one();
+}
+
+
+void Gnss_Thread_Pool::submit(const std::vector<Task>& tasks)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        for (unsigned int i = 0; i < tasks.size(); i++)
+            {
+                push(tasks[i]);
+            }
+    }
+    d_cond.notify_all();
+}
+
+
+Gnss_Fft_Scratch& Gnss_Thread_Pool::scratch(unsigned int worker, unsigned int fft_size)
+{
+    std::map<unsigned int, Gnss_Fft_Scratch*>& scratch = d_workers[worker]->scratch;
+    std::map<unsigned int, Gnss_Fft_Scratch*>::iterator it = scratch.find(fft_size);
+    if (it == scratch.end())
+        {
+            it = scratch.insert(std::make_pair(fft_size, new Gnss_Fft_Scratch(fft_size))).first;
+            DLOG(INFO) << "Thread pool worker " << worker << ": FFT scratch of size " << fft_size;
+        }
+    return *it->second;
+}
+
+
+bool Gnss_Thread_Pool::pop(unsigned int worker, Task& task)
+{
+    // Oldest task of the own queue first, then steal the newest task of the
+    // other queues, so that blocks submitting at the same time share cores
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        {
+            Worker* victim = d_workers[(worker + i) % d_workers.size()];
+            boost::mutex::scoped_lock lock(victim->mutex);
+            if (victim->tasks.empty()) continue;
+            if (i == 0)
+                {
+                    task = victim->tasks.front();
+                    victim->tasks.pop_front();
+                }
+            else
+                {
+                    task = victim->tasks.back();
+                    victim->tasks.pop_back();
+                }
+            return true;
+        }
+    return false;
+}
+
+
+void Gnss_Thread_Pool::run(unsigned int worker)
+{
+    Task task;
+    while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                while (d_pending == 0 && !d_stop)
+                    {
+                        d_cond.wait(lock);
+                    }
+                if (d_pending == 0 && d_stop)
+                    {
+                        return;
+                    }
+                // Claim one of the queued tasks; it is in some worker queue
+                d_pending--;
+            }
+            while (!pop(worker, task))
+                {
+                    boost::this_thread::yield();
+                }
+            task(worker);
+        }
+}
@@ -0,0 +1,149 @@
+/*!
+ * \file gnss_thread_pool.h
+ * \brief Persistent, receiver-wide work-stealing thread pool for the
+ * signal processing blocks.
+ *
+ * Blocks that split their work into independent tasks (e.g. the Doppler
+ * bins of an acquisition dwell) submit them to this pool instead of
+ * creating threads. The workers are created once, each one with its own
+ * task queue; an idle worker takes tasks from the other queues, so that a
+ * single block can use all the idle cores, while the tasks of many blocks
+ * are spread over all the workers and none of them waits for a busy core.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_THREAD_POOL_H_
+#define GNSS_SDR_GNSS_THREAD_POOL_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "gnss_fft_plan_cache.h"
+
+/*!
+ * \brief Direct and inverse FFTs and a magnitude buffer of one pool
+ * worker, for one FFT size.
+ */
+class Gnss_Fft_Scratch
+{
+public:
+    explicit Gnss_Fft_Scratch(unsigned int fft_size);
+    ~Gnss_Fft_Scratch();
+
+    Gnss_Fft fft;       // direct FFT
+    Gnss_Fft ifft;      // inverse FFT
+    float* magnitude;   // fft_size floats, SIMD-aligned
+
+private:
+    Gnss_Fft_Scratch(const Gnss_Fft_Scratch&);
+    Gnss_Fft_Scratch& operator=(const Gnss_Fft_Scratch&);
+};
+
+
+/*!
+ * \brief Thread-safe work-stealing pool with a fixed number of workers.
+ *
+ * Tasks receive the index of the worker running them, in [0, size()).
+ * Each worker owns the FFT scratch of the tasks it runs, one per FFT size,
+ * so that all the blocks submitting tasks share size() scratch sets
+ * instead of allocating one per worker each.
+ */
+class Gnss_Thread_Pool
+{
+public:
+    typedef boost::function<void (unsigned int)> Task;
+
+    /*!
+     * \brief Returns the receiver-wide instance, with one worker per
+     * hardware thread.
+     */
+    static Gnss_Thread_Pool& instance();
+
+    /*!
+     * \brief Creates a pool with \p num_workers workers (at least one).
+     */
+    explicit Gnss_Thread_Pool(unsigned int num_workers);
+
+    /*!
+     * \brief Runs the pending tasks and joins the workers.
+     */
+    ~Gnss_Thread_Pool();
+
+    /*!
+     * \brief Number of workers.
+     */
+    unsigned int size() const
+    {
+        return d_workers.size();
+    }
+
+    /*!
+     * \brief Queues a task.
+     */
+    void submit(const Task& task);
+
+    /*!
+     * \brief Queues a set of tasks, spread over the workers.
+     */
+    void submit(const std::vector<Task>& tasks);
+
+    /*!
+     * \brief FFT scratch of worker \p worker for FFTs of \p fft_size
+     * points, created on first use. Only to be called from a task, with the
+     * worker index it received: no other thread uses that scratch, so no
+     * lock is taken.
+     */
+    Gnss_Fft_Scratch& scratch(unsigned int worker, unsigned int fft_size);
+
+private:
+    Gnss_Thread_Pool(const Gnss_Thread_Pool&);
+    Gnss_Thread_Pool& operator=(const Gnss_Thread_Pool&);
+
+    struct Worker
+    {
+        std::deque<Task> tasks;
+        boost::mutex mutex;
+        std::map<unsigned int, Gnss_Fft_Scratch*> scratch;   // by FFT size
+    };
+
+    void run(unsigned int worker);
+    bool pop(unsigned int worker, Task& task);
+    void push(const Task& task);
+
+    std::vector<Worker*> d_workers;
+    boost::thread_group d_threads;
+    boost::mutex d_mutex;
+    boost::condition_variable d_cond;
+    unsigned int d_pending;   // tasks queued and not yet claimed by a worker
+    unsigned int d_next;      // worker queue that receives the next task
+    bool d_stop;
+};
+
+#endif /* GNSS_SDR_GNSS_THREAD_POOL_H_ */
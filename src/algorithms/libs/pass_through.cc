@@ -35,6 +35,7 @@
 #include <iostream>
 //#include <gnuradio/io_signature.h>
 #include <glog/logging.h>
+#include <volk/volk_complex.h>
 #include "configuration_interface.h"
 
 using google::LogMessage;
@@ -61,6 +62,10 @@ Pass_Through::Pass_Through(ConfigurationInterface* configuration, std::string ro
         {
             item_size_ = sizeof(short);
         }
+    else if(item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+        }
     else
         {
             LOG(WARNING) << item_type_ << " unrecognized item type. Using float";
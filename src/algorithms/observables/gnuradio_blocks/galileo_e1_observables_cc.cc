@@ -37,6 +37,7 @@
 #include <map>
 #include <sstream>
 #include <vector>
+#include <boost/lexical_cast.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "control_message_factory.h"
@@ -70,16 +71,26 @@ galileo_e1_observables_cc::galileo_e1_observables_cc(unsigned int nchannels, boo
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    // one record per epoch, with the observables of all the channels
+                    Gnss_Dump_Schema schema("galileo_e1_observables");
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            const std::string channel = "ch" + boost::lexical_cast<std::string>(i) + ".";
+                            schema.add_field(channel + "d_TOW_at_current_symbol", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "Prn_timestamp_ms", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "Pseudorange_m", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "Flag_valid_pseudorange", Gnss_Dump_Schema::FLOAT64);
+                            schema.add_field(channel + "PRN", Gnss_Dump_Schema::FLOAT64);
+                        }
+                    d_dump_record.resize(5 * d_nchannels);
+                    if (d_dump_file.open(d_dump_filename, schema))
+                        {
                             LOG(INFO) << "Observables dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "Exception opening observables dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Unable to open observables dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -172,28 +183,18 @@ int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &n
 
       if(d_dump == true)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    for (unsigned int i = 0; i < d_nchannels ; i++)
-                        {
-                            tmp_double = current_gnss_synchro[i].d_TOW_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Prn_timestamp_ms;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Pseudorange_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].PRN;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                        }
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file. The record is
+            // queued, and written to the file by the dump writer thread
+            for (unsigned int i = 0; i < d_nchannels ; i++)
+                {
+                    double* channel_record = &d_dump_record[5 * i];
+                    channel_record[0] = current_gnss_synchro[i].d_TOW_at_current_symbol;
+                    channel_record[1] = current_gnss_synchro[i].Prn_timestamp_ms;
+                    channel_record[2] = current_gnss_synchro[i].Pseudorange_m;
+                    channel_record[3] = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
+                    channel_record[4] = current_gnss_synchro[i].PRN;
+                }
+            d_dump_file.write(&d_dump_record[0]);
         }
 
     consume_each(1); //one by one
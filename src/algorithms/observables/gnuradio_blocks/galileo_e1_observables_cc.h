@@ -37,6 +37,7 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -46,6 +47,7 @@
 #include "rinex_printer.h"
 #include "Galileo_E1.h"
 #include "gnss_synchro.h"
+#include "gnss_dump_writer.h"
 
 class galileo_e1_observables_cc;
 
@@ -79,7 +81,8 @@ private:
     unsigned long int d_fs_in;
     int d_output_rate_ms;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
+    std::vector<double> d_dump_record;  // observables of all the channels in an epoch
 };
 
 #endif
@@ -35,6 +35,7 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -44,6 +45,7 @@
 #include "rinex_printer.h"
 #include "GPS_L1_CA.h"
 #include "gnss_synchro.h"
+#include "gnss_dump_writer.h"
 
 class gps_l1_ca_observables_cc;
 
@@ -77,7 +79,8 @@ private:
     unsigned long int d_fs_in;
     int d_output_rate_ms;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
+    std::vector<double> d_dump_record;  // observables of all the channels in an epoch
 };
 
 #endif
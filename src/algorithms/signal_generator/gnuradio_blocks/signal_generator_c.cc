@@ -28,12 +28,13 @@
  * -------------------------------------------------------------------------
  */
 
+#include <cstring>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include "signal_generator_c.h"
 #include "gps_sdr_signal_processing.h"
 #include "galileo_e1_signal_processing.h"
-#include "nco_lib.h"
+#include "carrier_nco.h"
 
 
 /*
@@ -249,7 +250,7 @@ int signal_generator_c::general_work (int noutput_items,
     for (unsigned int sat = 0; sat < num_sats_; sat++)
         {
             float phase_step_rad = -(float)GPS_TWO_PI*doppler_Hz_[sat] / (float)fs_in_;
-            fxp_nco(complex_phase_, vector_length_, start_phase_rad_[sat], phase_step_rad);
+            carrier_nco(complex_phase_, vector_length_, start_phase_rad_[sat], phase_step_rad);
             start_phase_rad_[sat] += vector_length_ * phase_step_rad;
 
             out_idx = 0;
@@ -81,6 +81,11 @@ FileSignalSource::FileSignalSource(ConfigurationInterface* configuration,
         {
             item_size_ = sizeof(short int);
         }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            // interleaved I/Q 16-bit samples, kept as integers
+            item_size_ = 2 * sizeof(short int);
+        }
     else
         {
             LOG(WARNING) << item_type_
@@ -68,6 +68,8 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
+    int cn0_estimation_window = configuration->property(role + ".cn0_estimation_window", 20);
+    std::string cn0_estimation_window_type = configuration->property(role + ".cn0_estimation_window_type", std::string("sliding"));
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
@@ -93,6 +95,7 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
                     dll_bw_hz,
                     early_late_space_chips,
                     very_early_late_space_chips);
+            tracking_->set_lock_detector_window(cn0_estimation_window, cn0_estimation_window_type.compare("exponential") == 0);
         }
     else
         {
@@ -73,6 +73,8 @@ GpsL1CaDllFllPllTracking::GpsL1CaDllFllPllTracking(
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
+    int cn0_estimation_window = configuration->property(role + ".cn0_estimation_window", 20);
+    std::string cn0_estimation_window_type = configuration->property(role + ".cn0_estimation_window_type", std::string("sliding"));
     order = configuration->property(role + ".order", 2);
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     fll_bw_hz = configuration->property(role + ".fll_bw_hz", 100.0);
@@ -99,6 +101,7 @@ GpsL1CaDllFllPllTracking::GpsL1CaDllFllPllTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips);
+            tracking_->set_lock_detector_window(cn0_estimation_window, cn0_estimation_window_type.compare("exponential") == 0);
         }
     else
         {
@@ -0,0 +1,170 @@
+/*!
+ * \file gps_l1_ca_dll_pll_batch_tracking.cc
+ * \brief Implementation of an adapter of the batched DLL+PLL tracking block
+ * for GPS L1 C/A to a TrackingInterface
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gps_l1_ca_dll_pll_batch_tracking.h"
+#include <gnuradio/blocks/copy.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <glog/logging.h>
+#include "GPS_L1_CA.h"
+#include "configuration_interface.h"
+
+
+using google::LogMessage;
+
+GpsL1CaDllPllBatchTracking::GpsL1CaDllPllBatchTracking(
+        ConfigurationInterface* configuration, std::string role,
+        unsigned int in_streams, unsigned int out_streams,
+        boost::shared_ptr<gr::msg_queue> queue) :
+                role_(role), in_streams_(in_streams), out_streams_(out_streams),
+                queue_(queue)
+{
+    DLOG(INFO) << "role " << role;
+    //################# CONFIGURATION PARAMETERS ########################
+    int fs_in;
+    int vector_length;
+    int f_if;
+    bool dump;
+    std::string dump_filename;
+    std::string item_type;
+    std::string default_item_type = "gr_complex";
+    float pll_bw_hz;
+    float dll_bw_hz;
+    float early_late_space_chips;
+    item_type = configuration->property(role + ".item_type", default_item_type);
+    fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+    f_if = configuration->property(role + ".if", 0);
+    dump = configuration->property(role + ".dump", false);
+    int cn0_estimation_window = configuration->property(role + ".cn0_estimation_window", 20);
+    std::string cn0_estimation_window_type = configuration->property(role + ".cn0_estimation_window_type", std::string("sliding"));
+    pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
+    dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
+    early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    int extend_correlation_ms = configuration->property(role + ".extend_correlation_ms", 1);
+    float pll_bw_narrow_hz = configuration->property(role + ".pll_bw_narrow_hz", 15.0);
+    float dll_bw_narrow_hz = configuration->property(role + ".dll_bw_narrow_hz", 1.5);
+    bool vector_tracking = configuration->property(role + ".vector_tracking", false);
+    std::string default_dump_filename = "./track_ch";
+    dump_filename = configuration->property(role + ".dump_filename",
+            default_dump_filename);
+    vector_length = std::round(fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+
+    port_ = 0;
+    channel_ = 0;
+
+    //################# MAKE TRACKING GNURadio object ###################
+    if (item_type.compare("gr_complex") == 0)
+        {
+            item_size_ = sizeof(gr_complex);
+            tracking_ = gps_l1_ca_dll_pll_make_batch_tracking_cc(
+                    f_if,
+                    fs_in,
+                    vector_length,
+                    queue_,
+                    dump,
+                    dump_filename,
+                    pll_bw_hz,
+                    dll_bw_hz,
+                    early_late_space_chips);
+            tracking_->set_lock_detector_window(cn0_estimation_window, cn0_estimation_window_type.compare("exponential") == 0);
+            tracking_->set_extend_correlation_ms(extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz);
+            tracking_->set_vector_tracking(vector_tracking);
+            port_ = tracking_->add_channel();
+            if (port_ != 0)
+                {
+                    null_sink_ = gr::blocks::null_sink::make(item_size_);
+                }
+            output_ = gr::blocks::copy::make(sizeof(Gnss_Synchro));
+            DLOG(INFO) << "tracking(" << tracking_->unique_id() << ") port " << port_;
+        }
+    else
+        {
+            LOG(WARNING) << item_type << " unknown tracking item type.";
+        }
+}
+
+
+GpsL1CaDllPllBatchTracking::~GpsL1CaDllPllBatchTracking()
+{}
+
+
+void GpsL1CaDllPllBatchTracking::start_tracking()
+{
+    tracking_->start_tracking(port_);
+}
+
+/*
+ * Set tracking channel unique ID
+ */
+void GpsL1CaDllPllBatchTracking::set_channel(unsigned int channel)
+{
+    channel_ = channel;
+    tracking_->set_channel(port_, channel);
+}
+
+/*
+ * Set tracking channel internal queue
+ */
+void GpsL1CaDllPllBatchTracking::set_channel_queue(
+        concurrent_queue<int> *channel_internal_queue)
+{
+    channel_internal_queue_ = channel_internal_queue;
+    tracking_->set_channel_queue(port_, channel_internal_queue_);
+}
+
+void GpsL1CaDllPllBatchTracking::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+{
+    tracking_->set_gnss_synchro(port_, p_gnss_synchro);
+}
+
+void GpsL1CaDllPllBatchTracking::connect(gr::top_block_sptr top_block)
+{
+    top_block->connect(tracking_, port_, output_, 0);
+}
+
+void GpsL1CaDllPllBatchTracking::disconnect(gr::top_block_sptr top_block)
+{
+    top_block->disconnect(tracking_, port_, output_, 0);
+}
+
+gr::basic_block_sptr GpsL1CaDllPllBatchTracking::get_left_block()
+{
+    // The shared block reads the samples once for all the channels
+    if (port_ == 0)
+        {
+            return tracking_;
+        }
+    return null_sink_;
+}
+
+gr::basic_block_sptr GpsL1CaDllPllBatchTracking::get_right_block()
+{
+    return output_;
+}
@@ -0,0 +1,115 @@
+/*!
+ * \file gps_l1_ca_dll_pll_batch_tracking.h
+ * \brief  Interface of an adapter of the batched DLL+PLL tracking block
+ * for GPS L1 C/A to a TrackingInterface
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_H_
+#define GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_H_
+
+#include <string>
+#include <gnuradio/msg_queue.h>
+#include "tracking_interface.h"
+#include "gps_l1_ca_dll_pll_batch_tracking_cc.h"
+
+
+class ConfigurationInterface;
+
+/*!
+ * \brief This class implements a code DLL + carrier PLL tracking loop
+ * channel of Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc.
+ *
+ * All the adapters share the same block. The first one feeds its input,
+ * and the others drop the samples of their channel in a null sink. Each
+ * adapter forwards the output port of its channel to the telemetry decoder.
+ */
+class GpsL1CaDllPllBatchTracking : public TrackingInterface
+{
+public:
+
+    GpsL1CaDllPllBatchTracking(ConfigurationInterface* configuration,
+            std::string role,
+            unsigned int in_streams,
+            unsigned int out_streams,
+            boost::shared_ptr<gr::msg_queue> queue);
+
+    virtual ~GpsL1CaDllPllBatchTracking();
+
+    std::string role()
+    {
+        return role_;
+    }
+
+    //! Returns "GPS_L1_CA_DLL_PLL_Batch_Tracking"
+    std::string implementation()
+    {
+        return "GPS_L1_CA_DLL_PLL_Batch_Tracking";
+    }
+    size_t item_size()
+    {
+        return item_size_;
+    }
+
+    void connect(gr::top_block_sptr top_block);
+    void disconnect(gr::top_block_sptr top_block);
+    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_right_block();
+
+
+    /*!
+     * \brief Set tracking channel unique ID
+     */
+    void set_channel(unsigned int channel);
+
+    /*!
+     * \brief Set acquisition/tracking common Gnss_Synchro object pointer
+     * to efficiently exchange synchronization data between acquisition and tracking blocks
+     */
+    void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
+
+    /*!
+     * \brief Set tracking channel internal queue
+     */
+    void set_channel_queue(concurrent_queue<int> *channel_internal_queue);
+
+    void start_tracking();
+
+private:
+    gps_l1_ca_dll_pll_batch_tracking_cc_sptr tracking_;
+    int port_;
+    gr::block_sptr null_sink_;
+    gr::block_sptr output_;
+    size_t item_size_;
+    unsigned int channel_;
+    std::string role_;
+    unsigned int in_streams_;
+    unsigned int out_streams_;
+    boost::shared_ptr<gr::msg_queue> queue_;
+    concurrent_queue<int> *channel_internal_queue_;
+};
+
+#endif // GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_H_
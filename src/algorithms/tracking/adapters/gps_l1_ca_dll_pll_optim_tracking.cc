@@ -69,9 +69,14 @@ GpsL1CaDllPllOptimTracking::GpsL1CaDllPllOptimTracking(
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
+    int cn0_estimation_window = configuration->property(role + ".cn0_estimation_window", 20);
+    std::string cn0_estimation_window_type = configuration->property(role + ".cn0_estimation_window_type", std::string("sliding"));
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    int extend_correlation_ms = configuration->property(role + ".extend_correlation_ms", 1);
+    float pll_bw_narrow_hz = configuration->property(role + ".pll_bw_narrow_hz", 15.0);
+    float dll_bw_narrow_hz = configuration->property(role + ".dll_bw_narrow_hz", 1.5);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = round(fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
@@ -90,6 +95,8 @@ GpsL1CaDllPllOptimTracking::GpsL1CaDllPllOptimTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips);
+            tracking_->set_lock_detector_window(cn0_estimation_window, cn0_estimation_window_type.compare("exponential") == 0);
+            tracking_->set_extend_correlation_ms(extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz);
         }
     else
         {
@@ -42,6 +42,8 @@
 #include <gnuradio/msg_queue.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "lock_detectors.h"
+#include "tracking_dump.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
@@ -74,6 +76,13 @@ public:
     void set_channel(unsigned int channel);
     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
     void start_tracking();
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector, updated with every integration: the last \p length
+     * integrations, or an exponential window of time constant \p length
+     */
+    void set_lock_detector_window(int length, bool exponential);
     void set_channel_queue(concurrent_queue<int> *channel_internal_queue);
 
     /*!
@@ -130,12 +139,11 @@ private:
     float d_very_early_late_spc_chips;
 
     gr_complex* d_ca_code;
+    double d_local_code_shift_half_chips[5];  // Very Early to Very Late shifts
 
-    gr_complex* d_very_early_code;
-    gr_complex* d_early_code;
-    gr_complex* d_prompt_code;
-    gr_complex* d_late_code;
-    gr_complex* d_very_late_code;
+    // code phase of the first sample of the integration and its rate
+    double d_code_phase_half_chips;
+    double d_code_phase_step_half_chips;
     gr_complex* d_carr_sign;
 
     gr_complex *d_Very_Early;
@@ -158,6 +166,7 @@ private:
 
     // correlator
     Correlator d_correlator;
+    gr_complex* d_correlator_outs[5];    // d_Very_Early to d_Very_Late
 
     // tracking vars
     float d_code_freq_chips;
@@ -171,10 +180,10 @@ private:
     //processing samples counters
     unsigned long int d_sample_counter;
     unsigned long int d_acq_sample_stamp;
+    int d_samples_to_skip; // input samples already counted in d_sample_counter but not consumed yet
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Tracking_Lock_Detector d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
@@ -186,7 +195,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -37,6 +37,7 @@
  */
 
 #include "galileo_e1_tcp_connector_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -45,6 +46,8 @@
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "gnss_synchro.h"
+#include "carrier_nco.h"
+#include "code_nco.h"
 #include "galileo_e1_signal_processing.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
@@ -85,7 +88,7 @@ galileo_e1_tcp_connector_tracking_cc_sptr galileo_e1_tcp_connector_make_tracking
 void Galileo_E1_Tcp_Connector_Tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = (int)d_vector_length*2; // set the required available samples in each call
+    ninput_items_required[0] = std::min(d_samples_to_skip, d_current_prn_length_samples) + d_current_prn_length_samples; // next integration, after at most one PRN period of alignment skip
 }
 
 
@@ -126,7 +129,7 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     // Initialization of local code replica
     // Get space for a vector with the sinboc(1,1) replica sampled 2x/chip
-    d_ca_code = new gr_complex[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS + 4)];
+    d_ca_code = new gr_complex[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS)];
 
     /* If an array is partitioned for more than one thread to operate on,
      * having the sub-array boundaries unaligned to cache lines could lead
@@ -142,6 +145,10 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
     if (posix_memalign((void**)&d_very_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+
+    // The correlator scratch buffer is allocated once, for the longest integration
+    d_correlator.reserve(2 * d_vector_length);
+
     // correlator outputs (scalar)
     if (posix_memalign((void**)&d_Very_Early, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
@@ -159,6 +166,7 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     // sample synchronization
     d_sample_counter = 0;
+    d_samples_to_skip = 0;
     d_acq_sample_stamp = 0;
 
     d_enable_tracking = false;
@@ -167,9 +175,8 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     d_current_prn_length_samples = (int)d_vector_length;
 
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
+    // CN0 estimation and lock detector
+    d_lock_detector.set_window(CN0_ESTIMATION_SAMPLES, false);
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -179,26 +186,28 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
 
 
+void Galileo_E1_Tcp_Connector_Tracking_cc::set_lock_detector_window(int length, bool exponential)
+{
+    d_lock_detector.set_window(length, exponential);
+}
+
+
 void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
 {
     d_acq_code_phase_samples = d_acquisition_gnss_synchro->Acq_delay_samples;
     d_acq_carrier_doppler_hz = d_acquisition_gnss_synchro->Acq_doppler_hz;
     d_acq_sample_stamp =  d_acquisition_gnss_synchro->Acq_samplestamp_samples;
 
-    // generate local reference ALWAYS starting at chip 2 (2 samples per chip)
-    galileo_e1_code_gen_complex_sampled(&d_ca_code[2],
+    // generate local reference (2 samples per chip)
+    galileo_e1_code_gen_complex_sampled(d_ca_code,
                                         d_acquisition_gnss_synchro->Signal,
                                         false,
                                         d_acquisition_gnss_synchro->PRN,
                                         2*Galileo_E1_CODE_CHIP_RATE_HZ,
                                         0);
-    // Fill head and tail
-    d_ca_code[0] = d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS)];
-    d_ca_code[1] = d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+1)];
-    d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+2)] = d_ca_code[2];
-    d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+3)] = d_ca_code[3];
 
     d_carrier_lock_fail_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0.0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -226,7 +235,6 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_code()
 {
     double tcode_half_chips;
     float rem_code_phase_half_chips;
-    int associated_chip_index;
     int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
     double code_phase_step_chips;
     double code_phase_step_half_chips;
@@ -246,12 +254,12 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_code()
 
     epl_loop_length_samples = d_current_prn_length_samples + very_early_late_spc_samples*2;
 
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 2 + round(fmod(tcode_half_chips - 2*d_very_early_late_spc_chips, code_length_half_chips));
-            d_very_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_half_chips = tcode_half_chips + code_phase_step_half_chips;
-        }
+    Code_Nco code_nco;
+    code_nco.set_code_length(code_length_half_chips);
+    // Half an entry ahead, so that the NCO takes the nearest entry of each sample
+    code_nco.set_phase(tcode_half_chips - 2*d_very_early_late_spc_chips + 0.5);
+    code_nco.set_phase_step(code_phase_step_half_chips);
+    code_nco.generate(d_very_early_code, d_ca_code, epl_loop_length_samples);
     memcpy(d_early_code, &d_very_early_code[very_early_late_spc_samples - early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
     memcpy(d_prompt_code, &d_very_early_code[very_early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
     memcpy(d_late_code, &d_very_early_code[2*very_early_late_spc_samples - early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
@@ -266,11 +274,7 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_carrier()
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
     // Initialize the carrier phase with the remnant carrier phase of the K-2 loop
     phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    carrier_nco(d_carr_sign, d_current_prn_length_samples, phase_rad, phase_step_rad);
 }
 
 
@@ -291,7 +295,6 @@ Galileo_E1_Tcp_Connector_Tracking_cc::~Galileo_E1_Tcp_Connector_Tracking_cc()
     free(d_Very_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 
     d_tcp_com.close_tcp_connection(d_port);
 }
@@ -321,8 +324,15 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
                     samples_offset = round(d_acq_code_phase_samples + acq_trk_shif_correction_samples);
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
-                    consume_each(samples_offset); //shift input to perform alignment with local replica
-                    return 1;
+                    d_samples_to_skip += samples_offset; //shift input to perform alignment with local replica
+                }
+            if (ninput_items[0] < d_samples_to_skip + d_current_prn_length_samples)
+                {
+                    // drop the samples to be skipped that are already here and wait for the rest
+                    int samples_skipped = std::min(d_samples_to_skip, ninput_items[0]);
+                    d_samples_to_skip -= samples_skipped;
+                    consume_each(samples_skipped);
+                    return 0;
                 }
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
             Gnss_Synchro current_synchro_data;
@@ -330,7 +340,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             current_synchro_data = *d_acquisition_gnss_synchro;
 
             // Block input data and block output stream pointers
-            const gr_complex* in = (gr_complex*) input_items[0];
+            const gr_complex* in = (gr_complex*) input_items[0] + d_samples_to_skip;
             Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
 
             // Generate local code and carrier replicas (using \hat{f}_d(k-1))
@@ -409,21 +419,15 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update(*d_Prompt);
+            if (d_lock_detector.ready())
                 {
-                    d_cn0_estimation_counter = 0;
 
                     // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_svn(d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
 
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
 
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
@@ -520,65 +524,45 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
 
     if(d_dump)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_VE, tmp_E, tmp_P, tmp_L, tmp_VL;
-            float tmp_float;
-            tmp_float=0;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_VE = std::abs<float>(*d_Very_Early);
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            tmp_VL = std::abs<float>(*d_Very_Late);
-
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_VE, sizeof(float));
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    d_dump_file.write((char*)&tmp_VL, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_chips, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&carr_error_filt_hz, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&code_error_filt_chips, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter+d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file. The record is
+            // queued, and written to the file by the dump writer thread
+            Galileo_E1_Tracking_Dump_Record record;
+            // VE, E, P, L and VL correlators
+            record.abs_VE = std::abs<float>(*d_Very_Early);
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            record.abs_VL = std::abs<float>(*d_Very_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.carrier_doppler_hz = d_carrier_doppler_hz;
+            record.code_freq_chips = d_code_freq_chips;
+            //PLL commands
+            record.carr_error_hz = 0;
+            record.carr_error_filt_hz = carr_error_filt_hz;
+            //DLL commands
+            record.code_error_chips = 0;
+            record.code_error_filt_chips = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = d_CN0_SNV_dB_Hz;
+            record.carrier_lock_test = d_carrier_lock_test;
+            // AUX vars (for debug purposes)
+            record.aux1 = d_rem_code_phase_samples;
+            record.aux2 = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_file.write(&record);
         }
-    consume_each(d_current_prn_length_samples); // this is needed in gr::block derivates
+    // the next integration starts d_current_prn_length_samples after this one. The part of
+    // them not yet in the input buffer is skipped in the next call
+    int samples_available = ninput_items[0] - d_samples_to_skip;
+    int samples_consumed = std::min(d_current_prn_length_samples, samples_available);
+    consume_each(d_samples_to_skip + samples_consumed); // this is needed in gr::block derivates
+    d_samples_to_skip = d_current_prn_length_samples - samples_consumed;
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
     return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
 }
@@ -594,18 +578,16 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, galileo_e1_tracking_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Unable to open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 
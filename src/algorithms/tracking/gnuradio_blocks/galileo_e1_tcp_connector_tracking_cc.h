@@ -49,6 +49,8 @@
 #include <gnuradio/msg_queue.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "lock_detectors.h"
+#include "tracking_dump.h"
 #include "correlator.h"
 #include "tcp_communication.h"
 
@@ -82,6 +84,13 @@ public:
     void set_channel(unsigned int channel);
     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
     void start_tracking();
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector, updated with every integration: the last \p length
+     * integrations, or an exponential window of time constant \p length
+     */
+    void set_lock_detector_window(int length, bool exponential);
     void set_channel_queue(concurrent_queue<int> *channel_internal_queue);
 
     int general_work (int noutput_items, gr_vector_int &ninput_items,
@@ -180,10 +189,10 @@ private:
     //processing samples counters
     unsigned long int d_sample_counter;
     unsigned long int d_acq_sample_stamp;
+    int d_samples_to_skip; // input samples already counted in d_sample_counter but not consumed yet
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Tracking_Lock_Detector d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
@@ -195,7 +204,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -35,6 +35,7 @@
  */
 
 #include "gps_l1_ca_dll_fll_pll_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -42,6 +43,8 @@
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include "gnss_synchro.h"
+#include "carrier_nco.h"
+#include "code_nco.h"
 #include "gps_sdr_signal_processing.h"
 #include "GPS_L1_CA.h"
 #include "tracking_discriminators.h"
@@ -84,7 +87,7 @@ gps_l1_ca_dll_fll_pll_tracking_cc_sptr gps_l1_ca_dll_fll_pll_make_tracking_cc(
 
 void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::forecast (int noutput_items, gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = d_vector_length*2; //set the required available samples in each call
+    ninput_items_required[0] = std::min(d_samples_to_skip, d_current_prn_length_samples) + d_current_prn_length_samples; // next integration, after at most one PRN period of alignment skip
 }
 
 
@@ -103,6 +106,7 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
         gr::block("Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
                 gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
+    this->set_relative_rate(1.0/vector_length);
     // initialize internal vars
     d_queue = queue;
     d_dump = dump;
@@ -122,7 +126,7 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
     d_code_loop_filter.set_DLL_BW(dll_bw_hz);
 
     // Get space for a vector with the C/A code replica sampled 1x/chip
-    d_ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 2];
+    d_ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
 
     /* If an array is partitioned for more than one thread to operate on,
      * having the sub-array boundaries unaligned to cache lines could lead
@@ -136,21 +140,25 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
     if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+
+    // The correlator scratch buffer is allocated once, for the longest integration
+    d_correlator.reserve(2 * d_vector_length);
+
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Prompt, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
 
     // sample synchronization
     d_sample_counter = 0;
+    d_samples_to_skip = 0;
     d_acq_sample_stamp = 0;
     d_last_seg = 0;// this is for debug output only
     d_code_phase_samples = 0;
     d_enable_tracking = false;
     d_current_prn_length_samples = (int)d_vector_length;
 
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
+    // CN0 estimation and lock detector
+    d_lock_detector.set_window(CN0_ESTIMATION_SAMPLES, false);
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -166,6 +174,12 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
 
 
 
+void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::set_lock_detector_window(int length, bool exponential)
+{
+    d_lock_detector.set_window(length, exponential);
+}
+
+
 void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::start_tracking()
 {
     /*
@@ -214,13 +228,11 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::start_tracking()
     d_carrier_loop_filter.initialize(d_acq_carrier_doppler_hz);
     d_FLL_wait = 1;
 
-    // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
-
-    d_ca_code[0] = d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
-    d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
+    // generate local reference (1 sample per chip)
+    gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
 
     d_carrier_lock_fail_counter = 0;
+    d_lock_detector.reset();
     d_Prompt_prev = 0;
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase = 0;
@@ -256,7 +268,6 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_code()
     int early_late_spc_samples;
     int epl_loop_length_samples;
 
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     code_phase_step_chips = d_code_freq_hz / d_fs_in;
     rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_hz / d_fs_in);
@@ -265,12 +276,12 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_code()
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips/code_phase_step_chips);
     epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
-        }
+    Code_Nco code_nco;
+    code_nco.set_code_length(code_length_chips);
+    // Half an entry ahead, so that the NCO takes the nearest entry of each sample
+    code_nco.set_phase(tcode_chips - d_early_late_spc_chips + 0.5);
+    code_nco.set_phase_step(code_phase_step_chips);
+    code_nco.generate(d_early_code, d_ca_code, epl_loop_length_samples);
 
     memcpy(d_prompt_code,&d_early_code[early_late_spc_samples],d_current_prn_length_samples* sizeof(gr_complex));
     memcpy(d_late_code,&d_early_code[early_late_spc_samples*2],d_current_prn_length_samples* sizeof(gr_complex));
@@ -296,11 +307,8 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_carrier()
     double phase, phase_step;
     phase_step = GPS_TWO_PI * d_carrier_doppler_hz / d_fs_in;
     phase = d_rem_carr_phase;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase), -sin(phase));
-            phase += phase_step;
-        }
+    carrier_nco(d_carr_sign, d_current_prn_length_samples, phase, phase_step);
+    phase += d_current_prn_length_samples * phase_step;
     d_rem_carr_phase = fmod(phase, GPS_TWO_PI);
     d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + phase;
 }
@@ -319,7 +327,6 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc()
     free(d_Early);
     free(d_Prompt);
     free(d_Late);
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -333,8 +340,7 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
     double correlation_time_s = 0;
     double PLL_discriminator_hz = 0;
     double carr_nco_hz = 0;
-    // get the sample in and out pointers
-    const gr_complex* in = (gr_complex*) input_items[0];     // block input samples pointer
+    // get the sample out pointers
     Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0]; // block output streams pointer
 
     d_Prompt_prev = *d_Prompt; // for the FLL discriminator
@@ -359,22 +365,19 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
                     // /todo: Check if the sample counter sent to the next block as a time reference should be incremented AFTER sended or BEFORE
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
-                    consume_each(samples_offset); //shift input to perform alignment with local replica
-
-                    // make an output to not stop the rest of the processing blocks
-                    current_synchro_data.Prompt_I = 0.0;
-                    current_synchro_data.Prompt_Q = 0.0;
-                    current_synchro_data.Tracking_timestamp_secs = (double)d_sample_counter/d_fs_in;
-                    current_synchro_data.Carrier_phase_rads = 0.0;
-                    current_synchro_data.Code_phase_secs = 0.0;
-                    current_synchro_data.CN0_dB_hz = 0.0;
-                    current_synchro_data.Flag_valid_tracking = false;
-
-                    *out[0] = current_synchro_data;
-
-                    return 1;
+                    d_samples_to_skip += samples_offset; //shift input to perform alignment with local replica
+                }
+            if (ninput_items[0] < d_samples_to_skip + d_current_prn_length_samples)
+                {
+                    // drop the samples to be skipped that are already here and wait for the rest
+                    int samples_skipped = std::min(d_samples_to_skip, ninput_items[0]);
+                    d_samples_to_skip -= samples_skipped;
+                    consume_each(samples_skipped);
+                    return 0;
                 }
 
+            const gr_complex* in = (gr_complex*) input_items[0] + d_samples_to_skip; // block input samples pointer
+
             update_local_code();
             update_local_carrier();
 
@@ -392,10 +395,11 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
             // check for samples consistency (this should be done before in the receiver / here only if the source is a file)
             if (std::isnan((*d_Prompt).real()) == true or std::isnan((*d_Prompt).imag()) == true )// or std::isinf(in[i].real())==true or std::isinf(in[i].imag())==true)
                 {
-                    const int samples_available = ninput_items[0];
+                    const int samples_available = ninput_items[0] - d_samples_to_skip;
                     d_sample_counter = d_sample_counter + samples_available;
                     LOG(WARNING) << "Detected NaN samples at sample number " << d_sample_counter;
-                    consume_each(samples_available);
+                    consume_each(ninput_items[0]);
+                    d_samples_to_skip = 0;
 
                     // make an output to not stop the rest of the processing blocks
                     current_synchro_data.Prompt_I = 0.0;
@@ -448,19 +452,13 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
              * \todo Improve the lock detection algorithm!
              */
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+            d_lock_detector.update(*d_Prompt);
+            if (d_lock_detector.ready())
                 {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
-                {
-                    d_cn0_estimation_counter = 0;
                     //d_CN0_SNV_dB_Hz = gps_l1_ca_CN0_SNV(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in);
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_svn(d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
 
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // ###### TRACKING UNLOCK NOTIFICATION #####
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -567,68 +565,43 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
 
     if(d_dump)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_E, tmp_P, tmp_L;
-            float tmp_float;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    tmp_float = (float)d_acc_carrier_phase_rad;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // carrier and code frequency
-                    tmp_float = (float)d_carrier_doppler_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)d_code_freq_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    //PLL commands
-                    tmp_float = (float)PLL_discriminator_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)carr_nco_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    //DLL commands
-                    tmp_float = (float)code_error_chips;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)code_error_filt_chips;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    tmp_float = (float)d_CN0_SNV_dB_Hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)d_carrier_lock_test;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = (float)d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(INFO) << "Exception writing trk dump file "<< e.what() << std::endl;
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file. The record is
+            // queued, and written to the file by the dump writer thread
+            Tracking_Dump_Record record;
+            // EPR
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = (float)d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.carrier_doppler_hz = (float)d_carrier_doppler_hz;
+            record.code_freq_chips = (float)d_code_freq_hz;
+            //PLL commands
+            record.carr_error_hz = (float)PLL_discriminator_hz;
+            record.carr_error_filt_hz = (float)carr_nco_hz;
+            //DLL commands
+            record.code_error_chips = (float)code_error_chips;
+            record.code_error_filt_chips = (float)code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = (float)d_CN0_SNV_dB_Hz;
+            record.carrier_lock_test = (float)d_carrier_lock_test;
+            // AUX vars (for debug purposes)
+            record.aux1 = (float)d_rem_code_phase_samples;
+            record.aux2 = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_file.write(&record);
         }
-    consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
+    // the next integration starts d_current_prn_length_samples after this one. The part of
+    // them not yet in the input buffer is skipped in the next call
+    int samples_available = ninput_items[0] - d_samples_to_skip;
+    int samples_consumed = std::min(d_current_prn_length_samples, samples_available);
+    consume_each(d_samples_to_skip + samples_consumed); // this is necessary in gr::block derivates
+    d_samples_to_skip = d_current_prn_length_samples - samples_consumed;
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
     return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
 }
@@ -643,18 +616,16 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Unable to open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
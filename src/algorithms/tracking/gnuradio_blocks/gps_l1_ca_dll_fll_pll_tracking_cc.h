@@ -50,6 +50,8 @@
 #include "tracking_FLL_PLL_filter.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "gnss_synchro.h"
+#include "lock_detectors.h"
+#include "tracking_dump.h"
 #include "correlator.h"
 
 class Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc;
@@ -82,6 +84,13 @@ public:
 
     void set_channel(unsigned int channel);
     void start_tracking();
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector, updated with every integration: the last \p length
+     * integrations, or an exponential window of time constant \p length
+     */
+    void set_lock_detector_window(int length, bool exponential);
     void update_local_code();
     void update_local_carrier();
     void set_FLL_and_PLL_BW(float fll_bw_hz,float pll_bw_hz);
@@ -187,10 +196,10 @@ private:
     unsigned long int d_sample_counter;
 
     unsigned long int d_acq_sample_stamp;
+    int d_samples_to_skip; // input samples already counted in d_sample_counter but not consumed yet
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Tracking_Lock_Detector d_lock_detector;
     double d_carrier_lock_test;
     double d_CN0_SNV_dB_Hz;
 
@@ -201,7 +210,7 @@ private:
     bool d_enable_tracking;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -0,0 +1,907 @@
+/*!
+ * \file gps_l1_ca_dll_pll_batch_tracking_cc.cc
+ * \brief Implementation of a code DLL + carrier PLL tracking block that
+ * tracks all the GPS L1 C/A channels in a single pass over the input samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_dll_pll_batch_tracking_cc.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <boost/lexical_cast.hpp>
+#include <boost/weak_ptr.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "carrier_nco.h"
+#include "concurrent_map.h"
+#include "gnss_navigation_aiding.h"
+#include "gps_ephemeris.h"
+#include "gps_sdr_signal_processing.h"
+#include "tracking_discriminators.h"
+#include "lock_detectors.h"
+#include "GPS_L1_CA.h"
+#include "control_message_factory.h"
+
+
+/*!
+ * \todo Include in definition header file
+ */
+#define CN0_ESTIMATION_SAMPLES 20
+#define MINIMUM_VALID_CN0 25
+#define MAXIMUM_LOCK_FAIL_COUNTER 50
+#define CARRIER_LOCK_THRESHOLD 0.85
+
+// Vector tracking: CN0 of the channels that take part in the estimate [dB-Hz],
+// channels needed for it, and period of the satellite geometry update [s]
+#define VECTOR_TRACKING_MIN_CN0 35
+#define VECTOR_TRACKING_MIN_CHANNELS 5
+#define VECTOR_TRACKING_GEOMETRY_PERIOD 0.1
+
+
+using google::LogMessage;
+
+extern concurrent_map<Gps_Ephemeris> global_gps_ephemeris_map;
+
+gps_l1_ca_dll_pll_batch_tracking_cc_sptr
+gps_l1_ca_dll_pll_make_batch_tracking_cc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        boost::shared_ptr<gr::msg_queue> queue,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips)
+{
+    // One block for all the channels of the flowgraph. It lives as long as
+    // the tracking adapters that hold it.
+    static boost::weak_ptr<Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc> instance;
+    static boost::mutex instance_mutex;
+    boost::mutex::scoped_lock lock(instance_mutex);
+    gps_l1_ca_dll_pll_batch_tracking_cc_sptr tracking = instance.lock();
+    if (!tracking)
+        {
+            tracking = gps_l1_ca_dll_pll_batch_tracking_cc_sptr(new Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc(if_freq,
+                    fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips));
+            instance = tracking;
+        }
+    return tracking;
+}
+
+
+
+Gps_L1_Ca_Batch_Tracking_Channel::Gps_L1_Ca_Batch_Tracking_Channel()
+{
+    channel = 0;
+    acquisition_gnss_synchro = 0;
+    channel_internal_queue = 0;
+    ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
+    acq_code_phase_samples = 0.0;
+    sample_counter = 0;
+    acq_sample_stamp = 0;
+    integration_start = 0;
+    integration_length = 0;
+    early = gr_complex(0,0);
+    prompt = gr_complex(0,0);
+    late = gr_complex(0,0);
+    bit_synchronizer.set_symbols_per_bit(GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND);
+    extended_integration = false;
+    extend_correlation_count = 0;
+    early_accu = gr_complex(0,0);
+    prompt_accu = gr_complex(0,0);
+    late_accu = gr_complex(0,0);
+    enable_tracking = false;
+    pull_in = false;
+    vector_aided = false;
+    shed = false;
+    last_seg = 0;
+}
+
+
+
+Gps_L1_Ca_Batch_Tracking_Channel::~Gps_L1_Ca_Batch_Tracking_Channel()
+{
+    if (dump_file.is_open())
+        {
+            Gnss_Overload_Controller::instance().remove_dump();
+        }
+    dump_file.close();
+    delete[] ca_code;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    // samples up to the end of the next integration of the channel that is most behind,
+    // which is the first one general_work can run
+    // (channels without a connected output are never run and stay behind the window)
+    boost::mutex::scoped_lock lock(d_mutex);
+    const unsigned long int window_start = nitems_read(0);
+    int samples_required = 0;
+    for (unsigned int port = 0; port < d_channels.size(); port++)
+        {
+            if (d_channels[port]->sample_counter < window_start) continue;
+            const int channel_required = (int)(d_channels[port]->sample_counter - window_start) + d_bank.prn_length_samples[port];
+            if (samples_required == 0 or channel_required < samples_required)
+                {
+                    samples_required = channel_required;
+                }
+        }
+    ninput_items_required[0] = (samples_required > 0) ? samples_required : (int)d_vector_length;
+}
+
+
+
+Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        boost::shared_ptr<gr::msg_queue> queue,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips) :
+        gr::block("Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                gr::io_signature::make(1, -1, sizeof(Gnss_Synchro)))
+{
+    this->set_relative_rate(1.0/vector_length);
+    // initialize internal vars
+    d_queue = queue;
+    d_dump = dump;
+    d_if_freq = if_freq;
+    d_fs_in = fs_in;
+    d_vector_length = vector_length;
+    d_dump_filename = dump_filename;
+
+    //--- DLL variables --------------------------------------------------------
+    d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
+    d_local_code_shift_chips[0] = -d_early_late_spc_chips;
+    d_local_code_shift_chips[1] = 0.0;
+    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+
+    // PLL and DLL of all the channels
+    d_bank.configure(d_fs_in, GPS_L1_FREQ_HZ, GPS_L1_CA_CODE_RATE_HZ, GPS_L1_CA_CODE_LENGTH_CHIPS,
+            GPS_L1_CA_CODE_PERIOD, pll_bw_hz, dll_bw_hz);
+    d_lock_detector_window = CN0_ESTIMATION_SAMPLES;
+    d_lock_detector_exponential = false;
+
+    // extended coherent integration
+    d_extend_correlation_ms = 1;
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+
+    d_vector_tracking = false;
+    d_vector_estimator.configure(GPS_L1_FREQ_HZ, VECTOR_TRACKING_MIN_CHANNELS);
+    d_vector_geometry_time_s = 0.0;
+
+    // todo: do something if posix_memalign fails
+    // space for the carrier replica of one integration
+    if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_correlator.reserve(d_vector_length * 2);
+
+    d_correlator_outs[0] = &d_Early;
+    d_correlator_outs[1] = &d_Prompt;
+    d_correlator_outs[2] = &d_Late;
+
+    d_last_seg = 0;
+    d_overload_level = Gnss_Overload_Controller::NORMAL;
+
+    systemName["G"] = std::string("GPS");
+    systemName["R"] = std::string("GLONASS");
+    systemName["S"] = std::string("SBAS");
+    systemName["E"] = std::string("Galileo");
+    systemName["C"] = std::string("Compass");
+}
+
+
+
+Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc()
+{
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            delete d_channels[i];
+        }
+    free(d_carr_sign);
+}
+
+
+
+int Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::add_channel()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    int port = d_channels.size();
+    d_channels.push_back(new Gps_L1_Ca_Batch_Tracking_Channel());
+    d_channels.back()->lock_detector.set_window(d_lock_detector_window, d_lock_detector_exponential);
+    d_channels.back()->lock_history.set_fs(d_fs_in);
+    d_produced.push_back(0);
+    d_pending_ports.reserve(d_channels.size());
+    d_bank.resize(d_channels.size());
+    d_bank.prn_length_samples[port] = (int)d_vector_length;
+    d_bank.code_freq_chips[port] = GPS_L1_CA_CODE_RATE_HZ;
+    d_bank.carrier_lock_test[port] = 1.0;
+    d_vector_estimator.resize(d_channels.size());
+    d_vector_weights.resize(d_channels.size(), 0.0);
+    return port;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_channel(int port, unsigned int channel)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    ch.channel = channel;
+    LOG(INFO) << "Batch tracking port " << port << " set to channel " << channel;
+    // ############# ENABLE DATA FILE LOG #################
+    if (d_dump == true)
+        {
+            if (ch.dump_file.is_open() == false)
+                {
+                    std::string dump_filename = d_dump_filename;
+                    dump_filename.append(boost::lexical_cast<std::string>(channel));
+                    dump_filename.append(".dat");
+                    if (ch.dump_file.open(dump_filename, tracking_dump_schema()))
+                        {
+                            Gnss_Overload_Controller::instance().add_dump();
+                            LOG(INFO) << "Tracking dump enabled on channel " << channel << " Log file: " << dump_filename.c_str() << std::endl;
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << channel << " Unable to open trk dump file " << dump_filename;
+                        }
+                }
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_lock_detector_window(int length, bool exponential)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_lock_detector_window = length;
+    d_lock_detector_exponential = exponential;
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            d_channels[i]->lock_detector.set_window(length, exponential);
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_extend_correlation_ms(int extend_correlation_ms,
+        float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    const int symbols_per_bit = GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND;
+    if (extend_correlation_ms < 1 or extend_correlation_ms > symbols_per_bit or symbols_per_bit % extend_correlation_ms != 0)
+        {
+            LOG(WARNING) << "Tracking extended correlation of " << extend_correlation_ms
+                         << " ms does not divide a data bit, using 1 ms";
+            extend_correlation_ms = 1;
+        }
+    d_extend_correlation_ms = extend_correlation_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
+    // the channels already tracking restart at their next bit edge
+    for (unsigned int port = 0; port < d_channels.size(); port++)
+        {
+            set_extended_integration(port, false);
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_extended_integration(int port, bool enabled)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    // the loop filters take the new summation interval and bandwidths, their state is kept
+    if (enabled)
+        {
+            d_bank.set_loop_integration(port, d_extend_correlation_ms, d_pll_bw_narrow_hz, d_dll_bw_narrow_hz);
+        }
+    else
+        {
+            d_bank.set_loop_integration(port, 1, d_pll_bw_hz, d_dll_bw_hz);
+        }
+    if (enabled != ch.extended_integration)
+        {
+            LOG(INFO) << "Tracking CH " << ch.channel << (enabled ? ": starting" : ": stopping")
+                      << " the " << d_extend_correlation_ms << " ms coherent integration";
+        }
+    ch.extended_integration = enabled;
+    ch.extend_correlation_count = 0;
+    ch.early_accu = gr_complex(0,0);
+    ch.prompt_accu = gr_complex(0,0);
+    ch.late_accu = gr_complex(0,0);
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_vector_tracking(bool enabled)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_vector_tracking = enabled;
+    // the geometry is computed on the first update
+    d_vector_geometry_time_s = -VECTOR_TRACKING_GEOMETRY_PERIOD;
+    LOG(INFO) << "Batch tracking vector tracking " << (enabled ? "enabled" : "disabled");
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_channel_queue(int port, concurrent_queue<int> *channel_internal_queue)
+{
+    d_channels[port]->channel_internal_queue = channel_internal_queue;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::set_gnss_synchro(int port, Gnss_Synchro* p_gnss_synchro)
+{
+    d_channels[port]->acquisition_gnss_synchro = p_gnss_synchro;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::start_tracking(int port)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    /*
+     *  correct the code phase according to the delay between acq and trk
+     */
+    ch.acq_code_phase_samples = ch.acquisition_gnss_synchro->Acq_delay_samples;
+    const float acq_carrier_doppler_hz = ch.acquisition_gnss_synchro->Acq_doppler_hz;
+    ch.acq_sample_stamp = ch.acquisition_gnss_synchro->Acq_samplestamp_samples;
+
+    unsigned long int acq_trk_diff_samples;
+    float acq_trk_diff_seconds;
+    acq_trk_diff_samples = ch.sample_counter - ch.acq_sample_stamp;
+    LOG(INFO) << "Number of samples between Acquisition and Tracking =" << acq_trk_diff_samples;
+    acq_trk_diff_seconds = (float)acq_trk_diff_samples / (float)d_fs_in;
+    //doppler effect
+    // Fd=(C/(C+Vr))*F
+    float radial_velocity;
+    radial_velocity = (GPS_L1_FREQ_HZ + acq_carrier_doppler_hz)/GPS_L1_FREQ_HZ;
+    // new chip and prn sequence periods based on acq Doppler
+    float T_chip_mod_seconds;
+    float T_prn_mod_seconds;
+    float T_prn_mod_samples;
+    float code_freq_chips = radial_velocity * GPS_L1_CA_CODE_RATE_HZ;
+    T_chip_mod_seconds = 1/code_freq_chips;
+    T_prn_mod_seconds = T_chip_mod_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
+    T_prn_mod_samples = T_prn_mod_seconds * (float)d_fs_in;
+
+    float T_prn_true_seconds = GPS_L1_CA_CODE_LENGTH_CHIPS / GPS_L1_CA_CODE_RATE_HZ;
+    float T_prn_true_samples = T_prn_true_seconds * (float)d_fs_in;
+    float T_prn_diff_seconds;
+    T_prn_diff_seconds = T_prn_true_seconds - T_prn_mod_seconds;
+    float N_prn_diff;
+    N_prn_diff = acq_trk_diff_seconds / T_prn_true_seconds;
+    float corrected_acq_phase_samples, delay_correction_samples;
+    corrected_acq_phase_samples = fmod((ch.acq_code_phase_samples + T_prn_diff_seconds * N_prn_diff * (float)d_fs_in), T_prn_true_samples);
+    if (corrected_acq_phase_samples < 0)
+        {
+            corrected_acq_phase_samples = T_prn_mod_samples + corrected_acq_phase_samples;
+        }
+    delay_correction_samples = ch.acq_code_phase_samples - corrected_acq_phase_samples;
+
+    ch.acq_code_phase_samples = corrected_acq_phase_samples;
+
+    // DLL/PLL filter and NCO initialization
+    d_bank.initialize(port, acq_carrier_doppler_hz, code_freq_chips, round(T_prn_mod_samples));
+
+    // generate local reference (1 sample per chip)
+    gps_l1_ca_code_gen_complex(ch.ca_code, ch.acquisition_gnss_synchro->PRN, 0);
+
+    ch.lock_detector.reset();
+    ch.lock_history.reset();
+    ch.bit_synchronizer.reset();
+    set_extended_integration(port, false);
+    ch.vector_aided = false;
+    ch.shed = false;
+    d_vector_estimator.clear_geometry(port);
+
+    std::string sys_ = &ch.acquisition_gnss_synchro->System;
+    ch.sys = sys_.substr(0,1);
+
+    // DEBUG OUTPUT
+    std::cout << "Tracking start on channel " << ch.channel << " for satellite " << Gnss_Satellite(systemName[ch.sys], ch.acquisition_gnss_synchro->PRN) << std::endl;
+    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[ch.sys], ch.acquisition_gnss_synchro->PRN) << " on channel " << ch.channel;
+
+    // enable tracking
+    ch.pull_in = true;
+    ch.enable_tracking = true;
+
+    LOG(INFO) << "PULL-IN Doppler [Hz]=" << acq_carrier_doppler_hz
+            << " Code Phase correction [samples]=" << delay_correction_samples
+            << " PULL-IN Code Phase [samples]=" << ch.acq_code_phase_samples;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::pull_in(int port)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    const int prn_length_samples = d_bank.prn_length_samples[port];
+    int samples_offset;
+    float acq_trk_shif_correction_samples;
+    int acq_to_trk_delay_samples;
+    acq_to_trk_delay_samples = ch.sample_counter - ch.acq_sample_stamp;
+    acq_trk_shif_correction_samples = prn_length_samples - fmod((float)acq_to_trk_delay_samples, (float)prn_length_samples);
+    samples_offset = round(ch.acq_code_phase_samples + acq_trk_shif_correction_samples);
+    ch.sample_counter = ch.sample_counter + samples_offset; // shift the channel to align it with the local replica
+    ch.pull_in = false;
+}
+
+
+
+bool Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::correlate(int port, const gr_complex* in,
+        int samples_available, Gnss_Synchro& synchro)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    ch.integration_start = ch.sample_counter;
+    ch.integration_length = d_bank.prn_length_samples[port];
+
+    if (ch.enable_tracking == false)
+        {
+            // Fill the acquisition data
+            synchro = *ch.acquisition_gnss_synchro;
+            ch.early = gr_complex(0,0);
+            ch.prompt = gr_complex(0,0);
+            ch.late = gr_complex(0,0);
+            ch.sample_counter += ch.integration_length;
+            dump_integration(port, false);
+            return false;
+        }
+
+    // Generate local code and carrier replicas (using \hat{f}_d(k-1))
+    // The E, P and L replicas are generated by the correlator while it correlates
+    const double code_phase_step_chips = ((double)d_bank.code_freq_chips[port]) / ((double)d_fs_in);
+    const double code_phase_chips = -d_bank.rem_code_phase_samples[port] * code_phase_step_chips;
+    carrier_nco(d_carr_sign, ch.integration_length, d_bank.rem_carr_phase_rad[port],
+            (float)GPS_TWO_PI * d_bank.carrier_doppler_hz[port] / (float)d_fs_in);
+
+    // perform carrier wipe-off and compute Early, Prompt and Late correlation in a single pass
+    d_correlator.Carrier_wipeoff_and_multicorrelator_resampler(ch.integration_length,
+            in,
+            d_carr_sign,
+            ch.ca_code,
+            (int)GPS_L1_CA_CODE_LENGTH_CHIPS,
+            code_phase_chips,
+            code_phase_step_chips,
+            3,
+            d_local_code_shift_chips,
+            d_correlator_outs);
+
+    // check for samples consistency (this should be done before in the receiver / here only if the source is a file)
+    if (std::isnan(d_Prompt.real()) == true or std::isnan(d_Prompt.imag()) == true )
+        {
+            ch.sample_counter = ch.sample_counter + samples_available;
+            LOG(WARNING) << "Detected NaN samples at sample number " << ch.sample_counter;
+
+            // make an output to not stop the rest of the processing blocks
+            synchro = *ch.acquisition_gnss_synchro;
+            synchro.Prompt_I = 0.0;
+            synchro.Prompt_Q = 0.0;
+            synchro.Tracking_timestamp_secs = (double)ch.sample_counter/(double)d_fs_in;
+            synchro.Carrier_phase_rads = 0.0;
+            synchro.Code_phase_secs = 0.0;
+            synchro.CN0_dB_hz = 0.0;
+            synchro.Flag_valid_tracking = false;
+            return false;
+        }
+
+    ch.early = d_Early;
+    ch.prompt = d_Prompt;
+    ch.late = d_Late;
+
+    // Once the data bits are synchronized, the loops are closed on the sum of the
+    // correlator outputs of d_extend_correlation_ms code periods within a bit
+    gr_complex early = d_Early;
+    gr_complex prompt = d_Prompt;
+    gr_complex late = d_Late;
+    int update_loops = 1;
+    if (ch.extended_integration == true)
+        {
+            ch.early_accu += d_Early;
+            ch.prompt_accu += d_Prompt;
+            ch.late_accu += d_Late;
+            ch.extend_correlation_count++;
+            early = ch.early_accu;
+            prompt = ch.prompt_accu;
+            late = ch.late_accu;
+            update_loops = (ch.extend_correlation_count == d_extend_correlation_ms);
+            if (update_loops)
+                {
+                    ch.early_accu = gr_complex(0,0);
+                    ch.prompt_accu = gr_complex(0,0);
+                    ch.late_accu = gr_complex(0,0);
+                    ch.extend_correlation_count = 0;
+                }
+        }
+
+    d_bank.early_i[port] = early.real();
+    d_bank.early_q[port] = early.imag();
+    d_bank.prompt_i[port] = prompt.real();
+    d_bank.prompt_q[port] = prompt.imag();
+    d_bank.late_i[port] = late.real();
+    d_bank.late_q[port] = late.imag();
+    d_bank.loop_update[port] = update_loops;
+    d_bank.pending[port] = 1;
+    return true;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::finish_integration(int port, Gnss_Synchro& synchro)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    const gr_complex prompt = ch.prompt;
+
+    // ################## BIT SYNCHRONIZATION ##########################################
+    ch.bit_synchronizer.update(prompt.real());
+    if (d_extend_correlation_ms > 1)
+        {
+            if (ch.extended_integration == false and ch.bit_synchronizer.bit_start() == true)
+                {
+                    set_extended_integration(port, true);
+                }
+            else if (ch.extended_integration == true and ch.bit_synchronizer.synchronized() == false)
+                {
+                    set_extended_integration(port, false);
+                }
+        }
+
+    // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
+    ch.lock_detector.update(prompt);
+    if (ch.lock_detector.ready())
+        {
+            // Code lock indicator
+            d_bank.cn0_snv_db_hz[port] = ch.lock_detector.cn0_svn(d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+            // Carrier lock indicator
+            d_bank.carrier_lock_test[port] = ch.lock_detector.carrier_lock();
+            // Loss of lock detection
+            if (d_bank.carrier_lock_test[port] < CARRIER_LOCK_THRESHOLD or d_bank.cn0_snv_db_hz[port] < MINIMUM_VALID_CN0)
+                {
+                    d_bank.carrier_lock_fail_counter[port]++;
+                }
+            else
+                {
+                    if (d_bank.carrier_lock_fail_counter[port] > 0) d_bank.carrier_lock_fail_counter[port]--;
+                    // the next code period starts at the PRN start sample of this output
+                    ch.lock_history.update(round((double)ch.integration_start + (double)d_bank.prn_length_samples[port]
+                            + (double)d_bank.rem_code_phase_samples[port]),
+                            (double)d_fs_in * GPS_L1_CA_CODE_LENGTH_CHIPS / (double)d_bank.code_freq_chips[port],
+                            d_bank.carrier_doppler_hz[port]);
+                }
+            if (d_bank.carrier_lock_fail_counter[port] > MAXIMUM_LOCK_FAIL_COUNTER or ch.shed)
+                {
+                    if (ch.shed == true)
+                        {
+                            LOG(INFO) << "Satellite dropped in channel " << ch.channel << " to shed load";
+                            ch.shed = false;
+                        }
+                    else
+                        {
+                            std::cout << "Loss of lock in channel " << ch.channel << "!" << std::endl;
+                            LOG(INFO) << "Loss of lock in channel " << ch.channel << "!";
+                        }
+                    // the acquisition searches first around the last state in lock
+                    ch.lock_history.publish(ch.acquisition_gnss_synchro);
+                    ControlMessageFactory* cmf = new ControlMessageFactory();
+                    if (d_queue != gr::msg_queue::sptr())
+                        {
+                            d_queue->handle(cmf->GetQueueMessage(ch.channel, 2));
+                        }
+                    delete cmf;
+                    d_bank.carrier_lock_fail_counter[port] = 0;
+                    ch.enable_tracking = false;
+                }
+        }
+
+    // ########### Output the tracking data to navigation and PVT ##########
+    synchro = *ch.acquisition_gnss_synchro;
+    synchro.Prompt_I = (double)prompt.real();
+    synchro.Prompt_Q = (double)prompt.imag();
+    // Tracking_timestamp_secs is aligned with the PRN start sample
+    synchro.Tracking_timestamp_secs = ((double)ch.integration_start + (double)d_bank.prn_length_samples[port]
+            + (double)d_bank.rem_code_phase_samples[port])/(double)d_fs_in;
+    // This tracking block aligns the Tracking_timestamp_secs with the start sample of the PRN, thus, Code_phase_secs=0
+    synchro.Code_phase_secs = 0;
+    synchro.Carrier_phase_rads = (double)d_bank.acc_carrier_phase_rad[port];
+    synchro.Carrier_Doppler_hz = (double)d_bank.carrier_doppler_hz[port];
+    synchro.CN0_dB_hz = (double)d_bank.cn0_snv_db_hz[port];
+
+    if (floor(ch.integration_start / d_fs_in) != ch.last_seg)
+        {
+            ch.last_seg = floor(ch.integration_start / d_fs_in);
+            LOG(INFO) << "Tracking CH " << ch.channel <<  ": Satellite " << Gnss_Satellite(systemName[ch.sys], ch.acquisition_gnss_synchro->PRN)
+                      << ", CN0 = " << d_bank.cn0_snv_db_hz[port] << " [dB-Hz]";
+        }
+    // the next integration starts one updated PRN period after this one
+    ch.sample_counter += d_bank.prn_length_samples[port];
+    dump_integration(port, d_bank.loop_update[port] != 0);
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::dump_integration(int port, bool loops_updated)
+{
+    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+    // under overload, the dump is not recorded
+    if(d_dump and d_overload_level < Gnss_Overload_Controller::REDUCED_COST)
+        {
+            // MULTIPLEXED FILE RECORDING - Record results to file, as Gps_L1_Ca_Dll_Pll_Tracking_cc
+            Tracking_Dump_Record record;
+            // EPR
+            record.abs_E = std::abs<float>(ch.early);
+            record.abs_P = std::abs<float>(ch.prompt);
+            record.abs_L = std::abs<float>(ch.late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = ch.prompt.real();
+            record.prompt_Q = ch.prompt.imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = ch.integration_start;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = d_bank.acc_carrier_phase_rad[port];
+            // carrier and code frequency
+            record.carrier_doppler_hz = d_bank.carrier_doppler_hz[port];
+            record.code_freq_chips = d_bank.code_freq_chips[port];
+            // PLL and DLL commands. The loops of a channel that is not tracking, or that
+            // is within an extended integration, do not run
+            record.carr_error_hz = loops_updated ? d_bank.carr_error_hz[port] : 0.0;
+            record.carr_error_filt_hz = loops_updated ? d_bank.carr_error_filt_hz[port] : 0.0;
+            record.code_error_chips = loops_updated ? d_bank.code_error_chips[port] : 0.0;
+            record.code_error_filt_chips = loops_updated ? d_bank.code_error_filt_chips[port] : 0.0;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = d_bank.cn0_snv_db_hz[port];
+            record.carrier_lock_test = d_bank.carrier_lock_test[port];
+            // AUX vars (for debug purposes)
+            record.aux1 = d_bank.rem_code_phase_samples[port];
+            record.aux2 = (double)(ch.integration_start + d_bank.prn_length_samples[port]);
+            ch.dump_file.write(&record);
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::update_vector_tracking(double rx_time_s)
+{
+    if (rx_time_s - d_vector_geometry_time_s >= VECTOR_TRACKING_GEOMETRY_PERIOD or rx_time_s < d_vector_geometry_time_s)
+        {
+            update_vector_geometry(rx_time_s);
+            d_vector_geometry_time_s = rx_time_s;
+        }
+
+    // the channels in lock take part in the estimate, weighted by their CN0
+    const int n_channels = d_channels.size();
+    for (int port = 0; port < n_channels; port++)
+        {
+            const Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+            const float cn0_db_hz = d_bank.cn0_snv_db_hz[port];
+            const bool in_lock = ch.enable_tracking and ch.lock_detector.ready() and cn0_db_hz >= VECTOR_TRACKING_MIN_CN0
+                    and d_bank.carrier_lock_test[port] >= CARRIER_LOCK_THRESHOLD;
+            d_vector_weights[port] = in_lock ? pow(10.0, cn0_db_hz / 10.0) : 0.0;
+        }
+
+    if (!d_vector_estimator.estimate(d_bank.carrier_doppler_hz, &d_vector_weights[0]))
+        {
+            // the channels keep their last Doppler base and run as scalar loops
+            for (int port = 0; port < n_channels; port++)
+                {
+                    d_channels[port]->vector_aided = false;
+                }
+            return;
+        }
+
+    for (int port = 0; port < n_channels; port++)
+        {
+            Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+            if (!ch.enable_tracking or !d_vector_estimator.has_geometry(port))
+                {
+                    ch.vector_aided = false;
+                    continue;
+                }
+            const float predicted_doppler_hz = d_vector_estimator.predicted_doppler_hz(port);
+            if (!ch.vector_aided)
+                {
+                    // the loop filter takes the difference, so the NCO does not jump
+                    d_bank.old_carr_nco[port] += d_bank.acq_carrier_doppler_hz[port] - predicted_doppler_hz;
+                    ch.vector_aided = true;
+                    LOG(INFO) << "Vector tracking of satellite " << Gnss_Satellite(systemName[ch.sys], ch.acquisition_gnss_synchro->PRN)
+                              << " on channel " << ch.channel << ", predicted Doppler = " << predicted_doppler_hz
+                              << " [Hz], loop Doppler = " << d_bank.carrier_doppler_hz[port] << " [Hz]";
+                }
+            d_bank.acq_carrier_doppler_hz[port] = predicted_doppler_hz;
+            d_bank.carrier_doppler_hz[port] = predicted_doppler_hz + d_bank.old_carr_nco[port];
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::update_vector_geometry(double rx_time_s)
+{
+    double pvt_gps_time_s = 0.0;
+    double pvt_rx_time_s = 0.0;
+    double rx_position_m[3];
+    const bool solution = Gnss_Navigation_Aiding::instance().get_solution(pvt_gps_time_s, pvt_rx_time_s, rx_position_m);
+    // GPS time of the samples being tracked, which run ahead of the last solution
+    const double gps_time_s = pvt_gps_time_s + (rx_time_s - pvt_rx_time_s);
+
+    for (unsigned int port = 0; port < d_channels.size(); port++)
+        {
+            const Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+            Gps_Ephemeris eph;
+            if (!solution or !ch.enable_tracking or !global_gps_ephemeris_map.read(ch.acquisition_gnss_synchro->PRN, eph))
+                {
+                    d_vector_estimator.clear_geometry(port);
+                    continue;
+                }
+            // transmission time, from the range at the reception time
+            eph.satellitePosition(gps_time_s);
+            const double dx = eph.d_satpos_X - rx_position_m[0];
+            const double dy = eph.d_satpos_Y - rx_position_m[1];
+            const double dz = eph.d_satpos_Z - rx_position_m[2];
+            const double transmit_time_s = gps_time_s - sqrt(dx * dx + dy * dy + dz * dz) / GPS_C_m_s;
+
+            // position and velocity from the positions half a second before and after
+            double before_m[3];
+            eph.satellitePosition(transmit_time_s - 0.5);
+            before_m[0] = eph.d_satpos_X;
+            before_m[1] = eph.d_satpos_Y;
+            before_m[2] = eph.d_satpos_Z;
+            eph.satellitePosition(transmit_time_s + 0.5);
+            const double velocity_m_s[3] = {eph.d_satpos_X - before_m[0], eph.d_satpos_Y - before_m[1], eph.d_satpos_Z - before_m[2]};
+            double los[3] = {(eph.d_satpos_X + before_m[0]) / 2.0 - rx_position_m[0],
+                             (eph.d_satpos_Y + before_m[1]) / 2.0 - rx_position_m[1],
+                             (eph.d_satpos_Z + before_m[2]) / 2.0 - rx_position_m[2]};
+            const double range_m = sqrt(los[0] * los[0] + los[1] * los[1] + los[2] * los[2]);
+            for (int i = 0; i < 3; i++)
+                {
+                    los[i] /= range_m;
+                }
+            d_vector_estimator.set_geometry(port, los, velocity_m_s);
+        }
+}
+
+
+
+int Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    // overload protection: work time of this call
+    Gnss_Overload_Controller& overload_controller = Gnss_Overload_Controller::instance();
+    const double work_start_s = overload_controller.enabled() ? Gnss_Overload_Controller::now_s() : 0.0;
+    const gr_complex* in = (const gr_complex*) input_items[0];
+    const unsigned long int window_start = nitems_read(0);
+    const unsigned long int window_end = window_start + ninput_items[0];
+    const int n_channels = std::min((int)d_channels.size(), (int)output_items.size());
+
+    for (int port = 0; port < n_channels; port++)
+        {
+            d_produced[port] = 0;
+        }
+
+    // The window is processed in blocks of one code period. Every channel
+    // runs the integrations starting in a block before moving to the next
+    // one, so the samples are read from memory once for all the channels.
+    // Within a block, each round runs at most one integration per channel
+    // and updates the loops of all of them at once.
+    unsigned long int block_end = window_start;
+    while (block_end < window_end)
+        {
+            block_end = std::min(block_end + d_vector_length, window_end);
+            bool integrated = true;
+            while (integrated)
+                {
+                    integrated = false;
+                    d_pending_ports.clear();
+                    for (int port = 0; port < n_channels; port++)
+                        {
+                            Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+                            // Receiver signal alignment
+                            if (ch.pull_in == true)
+                                {
+                                    pull_in(port);
+                                }
+                            if (ch.sample_counter >= block_end or d_produced[port] >= noutput_items
+                                    or ch.sample_counter + d_bank.prn_length_samples[port] > window_end)
+                                {
+                                    continue;
+                                }
+                            integrated = true;
+                            Gnss_Synchro* out = (Gnss_Synchro*) output_items[port];
+                            const int offset = ch.sample_counter - window_start;
+                            if (correlate(port, in + offset, window_end - ch.sample_counter, out[d_produced[port]]))
+                                {
+                                    d_pending_ports.push_back(port);
+                                }
+                            else
+                                {
+                                    d_produced[port]++;
+                                }
+                        }
+                    if (!d_pending_ports.empty())
+                        {
+                            d_bank.update_loops();
+                            for (unsigned int i = 0; i < d_pending_ports.size(); i++)
+                                {
+                                    const int port = d_pending_ports[i];
+                                    Gnss_Synchro* out = (Gnss_Synchro*) output_items[port];
+                                    finish_integration(port, out[d_produced[port]]);
+                                    d_produced[port]++;
+                                }
+                        }
+                }
+            if (d_vector_tracking)
+                {
+                    update_vector_tracking((double)block_end / (double)d_fs_in);
+                }
+        }
+
+    // ########## DEBUG OUTPUT
+    /*!
+     *  \todo The stop timer has to be moved to the signal source!
+     */
+    if (floor(window_start / d_fs_in) != d_last_seg)
+        {
+            d_last_seg = floor(window_start / d_fs_in);
+            std::cout << "Current input signal time = " << d_last_seg << " [s]" << std::endl;
+        }
+
+    // Only the samples integrated by all the channels can be released
+    unsigned long int consumed_until = window_end;
+    for (int port = 0; port < n_channels; port++)
+        {
+            produce(port, d_produced[port]);
+            consumed_until = std::min(consumed_until, d_channels[port]->sample_counter);
+        }
+    consume_each(consumed_until - window_start);
+
+    if (overload_controller.enabled())
+        {
+            d_overload_level = overload_controller.report_work(unique_id(), Gnss_Overload_Controller::now_s() - work_start_s,
+                    (double)(consumed_until - window_start) / (double)d_fs_in,
+                    Gnss_Overload_Controller::input_buffer_fill(*this, ninput_items[0]));
+            for (int port = 0; port < n_channels; port++)
+                {
+                    Gps_L1_Ca_Batch_Tracking_Channel& ch = *d_channels[port];
+                    if (overload_controller.report_cn0(ch.channel, ch.enable_tracking ? d_bank.cn0_snv_db_hz[port] : 0.0))
+                        {
+                            ch.shed = true;
+                        }
+                }
+        }
+    return WORK_CALLED_PRODUCE;
+}
@@ -0,0 +1,313 @@
+/*!
+ * \file gps_l1_ca_dll_pll_batch_tracking_cc.h
+ * \brief Interface of a code DLL + carrier PLL tracking block that tracks
+ * all the GPS L1 C/A channels in a single pass over the input samples
+ *
+ * The loops are those of Gps_L1_Ca_Dll_Pll_Tracking_cc. Instead of one
+ * block per channel, each of them reading the whole sample stream, a single
+ * block processes the input in blocks of one code period, and runs the
+ * integrations of every channel falling in a block while its samples are
+ * still in the cache. Each channel gets its Gnss_Synchro stream on its own
+ * output port.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_CC_H
+#define	GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_CC_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/block.h>
+#include <gnuradio/msg_queue.h>
+#include "concurrent_queue.h"
+#include "gnss_synchro.h"
+#include "correlator.h"
+#include "gnss_overload_controller.h"
+#include "lock_detectors.h"
+#include "tracking_bit_synchronizer.h"
+#include "tracking_dump.h"
+#include "tracking_lock_history.h"
+#include "tracking_state_bank.h"
+#include "tracking_vector_estimator.h"
+
+class Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc;
+
+typedef boost::shared_ptr<Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc>
+        gps_l1_ca_dll_pll_batch_tracking_cc_sptr;
+
+/*!
+ * \brief Returns the batched tracking block of the receiver. All the
+ * channels share the same block: it is only created by the first call, and
+ * the arguments of the following calls are ignored until it is destroyed.
+ */
+gps_l1_ca_dll_pll_batch_tracking_cc_sptr
+gps_l1_ca_dll_pll_make_batch_tracking_cc(long if_freq,
+                                         long fs_in, unsigned
+                                         int vector_length,
+                                         boost::shared_ptr<gr::msg_queue> queue,
+                                         bool dump,
+                                         std::string dump_filename,
+                                         float pll_bw_hz,
+                                         float dll_bw_hz,
+                                         float early_late_space_chips);
+
+
+/*!
+ * \brief Control state of one channel of Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc.
+ * Its loops are in the Tracking_State_Bank of the block.
+ */
+class Gps_L1_Ca_Batch_Tracking_Channel
+{
+public:
+    Gps_L1_Ca_Batch_Tracking_Channel();
+    ~Gps_L1_Ca_Batch_Tracking_Channel();
+
+    unsigned int channel;
+    Gnss_Synchro* acquisition_gnss_synchro;
+    concurrent_queue<int>* channel_internal_queue;
+
+    gr_complex* ca_code;
+
+    // acquisition
+    float acq_code_phase_samples;
+
+    // absolute index of the first sample of the next integration
+    unsigned long int sample_counter;
+    unsigned long int acq_sample_stamp;
+
+    // integration waiting for the loop update
+    unsigned long int integration_start;
+    int integration_length;
+    gr_complex early;                    // correlator outputs of the last code period
+    gr_complex prompt;
+    gr_complex late;
+
+    // extended coherent integration, started at a data bit edge
+    Tracking_Bit_Synchronizer bit_synchronizer;
+    bool extended_integration;
+    int extend_correlation_count;        // code periods in early_accu, prompt_accu and late_accu
+    gr_complex early_accu;
+    gr_complex prompt_accu;
+    gr_complex late_accu;
+
+    // CN0 estimation and lock detector
+    Tracking_Lock_Detector lock_detector;
+    Tracking_Lock_History lock_history;  // last state in lock, for the reacquisition
+
+    // control vars
+    bool enable_tracking;
+    bool pull_in;
+    bool vector_aided;       // the carrier NCO follows the vector tracking prediction
+    bool shed;               // the overload controller asked to drop the satellite
+    int last_seg;
+    std::string sys;
+
+    // file dump
+    Gnss_Dump_File dump_file;
+
+private:
+    Gps_L1_Ca_Batch_Tracking_Channel(const Gps_L1_Ca_Batch_Tracking_Channel&);
+    Gps_L1_Ca_Batch_Tracking_Channel& operator=(const Gps_L1_Ca_Batch_Tracking_Channel&);
+};
+
+
+/*!
+ * \brief This class implements a DLL + PLL tracking loop block for all the
+ * channels of the receiver.
+ *
+ * The block has a single input and one output per channel. The channels
+ * are identified by their output port, returned by add_channel(). Each
+ * channel keeps the absolute index of the next sample it has to
+ * integrate, and the block only consumes the samples that all the channels
+ * have integrated.
+ *
+ * The channels are processed in rounds of at most one integration each:
+ * the correlator outputs of the round are written to a Tracking_State_Bank,
+ * which updates the loops of all of them at once, and then the lock
+ * detectors and the outputs of each channel are computed.
+ *
+ * With vector tracking enabled, once the PVT publishes a position, the
+ * carrier Doppler of the channels in lock are combined after every code
+ * period in an estimate of the receiver velocity and clock drift, and the
+ * carrier NCO of each channel is steered by the Doppler predicted for its
+ * satellite. The PLL of the channel only tracks the residual.
+ */
+class Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc: public gr::block
+{
+public:
+    ~Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc();
+
+    /*!
+     * \brief Adds a channel to the block and returns its output port
+     */
+    int add_channel();
+
+    void set_channel(int port, unsigned int channel);
+    void set_gnss_synchro(int port, Gnss_Synchro* p_gnss_synchro);
+    void start_tracking(int port);
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector of all the channels, as
+     * Gps_L1_Ca_Dll_Pll_Tracking_cc::set_lock_detector_window()
+     */
+    void set_lock_detector_window(int length, bool exponential);
+
+    /*!
+     * \brief Sets the coherent integration of the loops of all the channels
+     * once their data bits are synchronized, as
+     * Gps_L1_Ca_Dll_Pll_Tracking_cc::set_extend_correlation_ms()
+     */
+    void set_extend_correlation_ms(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
+
+    /*!
+     * \brief Enables the vector tracking of the carrier, aided by the
+     * position solution of the PVT
+     */
+    void set_vector_tracking(bool enabled);
+    void set_channel_queue(int port, concurrent_queue<int> *channel_internal_queue);
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+private:
+    friend gps_l1_ca_dll_pll_batch_tracking_cc_sptr
+    gps_l1_ca_dll_pll_make_batch_tracking_cc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            boost::shared_ptr<gr::msg_queue> queue,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+
+    Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            boost::shared_ptr<gr::msg_queue> queue,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+
+    /*!
+     * \brief Aligns the channel with the start of the code period found by
+     * the acquisition
+     */
+    void pull_in(int port);
+
+    /*!
+     * \brief Runs the correlation of the next integration of the channel
+     * on \p in, the samples starting at its sample_counter. Returns true if
+     * the channel waits for the loop update. Otherwise, the channel is not
+     * tracking or the samples are not valid, and its output has been
+     * written to \p synchro. Invalid samples make the channel skip the rest
+     * of the window (\p samples_available samples).
+     */
+    bool correlate(int port, const gr_complex* in, int samples_available, Gnss_Synchro& synchro);
+
+    /*!
+     * \brief Runs the lock detectors of a channel whose loops have been
+     * updated, and writes its output to \p synchro
+     */
+    void finish_integration(int port, Gnss_Synchro& synchro);
+
+    void dump_integration(int port, bool loops_updated);
+
+    void set_extended_integration(int port, bool enabled);
+
+    /*!
+     * \brief Estimates the receiver velocity and clock drift from the
+     * channels in lock and steers the carrier NCO of the channels with a
+     * known geometry. \p rx_time_s is the receiver time of the samples
+     * processed.
+     */
+    void update_vector_tracking(double rx_time_s);
+
+    /*!
+     * \brief Computes the line of sight and the velocity of the satellites
+     * at \p rx_time_s, from the last position solution and the ephemeris
+     */
+    void update_vector_geometry(double rx_time_s);
+
+    // tracking configuration vars
+    boost::shared_ptr<gr::msg_queue> d_queue;
+    unsigned int d_vector_length;
+    bool d_dump;
+    long d_if_freq;
+    long d_fs_in;
+
+    double d_early_late_spc_chips;
+    double d_local_code_shift_chips[3];  // Early, Prompt and Late shifts
+
+    // the replicas and the correlator scratch buffers are shared by all
+    // the channels, as they are processed one after another
+    gr_complex* d_carr_sign;
+    gr_complex d_Early;
+    gr_complex d_Prompt;
+    gr_complex d_Late;
+    Correlator d_correlator;
+    gr_complex* d_correlator_outs[3];    // d_Early, d_Prompt and d_Late
+
+    std::vector<Gps_L1_Ca_Batch_Tracking_Channel*> d_channels;
+    Tracking_State_Bank d_bank;          // loops of d_channels, by port
+    int d_lock_detector_window;
+    bool d_lock_detector_exponential;
+    std::vector<int> d_pending_ports;    // channels correlated in the current round
+
+    // extended coherent integration
+    int d_extend_correlation_ms;
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+
+    // vector tracking
+    bool d_vector_tracking;
+    Tracking_Vector_Estimator d_vector_estimator;
+    std::vector<float> d_vector_weights; // CN0 of the channels in lock, 0 for the others
+    double d_vector_geometry_time_s;     // receiver time of the last geometry update
+    std::vector<int> d_produced;
+    int d_last_seg;
+
+    // overload protection
+    int d_overload_level;
+
+    // start_tracking() is called from the channel threads
+    boost::mutex d_mutex;
+
+    std::string d_dump_filename;
+    std::map<std::string, std::string> systemName;
+};
+
+#endif //GNSS_SDR_GPS_L1_CA_DLL_PLL_BATCH_TRACKING_CC_H
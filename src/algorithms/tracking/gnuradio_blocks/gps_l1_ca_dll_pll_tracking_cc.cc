@@ -35,6 +35,7 @@
  */
 
 #include "gps_l1_ca_dll_pll_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -42,6 +43,7 @@
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "gnss_synchro.h"
+#include "carrier_nco.h"
 #include "gps_sdr_signal_processing.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
@@ -81,7 +83,7 @@ gps_l1_ca_dll_pll_make_tracking_cc(
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = (int)d_vector_length*2; //set the required available samples in each call
+    ninput_items_required[0] = std::min(d_samples_to_skip, d_current_prn_length_samples) + d_current_prn_length_samples; // next integration, after at most one PRN period of alignment skip
 }
 
 
@@ -99,6 +101,7 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
         gr::block("Gps_L1_Ca_Dll_Pll_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
                 gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
+    this->set_relative_rate(1.0/vector_length);
     // initialize internal vars
     d_queue = queue;
     d_dump = dump;
@@ -108,15 +111,21 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
     d_dump_filename = dump_filename;
 
     // Initialize tracking  ==========================================
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
     d_code_loop_filter.set_DLL_BW(dll_bw_hz);
     d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
 
     //--- DLL variables --------------------------------------------------------
     d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
+    d_local_code_shift_chips[0] = -d_early_late_spc_chips;
+    d_local_code_shift_chips[1] = 0.0;
+    d_local_code_shift_chips[2] = d_early_late_spc_chips;
 
     // Initialization of local code replica
-    // Get space for a vector with the C/A code replica sampled 1x/chip
-    d_ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 2];
+    // Get space for a vector with the C/A code replica sampled 1x/chip.
+    // The correlator resamples it on the fly for the E, P and L taps
+    d_ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
 
     /* If an array is partitioned for more than one thread to operate on,
      * having the sub-array boundaries unaligned to cache lines could lead
@@ -124,15 +133,15 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
-    if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Prompt, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
+    d_correlator_outs[0] = d_Early;
+    d_correlator_outs[1] = d_Prompt;
+    d_correlator_outs[2] = d_Late;
 
     //--- Perform initializations ------------------------------
     // define initial code frequency basis of NCO
@@ -144,6 +153,7 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
 
     // sample synchronization
     d_sample_counter = 0;
+    d_samples_to_skip = 0;
     //d_sample_counter_seconds = 0;
     d_acq_sample_stamp = 0;
 
@@ -153,14 +163,29 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
 
     d_current_prn_length_samples = (int)d_vector_length;
 
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
+    // extended coherent integration
+    d_bit_synchronizer.set_symbols_per_bit(GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND);
+    d_lock_history.set_fs(d_fs_in);
+    d_extend_correlation_ms = 1;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+    d_extended_integration = false;
+    d_extend_correlation_count = 0;
+    d_Early_accu = gr_complex(0,0);
+    d_Prompt_accu = gr_complex(0,0);
+    d_Late_accu = gr_complex(0,0);
+
+    // CN0 estimation and lock detector
+    d_lock_detector.set_window(CN0_ESTIMATION_SAMPLES, false);
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
     d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
 
+    // overload protection
+    d_overload_level = Gnss_Overload_Controller::NORMAL;
+    d_shed_satellite = false;
+
     systemName["G"] = std::string("GPS");
     systemName["R"] = std::string("GLONASS");
     systemName["S"] = std::string("SBAS");
@@ -169,6 +194,49 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
 }
 
 
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_lock_detector_window(int length, bool exponential)
+{
+    d_lock_detector.set_window(length, exponential);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_extend_correlation_ms(int extend_correlation_ms,
+        float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    const int symbols_per_bit = d_bit_synchronizer.symbols_per_bit();
+    if (extend_correlation_ms < 1 or extend_correlation_ms > symbols_per_bit or symbols_per_bit % extend_correlation_ms != 0)
+        {
+            LOG(WARNING) << "Tracking extended correlation of " << extend_correlation_ms
+                         << " ms does not divide a data bit, using 1 ms";
+            extend_correlation_ms = 1;
+        }
+    d_extend_correlation_ms = extend_correlation_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_extended_integration(bool enabled)
+{
+    // the loop filters take the new summation interval and bandwidths, their state is kept
+    float pdi = GPS_L1_CA_CODE_PERIOD * (enabled ? d_extend_correlation_ms : 1);
+    d_carrier_loop_filter.set_pdi(pdi);
+    d_code_loop_filter.set_pdi(pdi);
+    d_carrier_loop_filter.set_PLL_BW(enabled ? d_pll_bw_narrow_hz : d_pll_bw_hz);
+    d_code_loop_filter.set_DLL_BW(enabled ? d_dll_bw_narrow_hz : d_dll_bw_hz);
+    if (enabled != d_extended_integration)
+        {
+            LOG(INFO) << "Tracking CH " << d_channel << (enabled ? ": starting" : ": stopping")
+                      << " the " << d_extend_correlation_ms << " ms coherent integration";
+        }
+    d_extended_integration = enabled;
+    d_extend_correlation_count = 0;
+    d_Early_accu = gr_complex(0,0);
+    d_Prompt_accu = gr_complex(0,0);
+    d_Late_accu = gr_complex(0,0);
+}
+
+
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
 {
     /*
@@ -220,12 +288,15 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
     d_carrier_loop_filter.initialize(); // initialize the carrier filter
     d_code_loop_filter.initialize();    // initialize the code filter
 
-    // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
-    d_ca_code[0] = d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
-    d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
+    // generate local reference (1 sample per chip)
+    gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
 
     d_carrier_lock_fail_counter = 0;
+    d_lock_detector.reset();
+    d_bit_synchronizer.reset();
+    d_lock_history.reset();
+    d_shed_satellite = false;
+    set_extended_integration(false);
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -256,31 +327,10 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
 
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_code()
 {
-    double tcode_chips;
-    double rem_code_phase_chips;
-    int associated_chip_index;
-    int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
-    double code_phase_step_chips;
-    int early_late_spc_samples;
-    int epl_loop_length_samples;
-
-    // unified loop for E, P, L code vectors
-    code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
-    rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / d_fs_in);
-    tcode_chips = -rem_code_phase_chips;
-
-    // Alternative EPL code generation (40% of speed improvement!)
-    early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
-    epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
-        }
-
-    memcpy(d_prompt_code,&d_early_code[early_late_spc_samples],d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code,&d_early_code[early_late_spc_samples*2],d_current_prn_length_samples* sizeof(gr_complex));
+    // The E, P and L replicas are generated by the correlator while it
+    // correlates: only the code NCO phase and rate are needed here
+    d_code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
+    d_code_phase_chips = -d_rem_code_phase_samples * d_code_phase_step_chips;
 }
 
 
@@ -292,11 +342,7 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_carrier()
 
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
     phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    carrier_nco(d_carr_sign, d_current_prn_length_samples, phase_rad, phase_step_rad);
     //d_rem_carr_phase_rad = fmod(phase_rad, GPS_TWO_PI);
     //d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + d_rem_carr_phase_rad;
 }
@@ -306,18 +352,18 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_carrier()
 
 Gps_L1_Ca_Dll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Tracking_cc()
 {
+    if (d_dump_file.is_open())
+        {
+            Gnss_Overload_Controller::instance().remove_dump();
+        }
     d_dump_file.close();
 
-    free(d_prompt_code);
-    free(d_late_code);
-    free(d_early_code);
     free(d_carr_sign);
     free(d_Early);
     free(d_Prompt);
     free(d_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -326,10 +372,14 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
     // process vars
-    float carr_error_hz;
-    float carr_error_filt_hz;
-    float code_error_chips;
-    float code_error_filt_chips;
+    float carr_error_hz = 0;
+    float carr_error_filt_hz = 0;
+    float code_error_chips = 0;
+    float code_error_filt_chips = 0;
+
+    // overload protection: work time of this call
+    Gnss_Overload_Controller& overload_controller = Gnss_Overload_Controller::instance();
+    const double work_start_s = overload_controller.enabled() ? Gnss_Overload_Controller::now_s() : 0.0;
 
     if (d_enable_tracking == true)
         {
@@ -346,9 +396,15 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                     //d_sample_counter_seconds = d_sample_counter_seconds + (((double)samples_offset) / (double)d_fs_in);
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
-                    //std::cout<<" samples_offset="<<samples_offset<<"\r\n";
-                    consume_each(samples_offset); //shift input to perform alignment with local replica
-                    return 1;
+                    d_samples_to_skip += samples_offset; //shift input to perform alignment with local replica
+                }
+            if (ninput_items[0] < d_samples_to_skip + d_current_prn_length_samples)
+                {
+                    // drop the samples to be skipped that are already here and wait for the rest
+                    int samples_skipped = std::min(d_samples_to_skip, ninput_items[0]);
+                    d_samples_to_skip -= samples_skipped;
+                    consume_each(samples_skipped);
+                    return 0;
                 }
 
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
@@ -357,32 +413,33 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             current_synchro_data = *d_acquisition_gnss_synchro;
 
             // Block input data and block output stream pointers
-            const gr_complex* in = (gr_complex*) input_items[0]; //PRN start block alignment
+            const gr_complex* in = (gr_complex*) input_items[0] + d_samples_to_skip; //PRN start block alignment
             Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
 
             // Generate local code and carrier replicas (using \hat{f}_d(k-1))
             update_local_code();
             update_local_carrier();
 
-            // perform carrier wipe-off and compute Early, Prompt and Late correlation
-            d_correlator.Carrier_wipeoff_and_EPL_volk(d_current_prn_length_samples,
+            // perform carrier wipe-off and compute Early, Prompt and Late correlation in a single pass
+            d_correlator.Carrier_wipeoff_and_multicorrelator_resampler(d_current_prn_length_samples,
                     in,
                     d_carr_sign,
-                    d_early_code,
-                    d_prompt_code,
-                    d_late_code,
-                    d_Early,
-                    d_Prompt,
-                    d_Late,
-                    is_unaligned());
+                    d_ca_code,
+                    (int)GPS_L1_CA_CODE_LENGTH_CHIPS,
+                    d_code_phase_chips,
+                    d_code_phase_step_chips,
+                    3,
+                    d_local_code_shift_chips,
+                    d_correlator_outs);
 
             // check for samples consistency (this should be done before in the receiver / here only if the source is a file)
             if (std::isnan((*d_Prompt).real()) == true or std::isnan((*d_Prompt).imag()) == true ) // or std::isinf(in[i].real())==true or std::isinf(in[i].imag())==true)
                 {
-                    const int samples_available = ninput_items[0];
+                    const int samples_available = ninput_items[0] - d_samples_to_skip;
                     d_sample_counter = d_sample_counter + samples_available;
                     LOG(WARNING) << "Detected NaN samples at sample number " << d_sample_counter;
-                    consume_each(samples_available);
+                    consume_each(ninput_items[0]);
+                    d_samples_to_skip = 0;
 
                     // make an output to not stop the rest of the processing blocks
                     current_synchro_data.Prompt_I = 0.0;
@@ -398,31 +455,60 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                     return 1;
                 }
 
-            // ################## PLL ##########################################################
-            // PLL discriminator
-            carr_error_hz = pll_cloop_two_quadrant_atan(*d_Prompt) / (float)GPS_TWO_PI;
-            // Carrier discriminator filter
-            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
-            // New carrier Doppler frequency estimation
-            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
-            // New code Doppler frequency estimation
-            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+            // ################## EXTENDED COHERENT INTEGRATION ##############################
+            // Once the data bits are synchronized, the loops are closed on the sum of the
+            // correlator outputs of d_extend_correlation_ms code periods within a bit
+            gr_complex* early = d_Early;
+            gr_complex* prompt = d_Prompt;
+            gr_complex* late = d_Late;
+            bool update_loops = true;
+            if (d_extended_integration == true)
+                {
+                    d_Early_accu += *d_Early;
+                    d_Prompt_accu += *d_Prompt;
+                    d_Late_accu += *d_Late;
+                    d_extend_correlation_count++;
+                    early = &d_Early_accu;
+                    prompt = &d_Prompt_accu;
+                    late = &d_Late_accu;
+                    update_loops = (d_extend_correlation_count == d_extend_correlation_ms);
+                }
+
+            float code_error_filt_secs = 0;
+            if (update_loops == true)
+                {
+                    const float integration_time_s = GPS_L1_CA_CODE_PERIOD * (d_extended_integration ? d_extend_correlation_ms : 1);
+                    // ################## PLL ##########################################################
+                    // PLL discriminator
+                    carr_error_hz = pll_cloop_two_quadrant_atan(*prompt) / (float)GPS_TWO_PI;
+                    // Carrier discriminator filter
+                    carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                    // New carrier Doppler frequency estimation
+                    d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+                    // New code Doppler frequency estimation
+                    d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+
+                    // ################## DLL ##########################################################
+                    // DLL discriminator
+                    code_error_chips = dll_nc_e_minus_l_normalized(*early, *late); //[chips/Ti]
+                    // Code discriminator filter
+                    code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                    //Code phase accumulator
+                    code_error_filt_secs = (integration_time_s*code_error_filt_chips)/GPS_L1_CA_CODE_RATE_HZ; //[seconds]
+                    d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
+
+                    d_Early_accu = gr_complex(0,0);
+                    d_Prompt_accu = gr_complex(0,0);
+                    d_Late_accu = gr_complex(0,0);
+                    d_extend_correlation_count = 0;
+                }
+
             //carrier phase accumulator for (K) doppler estimation
             d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
             //remanent carrier phase to prevent overflow in the code NCO
             d_rem_carr_phase_rad = d_rem_carr_phase_rad+GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
             d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
 
-            // ################## DLL ##########################################################
-            // DLL discriminator
-            code_error_chips = dll_nc_e_minus_l_normalized(*d_Early, *d_Late); //[chips/Ti]
-            // Code discriminator filter
-            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
-            //Code phase accumulator
-            float code_error_filt_secs;
-            code_error_filt_secs = (GPS_L1_CA_CODE_PERIOD*code_error_filt_chips)/GPS_L1_CA_CODE_RATE_HZ; //[seconds]
-            d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
-
             // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
             // keep alignment parameters for the next input buffer
             float T_chip_seconds;
@@ -437,20 +523,28 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
-            // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+            // ################## BIT SYNCHRONIZATION ##########################################
+            d_bit_synchronizer.update((*d_Prompt).real());
+            if (d_extend_correlation_ms > 1)
                 {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
+                    if (d_extended_integration == false and d_bit_synchronizer.bit_start() == true)
+                        {
+                            set_extended_integration(true);
+                        }
+                    else if (d_extended_integration == true and d_bit_synchronizer.synchronized() == false)
+                        {
+                            set_extended_integration(false);
+                        }
                 }
-            else
+
+            // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
+            d_lock_detector.update(*d_Prompt);
+            if (d_lock_detector.ready())
                 {
-                    d_cn0_estimation_counter = 0;
                     // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_svn(d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -459,11 +553,24 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                     else
                         {
                             if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
+                            // the next code period starts at the PRN start sample of this output
+                            d_lock_history.update(round((double)d_sample_counter + (double)d_current_prn_length_samples + (double)d_rem_code_phase_samples),
+                                    T_prn_samples, d_carrier_doppler_hz);
                         }
-                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER or d_shed_satellite)
                         {
-                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
-                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
+                            if (d_shed_satellite == true)
+                                {
+                                    LOG(INFO) << "Satellite dropped in channel " << d_channel << " to shed load";
+                                    d_shed_satellite = false;
+                                }
+                            else
+                                {
+                                    std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
+                                    LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
+                                }
+                            // the acquisition searches first around the last state in lock
+                            d_lock_history.publish(d_acquisition_gnss_synchro);
                             ControlMessageFactory* cmf = new ControlMessageFactory();
                             if (d_queue != gr::msg_queue::sptr())
                                 {
@@ -540,64 +647,58 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             *out[0] = *d_acquisition_gnss_synchro;
         }
 
-    if(d_dump)
+    // under overload, the dump is not recorded
+    if(d_dump and d_overload_level < Gnss_Overload_Controller::REDUCED_COST)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_E, tmp_P, tmp_L;
-            float tmp_float;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_chips, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&carr_error_hz, sizeof(float));
-                    d_dump_file.write((char*)&carr_error_filt_hz, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&code_error_chips, sizeof(float));
-                    d_dump_file.write((char*)&code_error_filt_chips, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double=(double)(d_sample_counter+d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file. The record is
+            // queued, and written to the file by the dump writer thread
+            Tracking_Dump_Record record;
+            // EPR
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.carrier_doppler_hz = d_carrier_doppler_hz;
+            record.code_freq_chips = d_code_freq_chips;
+            //PLL commands
+            record.carr_error_hz = carr_error_hz;
+            record.carr_error_filt_hz = carr_error_filt_hz;
+            //DLL commands
+            record.code_error_chips = code_error_chips;
+            record.code_error_filt_chips = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = d_CN0_SNV_dB_Hz;
+            record.carrier_lock_test = d_carrier_lock_test;
+            // AUX vars (for debug purposes)
+            record.aux1 = d_rem_code_phase_samples;
+            record.aux2 = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_file.write(&record);
         }
 
-    consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
+    // the next integration starts d_current_prn_length_samples after this one. The part of
+    // them not yet in the input buffer is skipped in the next call
+    int samples_available = ninput_items[0] - d_samples_to_skip;
+    int samples_consumed = std::min(d_current_prn_length_samples, samples_available);
+    consume_each(d_samples_to_skip + samples_consumed); // this is necessary in gr::block derivates
+    d_samples_to_skip = d_current_prn_length_samples - samples_consumed;
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
+
+    if (overload_controller.enabled())
+        {
+            d_overload_level = overload_controller.report_work(unique_id(), Gnss_Overload_Controller::now_s() - work_start_s,
+                    GPS_L1_CA_CODE_PERIOD, Gnss_Overload_Controller::input_buffer_fill(*this, ninput_items[0]));
+            if (overload_controller.report_cn0(d_channel, d_enable_tracking ? d_CN0_SNV_dB_Hz : 0.0))
+                {
+                    d_shed_satellite = true;
+                }
+        }
     return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
 }
 
@@ -612,18 +713,17 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_dump_schema()))
+                        {
+                            Gnss_Overload_Controller::instance().add_dump();
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str() << std::endl;
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what() << std::endl;
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Unable to open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
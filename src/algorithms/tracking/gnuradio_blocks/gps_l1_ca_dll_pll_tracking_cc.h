@@ -48,9 +48,14 @@
 #include "concurrent_queue.h"
 #include "gps_sdr_signal_processing.h"
 #include "gnss_synchro.h"
+#include "lock_detectors.h"
+#include "tracking_bit_synchronizer.h"
+#include "tracking_dump.h"
+#include "tracking_lock_history.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "gnss_overload_controller.h"
 
 class Gps_L1_Ca_Dll_Pll_Tracking_cc;
 
@@ -81,6 +86,22 @@ public:
     void set_channel(unsigned int channel);
     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
     void start_tracking();
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector, updated with every integration: the last \p length
+     * integrations, or an exponential window of time constant \p length
+     */
+    void set_lock_detector_window(int length, bool exponential);
+
+    /*!
+     * \brief Sets the coherent integration of the loops once the data bits
+     * are synchronized, in code periods, and the loop bandwidths used with
+     * it. It has to divide the 20 code periods of a bit; 1 disables the
+     * extended integration. The block still outputs the prompt of every
+     * code period.
+     */
+    void set_extend_correlation_ms(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
     void set_channel_queue(concurrent_queue<int> *channel_internal_queue);
 
     int general_work (int noutput_items, gr_vector_int &ninput_items,
@@ -111,6 +132,7 @@ private:
             float early_late_space_chips);
     void update_local_code();
     void update_local_carrier();
+    void set_extended_integration(bool enabled);
 
     // tracking configuration vars
     boost::shared_ptr<gr::msg_queue> d_queue;
@@ -127,10 +149,11 @@ private:
     double d_early_late_spc_chips;
 
     gr_complex* d_ca_code;
+    double d_local_code_shift_chips[3];  // Early, Prompt and Late shifts
 
-    gr_complex* d_early_code;
-    gr_complex* d_late_code;
-    gr_complex* d_prompt_code;
+    // code phase of the first sample of the integration and its rate
+    double d_code_phase_chips;
+    double d_code_phase_step_chips;
     gr_complex* d_carr_sign;
 
     gr_complex *d_Early;
@@ -150,6 +173,7 @@ private:
     float d_acq_carrier_doppler_hz;
     // correlator
     Correlator d_correlator;
+    gr_complex* d_correlator_outs[3];    // d_Early, d_Prompt and d_Late
 
     // tracking vars
     float d_code_freq_chips;
@@ -164,14 +188,32 @@ private:
     //processing samples counters
     unsigned long int d_sample_counter;
     unsigned long int d_acq_sample_stamp;
+    int d_samples_to_skip; // input samples already counted in d_sample_counter but not consumed yet
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Tracking_Lock_Detector d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
     int d_carrier_lock_fail_counter;
+    Tracking_Lock_History d_lock_history; // last state in lock, for the reacquisition
+
+    // overload protection
+    int d_overload_level;
+    bool d_shed_satellite;                // the overload controller asked to drop the satellite
+
+    // extended coherent integration, started at a data bit edge
+    Tracking_Bit_Synchronizer d_bit_synchronizer;
+    int d_extend_correlation_ms;
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+    bool d_extended_integration;
+    int d_extend_correlation_count;  // code periods in d_Early_accu, d_Prompt_accu and d_Late_accu
+    gr_complex d_Early_accu;
+    gr_complex d_Prompt_accu;
+    gr_complex d_Late_accu;
 
     // control vars
     bool d_enable_tracking;
@@ -179,7 +221,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Gnss_Dump_File d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
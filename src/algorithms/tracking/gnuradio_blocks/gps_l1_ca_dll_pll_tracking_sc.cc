@@ -0,0 +1,663 @@
+/*!
+ * \file gps_l1_ca_dll_pll_tracking_sc.cc
+ * \brief Implementation of a code DLL + carrier PLL tracking block for
+ * complex 16-bit samples
+ *
+ * Code DLL + carrier PLL according to the algorithms described in:
+ * [1] K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
+ * A Software-Defined GPS and Galileo Receiver. A Single-Frequency
+ * Approach, Birkhauser, 2007
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_dll_pll_tracking_sc.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "gnss_synchro.h"
+#include "gps_sdr_signal_processing.h"
+#include "tracking_discriminators.h"
+#include "lock_detectors.h"
+#include "GPS_L1_CA.h"
+#include "control_message_factory.h"
+
+
+/*!
+ * \todo Include in definition header file
+ */
+#define CN0_ESTIMATION_SAMPLES 20
+#define MINIMUM_VALID_CN0 25
+#define MAXIMUM_LOCK_FAIL_COUNTER 50
+#define CARRIER_LOCK_THRESHOLD 0.85
+
+
+using google::LogMessage;
+
+gps_l1_ca_dll_pll_tracking_sc_sptr
+gps_l1_ca_dll_pll_make_tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        boost::shared_ptr<gr::msg_queue> queue,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips)
+{
+    return gps_l1_ca_dll_pll_tracking_sc_sptr(new Gps_L1_Ca_Dll_Pll_Tracking_sc(if_freq,
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips));
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    ninput_items_required[0] = std::min(d_samples_to_skip, d_current_prn_length_samples) + d_current_prn_length_samples; // next integration, after at most one PRN period of alignment skip
+}
+
+
+
+Gps_L1_Ca_Dll_Pll_Tracking_sc::Gps_L1_Ca_Dll_Pll_Tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        boost::shared_ptr<gr::msg_queue> queue,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips) :
+        gr::block("Gps_L1_Ca_Dll_Pll_Tracking_sc", gr::io_signature::make(1, 1, sizeof(lv_16sc_t)),
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+{
+    this->set_relative_rate(1.0/vector_length);
+    // initialize internal vars
+    d_queue = queue;
+    d_dump = dump;
+    d_if_freq = if_freq;
+    d_fs_in = fs_in;
+    d_vector_length = vector_length;
+    d_dump_filename = dump_filename;
+
+    // Initialize tracking  ==========================================
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
+    d_code_loop_filter.set_DLL_BW(dll_bw_hz);
+    d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+
+    //--- DLL variables --------------------------------------------------------
+    d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
+    d_local_code_shift_chips[0] = -d_early_late_spc_chips;
+    d_local_code_shift_chips[1] = 0.0;
+    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+
+    // Initialization of local code replica
+    // Get space for a vector with the C/A code replica sampled 1x/chip.
+    // The correlator resamples it for the E, P and L taps
+    d_ca_code = new int16_t[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
+
+    // scratch buffers of the correlator, for the longest integration
+    d_correlator.reserve(d_vector_length * 2, 3);
+
+    if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&d_Prompt, 16, sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
+    d_correlator_outs[0] = d_Early;
+    d_correlator_outs[1] = d_Prompt;
+    d_correlator_outs[2] = d_Late;
+
+    //--- Perform initializations ------------------------------
+    // define initial code frequency basis of NCO
+    d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ;
+    // define residual code phase (in chips)
+    d_rem_code_phase_samples = 0.0;
+    // define residual carrier phase
+    d_rem_carr_phase_rad = 0.0;
+
+    // sample synchronization
+    d_sample_counter = 0;
+    d_samples_to_skip = 0;
+    //d_sample_counter_seconds = 0;
+    d_acq_sample_stamp = 0;
+
+    d_enable_tracking = false;
+    d_pull_in = false;
+    d_last_seg = 0;
+
+    d_current_prn_length_samples = (int)d_vector_length;
+
+    // extended coherent integration
+    d_bit_synchronizer.set_symbols_per_bit(GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND);
+    d_extend_correlation_ms = 1;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+    d_extended_integration = false;
+    d_extend_correlation_count = 0;
+    d_Early_accu = gr_complex(0,0);
+    d_Prompt_accu = gr_complex(0,0);
+    d_Late_accu = gr_complex(0,0);
+
+    // CN0 estimation and lock detector
+    d_lock_detector.set_window(CN0_ESTIMATION_SAMPLES, false);
+    d_carrier_lock_test = 1;
+    d_CN0_SNV_dB_Hz = 0;
+    d_carrier_lock_fail_counter = 0;
+    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
+
+    systemName["G"] = std::string("GPS");
+    systemName["R"] = std::string("GLONASS");
+    systemName["S"] = std::string("SBAS");
+    systemName["E"] = std::string("Galileo");
+    systemName["C"] = std::string("Compass");
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_lock_detector_window(int length, bool exponential)
+{
+    d_lock_detector.set_window(length, exponential);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_extend_correlation_ms(int extend_correlation_ms,
+        float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    const int symbols_per_bit = d_bit_synchronizer.symbols_per_bit();
+    if (extend_correlation_ms < 1 or extend_correlation_ms > symbols_per_bit or symbols_per_bit % extend_correlation_ms != 0)
+        {
+            LOG(WARNING) << "Tracking extended correlation of " << extend_correlation_ms
+                         << " ms does not divide a data bit, using 1 ms";
+            extend_correlation_ms = 1;
+        }
+    d_extend_correlation_ms = extend_correlation_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_extended_integration(bool enabled)
+{
+    // the loop filters take the new summation interval and bandwidths, their state is kept
+    float pdi = GPS_L1_CA_CODE_PERIOD * (enabled ? d_extend_correlation_ms : 1);
+    d_carrier_loop_filter.set_pdi(pdi);
+    d_code_loop_filter.set_pdi(pdi);
+    d_carrier_loop_filter.set_PLL_BW(enabled ? d_pll_bw_narrow_hz : d_pll_bw_hz);
+    d_code_loop_filter.set_DLL_BW(enabled ? d_dll_bw_narrow_hz : d_dll_bw_hz);
+    if (enabled != d_extended_integration)
+        {
+            LOG(INFO) << "Tracking CH " << d_channel << (enabled ? ": starting" : ": stopping")
+                      << " the " << d_extend_correlation_ms << " ms coherent integration";
+        }
+    d_extended_integration = enabled;
+    d_extend_correlation_count = 0;
+    d_Early_accu = gr_complex(0,0);
+    d_Prompt_accu = gr_complex(0,0);
+    d_Late_accu = gr_complex(0,0);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::start_tracking()
+{
+    /*
+     *  correct the code phase according to the delay between acq and trk
+     */
+    d_acq_code_phase_samples = d_acquisition_gnss_synchro->Acq_delay_samples;
+    d_acq_carrier_doppler_hz = d_acquisition_gnss_synchro->Acq_doppler_hz;
+    d_acq_sample_stamp =  d_acquisition_gnss_synchro->Acq_samplestamp_samples;
+
+    unsigned long int acq_trk_diff_samples;
+    float acq_trk_diff_seconds;
+    acq_trk_diff_samples = d_sample_counter - d_acq_sample_stamp;//-d_vector_length;
+    LOG(INFO) << "Number of samples between Acquisition and Tracking =" << acq_trk_diff_samples;
+    acq_trk_diff_seconds = (float)acq_trk_diff_samples / (float)d_fs_in;
+    //doppler effect
+    // Fd=(C/(C+Vr))*F
+    float radial_velocity;
+    radial_velocity = (GPS_L1_FREQ_HZ + d_acq_carrier_doppler_hz)/GPS_L1_FREQ_HZ;
+    // new chip and prn sequence periods based on acq Doppler
+    float T_chip_mod_seconds;
+    float T_prn_mod_seconds;
+    float T_prn_mod_samples;
+    d_code_freq_chips = radial_velocity * GPS_L1_CA_CODE_RATE_HZ;
+    T_chip_mod_seconds = 1/d_code_freq_chips;
+    T_prn_mod_seconds = T_chip_mod_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
+    T_prn_mod_samples = T_prn_mod_seconds * (float)d_fs_in;
+
+    d_current_prn_length_samples = round(T_prn_mod_samples);
+
+    float T_prn_true_seconds = GPS_L1_CA_CODE_LENGTH_CHIPS / GPS_L1_CA_CODE_RATE_HZ;
+    float T_prn_true_samples = T_prn_true_seconds * (float)d_fs_in;
+    float T_prn_diff_seconds;
+    T_prn_diff_seconds = T_prn_true_seconds - T_prn_mod_seconds;
+    float N_prn_diff;
+    N_prn_diff = acq_trk_diff_seconds / T_prn_true_seconds;
+    float corrected_acq_phase_samples, delay_correction_samples;
+    corrected_acq_phase_samples = fmod((d_acq_code_phase_samples + T_prn_diff_seconds * N_prn_diff * (float)d_fs_in), T_prn_true_samples);
+    if (corrected_acq_phase_samples < 0)
+        {
+            corrected_acq_phase_samples = T_prn_mod_samples + corrected_acq_phase_samples;
+        }
+    delay_correction_samples = d_acq_code_phase_samples - corrected_acq_phase_samples;
+
+    d_acq_code_phase_samples = corrected_acq_phase_samples;
+
+    d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
+
+    // DLL/PLL filter initialization
+    d_carrier_loop_filter.initialize(); // initialize the carrier filter
+    d_code_loop_filter.initialize();    // initialize the code filter
+
+    // generate local reference (1 sample per chip)
+    std::vector<gr_complex> ca_code((int)GPS_L1_CA_CODE_LENGTH_CHIPS);
+    gps_l1_ca_code_gen_complex(&ca_code[0], d_acquisition_gnss_synchro->PRN, 0);
+    for (int i = 0; i < (int)GPS_L1_CA_CODE_LENGTH_CHIPS; i++)
+        {
+            d_ca_code[i] = (ca_code[i].real() < 0) ? -1 : 1;
+        }
+
+    d_carrier_lock_fail_counter = 0;
+    d_lock_detector.reset();
+    d_bit_synchronizer.reset();
+    set_extended_integration(false);
+    d_rem_code_phase_samples = 0;
+    d_rem_carr_phase_rad = 0;
+    d_acc_carrier_phase_rad = 0;
+    d_acc_code_phase_secs = 0;
+
+    d_code_phase_samples = d_acq_code_phase_samples;
+
+    std::string sys_ = &d_acquisition_gnss_synchro->System;
+    sys = sys_.substr(0,1);
+
+    // DEBUG OUTPUT
+    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << std::endl;
+    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+
+
+    // enable tracking
+    d_pull_in = true;
+    d_enable_tracking = true;
+
+    LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
+            << " Code Phase correction [samples]=" << delay_correction_samples
+            << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples;
+}
+
+
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::update_local_code()
+{
+    // The E, P and L replicas are generated by the correlator while it
+    // correlates: only the code NCO phase and rate are needed here
+    d_code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
+    d_code_phase_chips = -d_rem_code_phase_samples * d_code_phase_step_chips;
+}
+
+
+
+
+Gps_L1_Ca_Dll_Pll_Tracking_sc::~Gps_L1_Ca_Dll_Pll_Tracking_sc()
+{
+    d_dump_file.close();
+
+    free(d_Early);
+    free(d_Prompt);
+    free(d_Late);
+
+    delete[] d_ca_code;
+}
+
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_sc::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    // process vars
+    float carr_error_hz = 0;
+    float carr_error_filt_hz = 0;
+    float code_error_chips = 0;
+    float code_error_filt_chips = 0;
+
+    if (d_enable_tracking == true)
+        {
+            // Receiver signal alignment
+            if (d_pull_in == true)
+                {
+                    int samples_offset;
+                    float acq_trk_shif_correction_samples;
+                    int acq_to_trk_delay_samples;
+                    acq_to_trk_delay_samples = d_sample_counter - d_acq_sample_stamp;
+                    acq_trk_shif_correction_samples = d_current_prn_length_samples - fmod((float)acq_to_trk_delay_samples, (float)d_current_prn_length_samples);
+                    samples_offset = round(d_acq_code_phase_samples + acq_trk_shif_correction_samples);
+                    // /todo: Check if the sample counter sent to the next block as a time reference should be incremented AFTER sended or BEFORE
+                    //d_sample_counter_seconds = d_sample_counter_seconds + (((double)samples_offset) / (double)d_fs_in);
+                    d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
+                    d_pull_in = false;
+                    d_samples_to_skip += samples_offset; //shift input to perform alignment with local replica
+                }
+            if (ninput_items[0] < d_samples_to_skip + d_current_prn_length_samples)
+                {
+                    // drop the samples to be skipped that are already here and wait for the rest
+                    int samples_skipped = std::min(d_samples_to_skip, ninput_items[0]);
+                    d_samples_to_skip -= samples_skipped;
+                    consume_each(samples_skipped);
+                    return 0;
+                }
+
+            // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
+            Gnss_Synchro current_synchro_data;
+            // Fill the acquisition data
+            current_synchro_data = *d_acquisition_gnss_synchro;
+
+            // Block input data and block output stream pointers
+            const lv_16sc_t* in = (lv_16sc_t*) input_items[0] + d_samples_to_skip; //PRN start block alignment
+            Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
+
+            // Update the code NCO (using \hat{f}_d(k-1))
+            update_local_code();
+
+            // perform carrier wipe-off and compute Early, Prompt and Late correlation on integers,
+            // with the carrier read from the table of the correlator
+            d_correlator.Carrier_wipeoff_and_multicorrelator_resampler(d_current_prn_length_samples,
+                    in,
+                    d_rem_carr_phase_rad,
+                    GPS_TWO_PI * d_carrier_doppler_hz / (double)d_fs_in,
+                    d_ca_code,
+                    (int)GPS_L1_CA_CODE_LENGTH_CHIPS,
+                    d_code_phase_chips,
+                    d_code_phase_step_chips,
+                    3,
+                    d_local_code_shift_chips,
+                    d_correlator_outs);
+
+            // ################## EXTENDED COHERENT INTEGRATION ##############################
+            // Once the data bits are synchronized, the loops are closed on the sum of the
+            // correlator outputs of d_extend_correlation_ms code periods within a bit
+            gr_complex* early = d_Early;
+            gr_complex* prompt = d_Prompt;
+            gr_complex* late = d_Late;
+            bool update_loops = true;
+            if (d_extended_integration == true)
+                {
+                    d_Early_accu += *d_Early;
+                    d_Prompt_accu += *d_Prompt;
+                    d_Late_accu += *d_Late;
+                    d_extend_correlation_count++;
+                    early = &d_Early_accu;
+                    prompt = &d_Prompt_accu;
+                    late = &d_Late_accu;
+                    update_loops = (d_extend_correlation_count == d_extend_correlation_ms);
+                }
+
+            float code_error_filt_secs = 0;
+            if (update_loops == true)
+                {
+                    const float integration_time_s = GPS_L1_CA_CODE_PERIOD * (d_extended_integration ? d_extend_correlation_ms : 1);
+                    // ################## PLL ##########################################################
+                    // PLL discriminator
+                    carr_error_hz = pll_cloop_two_quadrant_atan(*prompt) / (float)GPS_TWO_PI;
+                    // Carrier discriminator filter
+                    carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                    // New carrier Doppler frequency estimation
+                    d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+                    // New code Doppler frequency estimation
+                    d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+
+                    // ################## DLL ##########################################################
+                    // DLL discriminator
+                    code_error_chips = dll_nc_e_minus_l_normalized(*early, *late); //[chips/Ti]
+                    // Code discriminator filter
+                    code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                    //Code phase accumulator
+                    code_error_filt_secs = (integration_time_s*code_error_filt_chips)/GPS_L1_CA_CODE_RATE_HZ; //[seconds]
+                    d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
+
+                    d_Early_accu = gr_complex(0,0);
+                    d_Prompt_accu = gr_complex(0,0);
+                    d_Late_accu = gr_complex(0,0);
+                    d_extend_correlation_count = 0;
+                }
+
+            //carrier phase accumulator for (K) doppler estimation
+            d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
+            //remanent carrier phase to prevent overflow in the code NCO
+            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
+            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
+
+            // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
+            // keep alignment parameters for the next input buffer
+            float T_chip_seconds;
+            float T_prn_seconds;
+            float T_prn_samples;
+            float K_blk_samples;
+            // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
+            T_chip_seconds = 1 / d_code_freq_chips;
+            T_prn_seconds = T_chip_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
+            T_prn_samples = T_prn_seconds * (float)d_fs_in;
+            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs*(float)d_fs_in;
+            d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
+            d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
+
+            // ################## BIT SYNCHRONIZATION ##########################################
+            d_bit_synchronizer.update((*d_Prompt).real());
+            if (d_extend_correlation_ms > 1)
+                {
+                    if (d_extended_integration == false and d_bit_synchronizer.bit_start() == true)
+                        {
+                            set_extended_integration(true);
+                        }
+                    else if (d_extended_integration == true and d_bit_synchronizer.synchronized() == false)
+                        {
+                            set_extended_integration(false);
+                        }
+                }
+
+            // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
+            d_lock_detector.update(*d_Prompt);
+            if (d_lock_detector.ready())
+                {
+                    // Code lock indicator
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_svn(d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    // Carrier lock indicator
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
+                    // Loss of lock detection
+                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
+                        {
+                            d_carrier_lock_fail_counter++;
+                        }
+                    else
+                        {
+                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
+                        }
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                        {
+                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
+                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
+                            ControlMessageFactory* cmf = new ControlMessageFactory();
+                            if (d_queue != gr::msg_queue::sptr())
+                                {
+                                    d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
+                                }
+                            delete cmf;
+                            d_carrier_lock_fail_counter = 0;
+                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                        }
+                }
+            // ########### Output the tracking data to navigation and PVT ##########
+            current_synchro_data.Prompt_I = (double)(*d_Prompt).real();
+            current_synchro_data.Prompt_Q = (double)(*d_Prompt).imag();
+            // Tracking_timestamp_secs is aligned with the PRN start sample
+            current_synchro_data.Tracking_timestamp_secs = ((double)d_sample_counter + (double)d_current_prn_length_samples + (double)d_rem_code_phase_samples)/(double)d_fs_in;
+            // This tracking block aligns the Tracking_timestamp_secs with the start sample of the PRN, thus, Code_phase_secs=0
+            current_synchro_data.Code_phase_secs = 0;
+            current_synchro_data.Carrier_phase_rads = (double)d_acc_carrier_phase_rad;
+            current_synchro_data.Carrier_Doppler_hz = (double)d_carrier_doppler_hz;
+            current_synchro_data.CN0_dB_hz = (double)d_CN0_SNV_dB_Hz;
+            *out[0] = current_synchro_data;
+
+            // ########## DEBUG OUTPUT
+            /*!
+             *  \todo The stop timer has to be moved to the signal source!
+             */
+            // debug: Second counter in channel 0
+            if (d_channel == 0)
+                {
+                    if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                        {
+                            d_last_seg = floor(d_sample_counter / d_fs_in);
+                            std::cout << "Current input signal time = " << d_last_seg << " [s]" << std::endl;
+                            LOG(INFO) << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                                      << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
+                            //if (d_last_seg==5) d_carrier_lock_fail_counter=500; //DEBUG: force unlock!
+                        }
+                }
+            else
+                {
+                    if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                        {
+                            d_last_seg = floor(d_sample_counter / d_fs_in);
+                            LOG(INFO) << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                                                    << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
+                            //std::cout<<"TRK CH "<<d_channel<<" Carrier_lock_test="<<d_carrier_lock_test<< std::endl;
+                        }
+                }
+        }
+    else
+        {
+			// ########## DEBUG OUTPUT (TIME ONLY for channel 0 when tracking is disabled)
+			/*!
+			 *  \todo The stop timer has to be moved to the signal source!
+			 */
+			// stream to collect cout calls to improve thread safety
+			std::stringstream tmp_str_stream;
+			if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+			{
+				d_last_seg = floor(d_sample_counter / d_fs_in);
+
+				if (d_channel == 0)
+				{
+					// debug: Second counter in channel 0
+					tmp_str_stream << "Current input signal time = " << d_last_seg << " [s]" << std::endl << std::flush;
+					std::cout << tmp_str_stream.rdbuf() << std::flush;
+				}
+			}
+            *d_Early = gr_complex(0,0);
+            *d_Prompt = gr_complex(0,0);
+            *d_Late = gr_complex(0,0);
+            Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0]; //block output streams pointer
+            // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
+            *out[0] = *d_acquisition_gnss_synchro;
+        }
+
+    if(d_dump)
+        {
+            // MULTIPLEXED FILE RECORDING - Record results to file. The record is
+            // queued, and written to the file by the dump writer thread
+            Tracking_Dump_Record record;
+            // EPR
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.carrier_doppler_hz = d_carrier_doppler_hz;
+            record.code_freq_chips = d_code_freq_chips;
+            //PLL commands
+            record.carr_error_hz = carr_error_hz;
+            record.carr_error_filt_hz = carr_error_filt_hz;
+            //DLL commands
+            record.code_error_chips = code_error_chips;
+            record.code_error_filt_chips = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = d_CN0_SNV_dB_Hz;
+            record.carrier_lock_test = d_carrier_lock_test;
+            // AUX vars (for debug purposes)
+            record.aux1 = d_rem_code_phase_samples;
+            record.aux2 = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_file.write(&record);
+        }
+
+    // the next integration starts d_current_prn_length_samples after this one. The part of
+    // them not yet in the input buffer is skipped in the next call
+    int samples_available = ninput_items[0] - d_samples_to_skip;
+    int samples_consumed = std::min(d_current_prn_length_samples, samples_available);
+    consume_each(d_samples_to_skip + samples_consumed); // this is necessary in gr::block derivates
+    d_samples_to_skip = d_current_prn_length_samples - samples_consumed;
+    d_sample_counter += d_current_prn_length_samples; //count for the processed samples
+    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_channel(unsigned int channel)
+{
+    d_channel = channel;
+    LOG(INFO) << "Tracking Channel set to " << d_channel;
+    // ############# ENABLE DATA FILE LOG #################
+    if (d_dump == true)
+        {
+            if (d_dump_file.is_open() == false)
+                {
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_dump_schema()))
+                        {
+                            LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str() << std::endl;
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Unable to open trk dump file " << d_dump_filename;
+                        }
+                }
+        }
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_channel_queue(concurrent_queue<int> *channel_internal_queue)
+{
+    d_channel_internal_queue = channel_internal_queue;
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+{
+    d_acquisition_gnss_synchro = p_gnss_synchro;
+}
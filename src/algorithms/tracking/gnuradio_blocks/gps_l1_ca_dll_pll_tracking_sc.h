@@ -0,0 +1,217 @@
+/*!
+ * \file gps_l1_ca_dll_pll_tracking_sc.h
+ * \brief Interface of a code DLL + carrier PLL tracking block for complex
+ * 16-bit samples
+ *
+ * The same loops as Gps_L1_Ca_Dll_Pll_Tracking_cc, with the carrier
+ * wipe-off and the correlators computed on integers (see
+ * correlator_int16.h).
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
+#define	GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
+
+#include <fstream>
+#include <queue>
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/block.h>
+#include <gnuradio/msg_queue.h>
+#include "concurrent_queue.h"
+#include "gps_sdr_signal_processing.h"
+#include "gnss_synchro.h"
+#include "lock_detectors.h"
+#include "tracking_bit_synchronizer.h"
+#include "tracking_dump.h"
+#include "tracking_2nd_DLL_filter.h"
+#include "tracking_2nd_PLL_filter.h"
+#include "correlator_int16.h"
+
+class Gps_L1_Ca_Dll_Pll_Tracking_sc;
+
+typedef boost::shared_ptr<Gps_L1_Ca_Dll_Pll_Tracking_sc>
+        gps_l1_ca_dll_pll_tracking_sc_sptr;
+
+gps_l1_ca_dll_pll_tracking_sc_sptr
+gps_l1_ca_dll_pll_make_tracking_sc(long if_freq,
+                                   long fs_in, unsigned
+                                   int vector_length,
+                                   boost::shared_ptr<gr::msg_queue> queue,
+                                   bool dump,
+                                   std::string dump_filename,
+                                   float pll_bw_hz,
+                                   float dll_bw_hz,
+                                   float early_late_space_chips);
+
+
+
+/*!
+ * \brief This class implements a DLL + PLL tracking loop block for complex
+ * 16-bit (lv_16sc_t) input samples
+ */
+class Gps_L1_Ca_Dll_Pll_Tracking_sc: public gr::block
+{
+public:
+    ~Gps_L1_Ca_Dll_Pll_Tracking_sc();
+
+    void set_channel(unsigned int channel);
+    void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
+    void start_tracking();
+
+    /*!
+     * \brief Sets the window of the CN0 estimator and the carrier lock
+     * detector, updated with every integration: the last \p length
+     * integrations, or an exponential window of time constant \p length
+     */
+    void set_lock_detector_window(int length, bool exponential);
+
+    /*!
+     * \brief Sets the coherent integration of the loops once the data bits
+     * are synchronized, as Gps_L1_Ca_Dll_Pll_Tracking_cc::set_extend_correlation_ms()
+     */
+    void set_extend_correlation_ms(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
+    void set_channel_queue(concurrent_queue<int> *channel_internal_queue);
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+private:
+    friend gps_l1_ca_dll_pll_tracking_sc_sptr
+    gps_l1_ca_dll_pll_make_tracking_sc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            boost::shared_ptr<gr::msg_queue> queue,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+
+    Gps_L1_Ca_Dll_Pll_Tracking_sc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            boost::shared_ptr<gr::msg_queue> queue,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+    void update_local_code();
+    void set_extended_integration(bool enabled);
+
+    // tracking configuration vars
+    boost::shared_ptr<gr::msg_queue> d_queue;
+    concurrent_queue<int> *d_channel_internal_queue;
+    unsigned int d_vector_length;
+    bool d_dump;
+
+    Gnss_Synchro* d_acquisition_gnss_synchro;
+    unsigned int d_channel;
+    int d_last_seg;
+    long d_if_freq;
+    long d_fs_in;
+
+    double d_early_late_spc_chips;
+
+    int16_t* d_ca_code;                  // +1/-1 chips
+    double d_local_code_shift_chips[3];  // Early, Prompt and Late shifts
+
+    // code phase of the first sample of the integration and its rate
+    double d_code_phase_chips;
+    double d_code_phase_step_chips;
+
+    gr_complex *d_Early;
+    gr_complex *d_Prompt;
+    gr_complex *d_Late;
+
+    // remaining code phase and carrier phase between tracking loops
+    float d_rem_code_phase_samples;
+    float d_rem_carr_phase_rad;
+
+    // PLL and DLL filter library
+    Tracking_2nd_DLL_filter d_code_loop_filter;
+    Tracking_2nd_PLL_filter d_carrier_loop_filter;
+
+    // acquisition
+    float d_acq_code_phase_samples;
+    float d_acq_carrier_doppler_hz;
+    // correlator
+    Correlator_Int16 d_correlator;
+    gr_complex* d_correlator_outs[3];    // d_Early, d_Prompt and d_Late
+
+    // tracking vars
+    float d_code_freq_chips;
+    float d_carrier_doppler_hz;
+    float d_acc_carrier_phase_rad;
+    float d_code_phase_samples;
+    float d_acc_code_phase_secs;
+
+    //PRN period in samples
+    int d_current_prn_length_samples;
+
+    //processing samples counters
+    unsigned long int d_sample_counter;
+    unsigned long int d_acq_sample_stamp;
+    int d_samples_to_skip; // input samples already counted in d_sample_counter but not consumed yet
+
+    // CN0 estimation and lock detector
+    Tracking_Lock_Detector d_lock_detector;
+    float d_carrier_lock_test;
+    float d_CN0_SNV_dB_Hz;
+    float d_carrier_lock_threshold;
+    int d_carrier_lock_fail_counter;
+
+    // extended coherent integration, started at a data bit edge
+    Tracking_Bit_Synchronizer d_bit_synchronizer;
+    int d_extend_correlation_ms;
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+    bool d_extended_integration;
+    int d_extend_correlation_count;  // code periods in d_Early_accu, d_Prompt_accu and d_Late_accu
+    gr_complex d_Early_accu;
+    gr_complex d_Prompt_accu;
+    gr_complex d_Late_accu;
+
+    // control vars
+    bool d_enable_tracking;
+    bool d_pull_in;
+
+    // file dump
+    std::string d_dump_filename;
+    Gnss_Dump_File d_dump_file;
+
+    std::map<std::string, std::string> systemName;
+    std::string sys;
+};
+
+#endif //GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
@@ -35,6 +35,7 @@
 
 
 #include "correlator.h"
+#include <cstdlib>
 #include <iostream>
 #define LV_HAVE_SSE3
 #include "volk_cw_epl_corr.h"
@@ -76,14 +77,42 @@ void Correlator::Carrier_wipeoff_and_EPL_generic(int signal_length_samples, cons
 
 
 
+gr_complex* Correlator::baseband_buffer(int signal_length_samples)
+{
+    if (signal_length_samples > d_bb_signal_capacity)
+        {
+            reserve(signal_length_samples);
+        }
+    return d_bb_signal;
+}
+
+
+void Correlator::reserve(int max_signal_length_samples)
+{
+    if (max_signal_length_samples <= d_bb_signal_capacity)
+        {
+            return;
+        }
+    free(d_bb_signal);
+    d_bb_signal = 0;
+    d_bb_signal_capacity = 0;
+    // Cache line aligned, so that no other data shares its lines
+    if (posix_memalign((void**)&d_bb_signal, 64, max_signal_length_samples * sizeof(gr_complex)) == 0)
+        {
+            d_bb_signal_capacity = max_signal_length_samples;
+        }
+    else
+        {
+            std::cout << "Correlator: unable to allocate the baseband buffer" << std::endl;
+        }
+}
+
+
 void Correlator::Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned)
 {
-    gr_complex* bb_signal;
+    gr_complex* bb_signal = baseband_buffer(signal_length_samples);
     //gr_complex* input_aligned;
 
-    //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&bb_signal, 16, signal_length_samples * sizeof(gr_complex)) == 0) {};
-
     if (input_vector_unaligned == true)
         {
             //todo: do something if posix_memalign fails
@@ -106,7 +135,6 @@ void Correlator::Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const g
     volk_32fc_x2_dot_prod_32fc_a(P_out, bb_signal, P_code, signal_length_samples);
     volk_32fc_x2_dot_prod_32fc_a(L_out, bb_signal, L_code, signal_length_samples);
 
-    free(bb_signal);
     //if (input_vector_unaligned==false)
     //{
     //	free(input_aligned);
@@ -118,14 +146,33 @@ void Correlator::Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples,
     volk_cw_epl_corr_u(input, carrier, E_code, P_code, L_code, E_out, P_out, L_out, signal_length_samples);
 }
 
+void Correlator::Carrier_wipeoff_and_multicorrelator(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, int n_correlators, const gr_complex* const* local_codes, gr_complex* const* corr_out)
+{
+    d_multicorrelator_kernel(input, carrier, n_correlators, local_codes, corr_out, signal_length_samples);
+}
+
+void Correlator::Carrier_wipeoff_and_multicorrelator_resampler(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, const gr_complex* code, int code_length, double code_phase, double code_phase_step, int n_correlators, const double* tap_shifts, gr_complex* const* corr_out)
+{
+    Code_Nco code_nco;
+    code_nco.set_code_length(code_length);
+    if ((int)d_tap_phases.size() < n_correlators)
+        {
+            d_tap_phases.resize(n_correlators);
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            // Half an entry ahead, so that the NCO takes the nearest entry
+            code_nco.set_phase(code_phase + tap_shifts[k] + 0.5);
+            d_tap_phases[k] = code_nco.phase();
+        }
+    d_multicorrelator_resampler_kernel(input, carrier, code, code_length, n_correlators, &d_tap_phases[0], Code_Nco::to_fixed_point(code_phase_step), corr_out, signal_length_samples);
+}
+
 void Correlator::Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* VE_code, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* VL_code, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out, bool input_vector_unaligned)
 {
-    gr_complex* bb_signal;
+    gr_complex* bb_signal = baseband_buffer(signal_length_samples);
     //gr_complex* input_aligned;
 
-    //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&bb_signal, 16, signal_length_samples * sizeof(gr_complex)) == 0) {};
-
     if (input_vector_unaligned == false)
         {
             //todo: do something if posix_memalign fails
@@ -146,7 +193,6 @@ void Correlator::Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const
     volk_32fc_x2_dot_prod_32fc_a(L_out, bb_signal, L_code, signal_length_samples);
     volk_32fc_x2_dot_prod_32fc_a(VL_out, bb_signal, VL_code, signal_length_samples);
 
-    free(bb_signal);
     //if (input_vector_unaligned == false)
         //{
             //free(input_aligned);
@@ -226,11 +272,36 @@ void Correlator::cpu_arch_test_volk_32fc_x2_multiply_32fc_a()
 }
 */
 
+static multicorrelator_kernel select_multicorrelator_kernel()
+{
+    std::string arch;
+    multicorrelator_kernel kernel = multicorrelator_best_kernel(arch);
+    std::cout << "Selected architecture for the multicorrelator is " << arch << std::endl;
+    return kernel;
+}
+
+static multicorrelator_resampler_kernel select_multicorrelator_resampler_kernel()
+{
+    std::string arch;
+    multicorrelator_resampler_kernel kernel = multicorrelator_resampler_best_kernel(arch);
+    std::cout << "Selected architecture for the multicorrelator resampler is " << arch << std::endl;
+    return kernel;
+}
+
 Correlator::Correlator ()
 {
+    d_bb_signal = 0;
+    d_bb_signal_capacity = 0;
+    // The processor is the same for all the channels: select the kernel once
+    static multicorrelator_kernel best_kernel = select_multicorrelator_kernel();
+    d_multicorrelator_kernel = best_kernel;
+    static multicorrelator_resampler_kernel best_resampler_kernel = select_multicorrelator_resampler_kernel();
+    d_multicorrelator_resampler_kernel = best_resampler_kernel;
     //cpu_arch_test_volk_32fc_x2_dot_prod_32fc_a();
     //cpu_arch_test_volk_32fc_x2_multiply_32fc_a();
 }
 
 Correlator::~Correlator ()
-{}
+{
+    free(d_bb_signal);
+}
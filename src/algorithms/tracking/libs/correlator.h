@@ -38,8 +38,10 @@
 #define GNSS_SDR_CORRELATOR_H_
 
 #include <string>
+#include <vector>
 #include <volk/volk.h>
 #include <gnuradio/gr_complex.h>
+#include "multicorrelator_kernels.h"
 
 
 /*!
@@ -48,6 +50,13 @@
  * Implemented versions:
  * - Generic: Standard C++ implementation.
  * - Volk: uses VOLK (Vector-Optimized Library of Kernels) and uses the processor's SIMD instruction sets. See http://gnuradio.org/redmine/projects/gnuradio/wiki/Volk
+ * - Multicorrelator: fused carrier wipe-off and any number of correlators in a single pass over the samples, with the SIMD kernel selected at run time (see multicorrelator_kernels.h).
+ * - Multicorrelator resampler: the same, generating the code replicas on the fly from the code table.
+ *
+ * The baseband signal of the Volk versions goes to a scratch buffer owned
+ * by the correlator, aligned to a cache line and only reallocated when a
+ * longer signal arrives, so that tracking performs no heap allocation per
+ * integration. A Correlator must therefore not be shared between threads.
  *
  */
 class Correlator
@@ -57,9 +66,38 @@ public:
     void Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* VE_code, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* VL_code, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out, bool input_vector_unaligned);
+    /*!
+     * \brief Performs the carrier wipe-off and the correlation with
+     * \p n_correlators local codes in one pass over the input, writing the
+     * correlation with local_codes[k] to *corr_out[k].
+     */
+    void Carrier_wipeoff_and_multicorrelator(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, int n_correlators, const gr_complex* const* local_codes, gr_complex* const* corr_out);
+    /*!
+     * \brief Performs the carrier wipe-off and the correlation with
+     * \p n_correlators replicas of the code table \p code (\p code_length
+     * entries, e.g. chips) in one pass, without materializing the replicas.
+     * The code phase of the first sample is \p code_phase entries, it
+     * advances \p code_phase_step entries per sample, and the replica of tap
+     * k is shifted by tap_shifts[k] entries (negative for the early taps).
+     * Each sample takes the nearest code table entry.
+     */
+    void Carrier_wipeoff_and_multicorrelator_resampler(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, const gr_complex* code, int code_length, double code_phase, double code_phase_step, int n_correlators, const double* tap_shifts, gr_complex* const* corr_out);
+    /*!
+     * \brief Allocates the scratch buffer for signals of up to
+     * \p max_signal_length_samples samples.
+     */
+    void reserve(int max_signal_length_samples);
     Correlator();
     ~Correlator();
 private:
+    Correlator(const Correlator&);
+    Correlator& operator=(const Correlator&);
+    gr_complex* baseband_buffer(int signal_length_samples);
+    gr_complex* d_bb_signal;
+    int d_bb_signal_capacity;
+    multicorrelator_kernel d_multicorrelator_kernel;
+    multicorrelator_resampler_kernel d_multicorrelator_resampler_kernel;
+    std::vector<uint64_t> d_tap_phases;
     std::string volk_32fc_x2_multiply_32fc_a_best_arch;
     std::string volk_32fc_x2_dot_prod_32fc_a_best_arch;
     unsigned long next_power_2(unsigned long v);
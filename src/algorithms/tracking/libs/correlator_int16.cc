@@ -0,0 +1,144 @@
+/*!
+ * \file correlator_int16.cc
+ * \brief Carrier wipe-off and correlators for complex 16-bit samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "correlator_int16.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "code_nco.h"
+
+// int16 values per cache line: every vector of the buffer starts on one
+#define CORRELATOR_INT16_ALIGNMENT 32
+
+
+static carrier_wipeoff_int16_kernel select_carrier_wipeoff_int16_kernel()
+{
+    std::string arch;
+    carrier_wipeoff_int16_kernel kernel = carrier_wipeoff_int16_best_kernel(arch);
+    std::cout << "Selected architecture for the int16 carrier wipe-off is " << arch << std::endl;
+    return kernel;
+}
+
+static multicorrelator_int16_kernel select_multicorrelator_int16_kernel()
+{
+    std::string arch;
+    multicorrelator_int16_kernel kernel = multicorrelator_int16_best_kernel(arch);
+    std::cout << "Selected architecture for the int16 multicorrelator is " << arch << std::endl;
+    return kernel;
+}
+
+
+Correlator_Int16::Correlator_Int16()
+{
+    d_buffer = 0;
+    d_stride = 0;
+    d_n_vectors = 0;
+    // The processor is the same for all the channels: select the kernels once
+    static carrier_wipeoff_int16_kernel best_carrier_wipeoff_kernel = select_carrier_wipeoff_int16_kernel();
+    d_carrier_wipeoff_kernel = best_carrier_wipeoff_kernel;
+    static multicorrelator_int16_kernel best_multicorrelator_kernel = select_multicorrelator_int16_kernel();
+    d_multicorrelator_kernel = best_multicorrelator_kernel;
+}
+
+
+Correlator_Int16::~Correlator_Int16()
+{
+    free(d_buffer);
+}
+
+
+void Correlator_Int16::reserve(int max_signal_length_samples, int n_correlators)
+{
+    const int stride = ((max_signal_length_samples + CORRELATOR_INT16_ALIGNMENT - 1) / CORRELATOR_INT16_ALIGNMENT) * CORRELATOR_INT16_ALIGNMENT;
+    const int n_vectors = 2 + n_correlators;
+    if (stride <= d_stride && n_vectors <= d_n_vectors)
+        {
+            return;
+        }
+    free(d_buffer);
+    d_buffer = 0;
+    d_stride = 0;
+    d_n_vectors = 0;
+    if (posix_memalign((void**)&d_buffer, 64, (size_t)stride * n_vectors * sizeof(int16_t)) == 0)
+        {
+            d_stride = stride;
+            d_n_vectors = n_vectors;
+        }
+    else
+        {
+            std::cout << "Correlator_Int16: unable to allocate the scratch buffers" << std::endl;
+        }
+}
+
+
+void Correlator_Int16::Carrier_wipeoff_and_multicorrelator_resampler(int signal_length_samples,
+        const lv_16sc_t* input, double carrier_phase_rad, double carrier_phase_step_rad,
+        const int16_t* code, int code_length, double code_phase, double code_phase_step,
+        int n_correlators, const double* tap_shifts, gr_complex* const* corr_out)
+{
+    if (signal_length_samples > d_stride || 2 + n_correlators > d_n_vectors)
+        {
+            reserve(signal_length_samples, n_correlators);
+        }
+    int16_t* bb_i = d_buffer;
+    int16_t* bb_q = d_buffer + d_stride;
+
+    // 2^32 is a carrier cycle
+    const double cycles_per_rad = 1.0 / (2.0 * M_PI);
+    const double phase_cycles = carrier_phase_rad * cycles_per_rad - floor(carrier_phase_rad * cycles_per_rad);
+    d_carrier_wipeoff_kernel(input, carrier_phase_int16(phase_cycles),
+            carrier_phase_int16(carrier_phase_step_rad * cycles_per_rad), bb_i, bb_q,
+            signal_length_samples);
+
+    // +1/-1 replicas from the code NCO, half an entry ahead for the nearest entry
+    Code_Nco code_nco;
+    code_nco.set_code_length(code_length);
+    code_nco.set_phase_step(code_phase_step);
+    if ((int)d_local_codes.size() < n_correlators)
+        {
+            d_local_codes.resize(n_correlators);
+            d_corr_i.resize(n_correlators);
+            d_corr_q.resize(n_correlators);
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            int16_t* replica = d_buffer + (2 + k) * d_stride;
+            code_nco.set_phase(code_phase + tap_shifts[k] + 0.5);
+            code_nco.generate(replica, code, signal_length_samples);
+            d_local_codes[k] = replica;
+        }
+
+    d_multicorrelator_kernel(bb_i, bb_q, n_correlators, &d_local_codes[0],
+            &d_corr_i[0], &d_corr_q[0], signal_length_samples);
+    for (int k = 0; k < n_correlators; k++)
+        {
+            *corr_out[k] = gr_complex((float)d_corr_i[k], (float)d_corr_q[k]);
+        }
+}
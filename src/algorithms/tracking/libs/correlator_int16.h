@@ -0,0 +1,88 @@
+/*!
+ * \file correlator_int16.h
+ * \brief Carrier wipe-off and correlators for complex 16-bit samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CORRELATOR_INT16_H_
+#define GNSS_SDR_CORRELATOR_INT16_H_
+
+#include <stdint.h>
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <volk/volk_complex.h>
+#include "multicorrelator_int16_kernels.h"
+
+
+/*!
+ * \brief Integer counterpart of Correlator::Carrier_wipeoff_and_multicorrelator_resampler,
+ * for sources that deliver complex 16-bit samples (or fewer bits).
+ *
+ * The baseband signal and the code replicas go to scratch buffers owned by
+ * the correlator, only reallocated when a longer signal arrives. A
+ * Correlator_Int16 must therefore not be shared between threads.
+ */
+class Correlator_Int16
+{
+public:
+    Correlator_Int16();
+    ~Correlator_Int16();
+
+    /*!
+     * \brief Performs the carrier wipe-off, with a carrier of phase
+     * \p carrier_phase_rad at the first sample advancing
+     * \p carrier_phase_step_rad per sample, and the correlation with
+     * \p n_correlators replicas of the +1/-1 code table \p code
+     * (\p code_length entries). The code phase arguments are those of
+     * Correlator::Carrier_wipeoff_and_multicorrelator_resampler. The
+     * correlations are written to *corr_out[k] in input sample units.
+     */
+    void Carrier_wipeoff_and_multicorrelator_resampler(int signal_length_samples,
+            const lv_16sc_t* input, double carrier_phase_rad, double carrier_phase_step_rad,
+            const int16_t* code, int code_length, double code_phase, double code_phase_step,
+            int n_correlators, const double* tap_shifts, gr_complex* const* corr_out);
+
+    /*!
+     * \brief Allocates the scratch buffers for signals of up to
+     * \p max_signal_length_samples samples and \p n_correlators taps.
+     */
+    void reserve(int max_signal_length_samples, int n_correlators);
+
+private:
+    Correlator_Int16(const Correlator_Int16&);
+    Correlator_Int16& operator=(const Correlator_Int16&);
+
+    int16_t* d_buffer;      // baseband I, baseband Q and the replicas
+    int d_stride;           // int16 values per vector of the buffer
+    int d_n_vectors;        // vectors in the buffer
+    std::vector<const int16_t*> d_local_codes;
+    std::vector<int32_t> d_corr_i;
+    std::vector<int32_t> d_corr_q;
+    carrier_wipeoff_int16_kernel d_carrier_wipeoff_kernel;
+    multicorrelator_int16_kernel d_multicorrelator_kernel;
+};
+
+#endif
@@ -47,6 +47,7 @@
  */
 
 #include "lock_detectors.h"
+#include <cmath>
 #include "GPS_L1_CA.h"
 #include "Galileo_E1.h"
 
@@ -111,3 +112,127 @@ float carrier_lock_detector(gr_complex* Prompt_buffer, int length)
     NBD = tmp_sum_I*tmp_sum_I - tmp_sum_Q*tmp_sum_Q;
     return NBD/NBP;
 }
+
+
+
+#define TRACKING_LOCK_DETECTOR_DEFAULT_LENGTH 20
+
+Tracking_Lock_Detector::Tracking_Lock_Detector()
+{
+    d_history = 0;
+    set_window(TRACKING_LOCK_DETECTOR_DEFAULT_LENGTH, false);
+}
+
+
+Tracking_Lock_Detector::~Tracking_Lock_Detector()
+{
+    delete[] d_history;
+}
+
+
+void Tracking_Lock_Detector::set_window(int length, bool exponential)
+{
+    delete[] d_history;
+    d_history = 0;
+    d_length = length > 0 ? length : 1;
+    d_exponential = exponential;
+    d_decay = 1.0 - 1.0 / (double)d_length;
+    if (d_exponential == false)
+        {
+            d_history = new gr_complex[d_length];
+        }
+    reset();
+}
+
+
+void Tracking_Lock_Detector::reset()
+{
+    d_index = 0;
+    d_count = 0;
+    d_sum_abs_i = 0.0;
+    d_sum_power = 0.0;
+    d_sum_i = 0.0;
+    d_sum_q = 0.0;
+    d_weight = 0.0;
+}
+
+
+void Tracking_Lock_Detector::update(const gr_complex& prompt)
+{
+    const double i = prompt.real();
+    const double q = prompt.imag();
+    if (d_exponential == true)
+        {
+            d_sum_abs_i = d_decay * d_sum_abs_i + std::abs(i);
+            d_sum_power = d_decay * d_sum_power + i * i + q * q;
+            d_sum_i = d_decay * d_sum_i + i;
+            d_sum_q = d_decay * d_sum_q + q;
+            d_weight = d_decay * d_weight + 1.0;
+        }
+    else
+        {
+            if (d_count >= d_length)
+                {
+                    // the oldest output leaves the window
+                    const double old_i = d_history[d_index].real();
+                    const double old_q = d_history[d_index].imag();
+                    d_sum_abs_i -= std::abs(old_i);
+                    d_sum_power -= old_i * old_i + old_q * old_q;
+                    d_sum_i -= old_i;
+                    d_sum_q -= old_q;
+                    d_weight -= 1.0;
+                }
+            d_history[d_index] = prompt;
+            d_sum_abs_i += std::abs(i);
+            d_sum_power += i * i + q * q;
+            d_sum_i += i;
+            d_sum_q += q;
+            d_weight += 1.0;
+            d_index++;
+            if (d_index == d_length)
+                {
+                    d_index = 0;
+                    // once per window, so that the rounding errors of the
+                    // subtractions do not build up
+                    resync();
+                }
+        }
+    if (d_count < d_length) d_count++;
+}
+
+
+void Tracking_Lock_Detector::resync()
+{
+    d_sum_abs_i = 0.0;
+    d_sum_power = 0.0;
+    d_sum_i = 0.0;
+    d_sum_q = 0.0;
+    for (int k = 0; k < d_length; k++)
+        {
+            const double i = d_history[k].real();
+            const double q = d_history[k].imag();
+            d_sum_abs_i += std::abs(i);
+            d_sum_power += i * i + q * q;
+            d_sum_i += i;
+            d_sum_q += q;
+        }
+    d_weight = d_length;
+}
+
+
+float Tracking_Lock_Detector::cn0_svn(long fs_in, double code_length) const
+{
+    float Psig = d_sum_abs_i / d_weight;
+    Psig = Psig * Psig;
+    float Ptot = d_sum_power / d_weight;
+    float SNR = Psig / (Ptot - Psig);
+    return 10 * log10(SNR) + 10 * log10(fs_in/2) - 10 * log10((float)code_length);
+}
+
+
+float Tracking_Lock_Detector::carrier_lock() const
+{
+    float NBP = d_sum_i * d_sum_i + d_sum_q * d_sum_q;
+    float NBD = d_sum_i * d_sum_i - d_sum_q * d_sum_q;
+    return NBD / NBP;
+}
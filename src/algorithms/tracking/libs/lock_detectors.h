@@ -92,4 +92,82 @@ float cn0_svn_estimator(gr_complex* Prompt_buffer, int length, long fs_in, doubl
  */
 float carrier_lock_detector(gr_complex* Prompt_buffer, int length);
 
+
+
+/*! \brief Streaming versions of cn0_svn_estimator() and
+ * carrier_lock_detector()
+ *
+ * The prompt correlator output of each integration is fed with update(),
+ * which costs the same whatever the window length, and both estimates can
+ * be read after every integration once the window has been filled.
+ * Instead of a buffer of prompt outputs, the detector keeps running sums of
+ * \f$|Re(Pc(i))|\f$, \f$|Pc(i)|^2\f$, \f$Re(Pc(i))\f$ and \f$Im(Pc(i))\f$ over
+ * either
+ * - a sliding window of the last N outputs, which gives the same values as
+ *   the functions above on those N outputs, or
+ * - an exponential window with a time constant of N outputs, which needs no
+ *   history at all.
+ */
+class Tracking_Lock_Detector
+{
+public:
+    Tracking_Lock_Detector();
+    ~Tracking_Lock_Detector();
+
+    /*!
+     * \brief Sets the window length, in integrations, and its type, and
+     * resets the detector.
+     */
+    void set_window(int length, bool exponential);
+
+    /*!
+     * \brief Empties the window, when the channel starts tracking.
+     */
+    void reset();
+
+    /*!
+     * \brief Adds the prompt correlator output of the last integration.
+     */
+    void update(const gr_complex& prompt);
+
+    /*!
+     * \brief True once the window has been filled since the last reset().
+     */
+    bool ready() const
+    {
+        return d_count >= d_length;
+    }
+
+    /*!
+     * \brief CN0 [dB-Hz] of the outputs in the window, as cn0_svn_estimator()
+     */
+    float cn0_svn(long fs_in, double code_length) const;
+
+    /*!
+     * \brief Carrier lock test of the outputs in the window, as
+     * carrier_lock_detector()
+     */
+    float carrier_lock() const;
+
+private:
+    Tracking_Lock_Detector(const Tracking_Lock_Detector&);
+    Tracking_Lock_Detector& operator=(const Tracking_Lock_Detector&);
+
+    void resync();
+
+    int d_length;
+    bool d_exponential;
+    double d_decay;          // exponential window: weight of the sums kept
+    gr_complex* d_history;   // sliding window: the outputs in the window
+    int d_index;             // sliding window: oldest output
+    int d_count;
+
+    // running sums
+    double d_sum_abs_i;
+    double d_sum_power;
+    double d_sum_i;
+    double d_sum_q;
+    double d_weight;
+};
+
 #endif
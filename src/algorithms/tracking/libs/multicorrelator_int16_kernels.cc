@@ -0,0 +1,154 @@
+/*!
+ * \file multicorrelator_int16_kernels.cc
+ * \brief Integer carrier wipe-off and N-tap correlation kernels for
+ * complex 16-bit samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "multicorrelator_int16_kernels.h"
+#include <cstring>
+
+// Correlators accumulated on each pass over the samples
+#define MULTICORRELATOR_INT16_TAPS_PER_PASS 5
+
+
+static int32_t* make_carrier_lut_int16()
+{
+    const int entries = 1 << CARRIER_LUT_INT16_BITS;
+    const double amplitude = (double)((1 << CARRIER_LUT_INT16_SCALE_BITS) - 1);
+    int32_t* lut = new int32_t[entries];
+    for (int k = 0; k < entries; k++)
+        {
+            const double phase_rad = 2.0 * M_PI * (double)k / (double)entries;
+            int16_t entry[2];
+            entry[0] = (int16_t)floor(amplitude * cos(phase_rad) + 0.5);
+            entry[1] = (int16_t)floor(amplitude * sin(phase_rad) + 0.5);
+            memcpy(&lut[k], entry, sizeof(int32_t));
+        }
+    return lut;
+}
+
+
+const int32_t* carrier_lut_int16()
+{
+    // Built once, never freed
+    static const int32_t* lut = make_carrier_lut_int16();
+    return lut;
+}
+
+
+static inline int16_t saturate_int16(int32_t value)
+{
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return (int16_t)value;
+}
+
+
+void carrier_wipeoff_int16_generic(const lv_16sc_t* input,
+        uint32_t carrier_phase, uint32_t carrier_phase_step,
+        int16_t* bb_i, int16_t* bb_q, int num_points)
+{
+    const int16_t* lut = (const int16_t*)carrier_lut_int16();
+    const int32_t rounding = 1 << (CARRIER_LUT_INT16_SCALE_BITS - 1);
+    // Half a table entry ahead, so that the index rounds to the nearest entry
+    uint32_t phase = carrier_phase + (1u << (31 - CARRIER_LUT_INT16_BITS));
+    for (int i = 0; i < num_points; i++)
+        {
+            const int index = phase >> (32 - CARRIER_LUT_INT16_BITS);
+            const int32_t c = lut[2 * index];
+            const int32_t s = lut[2 * index + 1];
+            const int32_t x_i = input[i].real();
+            const int32_t x_q = input[i].imag();
+            // (x_i + j x_q) * (c - j s)
+            bb_i[i] = saturate_int16((x_i * c + x_q * s + rounding) >> CARRIER_LUT_INT16_SCALE_BITS);
+            bb_q[i] = saturate_int16((x_q * c - x_i * s + rounding) >> CARRIER_LUT_INT16_SCALE_BITS);
+            phase += carrier_phase_step;
+        }
+}
+
+
+void multicorrelator_int16_generic(const int16_t* bb_i, const int16_t* bb_q,
+        int n_correlators, const int16_t* const* local_codes,
+        int32_t* corr_i, int32_t* corr_q, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_INT16_TAPS_PER_PASS)
+        {
+            int last = first + MULTICORRELATOR_INT16_TAPS_PER_PASS;
+            if (last > n_correlators) last = n_correlators;
+            int32_t acc_i[MULTICORRELATOR_INT16_TAPS_PER_PASS] = {0};
+            int32_t acc_q[MULTICORRELATOR_INT16_TAPS_PER_PASS] = {0};
+            for (int i = 0; i < num_points; i++)
+                {
+                    const int32_t x_i = bb_i[i];
+                    const int32_t x_q = bb_q[i];
+                    for (int k = first; k < last; k++)
+                        {
+                            acc_i[k - first] += x_i * local_codes[k][i];
+                            acc_q[k - first] += x_q * local_codes[k][i];
+                        }
+                }
+            for (int k = first; k < last; k++)
+                {
+                    corr_i[k] = acc_i[k - first];
+                    corr_q[k] = acc_q[k - first];
+                }
+        }
+}
+
+
+carrier_wipeoff_int16_kernel carrier_wipeoff_int16_best_kernel(std::string& name)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef HAVE_MULTICORRELATOR_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        {
+            name = "avx2";
+            return carrier_wipeoff_int16_avx2;
+        }
+#endif
+#endif
+    name = "generic";
+    return carrier_wipeoff_int16_generic;
+}
+
+
+multicorrelator_int16_kernel multicorrelator_int16_best_kernel(std::string& name)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef HAVE_MULTICORRELATOR_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        {
+            name = "avx2";
+            return multicorrelator_int16_avx2;
+        }
+#endif
+#endif
+    name = "generic";
+    return multicorrelator_int16_generic;
+}
@@ -0,0 +1,127 @@
+/*!
+ * \file multicorrelator_int16_kernels.h
+ * \brief Integer carrier wipe-off and N-tap correlation kernels for
+ * complex 16-bit samples
+ *
+ * The carrier is read from a table of 2^CARRIER_LUT_INT16_BITS phases
+ * indexed by the most significant bits of a 32-bit phase accumulator, the
+ * baseband signal is kept as 16-bit integers and the code replicas are +1/-1
+ * 16-bit integers, so that every multiply-accumulate works on twice as many
+ * SIMD lanes as the floating point kernels and the signal takes half the
+ * memory. The products are summed in 32-bit lanes (pmaddwd).
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_MULTICORRELATOR_INT16_KERNELS_H_
+#define GNSS_SDR_MULTICORRELATOR_INT16_KERNELS_H_
+
+#include <stdint.h>
+#include <cmath>
+#include <string>
+#include <volk/volk_complex.h>
+
+/*!
+ * \brief log2 of the number of entries of the carrier table. The phase
+ * error of a 256-entry table is below pi/256 rad.
+ */
+#define CARRIER_LUT_INT16_BITS 8
+
+/*!
+ * \brief Fractional bits of the carrier table amplitude: the baseband
+ * signal keeps the scale of the input samples.
+ */
+#define CARRIER_LUT_INT16_SCALE_BITS 14
+
+/*!
+ * \brief Returns the carrier table: entry k holds cos(2*pi*k/N) and
+ * sin(2*pi*k/N) (in this order) as 16-bit integers scaled by
+ * 2^CARRIER_LUT_INT16_SCALE_BITS, packed in 32 bits so that a SIMD gather
+ * reads both.
+ */
+const int32_t* carrier_lut_int16();
+
+/*!
+ * \brief Converts a phase in cycles to the 32-bit carrier phase accumulator
+ * (2^32 is a cycle).
+ */
+inline uint32_t carrier_phase_int16(double phase_cycles)
+{
+    return (uint32_t)(int64_t)floor(phase_cycles * 4294967296.0 + 0.5);
+}
+
+/*!
+ * \brief Carrier wipe-off:
+ * bb_i[i] + j bb_q[i] = input[i] * exp(-j * 2 * pi * phase_i / 2^32), with
+ * phase_i = carrier_phase + i * carrier_phase_step (modulo 2^32).
+ *
+ * The result is rounded and saturated to 16 bits. No vector needs to be
+ * aligned.
+ */
+typedef void (*carrier_wipeoff_int16_kernel)(const lv_16sc_t* input,
+        uint32_t carrier_phase, uint32_t carrier_phase_step,
+        int16_t* bb_i, int16_t* bb_q, int num_points);
+
+void carrier_wipeoff_int16_generic(const lv_16sc_t* input,
+        uint32_t carrier_phase, uint32_t carrier_phase_step,
+        int16_t* bb_i, int16_t* bb_q, int num_points);
+
+#ifdef HAVE_MULTICORRELATOR_AVX2
+void carrier_wipeoff_int16_avx2(const lv_16sc_t* input,
+        uint32_t carrier_phase, uint32_t carrier_phase_step,
+        int16_t* bb_i, int16_t* bb_q, int num_points);
+#endif
+
+/*!
+ * \brief Correlation of the baseband signal with \p n_correlators local
+ * codes of +1/-1 values:
+ * corr_i[k] = sum_i bb_i[i] * local_codes[k][i], and the same for corr_q.
+ *
+ * The sums are accumulated in 32 bits: with full scale 16-bit samples they
+ * do not overflow for up to 65536 samples. No vector needs to be aligned.
+ */
+typedef void (*multicorrelator_int16_kernel)(const int16_t* bb_i,
+        const int16_t* bb_q, int n_correlators,
+        const int16_t* const* local_codes, int32_t* corr_i, int32_t* corr_q,
+        int num_points);
+
+void multicorrelator_int16_generic(const int16_t* bb_i, const int16_t* bb_q,
+        int n_correlators, const int16_t* const* local_codes,
+        int32_t* corr_i, int32_t* corr_q, int num_points);
+
+#ifdef HAVE_MULTICORRELATOR_AVX2
+void multicorrelator_int16_avx2(const int16_t* bb_i, const int16_t* bb_q,
+        int n_correlators, const int16_t* const* local_codes,
+        int32_t* corr_i, int32_t* corr_q, int num_points);
+#endif
+
+/*!
+ * \brief Return the fastest kernels supported by this processor, and
+ * their name in \p name ("generic" or "avx2").
+ */
+carrier_wipeoff_int16_kernel carrier_wipeoff_int16_best_kernel(std::string& name);
+multicorrelator_int16_kernel multicorrelator_int16_best_kernel(std::string& name);
+
+#endif /* GNSS_SDR_MULTICORRELATOR_INT16_KERNELS_H_ */
@@ -0,0 +1,145 @@
+/*!
+ * \file multicorrelator_int16_kernels_avx2.cc
+ * \brief AVX2 versions of the integer carrier wipe-off and correlation
+ * kernels, built with the AVX2 flags and only called when the processor
+ * supports them.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "multicorrelator_int16_kernels.h"
+#include <immintrin.h>
+
+// Correlators accumulated in registers on each pass over the samples
+#define MULTICORRELATOR_INT16_AVX2_TAPS_PER_PASS 5
+
+
+void carrier_wipeoff_int16_avx2(const lv_16sc_t* input,
+        uint32_t carrier_phase, uint32_t carrier_phase_step,
+        int16_t* bb_i, int16_t* bb_q, int num_points)
+{
+    const int* lut = (const int*)carrier_lut_int16();
+    const __m256i rounding = _mm256_set1_epi32(1 << (CARRIER_LUT_INT16_SCALE_BITS - 1));
+    // turns (c, s) pairs into (-s, c)
+    const __m256i negate_first = _mm256_set1_epi32(0x0001FFFF);
+    const __m256i step8 = _mm256_set1_epi32((int)(8 * carrier_phase_step));
+    // Half a table entry ahead, as in the generic kernel
+    __m256i phase = _mm256_add_epi32(_mm256_set1_epi32((int)(carrier_phase + (1u << (31 - CARRIER_LUT_INT16_BITS)))),
+            _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)carrier_phase_step)));
+    const int vector_points = num_points / 16;
+    for (int n = 0; n < vector_points; n++)
+        {
+            __m256i acc_i[2];
+            __m256i acc_q[2];
+            for (int h = 0; h < 2; h++)
+                {
+                    // 8 complex samples and their carrier (cos, sin) pairs
+                    const __m256i x = _mm256_loadu_si256((const __m256i*)(input + 16 * n + 8 * h));
+                    const __m256i index = _mm256_srli_epi32(phase, 32 - CARRIER_LUT_INT16_BITS);
+                    const __m256i cs = _mm256_i32gather_epi32(lut, index, 4);
+                    const __m256i sc = _mm256_sign_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(cs, 0xB1), 0xB1), negate_first);
+                    acc_i[h] = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(x, cs), rounding), CARRIER_LUT_INT16_SCALE_BITS);
+                    acc_q[h] = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(x, sc), rounding), CARRIER_LUT_INT16_SCALE_BITS);
+                    phase = _mm256_add_epi32(phase, step8);
+                }
+            // packs works within 128-bit lanes: restore the sample order
+            _mm256_storeu_si256((__m256i*)(bb_i + 16 * n), _mm256_permute4x64_epi64(_mm256_packs_epi32(acc_i[0], acc_i[1]), 0xD8));
+            _mm256_storeu_si256((__m256i*)(bb_q + 16 * n), _mm256_permute4x64_epi64(_mm256_packs_epi32(acc_q[0], acc_q[1]), 0xD8));
+        }
+    const int done = vector_points * 16;
+    if (done < num_points)
+        {
+            carrier_wipeoff_int16_generic(input + done, carrier_phase + (uint32_t)done * carrier_phase_step,
+                    carrier_phase_step, bb_i + done, bb_q + done, num_points - done);
+        }
+}
+
+
+static inline int32_t horizontal_sum(__m256i v)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+
+template <int N>
+static void multicorrelator_int16_avx2_pass(const int16_t* bb_i, const int16_t* bb_q,
+        const int16_t* const* local_codes, int32_t* corr_i, int32_t* corr_q, int num_points)
+{
+    __m256i acc_i[N];
+    __m256i acc_q[N];
+    for (int k = 0; k < N; k++)
+        {
+            acc_i[k] = _mm256_setzero_si256();
+            acc_q[k] = _mm256_setzero_si256();
+        }
+    const int vector_points = num_points / 16;
+    for (int n = 0; n < vector_points; n++)
+        {
+            const __m256i x_i = _mm256_loadu_si256((const __m256i*)(bb_i + 16 * n));
+            const __m256i x_q = _mm256_loadu_si256((const __m256i*)(bb_q + 16 * n));
+            for (int k = 0; k < N; k++)
+                {
+                    const __m256i y = _mm256_loadu_si256((const __m256i*)(local_codes[k] + 16 * n));
+                    acc_i[k] = _mm256_add_epi32(acc_i[k], _mm256_madd_epi16(x_i, y));
+                    acc_q[k] = _mm256_add_epi32(acc_q[k], _mm256_madd_epi16(x_q, y));
+                }
+        }
+    for (int k = 0; k < N; k++)
+        {
+            int32_t result_i = horizontal_sum(acc_i[k]);
+            int32_t result_q = horizontal_sum(acc_q[k]);
+            for (int i = vector_points * 16; i < num_points; i++)
+                {
+                    result_i += bb_i[i] * local_codes[k][i];
+                    result_q += bb_q[i] * local_codes[k][i];
+                }
+            corr_i[k] = result_i;
+            corr_q[k] = result_q;
+        }
+}
+
+
+void multicorrelator_int16_avx2(const int16_t* bb_i, const int16_t* bb_q,
+        int n_correlators, const int16_t* const* local_codes,
+        int32_t* corr_i, int32_t* corr_q, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_INT16_AVX2_TAPS_PER_PASS)
+        {
+            const int16_t* const* codes = local_codes + first;
+            int32_t* out_i = corr_i + first;
+            int32_t* out_q = corr_q + first;
+            switch (n_correlators - first)
+            {
+            case 1: multicorrelator_int16_avx2_pass<1>(bb_i, bb_q, codes, out_i, out_q, num_points); break;
+            case 2: multicorrelator_int16_avx2_pass<2>(bb_i, bb_q, codes, out_i, out_q, num_points); break;
+            case 3: multicorrelator_int16_avx2_pass<3>(bb_i, bb_q, codes, out_i, out_q, num_points); break;
+            case 4: multicorrelator_int16_avx2_pass<4>(bb_i, bb_q, codes, out_i, out_q, num_points); break;
+            default: multicorrelator_int16_avx2_pass<5>(bb_i, bb_q, codes, out_i, out_q, num_points); break;
+            }
+        }
+}
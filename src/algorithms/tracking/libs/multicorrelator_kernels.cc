@@ -0,0 +1,246 @@
+/*!
+ * \file multicorrelator_kernels.cc
+ * \brief Fused carrier wipe-off and N-tap correlation kernels: generic and
+ * NEON versions, and run-time selection of the best kernel
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "multicorrelator_kernels.h"
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Correlators accumulated in registers on each pass over the samples
+#define MULTICORRELATOR_TAPS_PER_PASS 5
+
+
+void multicorrelator_generic(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_TAPS_PER_PASS)
+        {
+            int taps = n_correlators - first;
+            if (taps > MULTICORRELATOR_TAPS_PER_PASS) taps = MULTICORRELATOR_TAPS_PER_PASS;
+            float acc_real[MULTICORRELATOR_TAPS_PER_PASS] = {0};
+            float acc_imag[MULTICORRELATOR_TAPS_PER_PASS] = {0};
+            for (int i = 0; i < num_points; i++)
+                {
+                    // Real arithmetic: std::complex products check for NaN
+                    const float bb_real = input[i].real() * carrier[i].real() - input[i].imag() * carrier[i].imag();
+                    const float bb_imag = input[i].real() * carrier[i].imag() + input[i].imag() * carrier[i].real();
+                    for (int k = 0; k < taps; k++)
+                        {
+                            const gr_complex code = local_codes[first + k][i];
+                            acc_real[k] += bb_real * code.real() - bb_imag * code.imag();
+                            acc_imag[k] += bb_real * code.imag() + bb_imag * code.real();
+                        }
+                }
+            for (int k = 0; k < taps; k++)
+                {
+                    *corr_out[first + k] = gr_complex(acc_real[k], acc_imag[k]);
+                }
+        }
+}
+
+
+template <int N>
+static void multicorrelator_resampler_generic_pass(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points)
+{
+    const uint64_t code_wrap = (uint64_t)code_length << CODE_NCO_FRACTIONAL_BITS;
+    uint64_t phase[N];
+    float acc_real[N];
+    float acc_imag[N];
+    for (int k = 0; k < N; k++)
+        {
+            phase[k] = tap_phases[k];
+            acc_real[k] = 0.0;
+            acc_imag[k] = 0.0;
+        }
+    for (int i = 0; i < num_points; i++)
+        {
+            const float bb_real = input[i].real() * carrier[i].real() - input[i].imag() * carrier[i].imag();
+            const float bb_imag = input[i].real() * carrier[i].imag() + input[i].imag() * carrier[i].real();
+            for (int k = 0; k < N; k++)
+                {
+                    const gr_complex c = code[phase[k] >> CODE_NCO_FRACTIONAL_BITS];
+                    acc_real[k] += bb_real * c.real() - bb_imag * c.imag();
+                    acc_imag[k] += bb_real * c.imag() + bb_imag * c.real();
+                    phase[k] += phase_step;
+                    if (phase[k] >= code_wrap) phase[k] -= code_wrap;
+                }
+        }
+    for (int k = 0; k < N; k++)
+        {
+            *corr_out[k] = gr_complex(acc_real[k], acc_imag[k]);
+        }
+}
+
+
+void multicorrelator_resampler_generic(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_TAPS_PER_PASS)
+        {
+            const uint64_t* phases = tap_phases + first;
+            gr_complex* const* out = corr_out + first;
+            switch (n_correlators - first)
+            {
+            case 1: multicorrelator_resampler_generic_pass<1>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 2: multicorrelator_resampler_generic_pass<2>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 3: multicorrelator_resampler_generic_pass<3>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 4: multicorrelator_resampler_generic_pass<4>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            default: multicorrelator_resampler_generic_pass<5>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            }
+        }
+}
+
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+template <int N>
+static void multicorrelator_neon_pass(const gr_complex* input, const gr_complex* carrier,
+        const gr_complex* const* local_codes, gr_complex* const* corr_out, int num_points)
+{
+    float32x4_t acc_real[N];
+    float32x4_t acc_imag[N];
+    for (int k = 0; k < N; k++)
+        {
+            acc_real[k] = vdupq_n_f32(0.0);
+            acc_imag[k] = vdupq_n_f32(0.0);
+        }
+    const int quarter_points = num_points / 4;
+    for (int n = 0; n < quarter_points; n++)
+        {
+            // Four complex samples, deinterleaved into real and imaginary parts
+            const float32x4x2_t x = vld2q_f32((const float*)(input + 4 * n));
+            const float32x4x2_t c = vld2q_f32((const float*)(carrier + 4 * n));
+            float32x4_t bb_real = vmulq_f32(x.val[0], c.val[0]);
+            bb_real = vmlsq_f32(bb_real, x.val[1], c.val[1]);
+            float32x4_t bb_imag = vmulq_f32(x.val[0], c.val[1]);
+            bb_imag = vmlaq_f32(bb_imag, x.val[1], c.val[0]);
+            for (int k = 0; k < N; k++)
+                {
+                    const float32x4x2_t y = vld2q_f32((const float*)(local_codes[k] + 4 * n));
+                    acc_real[k] = vmlaq_f32(acc_real[k], bb_real, y.val[0]);
+                    acc_real[k] = vmlsq_f32(acc_real[k], bb_imag, y.val[1]);
+                    acc_imag[k] = vmlaq_f32(acc_imag[k], bb_real, y.val[1]);
+                    acc_imag[k] = vmlaq_f32(acc_imag[k], bb_imag, y.val[0]);
+                }
+        }
+    for (int k = 0; k < N; k++)
+        {
+            float real[4];
+            float imag[4];
+            vst1q_f32(real, acc_real[k]);
+            vst1q_f32(imag, acc_imag[k]);
+            gr_complex result(real[0] + real[1] + real[2] + real[3], imag[0] + imag[1] + imag[2] + imag[3]);
+            for (int i = quarter_points * 4; i < num_points; i++)
+                {
+                    result += input[i] * carrier[i] * local_codes[k][i];
+                }
+            *corr_out[k] = result;
+        }
+}
+
+
+void multicorrelator_neon(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_TAPS_PER_PASS)
+        {
+            const gr_complex* const* codes = local_codes + first;
+            gr_complex* const* out = corr_out + first;
+            switch (n_correlators - first)
+            {
+            case 1: multicorrelator_neon_pass<1>(input, carrier, codes, out, num_points); break;
+            case 2: multicorrelator_neon_pass<2>(input, carrier, codes, out, num_points); break;
+            case 3: multicorrelator_neon_pass<3>(input, carrier, codes, out, num_points); break;
+            case 4: multicorrelator_neon_pass<4>(input, carrier, codes, out, num_points); break;
+            default: multicorrelator_neon_pass<5>(input, carrier, codes, out, num_points); break;
+            }
+        }
+}
+#endif
+
+
+multicorrelator_kernel multicorrelator_best_kernel(std::string& name)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef HAVE_MULTICORRELATOR_AVX512
+    if (__builtin_cpu_supports("avx512f"))
+        {
+            name = "avx512";
+            return multicorrelator_avx512;
+        }
+#endif
+#ifdef HAVE_MULTICORRELATOR_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            name = "avx2";
+            return multicorrelator_avx2;
+        }
+#endif
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    name = "neon";
+    return multicorrelator_neon;
+#else
+    name = "generic";
+    return multicorrelator_generic;
+#endif
+}
+
+
+multicorrelator_resampler_kernel multicorrelator_resampler_best_kernel(std::string& name)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef HAVE_MULTICORRELATOR_AVX512
+    if (__builtin_cpu_supports("avx512f"))
+        {
+            name = "avx512";
+            return multicorrelator_resampler_avx512;
+        }
+#endif
+#ifdef HAVE_MULTICORRELATOR_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            name = "avx2";
+            return multicorrelator_resampler_avx2;
+        }
+#endif
+#endif
+    // NEON has no gather: the generic version is used on ARM
+    name = "generic";
+    return multicorrelator_resampler_generic;
+}
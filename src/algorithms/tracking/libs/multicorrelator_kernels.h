@@ -0,0 +1,126 @@
+/*!
+ * \file multicorrelator_kernels.h
+ * \brief Fused carrier wipe-off and N-tap correlation kernels
+ *
+ * Each kernel reads the input and carrier samples once, forms the baseband
+ * sample in registers and accumulates its product with every local code
+ * replica, instead of writing the baseband signal to memory and reading it
+ * back once per correlator. The resampler kernels also generate the code
+ * replicas on the fly from a table with one entry per chip (or per
+ * subcarrier half chip), driven by a fixed-point code NCO, so that no
+ * replica is written to memory either. The best kernels for the processor
+ * running the receiver are selected at run time.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_MULTICORRELATOR_KERNELS_H_
+#define GNSS_SDR_MULTICORRELATOR_KERNELS_H_
+
+#include <stdint.h>
+#include <string>
+#include <gnuradio/gr_complex.h>
+#include "code_nco.h"
+
+/*!
+ * \brief Performs the carrier wipe-off and the correlation with
+ * \p n_correlators local code replicas in a single pass:
+ * corr_out[k] = sum_i input[i] * carrier[i] * local_codes[k][i].
+ *
+ * No vector needs to be aligned.
+ */
+typedef void (*multicorrelator_kernel)(const gr_complex* input,
+        const gr_complex* carrier, int n_correlators,
+        const gr_complex* const* local_codes, gr_complex* const* corr_out,
+        int num_points);
+
+void multicorrelator_generic(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points);
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+void multicorrelator_neon(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points);
+#endif
+
+#ifdef HAVE_MULTICORRELATOR_AVX2
+void multicorrelator_avx2(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points);
+#endif
+
+#ifdef HAVE_MULTICORRELATOR_AVX512
+void multicorrelator_avx512(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points);
+#endif
+
+/*!
+ * \brief Returns the fastest kernel supported by this processor, and its
+ * name in \p name ("generic", "neon", "avx2" or "avx512").
+ */
+multicorrelator_kernel multicorrelator_best_kernel(std::string& name);
+
+/*!
+ * \brief Performs the carrier wipe-off and the correlation with
+ * \p n_correlators code replicas read from the table \p code of
+ * \p code_length entries in a single pass.
+ *
+ * The replica of tap k at sample i is the code table entry of a Code_Nco
+ * phase that starts at tap_phases[k] and advances \p phase_step (less than
+ * code_length / 8 entries) per sample, wrapping around the table.
+ */
+typedef void (*multicorrelator_resampler_kernel)(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points);
+
+void multicorrelator_resampler_generic(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points);
+
+#ifdef HAVE_MULTICORRELATOR_AVX2
+void multicorrelator_resampler_avx2(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points);
+#endif
+
+#ifdef HAVE_MULTICORRELATOR_AVX512
+void multicorrelator_resampler_avx512(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points);
+#endif
+
+/*!
+ * \brief Returns the fastest resampler kernel supported by this processor,
+ * and its name in \p name ("generic", "avx2" or "avx512").
+ */
+multicorrelator_resampler_kernel multicorrelator_resampler_best_kernel(std::string& name);
+
+#endif /* GNSS_SDR_MULTICORRELATOR_KERNELS_H_ */
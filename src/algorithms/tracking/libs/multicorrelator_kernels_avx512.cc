@@ -0,0 +1,199 @@
+/*!
+ * \file multicorrelator_kernels_avx512.cc
+ * \brief AVX-512 version of the fused carrier wipe-off and N-tap correlation
+ * kernels. This file is compiled with -mavx512f and its kernels are only called
+ * when the processor supports them.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "multicorrelator_kernels.h"
+#include <immintrin.h>
+
+// Correlators accumulated in registers on each pass over the samples
+#define MULTICORRELATOR_AVX512_TAPS_PER_PASS 8
+
+
+template <int N>
+static void multicorrelator_avx512_pass(const gr_complex* input, const gr_complex* carrier,
+        const gr_complex* const* local_codes, gr_complex* const* corr_out, int num_points)
+{
+    // The products of the baseband samples with the real and the imaginary
+    // parts of the code are accumulated separately, and combined at the end
+    __m512 acc_real_code[N];
+    __m512 acc_imag_code[N];
+    for (int k = 0; k < N; k++)
+        {
+            acc_real_code[k] = _mm512_setzero_ps();
+            acc_imag_code[k] = _mm512_setzero_ps();
+        }
+    const int vector_points = num_points / 8;
+    for (int n = 0; n < vector_points; n++)
+        {
+            // carrier wipe-off of 8 complex samples
+            const __m512 x = _mm512_loadu_ps((const float*)(input + 8 * n));
+            const __m512 c = _mm512_loadu_ps((const float*)(carrier + 8 * n));
+            const __m512 x_swap = _mm512_permute_ps(x, 0xB1);
+            const __m512 bb = _mm512_fmaddsub_ps(x, _mm512_moveldup_ps(c), _mm512_mul_ps(x_swap, _mm512_movehdup_ps(c)));
+            const __m512 bb_swap = _mm512_permute_ps(bb, 0xB1);
+            for (int k = 0; k < N; k++)
+                {
+                    const __m512 y = _mm512_loadu_ps((const float*)(local_codes[k] + 8 * n));
+                    acc_real_code[k] = _mm512_fmadd_ps(bb, _mm512_moveldup_ps(y), acc_real_code[k]);
+                    acc_imag_code[k] = _mm512_fmadd_ps(bb_swap, _mm512_movehdup_ps(y), acc_imag_code[k]);
+                }
+        }
+    for (int k = 0; k < N; k++)
+        {
+            __attribute__((aligned(64))) gr_complex partial[8];
+            _mm512_store_ps((float*)partial, _mm512_fmaddsub_ps(acc_real_code[k], _mm512_set1_ps(1.0), acc_imag_code[k]));
+            gr_complex result(0.0, 0.0);
+            for (int j = 0; j < 8; j++)
+                {
+                    result += partial[j];
+                }
+            for (int i = vector_points * 8; i < num_points; i++)
+                {
+                    result += input[i] * carrier[i] * local_codes[k][i];
+                }
+            *corr_out[k] = result;
+        }
+}
+
+
+void multicorrelator_avx512(const gr_complex* input, const gr_complex* carrier,
+        int n_correlators, const gr_complex* const* local_codes,
+        gr_complex* const* corr_out, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_AVX512_TAPS_PER_PASS)
+        {
+            const gr_complex* const* codes = local_codes + first;
+            gr_complex* const* out = corr_out + first;
+            switch (n_correlators - first)
+            {
+            case 1: multicorrelator_avx512_pass<1>(input, carrier, codes, out, num_points); break;
+            case 2: multicorrelator_avx512_pass<2>(input, carrier, codes, out, num_points); break;
+            case 3: multicorrelator_avx512_pass<3>(input, carrier, codes, out, num_points); break;
+            case 4: multicorrelator_avx512_pass<4>(input, carrier, codes, out, num_points); break;
+            case 5: multicorrelator_avx512_pass<5>(input, carrier, codes, out, num_points); break;
+            case 6: multicorrelator_avx512_pass<6>(input, carrier, codes, out, num_points); break;
+            case 7: multicorrelator_avx512_pass<7>(input, carrier, codes, out, num_points); break;
+            default: multicorrelator_avx512_pass<8>(input, carrier, codes, out, num_points); break;
+            }
+        }
+}
+
+
+template <int N>
+static void multicorrelator_resampler_avx512_pass(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points)
+{
+    const uint64_t code_wrap = (uint64_t)code_length << CODE_NCO_FRACTIONAL_BITS;
+    const __m512i wrap = _mm512_set1_epi64((long long)code_wrap);
+    const __m512i step = _mm512_set1_epi64((long long)(8 * phase_step));
+    __m512i phase[N];  // code NCO phases of 8 consecutive samples
+    __m512 acc_real_code[N];
+    __m512 acc_imag_code[N];
+    for (int k = 0; k < N; k++)
+        {
+            long long lanes[8];
+            uint64_t p = tap_phases[k];
+            for (int j = 0; j < 8; j++)
+                {
+                    lanes[j] = (long long)p;
+                    p += phase_step;
+                    if (p >= code_wrap) p -= code_wrap;
+                }
+            phase[k] = _mm512_loadu_si512(lanes);
+            acc_real_code[k] = _mm512_setzero_ps();
+            acc_imag_code[k] = _mm512_setzero_ps();
+        }
+    const int vector_points = num_points / 8;
+    for (int n = 0; n < vector_points; n++)
+        {
+            const __m512 x = _mm512_loadu_ps((const float*)(input + 8 * n));
+            const __m512 c = _mm512_loadu_ps((const float*)(carrier + 8 * n));
+            const __m512 x_swap = _mm512_permute_ps(x, 0xB1);
+            const __m512 bb = _mm512_fmaddsub_ps(x, _mm512_moveldup_ps(c), _mm512_mul_ps(x_swap, _mm512_movehdup_ps(c)));
+            const __m512 bb_swap = _mm512_permute_ps(bb, 0xB1);
+            for (int k = 0; k < N; k++)
+                {
+                    // A complex float is 8 bytes: gather the code samples as doubles
+                    const __m512i index = _mm512_srli_epi64(phase[k], CODE_NCO_FRACTIONAL_BITS);
+                    const __m512 y = _mm512_castpd_ps(_mm512_i64gather_pd(index, (const double*)code, 8));
+                    acc_real_code[k] = _mm512_fmadd_ps(bb, _mm512_moveldup_ps(y), acc_real_code[k]);
+                    acc_imag_code[k] = _mm512_fmadd_ps(bb_swap, _mm512_movehdup_ps(y), acc_imag_code[k]);
+                    phase[k] = _mm512_add_epi64(phase[k], step);
+                    const __mmask8 wrapped = _mm512_cmpge_epu64_mask(phase[k], wrap);
+                    phase[k] = _mm512_mask_sub_epi64(phase[k], wrapped, phase[k], wrap);
+                }
+        }
+    for (int k = 0; k < N; k++)
+        {
+            __attribute__((aligned(64))) gr_complex partial[8];
+            _mm512_store_ps((float*)partial, _mm512_fmaddsub_ps(acc_real_code[k], _mm512_set1_ps(1.0), acc_imag_code[k]));
+            gr_complex result(0.0, 0.0);
+            for (int j = 0; j < 8; j++)
+                {
+                    result += partial[j];
+                }
+            long long lanes[8];
+            _mm512_storeu_si512(lanes, phase[k]);
+            uint64_t p = (uint64_t)lanes[0];
+            for (int i = vector_points * 8; i < num_points; i++)
+                {
+                    result += input[i] * carrier[i] * code[p >> CODE_NCO_FRACTIONAL_BITS];
+                    p += phase_step;
+                    if (p >= code_wrap) p -= code_wrap;
+                }
+            *corr_out[k] = result;
+        }
+}
+
+
+void multicorrelator_resampler_avx512(const gr_complex* input,
+        const gr_complex* carrier, const gr_complex* code, int code_length,
+        int n_correlators, const uint64_t* tap_phases, uint64_t phase_step,
+        gr_complex* const* corr_out, int num_points)
+{
+    for (int first = 0; first < n_correlators; first += MULTICORRELATOR_AVX512_TAPS_PER_PASS)
+        {
+            const uint64_t* phases = tap_phases + first;
+            gr_complex* const* out = corr_out + first;
+            switch (n_correlators - first)
+            {
+            case 1: multicorrelator_resampler_avx512_pass<1>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 2: multicorrelator_resampler_avx512_pass<2>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 3: multicorrelator_resampler_avx512_pass<3>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 4: multicorrelator_resampler_avx512_pass<4>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 5: multicorrelator_resampler_avx512_pass<5>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 6: multicorrelator_resampler_avx512_pass<6>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            case 7: multicorrelator_resampler_avx512_pass<7>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            default: multicorrelator_resampler_avx512_pass<8>(input, carrier, code, code_length, phases, phase_step, out, num_points); break;
+            }
+        }
+}
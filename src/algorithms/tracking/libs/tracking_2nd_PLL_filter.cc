@@ -58,6 +58,13 @@ void Tracking_2nd_PLL_filter::set_PLL_BW(float pll_bw_hz)
 
 
 
+void Tracking_2nd_PLL_filter::set_pdi(float pdi_carr)
+{
+    d_pdi_carr = pdi_carr; // Summation interval for carrier
+}
+
+
+
 void Tracking_2nd_PLL_filter::initialize()
 {
     // carrier/Costas loop parameters
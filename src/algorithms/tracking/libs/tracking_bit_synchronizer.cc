@@ -0,0 +1,123 @@
+/*!
+ * \file tracking_bit_synchronizer.cc
+ * \brief Histogram bit synchronizer: finds the data bit edges in the
+ * sequence of prompt correlator outputs, one per code period.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tracking_bit_synchronizer.h"
+#include <algorithm>
+
+// Sign changes needed before looking for the edge (about 80 data bits)
+#define BIT_SYNC_MIN_TRANSITIONS 40
+// Sign changes after which the histogram is restarted if no edge was found
+#define BIT_SYNC_MAX_TRANSITIONS 400
+// The edge needs this many times the sign changes of any other code period
+#define BIT_SYNC_EDGE_RATIO 4
+// Excess of sign changes away from the edge that drops the synchronization
+#define BIT_SYNC_MAX_MISALIGNED 10
+
+
+Tracking_Bit_Synchronizer::Tracking_Bit_Synchronizer()
+{
+    set_symbols_per_bit(20);
+}
+
+
+void Tracking_Bit_Synchronizer::set_symbols_per_bit(int symbols_per_bit)
+{
+    d_symbols_per_bit = std::max(symbols_per_bit, 1);
+    d_histogram.assign(d_symbols_per_bit, 0);
+    reset();
+}
+
+
+void Tracking_Bit_Synchronizer::reset()
+{
+    std::fill(d_histogram.begin(), d_histogram.end(), 0);
+    d_symbol_index = 0;
+    d_transitions = 0;
+    d_misaligned_transitions = 0;
+    d_edge_index = 0;
+    d_last_sign = false;
+    d_first_symbol = true;
+    d_synchronized = false;
+}
+
+
+void Tracking_Bit_Synchronizer::update(float prompt_i)
+{
+    bool sign = prompt_i >= 0;
+    if (!d_first_symbol and sign != d_last_sign)
+        {
+            if (d_synchronized)
+                {
+                    if (d_symbol_index == d_edge_index)
+                        {
+                            if (d_misaligned_transitions > 0) d_misaligned_transitions--;
+                        }
+                    else
+                        {
+                            d_misaligned_transitions++;
+                            if (d_misaligned_transitions > BIT_SYNC_MAX_MISALIGNED)
+                                {
+                                    // restart the search, keeping the position within the bit
+                                    int symbol_index = d_symbol_index;
+                                    reset();
+                                    d_symbol_index = symbol_index;
+                                }
+                        }
+                }
+            else
+                {
+                    d_histogram[d_symbol_index]++;
+                    d_transitions++;
+                    if (d_transitions >= BIT_SYNC_MIN_TRANSITIONS)
+                        {
+                            int edge = std::max_element(d_histogram.begin(), d_histogram.end()) - d_histogram.begin();
+                            int others = 0;
+                            for (int i = 0; i < d_symbols_per_bit; i++)
+                                {
+                                    if (i != edge) others = std::max(others, d_histogram[i]);
+                                }
+                            if (d_histogram[edge] >= BIT_SYNC_EDGE_RATIO * std::max(others, 1))
+                                {
+                                    d_edge_index = edge;
+                                    d_misaligned_transitions = 0;
+                                    d_synchronized = true;
+                                }
+                            else if (d_transitions >= BIT_SYNC_MAX_TRANSITIONS)
+                                {
+                                    std::fill(d_histogram.begin(), d_histogram.end(), 0);
+                                    d_transitions = 0;
+                                }
+                        }
+                }
+        }
+    d_last_sign = sign;
+    d_first_symbol = false;
+    d_symbol_index = (d_symbol_index + 1) % d_symbols_per_bit;
+}
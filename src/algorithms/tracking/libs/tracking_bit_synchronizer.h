@@ -0,0 +1,101 @@
+/*!
+ * \file tracking_bit_synchronizer.h
+ * \brief Histogram bit synchronizer: finds the data bit edges in the
+ * sequence of prompt correlator outputs, one per code period.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_BIT_SYNCHRONIZER_H_
+#define GNSS_SDR_TRACKING_BIT_SYNCHRONIZER_H_
+
+#include <vector>
+
+/*!
+ * \brief Finds the bit edges of a navigation message with several code
+ * periods per bit, as the GPS L1 C/A one (20 periods per bit).
+ *
+ * The sign changes of the in-phase prompt are counted at each of the
+ * code periods of a bit. Noise spreads its sign changes over all of them,
+ * while the data bit changes only happen at the bit edge, so the edge is
+ * declared once enough changes were seen and most of them fall on the
+ * same period. The synchronization is dropped when the sign keeps changing
+ * away from the edge, as it happens when the carrier lock degrades.
+ */
+class Tracking_Bit_Synchronizer
+{
+public:
+    Tracking_Bit_Synchronizer();
+
+    /*!
+     * \brief Sets the code periods per data bit and resets the synchronizer.
+     */
+    void set_symbols_per_bit(int symbols_per_bit);
+
+    /*!
+     * \brief Forgets the bit edge and the sign changes seen, when the
+     * channel starts tracking.
+     */
+    void reset();
+
+    /*!
+     * \brief Adds the in-phase prompt output of the last code period.
+     */
+    void update(float prompt_i);
+
+    /*!
+     * \brief True while the bit edge is known.
+     */
+    bool synchronized() const
+    {
+        return d_synchronized;
+    }
+
+    /*!
+     * \brief True if the next code period is the first one of a data bit.
+     */
+    bool bit_start() const
+    {
+        return d_synchronized and d_symbol_index == d_edge_index;
+    }
+
+    int symbols_per_bit() const
+    {
+        return d_symbols_per_bit;
+    }
+
+private:
+    int d_symbols_per_bit;
+    std::vector<int> d_histogram; // sign changes seen at the start of each code period of a bit
+    int d_symbol_index;           // position of the next code period within a bit
+    int d_transitions;
+    int d_misaligned_transitions; // sign changes away from the edge since the synchronization
+    int d_edge_index;
+    bool d_last_sign;
+    bool d_first_symbol;
+    bool d_synchronized;
+};
+
+#endif /* GNSS_SDR_TRACKING_BIT_SYNCHRONIZER_H_ */
@@ -88,6 +88,38 @@ float pll_cloop_two_quadrant_atan(gr_complex prompt_s1)
 }
 
 
+/*
+ * The same discriminator for n channels. atan is computed on [0, 1], using
+ * atan(x) = pi/2 - atan(1/x) for x > 1, with the polynomial of Abramowitz
+ * and Stegun 4.4.49 (error below 2e-8 rad). The selects replace the
+ * branches, so that the loop vectorizes.
+ */
+void pll_cloop_two_quadrant_atan(const float* prompt_i, const float* prompt_q, float* discriminator, int n)
+{
+    for (int k = 0; k < n; k++)
+        {
+            const float in_phase = prompt_i[k];
+            const float x = prompt_q[k] / (in_phase != 0.0f ? in_phase : 1.0f);
+            const float a = std::fabs(x);
+            const bool inverse = a > 1.0f;
+            const float t = inverse ? 1.0f / a : a;
+            const float t2 = t * t;
+            float p = 0.0028662257f;
+            p = p * t2 - 0.0161657367f;
+            p = p * t2 + 0.0429096138f;
+            p = p * t2 - 0.0752896400f;
+            p = p * t2 + 0.1065626393f;
+            p = p * t2 - 0.1420889944f;
+            p = p * t2 + 0.1999355085f;
+            p = p * t2 - 0.3333314528f;
+            p = (p * t2 + 1.0f) * t;
+            const float r = inverse ? 1.5707963268f - p : p;
+            const float signed_r = x < 0.0f ? -r : r;
+            discriminator[k] = in_phase != 0.0f ? signed_r : 0.0f;
+        }
+}
+
+
 /*
  * DLL Noncoherent Early minus Late envelope normalized discriminator:
  * \f{equation}
@@ -104,6 +136,19 @@ float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1)
     return (P_early - P_late) / ((P_early + P_late));
 }
 
+
+void dll_nc_e_minus_l_normalized(const float* early_i, const float* early_q,
+        const float* late_i, const float* late_q, float* discriminator, int n)
+{
+    for (int k = 0; k < n; k++)
+        {
+            const float P_early = std::sqrt(early_i[k] * early_i[k] + early_q[k] * early_q[k]);
+            const float P_late = std::sqrt(late_i[k] * late_i[k] + late_q[k] * late_q[k]);
+            const float P_sum = P_early + P_late;
+            discriminator[k] = (P_early - P_late) / (P_sum > 0.0f ? P_sum : 1.0f);
+        }
+}
+
 /*
  * DLL Noncoherent Very Early Minus Late Power (VEMLP) normalized discriminator, using the outputs
  * of four correlators, Very Early (VE), Early (E), Late (L) and Very Late (VL):
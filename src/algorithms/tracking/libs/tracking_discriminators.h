@@ -74,6 +74,15 @@ float pll_four_quadrant_atan(gr_complex prompt_s1);
  */
 float pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
 
+/*! \brief PLL Costas loop two quadrant arctan discriminator of \p n channels
+ *
+ * Same as pll_cloop_two_quadrant_atan(gr_complex) on the prompt outputs
+ * \p prompt_i[k] + j \p prompt_q[k]. The arctangent is a polynomial
+ * approximation (error below 2e-8 rad), and the loop has no branches, so
+ * that the compiler vectorizes it across channels.
+ */
+void pll_cloop_two_quadrant_atan(const float* prompt_i, const float* prompt_q, float* discriminator, int n);
+
 
 /*! \brief DLL Noncoherent Early minus Late envelope normalized discriminator
  *
@@ -86,6 +95,16 @@ float pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
  */
 float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1);
 
+/*! \brief DLL Noncoherent Early minus Late envelope normalized discriminator of \p n channels
+ *
+ * Same as dll_nc_e_minus_l_normalized(gr_complex, gr_complex) on the
+ * Early and Late outputs of each channel, without branches so that the
+ * compiler vectorizes it across channels. It is zero for the channels
+ * whose Early and Late outputs are zero.
+ */
+void dll_nc_e_minus_l_normalized(const float* early_i, const float* early_q,
+        const float* late_i, const float* late_q, float* discriminator, int n);
+
 
 /*! \brief DLL Noncoherent Very Early Minus Late Power (VEMLP) normalized discriminator
  *
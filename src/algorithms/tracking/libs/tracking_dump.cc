@@ -0,0 +1,83 @@
+/*!
+ * \file tracking_dump.cc
+ * \brief Records of the dump files of the tracking blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "tracking_dump.h"
+
+static_assert(sizeof(Tracking_Dump_Record) == 76, "Tracking_Dump_Record must be packed");
+static_assert(sizeof(Galileo_E1_Tracking_Dump_Record) == 84, "Galileo_E1_Tracking_Dump_Record must be packed");
+
+Gnss_Dump_Schema tracking_dump_schema()
+{
+    Gnss_Dump_Schema schema("gps_l1_ca_dll_pll_tracking");
+    schema.add_field("E", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("P", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("L", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("prompt_I", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("prompt_Q", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("PRN_start_sample", Gnss_Dump_Schema::UINT64);
+    schema.add_field("acc_carrier_phase_rad", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carrier_doppler_hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_freq_hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carr_error", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carr_nco", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_error", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_nco", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("CN0_SNV_dB_Hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carrier_lock_test", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("var1", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("var2", Gnss_Dump_Schema::FLOAT64);
+    return schema;
+}
+
+
+Gnss_Dump_Schema galileo_e1_tracking_dump_schema()
+{
+    Gnss_Dump_Schema schema("galileo_e1_dll_pll_veml_tracking");
+    schema.add_field("VE", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("E", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("P", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("L", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("VL", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("prompt_I", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("prompt_Q", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("PRN_start_sample", Gnss_Dump_Schema::UINT64);
+    schema.add_field("acc_carrier_phase_rad", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carrier_doppler_hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_freq_hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carr_error", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carr_nco", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_error", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("code_nco", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("CN0_SNV_dB_Hz", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("carrier_lock_test", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("var1", Gnss_Dump_Schema::FLOAT32);
+    schema.add_field("var2", Gnss_Dump_Schema::FLOAT64);
+    return schema;
+}
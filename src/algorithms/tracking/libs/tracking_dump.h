@@ -0,0 +1,121 @@
+/*!
+ * \file tracking_dump.h
+ * \brief Records of the dump files of the tracking blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TRACKING_DUMP_H_
+#define GNSS_SDR_TRACKING_DUMP_H_
+
+#include <stdint.h>
+#include "gnss_dump_writer.h"
+
+#pragma pack(push, 1)
+/*!
+ * \brief One integration of a tracking channel, as written to its dump
+ * file. The layout is the one read by
+ * utils/matlab/libs/gps_l1_ca_dll_pll_read_tracking_dump_64bits.m
+ */
+struct Tracking_Dump_Record
+{
+    // EPR
+    float abs_E;
+    float abs_P;
+    float abs_L;
+    // PROMPT I and Q (to analyze navigation symbols)
+    float prompt_I;
+    float prompt_Q;
+    // PRN start sample stamp
+    uint64_t PRN_start_sample;
+    // accumulated carrier phase
+    float acc_carrier_phase_rad;
+    // carrier and code frequency
+    float carrier_doppler_hz;
+    float code_freq_chips;
+    // PLL commands
+    float carr_error_hz;
+    float carr_error_filt_hz;
+    // DLL commands
+    float code_error_chips;
+    float code_error_filt_chips;
+    // CN0 and carrier lock test
+    float CN0_SNV_dB_Hz;
+    float carrier_lock_test;
+    // AUX vars (for debug purposes)
+    float aux1;
+    double aux2;
+};
+
+/*!
+ * \brief One integration of a Galileo E1 VEML tracking channel, as written
+ * to its dump file. The layout is the one read by
+ * utils/matlab/libs/galileo_e1_dll_pll_veml_read_tracking_dump.m
+ */
+struct Galileo_E1_Tracking_Dump_Record
+{
+    // VE, E, P, L and VL correlators
+    float abs_VE;
+    float abs_E;
+    float abs_P;
+    float abs_L;
+    float abs_VL;
+    // PROMPT I and Q (to analyze navigation symbols)
+    float prompt_I;
+    float prompt_Q;
+    // PRN start sample stamp
+    uint64_t PRN_start_sample;
+    // accumulated carrier phase
+    float acc_carrier_phase_rad;
+    // carrier and code frequency
+    float carrier_doppler_hz;
+    float code_freq_chips;
+    // PLL commands
+    float carr_error_hz;
+    float carr_error_filt_hz;
+    // DLL commands
+    float code_error_chips;
+    float code_error_filt_chips;
+    // CN0 and carrier lock test
+    float CN0_SNV_dB_Hz;
+    float carrier_lock_test;
+    // AUX vars (for debug purposes)
+    float aux1;
+    double aux2;
+};
+#pragma pack(pop)
+
+/*!
+ * \brief Schema of the Tracking_Dump_Record fields.
+ */
+Gnss_Dump_Schema tracking_dump_schema();
+
+/*!
+ * \brief Schema of the Galileo_E1_Tracking_Dump_Record fields.
+ */
+Gnss_Dump_Schema galileo_e1_tracking_dump_schema();
+
+#endif /* GNSS_SDR_TRACKING_DUMP_H_ */
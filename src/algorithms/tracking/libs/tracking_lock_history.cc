@@ -0,0 +1,91 @@
+/*!
+ * \file tracking_lock_history.cc
+ * \brief Last state of a channel while its tracking was in lock, handed
+ * to the acquisition for a fast reacquisition when the lock is lost.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "tracking_lock_history.h"
+
+// Shortest time between the records of the Doppler rate estimation [s]
+#define LOCK_HISTORY_RATE_INTERVAL 0.5
+
+
+Tracking_Lock_History::Tracking_Lock_History()
+{
+    d_fs_in = 1;
+    reset();
+}
+
+
+void Tracking_Lock_History::set_fs(long fs_in)
+{
+    d_fs_in = fs_in > 0 ? fs_in : 1;
+}
+
+
+void Tracking_Lock_History::reset()
+{
+    d_valid = false;
+    d_prn_start_sample = 0;
+    d_code_period_samples = 0.0;
+    d_doppler_hz = 0.0;
+    d_doppler_rate_hz_s = 0.0;
+    d_rate_start_sample = 0;
+    d_rate_start_doppler_hz = 0.0;
+}
+
+
+void Tracking_Lock_History::update(unsigned long int prn_start_sample, double code_period_samples, double doppler_hz)
+{
+    if (!d_valid)
+        {
+            d_rate_start_sample = prn_start_sample;
+            d_rate_start_doppler_hz = doppler_hz;
+        }
+    else if (prn_start_sample >= d_rate_start_sample + (unsigned long int)(LOCK_HISTORY_RATE_INTERVAL * d_fs_in))
+        {
+            const double interval_s = (double)(prn_start_sample - d_rate_start_sample) / (double)d_fs_in;
+            d_doppler_rate_hz_s = (doppler_hz - d_rate_start_doppler_hz) / interval_s;
+            d_rate_start_sample = prn_start_sample;
+            d_rate_start_doppler_hz = doppler_hz;
+        }
+    d_prn_start_sample = prn_start_sample;
+    d_code_period_samples = code_period_samples;
+    d_doppler_hz = doppler_hz;
+    d_valid = true;
+}
+
+
+void Tracking_Lock_History::publish(Gnss_Synchro* synchro) const
+{
+    synchro->Reacq_samplestamp_samples = d_prn_start_sample;
+    synchro->Reacq_code_period_samples = d_code_period_samples;
+    synchro->Reacq_doppler_hz = d_doppler_hz;
+    synchro->Reacq_doppler_rate_hz_s = d_doppler_rate_hz_s;
+    synchro->Flag_reacquisition = d_valid;
+}
@@ -0,0 +1,97 @@
+/*!
+ * \file tracking_lock_history.h
+ * \brief Last state of a channel while its tracking was in lock, handed
+ * to the acquisition for a fast reacquisition when the lock is lost.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TRACKING_LOCK_HISTORY_H_
+#define GNSS_SDR_TRACKING_LOCK_HISTORY_H_
+
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Keeps the code timing, the carrier Doppler and the Doppler rate
+ * of the last integrations that passed the lock detectors.
+ *
+ * The tracking blocks record the state after every integration in lock,
+ * and publish it in the reacquisition fields of the Gnss_Synchro shared
+ * with the acquisition when they declare the loss of lock. The state is
+ * the one before the loss of lock, and not the one of the loops at the
+ * time they give up, which have already drifted away from the signal.
+ * The Doppler rate is the Doppler change between records half a second
+ * apart, at least.
+ */
+class Tracking_Lock_History
+{
+public:
+    Tracking_Lock_History();
+
+    /*!
+     * \brief Sets the sampling frequency of the sample counters [Hz].
+     */
+    void set_fs(long fs_in);
+
+    /*!
+     * \brief Forgets the history, when the channel starts tracking.
+     */
+    void reset();
+
+    /*!
+     * \brief Records the state of an integration in lock: the sample
+     * where the next code period starts, the length of a code period in
+     * samples and the carrier Doppler [Hz].
+     */
+    void update(unsigned long int prn_start_sample, double code_period_samples, double doppler_hz);
+
+    /*!
+     * \brief True if an integration in lock was recorded since the last
+     * reset().
+     */
+    bool valid() const
+    {
+        return d_valid;
+    }
+
+    /*!
+     * \brief Writes the last state in lock to the reacquisition fields of
+     * \p synchro, and flags them as valid if there is one.
+     */
+    void publish(Gnss_Synchro* synchro) const;
+
+private:
+    long d_fs_in;
+    bool d_valid;
+    unsigned long int d_prn_start_sample;
+    double d_code_period_samples;
+    double d_doppler_hz;
+    double d_doppler_rate_hz_s;
+    unsigned long int d_rate_start_sample;  // record the Doppler rate is measured from
+    double d_rate_start_doppler_hz;
+};
+
+#endif /* GNSS_SDR_TRACKING_LOCK_HISTORY_H_ */
@@ -0,0 +1,275 @@
+/*!
+ * \file tracking_state_bank.cc
+ * \brief Loop state of all the channels of a tracking block, stored as a
+ * structure of arrays and updated for all the channels at once
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tracking_state_bank.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "tracking_discriminators.h"
+
+// Number of arrays in the storage, including the scratch of update_loops()
+#define TRACKING_STATE_BANK_ARRAYS 34
+// Floats per cache line: every array starts on one
+#define TRACKING_STATE_BANK_ALIGNMENT 16
+
+
+/*
+ * floor() for the values of update_loops(), written with a truncation so
+ * that it vectorizes without -ffast-math
+ */
+static inline float floor_branchless(float x)
+{
+    const float t = (float)(int)x;
+    return t - (t > x ? 1.0f : 0.0f);
+}
+
+
+/*
+ * Gains of the 2nd order loop filters, as computed by Tracking_2nd_PLL_filter
+ * and Tracking_2nd_DLL_filter
+ */
+static void loop_filter_gains(float lbw, float zeta, float k, float pdi, float* k1, float* k2)
+{
+    // Solve natural frequency
+    float Wn = lbw * 8 * zeta / (4 * zeta * zeta + 1);
+    // solve for t1 & t2
+    float tau1 = k / (Wn * Wn);
+    float tau2 = (2.0 * zeta) / Wn;
+    *k1 = tau2 / tau1;
+    *k2 = pdi / tau1;
+}
+
+
+Tracking_State_Bank::Tracking_State_Bank()
+{
+    d_storage = 0;
+    d_n_channels = 0;
+    d_capacity = 0;
+    set_arrays(0, 0);
+    configure(2048000, 1.57542e9, 1.023e6, 1023.0, 0.001, 50.0, 2.0);
+}
+
+
+Tracking_State_Bank::~Tracking_State_Bank()
+{
+    free(d_storage);
+}
+
+
+void Tracking_State_Bank::configure(long fs_in, double carrier_freq_hz, double code_rate_hz,
+        double code_length_chips, double integration_time_s,
+        float pll_bw_hz, float dll_bw_hz)
+{
+    d_fs_in = fs_in;
+    d_carrier_freq_hz = carrier_freq_hz;
+    d_code_rate_hz = code_rate_hz;
+    d_code_length_chips = code_length_chips;
+    d_integration_time_s = integration_time_s;
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
+    loop_filter_gains(pll_bw_hz, 0.65, 0.25, integration_time_s, &d_carr_k1, &d_carr_k2);
+    loop_filter_gains(dll_bw_hz, 0.7, 1.0, integration_time_s, &d_code_k1, &d_code_k2);
+}
+
+
+void Tracking_State_Bank::set_arrays(float* storage, int capacity)
+{
+    float* arrays[TRACKING_STATE_BANK_ARRAYS];
+    for (int a = 0; a < TRACKING_STATE_BANK_ARRAYS; a++)
+        {
+            arrays[a] = storage + a * capacity;
+        }
+    early_i = arrays[0];
+    early_q = arrays[1];
+    prompt_i = arrays[2];
+    prompt_q = arrays[3];
+    late_i = arrays[4];
+    late_q = arrays[5];
+    pending = (int*)arrays[6];
+    carr_error_hz = arrays[7];
+    carr_error_filt_hz = arrays[8];
+    code_error_chips = arrays[9];
+    code_error_filt_chips = arrays[10];
+    old_carr_nco = arrays[11];
+    old_carr_error = arrays[12];
+    old_code_nco = arrays[13];
+    old_code_error = arrays[14];
+    acq_carrier_doppler_hz = arrays[15];
+    carrier_doppler_hz = arrays[16];
+    code_freq_chips = arrays[17];
+    rem_carr_phase_rad = arrays[18];
+    acc_carrier_phase_rad = arrays[19];
+    rem_code_phase_samples = arrays[20];
+    acc_code_phase_secs = arrays[21];
+    prn_length_samples = (int*)arrays[22];
+    carrier_lock_test = arrays[23];
+    cn0_snv_db_hz = arrays[24];
+    carrier_lock_fail_counter = (int*)arrays[25];
+    loop_update = (int*)arrays[26];
+    carr_k1 = arrays[27];
+    carr_k2 = arrays[28];
+    code_k1 = arrays[29];
+    code_k2 = arrays[30];
+    loop_integration_time_s = arrays[31];
+    d_carr_discriminator = arrays[32];
+    d_code_discriminator = arrays[33];
+}
+
+
+void Tracking_State_Bank::resize(int n_channels)
+{
+    if (n_channels > d_capacity)
+        {
+            int capacity = ((n_channels + TRACKING_STATE_BANK_ALIGNMENT - 1) / TRACKING_STATE_BANK_ALIGNMENT) * TRACKING_STATE_BANK_ALIGNMENT;
+            float* storage = 0;
+            //todo: do something if posix_memalign fails
+            if (posix_memalign((void**)&storage, TRACKING_STATE_BANK_ALIGNMENT * sizeof(float),
+                    TRACKING_STATE_BANK_ARRAYS * capacity * sizeof(float)) == 0){};
+            memset(storage, 0, TRACKING_STATE_BANK_ARRAYS * capacity * sizeof(float));
+            for (int a = 0; a < TRACKING_STATE_BANK_ARRAYS; a++)
+                {
+                    memcpy(storage + a * capacity, d_storage + a * d_capacity, d_n_channels * sizeof(float));
+                }
+            free(d_storage);
+            d_storage = storage;
+            d_capacity = capacity;
+            set_arrays(d_storage, d_capacity);
+        }
+    d_n_channels = n_channels;
+}
+
+
+void Tracking_State_Bank::initialize(int channel, float acq_carrier_doppler_hz_,
+        float code_freq_chips_, int prn_length_samples_)
+{
+    old_carr_nco[channel] = 0.0;
+    old_carr_error[channel] = 0.0;
+    old_code_nco[channel] = 0.0;
+    old_code_error[channel] = 0.0;
+    acq_carrier_doppler_hz[channel] = acq_carrier_doppler_hz_;
+    carrier_doppler_hz[channel] = acq_carrier_doppler_hz_;
+    code_freq_chips[channel] = code_freq_chips_;
+    rem_carr_phase_rad[channel] = 0.0;
+    acc_carrier_phase_rad[channel] = 0.0;
+    rem_code_phase_samples[channel] = 0.0;
+    acc_code_phase_secs[channel] = 0.0;
+    prn_length_samples[channel] = prn_length_samples_;
+    carrier_lock_test[channel] = 1.0;
+    cn0_snv_db_hz[channel] = 0.0;
+    carrier_lock_fail_counter[channel] = 0;
+    pending[channel] = 0;
+    loop_update[channel] = 1;
+    carr_k1[channel] = d_carr_k1;
+    carr_k2[channel] = d_carr_k2;
+    code_k1[channel] = d_code_k1;
+    code_k2[channel] = d_code_k2;
+    loop_integration_time_s[channel] = d_integration_time_s;
+}
+
+
+void Tracking_State_Bank::set_loop_integration(int channel, int code_periods, float pll_bw_hz, float dll_bw_hz)
+{
+    const float pdi = d_integration_time_s * code_periods;
+    loop_filter_gains(pll_bw_hz, 0.65, 0.25, pdi, &carr_k1[channel], &carr_k2[channel]);
+    loop_filter_gains(dll_bw_hz, 0.7, 1.0, pdi, &code_k1[channel], &code_k2[channel]);
+    loop_integration_time_s[channel] = pdi;
+}
+
+
+void Tracking_State_Bank::update_loops()
+{
+    const int n = d_n_channels;
+    const float two_pi = 6.283185307179586;
+    const float fs = (float)d_fs_in;
+    const float T = d_integration_time_s;
+    const float code_rate_hz = d_code_rate_hz;
+    const float carrier_freq_hz = d_carrier_freq_hz;
+    const float code_length_chips = d_code_length_chips;
+
+    // Discriminators of all the channels
+    pll_cloop_two_quadrant_atan(prompt_i, prompt_q, d_carr_discriminator, n);
+    dll_nc_e_minus_l_normalized(early_i, early_q, late_i, late_q, d_code_discriminator, n);
+
+    // Loop filters and NCOs. All the lanes are computed, and the pending
+    // ones are blended in with a 0/1 weight, which is exact and, unlike a
+    // conditional store, lets the compiler vectorize the loop. The loop
+    // filters of the integrations that do not close the loops are blended
+    // out in the same way, and their NCOs keep the last frequencies. The
+    // arrays never overlap
+#if defined(__clang__)
+#pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+#pragma GCC ivdep
+#endif
+    for (int k = 0; k < n; k++)
+        {
+            const int update = pending[k] != 0;
+            const float w = (float)update;
+            const float w_old = 1.0f - w;
+            const float u = w * (float)(loop_update[k] != 0);
+            const float u_old = 1.0f - u;
+
+            // PLL
+            const float carr_error = d_carr_discriminator[k] / two_pi;
+            const float carr_filt = old_carr_nco[k] + carr_k1[k] * (carr_error - old_carr_error[k]) + carr_error * carr_k2[k];
+            const float carr_nco = u * carr_filt + u_old * old_carr_nco[k];
+            const float doppler = acq_carrier_doppler_hz[k] + carr_nco;
+            const float code_freq = code_rate_hz + doppler * code_rate_hz / carrier_freq_hz;
+            const float carr_phase_step = two_pi * doppler * T;
+            const float rem_carr = rem_carr_phase_rad[k] + carr_phase_step;
+
+            // DLL
+            const float code_error = d_code_discriminator[k];
+            const float code_filt = old_code_nco[k] + code_k1[k] * (code_error - old_code_error[k]) + code_error * code_k2[k];
+            const float code_nco = u * code_filt + u_old * old_code_nco[k];
+            const float code_error_filt_secs = u * loop_integration_time_s[k] * code_nco / code_rate_hz;
+
+            // Next integration: one code period at the new code rate, plus the code phase error
+            const float K_blk_samples = code_length_chips / code_freq * fs + rem_code_phase_samples[k] + code_error_filt_secs * fs;
+            const float length = floor_branchless(K_blk_samples + 0.5f);
+
+            carr_error_hz[k] = u * carr_error + u_old * carr_error_hz[k];
+            carr_error_filt_hz[k] = u * carr_nco + u_old * carr_error_filt_hz[k];
+            code_error_chips[k] = u * code_error + u_old * code_error_chips[k];
+            code_error_filt_chips[k] = u * code_nco + u_old * code_error_filt_chips[k];
+            old_carr_nco[k] = carr_nco;
+            old_carr_error[k] = u * carr_error + u_old * old_carr_error[k];
+            old_code_nco[k] = code_nco;
+            old_code_error[k] = u * code_error + u_old * old_code_error[k];
+            carrier_doppler_hz[k] = w * doppler + w_old * carrier_doppler_hz[k];
+            code_freq_chips[k] = w * code_freq + w_old * code_freq_chips[k];
+            acc_carrier_phase_rad[k] += w * carr_phase_step;
+            rem_carr_phase_rad[k] = w * (rem_carr - two_pi * floor_branchless(rem_carr / two_pi)) + w_old * rem_carr_phase_rad[k];
+            acc_code_phase_secs[k] += w * code_error_filt_secs;
+            rem_code_phase_samples[k] = w * (K_blk_samples - length) + w_old * rem_code_phase_samples[k];
+            prn_length_samples[k] += update * ((int)length - prn_length_samples[k]);
+            pending[k] = 0;
+        }
+}
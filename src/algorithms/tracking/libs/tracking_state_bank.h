@@ -0,0 +1,175 @@
+/*!
+ * \file tracking_state_bank.h
+ * \brief Loop state of all the channels of a tracking block, stored as a
+ * structure of arrays and updated for all the channels at once
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_STATE_BANK_H_
+#define GNSS_SDR_TRACKING_STATE_BANK_H_
+
+/*!
+ * \brief NCO, loop filter and lock detector state of the channels of a
+ * block that tracks several channels, such as
+ * Gps_L1_Ca_Dll_Pll_Batch_Tracking_cc.
+ *
+ * Each variable is an array indexed by the channel, and all the arrays
+ * live in a single cache-aligned buffer. The block writes the correlator
+ * outputs of the channels that have integrated and flags them in
+ * \ref pending, then update_loops() runs the PLL and DLL discriminators,
+ * the 2nd order loop filters of Tracking_2nd_PLL_filter and
+ * Tracking_2nd_DLL_filter, and the NCO updates of all of them in
+ * branch-free loops that the compiler vectorizes across channels.
+ *
+ * A channel can close its loops on a longer coherent integration than the
+ * code period, set with set_loop_integration(). It then flags in
+ * \ref loop_update the integrations that end a summation interval, with
+ * the correlator outputs summed over it, and the other ones only advance
+ * its NCOs at the last estimated frequencies.
+ */
+class Tracking_State_Bank
+{
+public:
+    Tracking_State_Bank();
+    ~Tracking_State_Bank();
+
+    /*!
+     * \brief Sets the parameters shared by all the channels: the sampling
+     * frequency, the carrier frequency and code rate of the signal, its
+     * code length, the integration time (one code period) and the loop
+     * bandwidths.
+     */
+    void configure(long fs_in, double carrier_freq_hz, double code_rate_hz,
+            double code_length_chips, double integration_time_s,
+            float pll_bw_hz, float dll_bw_hz);
+
+    /*!
+     * \brief Sets the number of channels. The state of the existing
+     * channels is kept, and the new ones are zeroed.
+     */
+    void resize(int n_channels);
+
+    int size() const
+    {
+        return d_n_channels;
+    }
+
+    /*!
+     * \brief Resets the loops of \p channel to start tracking with the
+     * acquisition Doppler, \p code_freq_chips and an integration of
+     * \p prn_length_samples samples.
+     */
+    void initialize(int channel, float acq_carrier_doppler_hz,
+            float code_freq_chips, int prn_length_samples);
+
+    /*!
+     * \brief Sets the loops of \p channel to be closed every
+     * \p code_periods integrations, with the bandwidths \p pll_bw_hz and
+     * \p dll_bw_hz. The state of its loop filters is kept.
+     */
+    void set_loop_integration(int channel, int code_periods, float pll_bw_hz, float dll_bw_hz);
+
+    /*!
+     * \brief Runs the discriminators, the loop filters and the NCO updates
+     * of the channels flagged in \ref pending, and clears the flags.
+     */
+    void update_loops();
+
+    // correlator outputs of the last integration
+    float* early_i;
+    float* early_q;
+    float* prompt_i;
+    float* prompt_q;
+    float* late_i;
+    float* late_q;
+
+    // non-zero for the channels whose loops update_loops() has to update
+    int* pending;
+    // non-zero if the integration of the channel closes its loops, zero if
+    // it only advances its NCOs. Kept by update_loops(), 1 after initialize()
+    int* loop_update;
+
+    // discriminator and loop filter outputs of the last update
+    float* carr_error_hz;
+    float* carr_error_filt_hz;
+    float* code_error_chips;
+    float* code_error_filt_chips;
+
+    // loop filter gains and summation interval, set by set_loop_integration()
+    float* carr_k1;
+    float* carr_k2;
+    float* code_k1;
+    float* code_k2;
+    float* loop_integration_time_s;
+
+    // loop filter states
+    float* old_carr_nco;
+    float* old_carr_error;
+    float* old_code_nco;
+    float* old_code_error;
+
+    // NCOs
+    float* acq_carrier_doppler_hz;  // Doppler the PLL output is added to: the acquisition one, or the vector tracking prediction
+    float* carrier_doppler_hz;
+    float* code_freq_chips;
+    float* rem_carr_phase_rad;
+    float* acc_carrier_phase_rad;
+    float* rem_code_phase_samples;
+    float* acc_code_phase_secs;
+    int* prn_length_samples;     // length of the next integration
+
+    // lock detectors
+    float* carrier_lock_test;
+    float* cn0_snv_db_hz;
+    int* carrier_lock_fail_counter;
+
+private:
+    Tracking_State_Bank(const Tracking_State_Bank&);
+    Tracking_State_Bank& operator=(const Tracking_State_Bank&);
+
+    void set_arrays(float* storage, int capacity);
+
+    float* d_storage;            // all the arrays above, capacity entries each
+    float* d_carr_discriminator; // scratch of update_loops()
+    float* d_code_discriminator;
+    int d_n_channels;
+    int d_capacity;
+
+    long d_fs_in;
+    float d_carrier_freq_hz;
+    float d_code_rate_hz;
+    float d_code_length_chips;
+    float d_integration_time_s;
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    // 2nd order loop filter gains of one code period: tau2/tau1 and T/tau1
+    float d_carr_k1;
+    float d_carr_k2;
+    float d_code_k1;
+    float d_code_k2;
+};
+
+#endif
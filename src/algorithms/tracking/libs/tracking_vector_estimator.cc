@@ -0,0 +1,234 @@
+/*!
+ * \file tracking_vector_estimator.cc
+ * \brief Least squares estimator of the receiver velocity and clock drift
+ * from the carrier Doppler of all the channels, which predicts the Doppler
+ * of each channel for vector tracking.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "tracking_vector_estimator.h"
+#include <cmath>
+#include <algorithm>
+
+// Largest disagreement [Hz] of a channel with the solution of the others
+#define VECTOR_MAX_RESIDUAL_HZ 20.0
+// Smallest pivot of the normal equations, relative to the largest one
+#define VECTOR_MIN_PIVOT 1e-9
+
+
+Tracking_Vector_Estimator::Tracking_Vector_Estimator()
+{
+    d_n_channels = 0;
+    d_channels_used = 0;
+    d_valid = false;
+    for (int i = 0; i < 4; i++)
+        {
+            d_solution[i] = 0.0;
+        }
+    configure(1.57542e9, 5);
+}
+
+
+void Tracking_Vector_Estimator::configure(double carrier_freq_hz, int min_channels)
+{
+    d_wavelength_m = 299792458.0 / carrier_freq_hz;
+    d_min_channels = std::max(min_channels, 4);
+    d_valid = false;
+}
+
+
+void Tracking_Vector_Estimator::resize(int n_channels)
+{
+    d_n_channels = n_channels;
+    d_los.resize(3 * n_channels, 0.0);
+    d_sat_velocity.resize(3 * n_channels, 0.0);
+    d_has_geometry.resize(n_channels, 0);
+    d_used.resize(n_channels, 0);
+}
+
+
+void Tracking_Vector_Estimator::set_geometry(int channel, const double* los, const double* sat_velocity_m_s)
+{
+    for (int i = 0; i < 3; i++)
+        {
+            d_los[3 * channel + i] = los[i];
+            d_sat_velocity[3 * channel + i] = sat_velocity_m_s[i];
+        }
+    d_has_geometry[channel] = 1;
+}
+
+
+void Tracking_Vector_Estimator::clear_geometry(int channel)
+{
+    d_has_geometry[channel] = 0;
+}
+
+
+bool Tracking_Vector_Estimator::estimate(const float* doppler_hz, const float* weight)
+{
+    for (int k = 0; k < d_n_channels; k++)
+        {
+            d_used[k] = d_has_geometry[k] != 0 and weight[k] > 0.0;
+        }
+    d_valid = false;
+    while (solve(doppler_hz, weight))
+        {
+            if (max_residual_hz(doppler_hz) <= VECTOR_MAX_RESIDUAL_HZ)
+                {
+                    d_valid = true;
+                    break;
+                }
+            // A wrong Doppler spreads its error over the residuals of all the
+            // channels, so the channel removed is the one whose removal leaves
+            // the others in best agreement
+            int worst = -1;
+            double best_residual_hz = 0.0;
+            for (int k = 0; k < d_n_channels; k++)
+                {
+                    if (!d_used[k]) continue;
+                    d_used[k] = 0;
+                    if (solve(doppler_hz, weight))
+                        {
+                            const double residual_hz = max_residual_hz(doppler_hz);
+                            if (worst < 0 or residual_hz < best_residual_hz)
+                                {
+                                    best_residual_hz = residual_hz;
+                                    worst = k;
+                                }
+                        }
+                    d_used[k] = 1;
+                }
+            if (worst < 0)
+                {
+                    break;
+                }
+            d_used[worst] = 0;
+        }
+    return d_valid;
+}
+
+
+double Tracking_Vector_Estimator::max_residual_hz(const float* doppler_hz) const
+{
+    double max_residual = 0.0;
+    for (int k = 0; k < d_n_channels; k++)
+        {
+            if (!d_used[k]) continue;
+            max_residual = std::max(max_residual, std::abs((double)doppler_hz[k] - predicted_doppler_hz(k)));
+        }
+    return max_residual;
+}
+
+
+bool Tracking_Vector_Estimator::solve(const float* doppler_hz, const float* weight)
+{
+    // Normal equations of the weighted least squares: for each channel,
+    // h = [u, 1] and y = lambda * f + v_s . u, with the unknowns [v_r, lambda * d]
+    double a[4][5] = {{0.0}};
+    float max_weight = 0.0;
+    int used = 0;
+    for (int k = 0; k < d_n_channels; k++)
+        {
+            if (!d_used[k]) continue;
+            max_weight = std::max(max_weight, weight[k]);
+            used++;
+        }
+    if (used < d_min_channels)
+        {
+            return false;
+        }
+    for (int k = 0; k < d_n_channels; k++)
+        {
+            if (!d_used[k]) continue;
+            const double* u = &d_los[3 * k];
+            const double* v_s = &d_sat_velocity[3 * k];
+            const double h[4] = {u[0], u[1], u[2], 1.0};
+            const double y = d_wavelength_m * doppler_hz[k] + v_s[0] * u[0] + v_s[1] * u[1] + v_s[2] * u[2];
+            const double w = weight[k] / max_weight;
+            for (int i = 0; i < 4; i++)
+                {
+                    for (int j = 0; j < 4; j++)
+                        {
+                            a[i][j] += w * h[i] * h[j];
+                        }
+                    a[i][4] += w * h[i] * y;
+                }
+        }
+
+    // Gaussian elimination with partial pivoting
+    double max_pivot = 0.0;
+    for (int c = 0; c < 4; c++)
+        {
+            int pivot = c;
+            for (int r = c + 1; r < 4; r++)
+                {
+                    if (std::abs(a[r][c]) > std::abs(a[pivot][c])) pivot = r;
+                }
+            max_pivot = std::max(max_pivot, std::abs(a[pivot][c]));
+            if (std::abs(a[pivot][c]) <= VECTOR_MIN_PIVOT * max_pivot)
+                {
+                    // the satellites do not observe all the unknowns
+                    return false;
+                }
+            for (int j = 0; j < 5; j++)
+                {
+                    std::swap(a[c][j], a[pivot][j]);
+                }
+            for (int r = c + 1; r < 4; r++)
+                {
+                    const double f = a[r][c] / a[c][c];
+                    for (int j = c; j < 5; j++)
+                        {
+                            a[r][j] -= f * a[c][j];
+                        }
+                }
+        }
+    for (int c = 3; c >= 0; c--)
+        {
+            double x = a[c][4];
+            for (int j = c + 1; j < 4; j++)
+                {
+                    x -= a[c][j] * d_solution[j];
+                }
+            d_solution[c] = x / a[c][c];
+        }
+    d_channels_used = used;
+    return true;
+}
+
+
+double Tracking_Vector_Estimator::predicted_doppler_hz(int channel) const
+{
+    const double* u = &d_los[3 * channel];
+    const double* v_s = &d_sat_velocity[3 * channel];
+    double range_rate_m_s = d_solution[3];
+    for (int i = 0; i < 3; i++)
+        {
+            range_rate_m_s += (d_solution[i] - v_s[i]) * u[i];
+        }
+    return range_rate_m_s / d_wavelength_m;
+}
@@ -0,0 +1,149 @@
+/*!
+ * \file tracking_vector_estimator.h
+ * \brief Least squares estimator of the receiver velocity and clock drift
+ * from the carrier Doppler of all the channels, which predicts the Doppler
+ * of each channel for vector tracking.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TRACKING_VECTOR_ESTIMATOR_H_
+#define GNSS_SDR_TRACKING_VECTOR_ESTIMATOR_H_
+
+#include <vector>
+
+/*!
+ * \brief Central estimator of a vector frequency lock loop.
+ *
+ * The Doppler of a channel is the projection of the relative velocity of
+ * the satellite on its line of sight plus the receiver clock drift:
+ *
+ *   lambda * f_i = (v_r - v_s_i) . u_i + lambda * d
+ *
+ * where u_i is the unit vector from the receiver to the satellite. With
+ * the geometry (u_i and v_s_i) of the channels, given by the navigation
+ * solution and the ephemeris, the Doppler measured by the loops of the
+ * channels in lock are combined in a least squares estimate of the
+ * receiver velocity v_r and the clock drift d, weighted by their CN0.
+ * The Doppler of every channel with a known geometry is then predicted
+ * from that estimate, so a weak channel is steered by the strong ones.
+ *
+ * The channels whose Doppler disagrees with the rest (e.g. a false lock)
+ * are removed from the estimate one at a time.
+ */
+class Tracking_Vector_Estimator
+{
+public:
+    Tracking_Vector_Estimator();
+
+    /*!
+     * \brief Sets the carrier frequency of the signal and the channels in
+     * lock needed for a solution (at least 4, as there are 4 unknowns).
+     */
+    void configure(double carrier_freq_hz, int min_channels);
+
+    void resize(int n_channels);
+
+    /*!
+     * \brief Sets the unit line of sight vector from the receiver to the
+     * satellite of a channel and the satellite velocity [m/s], in ECEF.
+     */
+    void set_geometry(int channel, const double* los, const double* sat_velocity_m_s);
+
+    /*!
+     * \brief Forgets the geometry of a channel, which is then neither used
+     * nor predicted.
+     */
+    void clear_geometry(int channel);
+
+    bool has_geometry(int channel) const
+    {
+        return d_has_geometry[channel] != 0;
+    }
+
+    /*!
+     * \brief Estimates the receiver velocity and clock drift from the
+     * carrier Doppler [Hz] of the channels, weighted by \p weight (0 for
+     * the channels out of lock). Returns valid().
+     */
+    bool estimate(const float* doppler_hz, const float* weight);
+
+    /*!
+     * \brief True if the last estimate() found a solution.
+     */
+    bool valid() const
+    {
+        return d_valid;
+    }
+
+    /*!
+     * \brief Doppler [Hz] of a channel with a known geometry, as predicted
+     * by the last estimate, while valid().
+     */
+    double predicted_doppler_hz(int channel) const;
+
+    /*!
+     * \brief Receiver velocity [m/s] in ECEF (X, Y, Z) of the last
+     * estimate, while valid().
+     */
+    const double* receiver_velocity_m_s() const
+    {
+        return d_solution;
+    }
+
+    /*!
+     * \brief Receiver clock drift [Hz] of the last estimate, while valid().
+     */
+    double clock_drift_hz() const
+    {
+        return d_solution[3] / d_wavelength_m;
+    }
+
+    /*!
+     * \brief Channels used by the last estimate, while valid().
+     */
+    int channels_used() const
+    {
+        return d_channels_used;
+    }
+
+private:
+    bool solve(const float* doppler_hz, const float* weight);
+    double max_residual_hz(const float* doppler_hz) const;
+
+    double d_wavelength_m;
+    int d_min_channels;
+    int d_n_channels;
+    std::vector<double> d_los;            // 3 per channel
+    std::vector<double> d_sat_velocity;   // 3 per channel
+    std::vector<int> d_has_geometry;
+    std::vector<int> d_used;              // channels of the current estimate
+    double d_solution[4];                 // receiver velocity [m/s] and clock drift [m/s]
+    int d_channels_used;
+    bool d_valid;
+};
+
+#endif /* GNSS_SDR_TRACKING_VECTOR_ESTIMATOR_H_ */
@@ -54,6 +54,8 @@
 #include "concurrent_queue.h"
 #include "concurrent_map.h"
 #include "gnss_flowgraph.h"
+#include "gnss_fft_plan_cache.h"
+#include "gnss_overload_controller.h"
 #include "file_configuration.h"
 #include "control_message_factory.h"
 
@@ -169,6 +171,9 @@ void ControlThread::run()
     std::cout << "Stopping GNSS-SDR, please wait!" << std::endl;
     flowgraph_->stop();
 
+    // Keep the FFT plans created by this run for the next one
+    Gnss_Fft_Plan_Cache::instance().save_wisdom();
+
     // Join GPS threads
     gps_ephemeris_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
     gps_iono_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
@@ -227,6 +232,21 @@ bool ControlThread::read_assistance_from_XML()
 
 void ControlThread::init()
 {
+    // The FFT plans of the acquisition blocks are created with the flowgraph
+    std::string wisdom_filename = configuration_->property("GNSS-SDR.fftw_wisdom_filename",
+            Gnss_Fft_Plan_Cache::instance().wisdom_filename());
+    std::string fftw_planner = configuration_->property("GNSS-SDR.fftw_planner", std::string("measure"));
+    Gnss_Fft_Plan_Cache::instance().configure(wisdom_filename, fftw_planner);
+
+    // Overload protection of the tracking and acquisition blocks
+    bool overload_protection = configuration_->property("GNSS-SDR.overload_protection", false);
+    double overload_high_load = configuration_->property("GNSS-SDR.overload_high_load", 0.9);
+    double overload_low_load = configuration_->property("GNSS-SDR.overload_low_load", 0.6);
+    double overload_interval_s = configuration_->property("GNSS-SDR.overload_evaluation_interval_s", 1.0);
+    Gnss_Overload_Controller::instance().reset();
+    Gnss_Overload_Controller::instance().configure(overload_protection, overload_high_load,
+            overload_low_load, overload_interval_s);
+
     // Instantiates a control queue, a GNSS flowgraph, and a control message factory
     control_queue_ = gr::msg_queue::make(0);
     flowgraph_ = std::make_shared<GNSSFlowgraph>(configuration_, control_queue_);
@@ -60,11 +60,15 @@
 #include "gps_l1_ca_pcps_tong_acquisition.h"
 #include "gps_l1_ca_pcps_assisted_acquisition.h"
 #include "gps_l1_ca_pcps_acquisition_fine_doppler.h"
+#include "gps_l1_ca_pcps_batch_acquisition.h"
+#include "gps_l1_ca_pcps_hierarchical_acquisition.h"
 #include "galileo_e1_pcps_ambiguous_acquisition.h"
 #include "galileo_e1_pcps_8ms_ambiguous_acquisition.h"
 #include "galileo_e1_pcps_tong_ambiguous_acquisition.h"
 #include "galileo_e1_pcps_cccwsr_ambiguous_acquisition.h"
 #include "gps_l1_ca_dll_pll_tracking.h"
+#include "gps_l1_ca_dll_pll_tracking_int16.h"
+#include "gps_l1_ca_dll_pll_batch_tracking.h"
 #include "gps_l1_ca_dll_pll_optim_tracking.h"
 #include "gps_l1_ca_dll_fll_pll_tracking.h"
 #include "gps_l1_ca_tcp_connector_tracking.h"
@@ -382,6 +386,16 @@ GNSSBlockInterface* GNSSBlockFactory::GetBlock(
             block = new GpsL1CaPcpsMultithreadAcquisition(configuration.get(), role, in_streams,
                     out_streams, queue);
         }
+    else if (implementation.compare("GPS_L1_CA_PCPS_Batch_Acquisition") == 0)
+        {
+            block = new GpsL1CaPcpsBatchAcquisition(configuration.get(), role, in_streams,
+                    out_streams, queue);
+        }
+    else if (implementation.compare("GPS_L1_CA_PCPS_Hierarchical_Acquisition") == 0)
+        {
+            block = new GpsL1CaPcpsHierarchicalAcquisition(configuration.get(), role, in_streams,
+                    out_streams, queue);
+        }
 
 #if OPENCL_BLOCKS
     else if (implementation.compare("GPS_L1_CA_PCPS_OpenCl_Acquisition") == 0)
@@ -423,6 +437,16 @@ GNSSBlockInterface* GNSSBlockFactory::GetBlock(
             block = new GpsL1CaDllPllTracking(configuration.get(), role, in_streams,
                     out_streams, queue);
         }
+    else if (implementation.compare("GPS_L1_CA_DLL_PLL_Tracking_int16") == 0)
+        {
+            block = new GpsL1CaDllPllTrackingInt16(configuration.get(), role, in_streams,
+                    out_streams, queue);
+        }
+    else if (implementation.compare("GPS_L1_CA_DLL_PLL_Batch_Tracking") == 0)
+        {
+            block = new GpsL1CaDllPllBatchTracking(configuration.get(), role, in_streams,
+                    out_streams, queue);
+        }
     else if (implementation.compare("GPS_L1_CA_DLL_PLL_Optim_Tracking") == 0)
         {
             block = new GpsL1CaDllPllOptimTracking(configuration.get(), role, in_streams,
@@ -62,6 +62,12 @@ public:
     //new
     unsigned long int PRN_start_sample; //!< Set by Tracking processing block
     bool Flag_valid_tracking;
+    //Reacquisition, last locked state of the tracking. Set by Tracking processing block when the lock is lost
+    bool Flag_reacquisition;                     //!< The reacquisition data below are valid
+    double Reacq_doppler_hz;                     //!< Carrier Doppler at Reacq_samplestamp_samples
+    double Reacq_doppler_rate_hz_s;              //!< Carrier Doppler rate [Hz/s]
+    double Reacq_code_period_samples;            //!< Length of a code period [samples]
+    unsigned long int Reacq_samplestamp_samples; //!< Sample where a code period starts
     //Telemetry Decoder
     double Prn_timestamp_ms;             //!< Set by Telemetry Decoder processing block
     double Prn_timestamp_at_preamble_ms; //!< Set by Telemetry Decoder processing block
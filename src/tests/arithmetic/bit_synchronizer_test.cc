@@ -0,0 +1,78 @@
+/*!
+ * \file bit_synchronizer_test.cc
+ * \brief  This file implements tests for the histogram bit synchronizer of the tracking blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include "tracking_bit_synchronizer.h"
+
+
+TEST(Tracking_Bit_Synchronizer_Test, FindsBitEdge)
+{
+    const int symbols_per_bit = 20;
+    const int edge = 7; // the first code period is the 8th one of its bit
+    Tracking_Bit_Synchronizer bit_synchronizer;
+    bit_synchronizer.set_symbols_per_bit(symbols_per_bit);
+    srand(5);
+    float bit = 1.0;
+    int i;
+    for (i = 0; i < 200 * symbols_per_bit and !bit_synchronizer.synchronized(); i++)
+        {
+            if ((i + symbols_per_bit - edge) % symbols_per_bit == 0)
+                {
+                    bit = (rand() % 2 == 0) ? 1.0 : -1.0;
+                }
+            // a few wrong signs, as with a weak signal
+            float sign = (rand() % 100 == 0) ? -1.0 : 1.0;
+            bit_synchronizer.update(sign * bit * (1.0 + (float)rand() / RAND_MAX));
+        }
+    ASSERT_TRUE(bit_synchronizer.synchronized());
+
+    // the synchronizer tells the first code period of every bit
+    for (int k = 0; k < 2 * symbols_per_bit; k++, i++)
+        {
+            EXPECT_EQ((i + symbols_per_bit - edge) % symbols_per_bit == 0, bit_synchronizer.bit_start()) << "code period " << i;
+            bit_synchronizer.update(1.0);
+        }
+
+    bit_synchronizer.reset();
+    EXPECT_FALSE(bit_synchronizer.synchronized());
+}
+
+
+
+TEST(Tracking_Bit_Synchronizer_Test, NoEdgeInNoise)
+{
+    Tracking_Bit_Synchronizer bit_synchronizer;
+    srand(6);
+    for (int i = 0; i < 20000; i++)
+        {
+            bit_synchronizer.update((float)rand() / RAND_MAX - 0.5);
+            ASSERT_FALSE(bit_synchronizer.synchronized()) << "code period " << i;
+        }
+}
@@ -0,0 +1,82 @@
+/*!
+ * \file code_nco_test.cc
+ * \brief  This file implements tests for the fixed-point code NCO.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include "code_nco.h"
+
+
+TEST(Code_Nco_Test, MatchesFloatingPointResampling)
+{
+    const int code_length = 1023;
+    const int n_samples = 8000;
+    const double code_phase_step = 1.023e6 / 4.0e6 * 1.0002;
+    const double start_phase = -0.7;
+    std::complex<float>* code = new std::complex<float>[code_length];
+    std::complex<float>* replica = new std::complex<float>[n_samples];
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = std::complex<float>(i, 0.0);
+        }
+
+    Code_Nco code_nco;
+    code_nco.set_code_length(code_length);
+    code_nco.set_phase(start_phase + 0.5);
+    code_nco.set_phase_step(code_phase_step);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    code_nco.generate(replica, code, n_samples);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "Code replica of " << n_samples << " samples generated by the fixed-point NCO in "
+              << (end - begin) << " microseconds" << std::endl;
+
+    // Nearest chip of each sample, as computed before with fmod() and round()
+    int mismatches = 0;
+    for (int i = 0; i < n_samples; i++)
+        {
+            int index = (int)round(fmod(start_phase + i * code_phase_step, (double)code_length));
+            if (index < 0) index += code_length;
+            if (index == code_length) index = 0;
+            if (replica[i] != code[index]) mismatches++;
+        }
+    EXPECT_EQ(0, mismatches);
+
+    // The phase carries on where the replica ended
+    double expected_phase = fmod(start_phase + 0.5 + n_samples * code_phase_step, (double)code_length);
+    EXPECT_NEAR(expected_phase, (double)code_nco.phase() / 4294967296.0, 1e-6);
+
+    delete[] code;
+    delete[] replica;
+}
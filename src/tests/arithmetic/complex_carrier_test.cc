@@ -34,6 +34,7 @@
 #include <ctime>
 #include <armadillo>
 #include <volk/volk.h>
+#include "carrier_nco.h"
 #include "gnss_signal_processing.h"
 
 DEFINE_int32(size_carrier_test, 100000, "Size of the arrays used for complex carrier testing");
@@ -125,7 +126,7 @@ TEST(ComplexCarrier_Test, OwnComplexImplementation)
     gettimeofday(&tv, NULL);
     long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
     std::cout << "A " << FLAGS_size_carrier_test
-              << "-length complex carrier using fixed point generated in " << (end - begin)
+              << "-length complex carrier using the carrier NCO generated in " << (end - begin)
               << " microseconds" << std::endl;
     ASSERT_LE(0, end - begin);
     std::complex<float> expected(1,0);
@@ -137,3 +138,41 @@ TEST(ComplexCarrier_Test, OwnComplexImplementation)
         }
     delete [] output;
 }
+
+
+
+TEST(ComplexCarrier_Test, CarrierNcoMatchesExactPhase)
+{
+    // An odd length exercises the tail of the SIMD versions
+    const int n_samples = FLAGS_size_carrier_test + 3;
+    std::complex<float>* generic_output = new std::complex<float>[n_samples];
+    std::complex<float>* output = new std::complex<float>[n_samples];
+    const double start_phase = 1.234;
+    const double phase_step = GPS_TWO_PI * 1234.5 / 4000000.0;
+
+    std::string name;
+    carrier_nco_kernel kernel = carrier_nco_best_kernel(name);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    kernel(output, n_samples, start_phase, phase_step);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "A " << n_samples << "-length complex carrier using the " << name
+              << " carrier NCO generated in " << (end - begin) << " microseconds" << std::endl;
+
+    carrier_nco_generic(generic_output, n_samples, start_phase, phase_step);
+
+    for(int i = 0; i < n_samples; i++)
+        {
+            const double phase = start_phase + i * phase_step;
+            std::complex<float> expected(cos(phase), -sin(phase));
+            ASSERT_NEAR(0.0, std::abs(output[i] - expected), 1e-4);
+            ASSERT_NEAR(0.0, std::abs(generic_output[i] - expected), 1e-4);
+        }
+    delete [] generic_output;
+    delete [] output;
+}
@@ -0,0 +1,97 @@
+/*!
+ * \file dump_writer_test.cc
+ * \brief  This file implements tests for the asynchronous writer of the dump files.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gnss_dump_writer.h"
+
+
+TEST(Gnss_Dump_Writer_Test, WritesHeaderAndRecords)
+{
+    const std::string filename = "./dump_writer_test.dat";
+    Gnss_Dump_Schema schema("test");
+    schema.add_field("counter", Gnss_Dump_Schema::UINT64);
+    schema.add_field("value", Gnss_Dump_Schema::FLOAT64);
+    schema.add_field("value_float", Gnss_Dump_Schema::FLOAT32);
+    ASSERT_EQ(20u, schema.record_bytes());
+
+    const unsigned int records = 100000;
+    Gnss_Dump_File dump_file;
+    ASSERT_TRUE(dump_file.open(filename, schema));
+    std::vector<char> record(schema.record_bytes());
+    for (unsigned long int i = 0; i < records; i++)
+        {
+            const double value = 0.5 * (double)i;
+            const float value_float = (float)i;
+            memcpy(&record[0], &i, 8);
+            memcpy(&record[8], &value, 8);
+            memcpy(&record[16], &value_float, 4);
+            dump_file.write(&record[0]);
+        }
+    dump_file.close();
+    EXPECT_FALSE(dump_file.is_open());
+
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ("GNSS-SDR dump 1", line);
+    std::getline(file, line);
+    EXPECT_EQ("name test", line);
+    std::getline(file, line);
+    EXPECT_EQ("record_bytes 20", line);
+    std::getline(file, line);
+    EXPECT_EQ("field uint64 counter", line);
+    std::getline(file, line);
+    EXPECT_EQ("field float64 value", line);
+    std::getline(file, line);
+    EXPECT_EQ("field float32 value_float", line);
+    std::getline(file, line);
+    EXPECT_EQ("end_header", line);
+
+    // the records follow, in order. They fit in the ring, so none was dropped
+    unsigned long int written = 0;
+    while (file.read(&record[0], record.size()))
+        {
+            unsigned long int counter;
+            double value;
+            memcpy(&counter, &record[0], 8);
+            memcpy(&value, &record[8], 8);
+            ASSERT_EQ(written, counter);
+            ASSERT_DOUBLE_EQ(0.5 * (double)counter, value);
+            written++;
+        }
+    EXPECT_EQ(0u, dump_file.dropped_records());
+    EXPECT_EQ(records, written);
+    file.close();
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,97 @@
+/*!
+ * \file fft_plan_cache_test.cc
+ * \brief  This file implements tests for the FFT plan cache of the acquisition blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <complex>
+#include <string>
+#include "gnss_fft_plan_cache.h"
+
+
+TEST(Gnss_Fft_Plan_Cache_Test, SharesPlansBySizeAndDirection)
+{
+    // No wisdom file: the test neither reads nor writes the one of the user
+    Gnss_Fft_Plan_Cache& cache = Gnss_Fft_Plan_Cache::instance();
+    cache.configure("", "estimate");
+    EXPECT_EQ(std::string(""), cache.wisdom_filename());
+
+    unsigned int plans = cache.size();
+    Gnss_Fft fft_1(1021, true);
+    unsigned int plans_forward = cache.size();
+    EXPECT_GE(plans + 1, plans_forward);
+
+    // Same size, direction and buffer alignment: the plan is reused
+    Gnss_Fft fft_2(1021, true);
+    EXPECT_EQ(plans_forward, cache.size());
+
+    Gnss_Fft ifft(1021, false);
+    EXPECT_EQ(plans_forward + 1, cache.size());
+
+    // Nothing to write without a wisdom file
+    cache.save_wisdom();
+    EXPECT_EQ(plans_forward + 1, cache.size());
+}
+
+
+TEST(Gnss_Fft_Plan_Cache_Test, ForwardInverseRoundTrip)
+{
+    const unsigned int fft_size = 1000;
+    Gnss_Fft fft(fft_size, true);
+    Gnss_Fft ifft(fft_size, false);
+    EXPECT_EQ(fft_size, fft.inbuf_length());
+    EXPECT_EQ(fft_size, ifft.outbuf_length());
+
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            fft.get_inbuf()[i] = gr_complex((float)(i % 7) - 3.0, (float)(i % 5));
+        }
+    fft.execute();
+
+    // Constant term of the spectrum
+    gr_complex sum(0.0, 0.0);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            sum += fft.get_inbuf()[i];
+        }
+    EXPECT_NEAR(sum.real(), fft.get_outbuf()[0].real(), 1e-2);
+    EXPECT_NEAR(sum.imag(), fft.get_outbuf()[0].imag(), 1e-2);
+
+    // The transforms are not normalized
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            ifft.get_inbuf()[i] = fft.get_outbuf()[i];
+        }
+    ifft.execute();
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex sample = ifft.get_outbuf()[i] / (float)fft_size;
+            EXPECT_NEAR(fft.get_inbuf()[i].real(), sample.real(), 1e-4);
+            EXPECT_NEAR(fft.get_inbuf()[i].imag(), sample.imag(), 1e-4);
+        }
+}
@@ -0,0 +1,96 @@
+/*!
+ * \file lock_detector_test.cc
+ * \brief  This file implements tests for the streaming CN0 estimator and carrier lock detector.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include "lock_detectors.h"
+
+
+TEST(Tracking_Lock_Detector_Test, SlidingWindowMatchesBuffer)
+{
+    const int window = 20;
+    const int n = 1000;
+    const long fs_in = 4000000;
+    gr_complex* prompt = new gr_complex[n];
+    srand(3);
+    for (int i = 0; i < n; i++)
+        {
+            // data bits on the in-phase component, noise on both
+            float bit = ((i / 20) % 3 == 0) ? -1.0 : 1.0;
+            prompt[i] = gr_complex(bit * 100.0 + 20.0 * ((float)rand() / RAND_MAX - 0.5),
+                    20.0 * ((float)rand() / RAND_MAX - 0.5));
+        }
+
+    Tracking_Lock_Detector lock_detector;
+    lock_detector.set_window(window, false);
+    for (int i = 0; i < n; i++)
+        {
+            lock_detector.update(prompt[i]);
+            ASSERT_EQ(i >= window - 1, lock_detector.ready());
+            if (lock_detector.ready())
+                {
+                    gr_complex* last = prompt + i - window + 1;
+                    EXPECT_NEAR(cn0_svn_estimator(last, window, fs_in, 1023.0), lock_detector.cn0_svn(fs_in, 1023.0), 1e-3) << "epoch " << i;
+                    EXPECT_NEAR(carrier_lock_detector(last, window), lock_detector.carrier_lock(), 1e-4) << "epoch " << i;
+                }
+        }
+
+    lock_detector.reset();
+    EXPECT_FALSE(lock_detector.ready());
+    delete[] prompt;
+}
+
+
+
+TEST(Tracking_Lock_Detector_Test, ExponentialWindowFollowsSignalLoss)
+{
+    const int window = 20;
+    const long fs_in = 4000000;
+    Tracking_Lock_Detector lock_detector;
+    lock_detector.set_window(window, true);
+    srand(4);
+    for (int i = 0; i < 200; i++)
+        {
+            lock_detector.update(gr_complex(100.0 + 20.0 * ((float)rand() / RAND_MAX - 0.5),
+                    20.0 * ((float)rand() / RAND_MAX - 0.5)));
+        }
+    ASSERT_TRUE(lock_detector.ready());
+    float locked_cn0 = lock_detector.cn0_svn(fs_in, 1023.0);
+    EXPECT_GT(lock_detector.carrier_lock(), 0.85);
+
+    // the signal is lost: noise only, with a random phase
+    for (int i = 0; i < 3 * window; i++)
+        {
+            lock_detector.update(gr_complex(20.0 * ((float)rand() / RAND_MAX - 0.5),
+                    20.0 * ((float)rand() / RAND_MAX - 0.5)));
+        }
+    EXPECT_LT(lock_detector.cn0_svn(fs_in, 1023.0), locked_cn0 - 10.0);
+}
@@ -0,0 +1,66 @@
+/*!
+ * \file lock_history_test.cc
+ * \brief  This file implements tests for the record of the last tracking state in lock.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "tracking_lock_history.h"
+#include "gnss_synchro.h"
+
+
+TEST(Tracking_Lock_History_Test, PublishesLastStateInLock)
+{
+    const long fs_in = 4000000;
+    const double code_period_samples = 4000.0;
+    Tracking_Lock_History lock_history;
+    lock_history.set_fs(fs_in);
+
+    Gnss_Synchro synchro;
+    synchro.Flag_reacquisition = true;
+    lock_history.publish(&synchro);
+    EXPECT_FALSE(synchro.Flag_reacquisition); // nothing recorded yet
+
+    // one second in lock with a Doppler rate of -0.5 Hz/s
+    unsigned long int prn_start = 0;
+    double doppler_hz = 0.0;
+    for (int k = 0; k <= 1000; k++)
+        {
+            prn_start = (unsigned long int)(k * code_period_samples);
+            doppler_hz = 1500.0 - 0.5 * (double)prn_start / (double)fs_in;
+            lock_history.update(prn_start, code_period_samples, doppler_hz);
+        }
+    ASSERT_TRUE(lock_history.valid());
+    lock_history.publish(&synchro);
+    EXPECT_TRUE(synchro.Flag_reacquisition);
+    EXPECT_EQ(prn_start, synchro.Reacq_samplestamp_samples);
+    EXPECT_DOUBLE_EQ(code_period_samples, synchro.Reacq_code_period_samples);
+    EXPECT_DOUBLE_EQ(doppler_hz, synchro.Reacq_doppler_hz);
+    EXPECT_NEAR(-0.5, synchro.Reacq_doppler_rate_hz_s, 1e-9);
+
+    lock_history.reset();
+    EXPECT_FALSE(lock_history.valid());
+}
@@ -0,0 +1,183 @@
+/*!
+ * \file multicorrelator_int16_test.cc
+ * \brief  This file implements tests for the 16-bit integer carrier wipe-off and
+ * multicorrelator kernels.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <string>
+#include "correlator_int16.h"
+#include "multicorrelator_int16_kernels.h"
+
+
+TEST(Multicorrelator_Int16_Test, BestKernelsMatchGeneric)
+{
+    const int n_samples = FLAGS_size_multicorrelator_test;
+    const int n_correlators = 7;  // more than one pass of every kernel
+    lv_16sc_t* input = new lv_16sc_t[n_samples];
+    int16_t* bb_i = new int16_t[n_samples];
+    int16_t* bb_q = new int16_t[n_samples];
+    int16_t* expected_bb_i = new int16_t[n_samples];
+    int16_t* expected_bb_q = new int16_t[n_samples];
+    int16_t* codes[n_correlators];
+    int32_t corr_i[n_correlators];
+    int32_t corr_q[n_correlators];
+    int32_t expected_corr_i[n_correlators];
+    int32_t expected_corr_q[n_correlators];
+    srand(1);
+    for (int i = 0; i < n_samples; i++)
+        {
+            input[i] = lv_16sc_t(rand() % 65535 - 32767, rand() % 65535 - 32767);
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            codes[k] = new int16_t[n_samples];
+            for (int i = 0; i < n_samples; i++)
+                {
+                    codes[k][i] = rand() % 2 ? 1 : -1;
+                }
+        }
+    const uint32_t carrier_phase = 123456789;
+    const uint32_t carrier_phase_step = carrier_phase_int16(-0.01234);
+
+    std::string wipeoff_arch;
+    carrier_wipeoff_int16_kernel wipeoff = carrier_wipeoff_int16_best_kernel(wipeoff_arch);
+    std::string multicorrelator_arch;
+    multicorrelator_int16_kernel multicorrelator = multicorrelator_int16_best_kernel(multicorrelator_arch);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    wipeoff(input, carrier_phase, carrier_phase_step, bb_i, bb_q, n_samples);
+    multicorrelator(bb_i, bb_q, n_correlators, codes, corr_i, corr_q, n_samples);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "Carrier wipe-off (" << wipeoff_arch << ") and " << n_correlators << " correlations ("
+              << multicorrelator_arch << ") of " << n_samples << " 16-bit samples finished in "
+              << (end - begin) << " microseconds" << std::endl;
+
+    // Integer arithmetic: the results must be identical
+    carrier_wipeoff_int16_generic(input, carrier_phase, carrier_phase_step, expected_bb_i, expected_bb_q, n_samples);
+    for (int i = 0; i < n_samples; i++)
+        {
+            ASSERT_EQ(expected_bb_i[i], bb_i[i]) << "at sample " << i;
+            ASSERT_EQ(expected_bb_q[i], bb_q[i]) << "at sample " << i;
+        }
+    multicorrelator_int16_generic(bb_i, bb_q, n_correlators, codes, expected_corr_i, expected_corr_q, n_samples);
+    for (int k = 0; k < n_correlators; k++)
+        {
+            EXPECT_EQ(expected_corr_i[k], corr_i[k]);
+            EXPECT_EQ(expected_corr_q[k], corr_q[k]);
+            delete[] codes[k];
+        }
+    delete[] input;
+    delete[] bb_i;
+    delete[] bb_q;
+    delete[] expected_bb_i;
+    delete[] expected_bb_q;
+}
+
+
+TEST(Multicorrelator_Int16_Test, CorrelatorMatchesFloat)
+{
+    const int n_samples = FLAGS_size_multicorrelator_test;
+    const int code_length = 1023;
+    const int n_correlators = 3;
+    const double code_phase = -0.3;
+    const double code_phase_step = 1.023e6 / 4.0e6 * 1.0001;
+    const double tap_shifts[n_correlators] = {-0.5, 0.0, 0.5};
+    const double carrier_phase = 1.0;
+    const double carrier_phase_step = -0.0123;
+    lv_16sc_t* input = new lv_16sc_t[n_samples];
+    int16_t* code = new int16_t[code_length];
+    gr_complex results[n_correlators];
+    gr_complex* outs[n_correlators];
+    srand(1);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = rand() % 2 ? 1 : -1;
+        }
+    // A carrier modulated by the prompt code, plus noise
+    for (int i = 0; i < n_samples; i++)
+        {
+            int index = (int)floor(code_phase + i * code_phase_step + 0.5) % code_length;
+            if (index < 0) index += code_length;
+            std::complex<double> sample = std::polar(1000.0 * code[index], carrier_phase + i * carrier_phase_step);
+            input[i] = lv_16sc_t(floor(sample.real() + 0.5) + rand() % 255 - 127,
+                                 floor(sample.imag() + 0.5) + rand() % 255 - 127);
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            outs[k] = &results[k];
+        }
+
+    Correlator_Int16 correlator;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    correlator.Carrier_wipeoff_and_multicorrelator_resampler(n_samples, input, carrier_phase,
+            carrier_phase_step, code, code_length, code_phase, code_phase_step, n_correlators,
+            tap_shifts, outs);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "16-bit carrier wipe-off and " << n_correlators << " correlations of " << n_samples
+              << " samples with on the fly code resampling finished in " << (end - begin)
+              << " microseconds" << std::endl;
+
+    // Double precision reference, with the replicas taking the nearest chip
+    std::complex<double> expected[n_correlators];
+    double prompt_magnitude = 0.0;
+    for (int k = 0; k < n_correlators; k++)
+        {
+            expected[k] = 0.0;
+            for (int i = 0; i < n_samples; i++)
+                {
+                    double phase = code_phase + tap_shifts[k] + i * code_phase_step;
+                    int index = (int)floor(phase + 0.5) % code_length;
+                    if (index < 0) index += code_length;
+                    std::complex<double> sample(input[i].real(), input[i].imag());
+                    expected[k] += sample * std::polar(1.0, -(carrier_phase + i * carrier_phase_step)) * (double)code[index];
+                }
+            prompt_magnitude = std::max(prompt_magnitude, std::abs(expected[k]));
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            // The carrier table quantizes the phase to 2*pi/256 rad
+            float tolerance = 1e-2 * prompt_magnitude;
+            EXPECT_NEAR(expected[k].real(), results[k].real(), tolerance);
+            EXPECT_NEAR(expected[k].imag(), results[k].imag(), tolerance);
+        }
+    delete[] input;
+    delete[] code;
+}
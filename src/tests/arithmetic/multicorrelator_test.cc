@@ -0,0 +1,173 @@
+/*!
+ * \file multicorrelator_test.cc
+ * \brief  This file implements tests for the fused carrier wipe-off and
+ * multicorrelator kernels.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <string>
+#include <volk/volk.h>
+#include "correlator.h"
+#include "multicorrelator_kernels.h"
+
+DEFINE_int32(size_multicorrelator_test, 4093, "Number of samples of the multicorrelator test");
+
+
+TEST(Multicorrelator_Test, BestKernelMatchesVolk)
+{
+    const int n_samples = FLAGS_size_multicorrelator_test;
+    const int n_correlators = 7;  // more than one pass of every kernel
+    gr_complex* input;
+    if (posix_memalign((void**)&input, 16, n_samples * sizeof(gr_complex)) == 0){};
+    gr_complex* carrier;
+    if (posix_memalign((void**)&carrier, 16, n_samples * sizeof(gr_complex)) == 0){};
+    gr_complex* bb_signal;
+    if (posix_memalign((void**)&bb_signal, 16, n_samples * sizeof(gr_complex)) == 0){};
+    gr_complex* codes[n_correlators];
+    gr_complex results[n_correlators];
+    gr_complex* outs[n_correlators];
+    srand(1);
+    for (int i = 0; i < n_samples; i++)
+        {
+            input[i] = gr_complex(rand() % 255 - 127, rand() % 255 - 127);
+            carrier[i] = std::polar<float>(1.0, 0.01 * i);
+        }
+    for (int k = 0; k < n_correlators; k++)
+        {
+            if (posix_memalign((void**)&codes[k], 16, n_samples * sizeof(gr_complex)) == 0){};
+            for (int i = 0; i < n_samples; i++)
+                {
+                    codes[k][i] = gr_complex(rand() % 2 ? 1.0 : -1.0, 0.0);
+                }
+            outs[k] = &results[k];
+        }
+
+    Correlator correlator;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    correlator.Carrier_wipeoff_and_multicorrelator(n_samples, input, carrier, n_correlators, codes, outs);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::string arch;
+    multicorrelator_best_kernel(arch);
+    std::cout << "Carrier wipe-off and " << n_correlators << " correlations of " << n_samples
+              << " samples with the " << arch << " multicorrelator finished in " << (end - begin)
+              << " microseconds" << std::endl;
+
+    volk_32fc_x2_multiply_32fc(bb_signal, input, carrier, n_samples);
+    for (int k = 0; k < n_correlators; k++)
+        {
+            gr_complex expected;
+            volk_32fc_x2_dot_prod_32fc(&expected, bb_signal, codes[k], n_samples);
+            // Only the summation order differs
+            float tolerance = 1e-4 * std::abs(expected) + 1e-2;
+            EXPECT_NEAR(expected.real(), results[k].real(), tolerance);
+            EXPECT_NEAR(expected.imag(), results[k].imag(), tolerance);
+            free(codes[k]);
+        }
+    free(input);
+    free(carrier);
+    free(bb_signal);
+}
+
+
+TEST(Multicorrelator_Test, ResamplerMatchesReplicas)
+{
+    const int n_samples = FLAGS_size_multicorrelator_test;
+    const int code_length = 1023;
+    const int n_correlators = 3;
+    const double code_phase = -0.3;
+    const double code_phase_step = 1.023e6 / 4.0e6 * 1.0001;
+    const double tap_shifts[n_correlators] = {-0.5, 0.0, 0.5};
+    gr_complex* input;
+    if (posix_memalign((void**)&input, 16, n_samples * sizeof(gr_complex)) == 0){};
+    gr_complex* carrier;
+    if (posix_memalign((void**)&carrier, 16, n_samples * sizeof(gr_complex)) == 0){};
+    gr_complex* code = new gr_complex[code_length];
+    gr_complex* replicas[n_correlators];
+    gr_complex expected[n_correlators];
+    gr_complex results[n_correlators];
+    gr_complex* expected_outs[n_correlators];
+    gr_complex* outs[n_correlators];
+    srand(1);
+    for (int i = 0; i < n_samples; i++)
+        {
+            input[i] = gr_complex(rand() % 255 - 127, rand() % 255 - 127);
+            carrier[i] = std::polar<float>(1.0, 0.01 * i);
+        }
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex(rand() % 2 ? 1.0 : -1.0, 0.0);
+        }
+    // Replicas taking the nearest chip of each sample, as the tracking blocks did
+    for (int k = 0; k < n_correlators; k++)
+        {
+            if (posix_memalign((void**)&replicas[k], 16, n_samples * sizeof(gr_complex)) == 0){};
+            for (int i = 0; i < n_samples; i++)
+                {
+                    double phase = code_phase + tap_shifts[k] + i * code_phase_step;
+                    int index = (int)floor(phase + 0.5) % code_length;
+                    if (index < 0) index += code_length;
+                    replicas[k][i] = code[index];
+                }
+            expected_outs[k] = &expected[k];
+            outs[k] = &results[k];
+        }
+
+    Correlator correlator;
+    correlator.Carrier_wipeoff_and_multicorrelator(n_samples, input, carrier, n_correlators, replicas, expected_outs);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    correlator.Carrier_wipeoff_and_multicorrelator_resampler(n_samples, input, carrier, code, code_length,
+            code_phase, code_phase_step, n_correlators, tap_shifts, outs);
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "Carrier wipe-off and " << n_correlators << " correlations of " << n_samples
+              << " samples with on the fly code resampling finished in " << (end - begin)
+              << " microseconds" << std::endl;
+
+    for (int k = 0; k < n_correlators; k++)
+        {
+            float tolerance = 1e-4 * std::abs(expected[k]) + 1e-2;
+            EXPECT_NEAR(expected[k].real(), results[k].real(), tolerance);
+            EXPECT_NEAR(expected[k].imag(), results[k].imag(), tolerance);
+            free(replicas[k]);
+        }
+    delete[] code;
+    free(input);
+    free(carrier);
+}
@@ -0,0 +1,125 @@
+/*!
+ * \file overload_controller_test.cc
+ * \brief  This file implements tests for the overload controller of the receiver.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <boost/thread/thread.hpp>
+#include "gnss_overload_controller.h"
+
+
+// Reports the work of a block over one evaluation interval, at the given load
+static int report_interval(Gnss_Overload_Controller& controller, double load)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+    return controller.report_work(1, load * 0.1, 0.1, 0.0);
+}
+
+
+TEST(Gnss_Overload_Controller_Test, DegradesAndRestores)
+{
+    Gnss_Overload_Controller& controller = Gnss_Overload_Controller::instance();
+    controller.reset();
+    controller.configure(true, 0.9, 0.6, 0.001);
+    controller.add_dump();  // a tracking dump that REDUCED_COST stops
+    for (unsigned int channel = 0; channel < 8; channel++)
+        {
+            EXPECT_FALSE(controller.report_cn0(channel, 40.0 + channel));
+        }
+
+    // one level more per overloaded interval
+    EXPECT_EQ(Gnss_Overload_Controller::REDUCED_COST, report_interval(controller, 2.0));
+    EXPECT_FALSE(controller.acquisition_paused());
+    EXPECT_EQ(Gnss_Overload_Controller::ACQUISITION_PAUSED, report_interval(controller, 2.0));
+    EXPECT_TRUE(controller.acquisition_paused());
+    EXPECT_EQ(Gnss_Overload_Controller::SHEDDING, report_interval(controller, 2.0));
+    EXPECT_NEAR(2.0, controller.load(), 1e-9);
+
+    // then the weakest satellite is dropped at each interval
+    report_interval(controller, 2.0);
+    EXPECT_EQ(1u, controller.dropped_satellites());
+    EXPECT_TRUE(controller.report_cn0(0, 40.0));
+    EXPECT_FALSE(controller.report_cn0(1, 41.0));
+    controller.report_cn0(0, 0.0);  // the channel lost the satellite
+
+    // a few relieved intervals restore each level
+    int level = controller.level();
+    for (int i = 0; i < 100 and level > Gnss_Overload_Controller::NORMAL; i++)
+        {
+            level = report_interval(controller, 0.1);
+        }
+    EXPECT_EQ(Gnss_Overload_Controller::NORMAL, level);
+    EXPECT_FALSE(controller.acquisition_paused());
+
+    controller.remove_dump();
+    controller.configure(false, 0.9, 0.6, 1.0);
+    controller.reset();
+}
+
+
+
+TEST(Gnss_Overload_Controller_Test, SkipsReducedCostWithoutDumps)
+{
+    Gnss_Overload_Controller& controller = Gnss_Overload_Controller::instance();
+    controller.reset();
+    controller.configure(true, 0.9, 0.6, 0.001);
+
+    // without tracking dumps, REDUCED_COST sheds nothing
+    EXPECT_EQ(Gnss_Overload_Controller::ACQUISITION_PAUSED, report_interval(controller, 2.0));
+    int level = controller.level();
+    for (int i = 0; i < 100 and level > Gnss_Overload_Controller::NORMAL; i++)
+        {
+            level = report_interval(controller, 0.1);
+            EXPECT_NE(Gnss_Overload_Controller::REDUCED_COST, level);
+        }
+    EXPECT_EQ(Gnss_Overload_Controller::NORMAL, level);
+
+    controller.configure(false, 0.9, 0.6, 1.0);
+    controller.reset();
+}
+
+
+
+TEST(Gnss_Overload_Controller_Test, KeepsSatellitesForThePvt)
+{
+    Gnss_Overload_Controller& controller = Gnss_Overload_Controller::instance();
+    controller.reset();
+    controller.configure(true, 0.9, 0.6, 0.001);
+    for (unsigned int channel = 0; channel < 4; channel++)
+        {
+            controller.report_cn0(channel, 40.0);
+        }
+    for (int i = 0; i < 10; i++)
+        {
+            report_interval(controller, 2.0);
+        }
+    EXPECT_EQ(Gnss_Overload_Controller::SHEDDING, controller.level());
+    EXPECT_EQ(0u, controller.dropped_satellites());
+
+    controller.configure(false, 0.9, 0.6, 1.0);
+    controller.reset();
+}
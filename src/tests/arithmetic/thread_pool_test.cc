@@ -0,0 +1,134 @@
+/*!
+ * \file thread_pool_test.cc
+ * \brief  This file implements tests for the thread pool of the signal processing blocks.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <map>
+#include <utility>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include "gnss_thread_pool.h"
+
+
+struct Thread_Pool_Test_Record
+{
+    boost::mutex mutex;
+    unsigned int tasks_run;
+    bool valid_workers;
+    bool stable_scratch;
+    std::map<std::pair<unsigned int, unsigned int>, Gnss_Fft_Scratch*> scratch; // by worker and FFT size
+};
+
+
+static void record_task(Gnss_Thread_Pool* pool, Thread_Pool_Test_Record* record,
+        unsigned int fft_size, unsigned int worker)
+{
+    Gnss_Fft_Scratch* scratch = 0;
+    if (fft_size > 0)
+        {
+            scratch = &pool->scratch(worker, fft_size);
+            scratch->magnitude[fft_size - 1] = 1.0;
+            scratch->fft.get_inbuf()[fft_size - 1] = gr_complex(1.0, 0.0);
+        }
+    boost::mutex::scoped_lock lock(record->mutex);
+    record->tasks_run++;
+    if (worker >= pool->size())
+        {
+            record->valid_workers = false;
+        }
+    if (scratch != 0)
+        {
+            std::pair<unsigned int, unsigned int> key(worker, fft_size);
+            if (record->scratch.count(key) > 0 && record->scratch[key] != scratch)
+                {
+                    record->stable_scratch = false;
+                }
+            record->scratch[key] = scratch;
+            if (scratch->fft.inbuf_length() != fft_size || scratch->ifft.inbuf_length() != fft_size)
+                {
+                    record->stable_scratch = false;
+                }
+        }
+}
+
+
+TEST(Gnss_Thread_Pool_Test, RunsEveryTask)
+{
+    Thread_Pool_Test_Record record;
+    record.tasks_run = 0;
+    record.valid_workers = true;
+    record.stable_scratch = true;
+    {
+        Gnss_Thread_Pool pool(3);
+        EXPECT_EQ((unsigned int)3, pool.size());
+        std::vector<Gnss_Thread_Pool::Task> tasks;
+        for (unsigned int i = 0; i < 1000; i++)
+            {
+                tasks.push_back(boost::bind(&record_task, &pool, &record, 0, _1));
+            }
+        pool.submit(tasks);
+        pool.submit(boost::bind(&record_task, &pool, &record, 0, _1));
+        // the destructor runs the pending tasks
+    }
+    EXPECT_EQ((unsigned int)1001, record.tasks_run);
+    EXPECT_TRUE(record.valid_workers);
+}
+
+
+TEST(Gnss_Thread_Pool_Test, ScratchPerWorkerAndFftSize)
+{
+    Thread_Pool_Test_Record record;
+    record.tasks_run = 0;
+    record.valid_workers = true;
+    record.stable_scratch = true;
+    {
+        Gnss_Thread_Pool pool(2);
+        std::vector<Gnss_Thread_Pool::Task> tasks;
+        for (unsigned int i = 0; i < 200; i++)
+            {
+                // two blocks with different FFT sizes
+                tasks.push_back(boost::bind(&record_task, &pool, &record, i % 2 == 0 ? 1024 : 4000, _1));
+            }
+        pool.submit(tasks);
+    }
+    EXPECT_EQ((unsigned int)200, record.tasks_run);
+    EXPECT_TRUE(record.valid_workers);
+    EXPECT_TRUE(record.stable_scratch);
+
+    // one scratch for each worker and FFT size, whatever the number of tasks
+    EXPECT_GE((unsigned int)4, record.scratch.size());
+    EXPECT_LE((unsigned int)2, record.scratch.size());
+    std::map<Gnss_Fft_Scratch*, unsigned int> owners;
+    for (std::map<std::pair<unsigned int, unsigned int>, Gnss_Fft_Scratch*>::iterator it = record.scratch.begin();
+            it != record.scratch.end(); ++it)
+        {
+            owners[it->second]++;
+        }
+    EXPECT_EQ(record.scratch.size(), owners.size());
+}
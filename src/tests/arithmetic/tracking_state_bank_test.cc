@@ -0,0 +1,247 @@
+/*!
+ * \file tracking_state_bank_test.cc
+ * \brief  This file implements tests for the batched loop update of Tracking_State_Bank.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include "tracking_2nd_DLL_filter.h"
+#include "tracking_2nd_PLL_filter.h"
+#include "tracking_discriminators.h"
+#include "tracking_state_bank.h"
+
+
+TEST(Tracking_State_Bank_Test, DiscriminatorsMatchScalar)
+{
+    const int n = 37;
+    float early_i[n], early_q[n], prompt_i[n], prompt_q[n], late_i[n], late_q[n];
+    float carr_discriminator[n], code_discriminator[n];
+    srand(1);
+    for (int k = 0; k < n; k++)
+        {
+            early_i[k] = (float)rand() / RAND_MAX - 0.5;
+            early_q[k] = (float)rand() / RAND_MAX - 0.5;
+            prompt_i[k] = (float)rand() / RAND_MAX - 0.5;
+            prompt_q[k] = 4.0 * ((float)rand() / RAND_MAX - 0.5);
+            late_i[k] = (float)rand() / RAND_MAX - 0.5;
+            late_q[k] = (float)rand() / RAND_MAX - 0.5;
+        }
+    prompt_i[0] = 0.0;
+
+    pll_cloop_two_quadrant_atan(prompt_i, prompt_q, carr_discriminator, n);
+    dll_nc_e_minus_l_normalized(early_i, early_q, late_i, late_q, code_discriminator, n);
+
+    for (int k = 0; k < n; k++)
+        {
+            gr_complex prompt(prompt_i[k], prompt_q[k]);
+            gr_complex early(early_i[k], early_q[k]);
+            gr_complex late(late_i[k], late_q[k]);
+            EXPECT_NEAR(pll_cloop_two_quadrant_atan(prompt), carr_discriminator[k], 1e-6) << "channel " << k;
+            EXPECT_NEAR(dll_nc_e_minus_l_normalized(early, late), code_discriminator[k], 1e-6) << "channel " << k;
+        }
+}
+
+
+
+TEST(Tracking_State_Bank_Test, LoopsMatchScalarFilters)
+{
+    const int n = 11;
+    const long fs_in = 4000000;
+    const float pll_bw_hz = 50.0;
+    const float dll_bw_hz = 2.0;
+    // single precision, as in the bank
+    const float code_rate_hz = 1.023e6;
+    const float carrier_freq_hz = 1.57542e9;
+    const float code_length_chips = 1023.0;
+    const float T = 0.001;
+    const float fs = fs_in;
+
+    Tracking_State_Bank bank;
+    bank.configure(fs_in, carrier_freq_hz, code_rate_hz, code_length_chips, T, pll_bw_hz, dll_bw_hz);
+    bank.resize(n);
+
+    Tracking_2nd_PLL_filter carrier_loop_filter[n];
+    Tracking_2nd_DLL_filter code_loop_filter[n];
+    float carrier_doppler_hz[n];
+    float rem_code_phase_samples[n];
+    int prn_length_samples[n];
+    for (int k = 0; k < n; k++)
+        {
+            float doppler = -4000.0 + 800.0 * k;
+            float code_freq = code_rate_hz * (carrier_freq_hz + doppler) / carrier_freq_hz;
+            int length = round(code_length_chips / code_freq * fs);
+            bank.initialize(k, doppler, code_freq, length);
+            carrier_loop_filter[k] = Tracking_2nd_PLL_filter(T);
+            carrier_loop_filter[k].set_PLL_BW(pll_bw_hz);
+            carrier_loop_filter[k].initialize();
+            code_loop_filter[k] = Tracking_2nd_DLL_filter(T);
+            code_loop_filter[k].set_DLL_BW(dll_bw_hz);
+            code_loop_filter[k].initialize();
+            carrier_doppler_hz[k] = doppler;
+            rem_code_phase_samples[k] = 0.0;
+            prn_length_samples[k] = length;
+        }
+
+    srand(2);
+    for (int epoch = 0; epoch < 100; epoch++)
+        {
+            bool pending[n];
+            for (int k = 0; k < n; k++)
+                {
+                    // channels integrate in different rounds
+                    pending[k] = (rand() % 3) != 0;
+                    bank.early_i[k] = 0.6 + 0.1 * ((float)rand() / RAND_MAX);
+                    bank.early_q[k] = 0.1 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.prompt_i[k] = 1.0;
+                    bank.prompt_q[k] = 0.2 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.late_i[k] = 0.6 + 0.1 * ((float)rand() / RAND_MAX);
+                    bank.late_q[k] = 0.1 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.pending[k] = pending[k];
+                }
+
+            // reference: the scalar loops of Gps_L1_Ca_Dll_Pll_Tracking_cc
+            for (int k = 0; k < n; k++)
+                {
+                    if (!pending[k]) continue;
+                    gr_complex prompt(bank.prompt_i[k], bank.prompt_q[k]);
+                    gr_complex early(bank.early_i[k], bank.early_q[k]);
+                    gr_complex late(bank.late_i[k], bank.late_q[k]);
+                    float carr_error_hz = pll_cloop_two_quadrant_atan(prompt) / (float)(2.0 * M_PI);
+                    float carr_error_filt_hz = carrier_loop_filter[k].get_carrier_nco(carr_error_hz);
+                    carrier_doppler_hz[k] = bank.acq_carrier_doppler_hz[k] + carr_error_filt_hz;
+                    float code_freq_chips = code_rate_hz + carrier_doppler_hz[k] * code_rate_hz / carrier_freq_hz;
+                    float code_error_chips = dll_nc_e_minus_l_normalized(early, late);
+                    float code_error_filt_chips = code_loop_filter[k].get_code_nco(code_error_chips);
+                    float code_error_filt_secs = T * code_error_filt_chips / code_rate_hz;
+                    float K_blk_samples = code_length_chips / code_freq_chips * fs + rem_code_phase_samples[k] + code_error_filt_secs * fs;
+                    prn_length_samples[k] = round(K_blk_samples);
+                    rem_code_phase_samples[k] = K_blk_samples - prn_length_samples[k];
+                }
+
+            bank.update_loops();
+
+            for (int k = 0; k < n; k++)
+                {
+                    EXPECT_EQ(0, bank.pending[k]);
+                    EXPECT_NEAR(carrier_doppler_hz[k], bank.carrier_doppler_hz[k], 1e-2) << "channel " << k << " epoch " << epoch;
+                    EXPECT_EQ(prn_length_samples[k], bank.prn_length_samples[k]) << "channel " << k << " epoch " << epoch;
+                    EXPECT_NEAR(rem_code_phase_samples[k], bank.rem_code_phase_samples[k], 1e-2) << "channel " << k << " epoch " << epoch;
+                }
+        }
+}
+
+
+
+TEST(Tracking_State_Bank_Test, ExtendedIntegrationMatchesScalarFilters)
+{
+    const int n = 5;
+    const int code_periods[n] = {1, 2, 4, 5, 20};
+    const long fs_in = 4000000;
+    const float pll_bw_narrow_hz = 15.0;
+    const float dll_bw_narrow_hz = 1.5;
+    const float code_rate_hz = 1.023e6;
+    const float carrier_freq_hz = 1.57542e9;
+    const float code_length_chips = 1023.0;
+    const float T = 0.001;
+    const float fs = fs_in;
+
+    Tracking_State_Bank bank;
+    bank.configure(fs_in, carrier_freq_hz, code_rate_hz, code_length_chips, T, 50.0, 2.0);
+    bank.resize(n);
+
+    Tracking_2nd_PLL_filter carrier_loop_filter[n];
+    Tracking_2nd_DLL_filter code_loop_filter[n];
+    float carrier_doppler_hz[n];
+    float rem_code_phase_samples[n];
+    int prn_length_samples[n];
+    for (int k = 0; k < n; k++)
+        {
+            float doppler = -1500.0 + 700.0 * k;
+            float code_freq = code_rate_hz * (carrier_freq_hz + doppler) / carrier_freq_hz;
+            int length = round(code_length_chips / code_freq * fs);
+            bank.initialize(k, doppler, code_freq, length);
+            bank.set_loop_integration(k, code_periods[k], pll_bw_narrow_hz, dll_bw_narrow_hz);
+            carrier_loop_filter[k] = Tracking_2nd_PLL_filter(T * code_periods[k]);
+            carrier_loop_filter[k].set_PLL_BW(pll_bw_narrow_hz);
+            carrier_loop_filter[k].initialize();
+            code_loop_filter[k] = Tracking_2nd_DLL_filter(T * code_periods[k]);
+            code_loop_filter[k].set_DLL_BW(dll_bw_narrow_hz);
+            code_loop_filter[k].initialize();
+            carrier_doppler_hz[k] = doppler;
+            rem_code_phase_samples[k] = 0.0;
+            prn_length_samples[k] = length;
+        }
+
+    srand(3);
+    for (int epoch = 0; epoch < 100; epoch++)
+        {
+            for (int k = 0; k < n; k++)
+                {
+                    bank.early_i[k] = 0.6 + 0.1 * ((float)rand() / RAND_MAX);
+                    bank.early_q[k] = 0.1 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.prompt_i[k] = 1.0;
+                    bank.prompt_q[k] = 0.2 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.late_i[k] = 0.6 + 0.1 * ((float)rand() / RAND_MAX);
+                    bank.late_q[k] = 0.1 * ((float)rand() / RAND_MAX - 0.5);
+                    bank.pending[k] = 1;
+                    bank.loop_update[k] = ((epoch + 1) % code_periods[k]) == 0;
+                }
+
+            // reference: the scalar loops of Gps_L1_Ca_Dll_Pll_Tracking_cc with extended integration
+            for (int k = 0; k < n; k++)
+                {
+                    float code_error_filt_secs = 0.0;
+                    if (bank.loop_update[k])
+                        {
+                            gr_complex prompt(bank.prompt_i[k], bank.prompt_q[k]);
+                            gr_complex early(bank.early_i[k], bank.early_q[k]);
+                            gr_complex late(bank.late_i[k], bank.late_q[k]);
+                            float carr_error_hz = pll_cloop_two_quadrant_atan(prompt) / (float)(2.0 * M_PI);
+                            float carr_error_filt_hz = carrier_loop_filter[k].get_carrier_nco(carr_error_hz);
+                            carrier_doppler_hz[k] = bank.acq_carrier_doppler_hz[k] + carr_error_filt_hz;
+                            float code_error_chips = dll_nc_e_minus_l_normalized(early, late);
+                            float code_error_filt_chips = code_loop_filter[k].get_code_nco(code_error_chips);
+                            code_error_filt_secs = T * code_periods[k] * code_error_filt_chips / code_rate_hz;
+                        }
+                    float code_freq_chips = code_rate_hz + carrier_doppler_hz[k] * code_rate_hz / carrier_freq_hz;
+                    float K_blk_samples = code_length_chips / code_freq_chips * fs + rem_code_phase_samples[k] + code_error_filt_secs * fs;
+                    prn_length_samples[k] = round(K_blk_samples);
+                    rem_code_phase_samples[k] = K_blk_samples - prn_length_samples[k];
+                }
+
+            bank.update_loops();
+
+            for (int k = 0; k < n; k++)
+                {
+                    EXPECT_NEAR(carrier_doppler_hz[k], bank.carrier_doppler_hz[k], 1e-2) << "channel " << k << " epoch " << epoch;
+                    EXPECT_EQ(prn_length_samples[k], bank.prn_length_samples[k]) << "channel " << k << " epoch " << epoch;
+                    EXPECT_NEAR(rem_code_phase_samples[k], bank.rem_code_phase_samples[k], 1e-2) << "channel " << k << " epoch " << epoch;
+                }
+        }
+}
@@ -0,0 +1,123 @@
+/*!
+ * \file vector_estimator_test.cc
+ * \brief  This file implements tests for the least squares estimator of the vector tracking.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cmath>
+#include "tracking_vector_estimator.h"
+
+
+static void vector_estimator_test_geometry(Tracking_Vector_Estimator& estimator, int n_channels,
+        const double* rx_velocity_m_s, double clock_drift_hz, double wavelength_m, float* doppler_hz)
+{
+    // satellites spread in azimuth and elevation, moving at a few km/s
+    for (int k = 0; k < n_channels; k++)
+        {
+            const double azimuth = 2.0 * M_PI * k / n_channels;
+            const double elevation = 0.2 + 1.2 * (k % 3) / 2.0;
+            const double los[3] = {cos(elevation) * cos(azimuth), cos(elevation) * sin(azimuth), sin(elevation)};
+            const double sat_velocity_m_s[3] = {3000.0 * sin(azimuth), -2500.0 * cos(azimuth), 1000.0 * (k % 2 ? 1.0 : -1.0)};
+            estimator.set_geometry(k, los, sat_velocity_m_s);
+            double range_rate_m_s = 0.0;
+            for (int i = 0; i < 3; i++)
+                {
+                    range_rate_m_s += (rx_velocity_m_s[i] - sat_velocity_m_s[i]) * los[i];
+                }
+            doppler_hz[k] = range_rate_m_s / wavelength_m + clock_drift_hz;
+        }
+}
+
+
+
+TEST(Tracking_Vector_Estimator_Test, PredictsDoppler)
+{
+    const int n_channels = 8;
+    const double carrier_freq_hz = 1.57542e9;
+    const double wavelength_m = 299792458.0 / carrier_freq_hz;
+    const double rx_velocity_m_s[3] = {12.0, -30.0, 2.5};
+    const double clock_drift_hz = 350.0;
+    float doppler_hz[n_channels];
+    float weight[n_channels];
+    Tracking_Vector_Estimator estimator;
+    estimator.configure(carrier_freq_hz, 5);
+    estimator.resize(n_channels);
+    vector_estimator_test_geometry(estimator, n_channels, rx_velocity_m_s, clock_drift_hz, wavelength_m, doppler_hz);
+    for (int k = 0; k < n_channels; k++)
+        {
+            weight[k] = 1000.0 * (k + 1);
+        }
+
+    // the last channel is out of lock: its loop Doppler is wrong, and it is not used
+    const float true_doppler_hz = doppler_hz[n_channels - 1];
+    doppler_hz[n_channels - 1] += 400.0;
+    weight[n_channels - 1] = 0.0;
+
+    ASSERT_TRUE(estimator.estimate(doppler_hz, weight));
+    EXPECT_EQ(n_channels - 1, estimator.channels_used());
+    for (int i = 0; i < 3; i++)
+        {
+            EXPECT_NEAR(rx_velocity_m_s[i], estimator.receiver_velocity_m_s()[i], 0.01);
+        }
+    EXPECT_NEAR(clock_drift_hz, estimator.clock_drift_hz(), 0.05);
+    EXPECT_NEAR(true_doppler_hz, estimator.predicted_doppler_hz(n_channels - 1), 0.05);
+}
+
+
+
+TEST(Tracking_Vector_Estimator_Test, RejectsOutlier)
+{
+    const int n_channels = 8;
+    const double carrier_freq_hz = 1.57542e9;
+    const double wavelength_m = 299792458.0 / carrier_freq_hz;
+    const double rx_velocity_m_s[3] = {0.0, 0.0, 0.0};
+    float doppler_hz[n_channels];
+    float weight[n_channels];
+    Tracking_Vector_Estimator estimator;
+    estimator.configure(carrier_freq_hz, 5);
+    estimator.resize(n_channels);
+    vector_estimator_test_geometry(estimator, n_channels, rx_velocity_m_s, -120.0, wavelength_m, doppler_hz);
+    for (int k = 0; k < n_channels; k++)
+        {
+            weight[k] = 1000.0;
+        }
+
+    // a false lock, 500 Hz away from the true Doppler
+    const float true_doppler_hz = doppler_hz[3];
+    doppler_hz[3] += 500.0;
+    ASSERT_TRUE(estimator.estimate(doppler_hz, weight));
+    EXPECT_EQ(n_channels - 1, estimator.channels_used());
+    EXPECT_NEAR(true_doppler_hz, estimator.predicted_doppler_hz(3), 0.05);
+
+    // not enough channels once the geometry of some of them is unknown
+    for (int k = 0; k < 3; k++)
+        {
+            estimator.clear_geometry(k);
+        }
+    EXPECT_FALSE(estimator.estimate(doppler_hz, weight));
+}
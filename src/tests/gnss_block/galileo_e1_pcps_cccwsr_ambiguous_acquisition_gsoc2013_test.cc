@@ -401,9 +401,15 @@ TEST_F(GalileoE1PcpsCccwsrAmbiguousAcquisitionTest, ConnectAndRun)
     delete config;
 }
 
-TEST_F(GalileoE1PcpsCccwsrAmbiguousAcquisitionTest, ValidationOfResults)
+class GalileoE1PcpsCccwsrAmbiguousAcquisitionValidationTest: public GalileoE1PcpsCccwsrAmbiguousAcquisitionTest,
+        public ::testing::WithParamInterface<unsigned int>
+{
+};
+
+TEST_P(GalileoE1PcpsCccwsrAmbiguousAcquisitionValidationTest, ValidationOfResults)
 {
     config_1();
+    config->set_property("Acquisition.noncoherent_dwells", std::to_string(GetParam()));
 
     acquisition = new GalileoE1PcpsCccwsrAmbiguousAcquisition(config, "Acquisition", 1, 1, queue);
 
@@ -487,6 +493,10 @@ TEST_F(GalileoE1PcpsCccwsrAmbiguousAcquisitionTest, ValidationOfResults)
     delete config;
 }
 
+// Coherent search of each 4 ms vector, and non-coherent integration of 4 of them
+INSTANTIATE_TEST_CASE_P(NoncoherentDwells, GalileoE1PcpsCccwsrAmbiguousAcquisitionValidationTest,
+        ::testing::Values(1u, 4u));
+
 TEST_F(GalileoE1PcpsCccwsrAmbiguousAcquisitionTest, ValidationOfResultsProbabilities)
 {
     config_2();
@@ -256,6 +256,27 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaDllPllTracking)
 }
 
 
+TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaDllPllBatchTracking)
+{
+    std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
+    configuration->set_property("Tracking.implementation", "GPS_L1_CA_DLL_PLL_Batch_Tracking");
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+
+    std::shared_ptr<GNSSBlockFactory> factory = std::make_shared<GNSSBlockFactory>();
+    TrackingInterface *tracking = (TrackingInterface*)factory->GetBlock(configuration, "Tracking", "GPS_L1_CA_DLL_PLL_Batch_Tracking", 1, 1, queue);
+    TrackingInterface *tracking2 = (TrackingInterface*)factory->GetBlock(configuration, "Tracking", "GPS_L1_CA_DLL_PLL_Batch_Tracking", 1, 1, queue);
+
+    EXPECT_STREQ("Tracking", tracking->role().c_str());
+    EXPECT_STREQ("GPS_L1_CA_DLL_PLL_Batch_Tracking", tracking->implementation().c_str());
+    // Only the first channel feeds the shared block
+    EXPECT_NE(tracking->get_left_block(), tracking2->get_left_block());
+    EXPECT_NE(tracking->get_right_block(), tracking2->get_right_block());
+
+    delete tracking;
+    delete tracking2;
+}
+
+
 TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaTcpConnectorTracking)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
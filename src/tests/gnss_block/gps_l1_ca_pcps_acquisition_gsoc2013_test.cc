@@ -33,6 +33,8 @@
 
 #include <ctime>
 #include <iostream>
+#include <map>
+#include <string>
 #include <gnuradio/top_block.h>
 #include <gnuradio/blocks/file_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
@@ -43,7 +45,11 @@
 #include "in_memory_configuration.h"
 #include "configuration_interface.h"
 #include "gnss_synchro.h"
+#include "acquisition_interface.h"
 #include "gps_l1_ca_pcps_acquisition.h"
+#include "gps_l1_ca_pcps_batch_acquisition.h"
+#include "gps_l1_ca_pcps_hierarchical_acquisition.h"
+#include "gps_l1_ca_pcps_multithread_acquisition.h"
 #include "signal_generator.h"
 #include "signal_generator_c.h"
 #include "fir_filter.h"
@@ -53,6 +59,24 @@
 #include "pass_through.h"
 
 
+/*!
+ * \brief Acquisition configuration checked against the signal generator
+ */
+struct AcquisitionValidationCase
+{
+    std::string name;
+    std::string implementation;
+    std::map<std::string, std::string> properties; // Acquisition properties on top of config_1
+    unsigned int fs_in;
+    double max_delay_error_chips;
+};
+
+void PrintTo(const AcquisitionValidationCase& validation_case, std::ostream* os)
+{
+    *os << validation_case.name;
+}
+
+
 class GpsL1CaPcpsAcquisitionGSoC2013Test: public ::testing::Test
 {
 protected:
@@ -76,10 +100,12 @@ protected:
     void wait_message();
     void process_message();
     void stop_queue();
+    AcquisitionInterface* make_acquisition(const std::string& implementation);
+    void run_validation(const AcquisitionValidationCase& validation_case);
 
     gr::msg_queue::sptr queue;
     gr::top_block_sptr top_block;
-    GpsL1CaPcpsAcquisition *acquisition;
+    AcquisitionInterface *acquisition;
     InMemoryConfiguration* config;
     Gnss_Synchro gnss_synchro;
     size_t item_size;
@@ -106,6 +132,12 @@ protected:
     double mse_doppler;
     double mse_delay;
 
+    // Detection of the visible satellite in the last run_validation
+    int acquired_message;
+    double acquired_delay_samples;
+    double acquired_doppler_hz;
+    unsigned int acquired_time_us;
+
     double Pd;
     double Pfa_p;
     double Pfa_a;
@@ -356,51 +388,39 @@ void GpsL1CaPcpsAcquisitionGSoC2013Test::stop_queue()
     stop = true;
 }
 
-TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, Instantiate)
+AcquisitionInterface* GpsL1CaPcpsAcquisitionGSoC2013Test::make_acquisition(const std::string& implementation)
 {
-    config_1();
-    acquisition = new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
-    delete acquisition;
-    delete config;
+    if (implementation.compare("GPS_L1_CA_PCPS_Batch_Acquisition") == 0)
+        {
+            return new GpsL1CaPcpsBatchAcquisition(config, "Acquisition", 1, 1, queue);
+        }
+    if (implementation.compare("GPS_L1_CA_PCPS_Hierarchical_Acquisition") == 0)
+        {
+            return new GpsL1CaPcpsHierarchicalAcquisition(config, "Acquisition", 1, 1, queue);
+        }
+    if (implementation.compare("GPS_L1_CA_PCPS_Multithread_Acquisition") == 0)
+        {
+            return new GpsL1CaPcpsMultithreadAcquisition(config, "Acquisition", 1, 1, queue);
+        }
+    return new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
 }
 
-TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ConnectAndRun)
+void GpsL1CaPcpsAcquisitionGSoC2013Test::run_validation(const AcquisitionValidationCase& validation_case)
 {
-    int nsamples = floor(fs_in*integration_time_ms*1e-3);
-    struct timeval tv;
-    long long int begin = 0;
-    long long int end = 0;
-
     config_1();
-    acquisition = new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
-
-    ASSERT_NO_THROW( {
-        acquisition->connect(top_block);
-        boost::shared_ptr<gr::analog::sig_source_c> source = gr::analog::sig_source_c::make(fs_in, gr::analog::GR_SIN_WAVE, 1000, 1, gr_complex(0));
-        boost::shared_ptr<gr::block> valve = gnss_sdr_make_valve(sizeof(gr_complex), nsamples, queue);
-        top_block->connect(source, 0, valve, 0);
-        top_block->connect(valve, 0, acquisition->get_left_block(), 0);
-    }) << "Failure connecting the blocks of acquisition test."<< std::endl;
 
-    EXPECT_NO_THROW( {
-        gettimeofday(&tv, NULL);
-        begin = tv.tv_sec *1e6 + tv.tv_usec;
-        top_block->run(); // Start threads and wait
-        gettimeofday(&tv, NULL);
-        end = tv.tv_sec *1e6 + tv.tv_usec;
-    }) << "Failure running the top_block."<< std::endl;
-
-    std::cout <<  "Processed " << nsamples << " samples in " << (end-begin) << " microseconds" << std::endl;
-
-    delete acquisition;
-    delete config;
-}
-
-TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResults)
-{
-    config_1();
+    fs_in = validation_case.fs_in;
+    max_delay_error_chips = validation_case.max_delay_error_chips;
+    config->set_property("GNSS-SDR.internal_fs_hz", std::to_string(fs_in));
+    config->set_property("SignalSource.fs_hz", std::to_string(fs_in));
+    config->set_property("Acquisition.implementation", validation_case.implementation);
+    for (std::map<std::string, std::string>::const_iterator it = validation_case.properties.begin();
+            it != validation_case.properties.end(); ++it)
+        {
+            config->set_property("Acquisition." + it->first, it->second);
+        }
 
-    acquisition = new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
+    acquisition = make_acquisition(validation_case.implementation);
 
     ASSERT_NO_THROW( {
         acquisition->set_channel(1);
@@ -430,6 +450,8 @@ TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResults)
         acquisition->connect(top_block);
     }) << "Failure connecting acquisition to the top_block."<< std::endl;
 
+    // Some implementations already generate the local code in init()
+    gnss_synchro.PRN = 10;
     acquisition->init();
 
     ASSERT_NO_THROW( {
@@ -466,6 +488,11 @@ TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResults)
 
             if (i == 0)
             {
+                acquired_message = message;
+                acquired_delay_samples = gnss_synchro.Acq_delay_samples;
+                acquired_doppler_hz = gnss_synchro.Acq_doppler_hz;
+                acquired_time_us = mean_acq_time_us;
+
                 EXPECT_EQ(1, message) << "Acquisition failure. Expected message: 1=ACQ SUCCESS.";
                 if (message == 1)
                     {
@@ -483,6 +510,108 @@ TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResults)
     delete config;
 }
 
+TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, Instantiate)
+{
+    config_1();
+    acquisition = new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
+    delete acquisition;
+    delete config;
+}
+
+TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ConnectAndRun)
+{
+    int nsamples = floor(fs_in*integration_time_ms*1e-3);
+    struct timeval tv;
+    long long int begin = 0;
+    long long int end = 0;
+
+    config_1();
+    acquisition = new GpsL1CaPcpsAcquisition(config, "Acquisition", 1, 1, queue);
+
+    ASSERT_NO_THROW( {
+        acquisition->connect(top_block);
+        boost::shared_ptr<gr::analog::sig_source_c> source = gr::analog::sig_source_c::make(fs_in, gr::analog::GR_SIN_WAVE, 1000, 1, gr_complex(0));
+        boost::shared_ptr<gr::block> valve = gnss_sdr_make_valve(sizeof(gr_complex), nsamples, queue);
+        top_block->connect(source, 0, valve, 0);
+        top_block->connect(valve, 0, acquisition->get_left_block(), 0);
+    }) << "Failure connecting the blocks of acquisition test."<< std::endl;
+
+    EXPECT_NO_THROW( {
+        gettimeofday(&tv, NULL);
+        begin = tv.tv_sec *1e6 + tv.tv_usec;
+        top_block->run(); // Start threads and wait
+        gettimeofday(&tv, NULL);
+        end = tv.tv_sec *1e6 + tv.tv_usec;
+    }) << "Failure running the top_block."<< std::endl;
+
+    std::cout <<  "Processed " << nsamples << " samples in " << (end-begin) << " microseconds" << std::endl;
+
+    delete acquisition;
+    delete config;
+}
+
+class GpsL1CaPcpsAcquisitionGSoC2013ValidationTest: public GpsL1CaPcpsAcquisitionGSoC2013Test,
+        public ::testing::WithParamInterface<AcquisitionValidationCase>
+{
+};
+
+TEST_P(GpsL1CaPcpsAcquisitionGSoC2013ValidationTest, ValidationOfResults)
+{
+    run_validation(GetParam());
+}
+
+INSTANTIATE_TEST_CASE_P(AcquisitionSearches, GpsL1CaPcpsAcquisitionGSoC2013ValidationTest, ::testing::Values(
+        AcquisitionValidationCase{"SerialDopplerSearch", "GPS_L1_CA_PCPS_Acquisition",
+                {}, 4000000, 0.50},
+        // 1 kHz FFT bins: a rotation of the spectrum and a residual of 0, 250, 500 or 750 Hz
+        AcquisitionValidationCase{"DopplerBinRotation", "GPS_L1_CA_PCPS_Acquisition",
+                {{"doppler_bin_rotation", "true"}}, 4000000, 0.50},
+        // 4092 samples per code period zero-padded to an 8192-point FFT
+        AcquisitionValidationCase{"FastFftSize", "GPS_L1_CA_PCPS_Acquisition",
+                {{"fast_fft_size", "true"}}, 4092000, 0.50},
+        // Search at 1 MHz: the interpolated code phase must remove the (D-1)/2
+        // samples of delay of the integrate and dump, 0.48 chips here
+        AcquisitionValidationCase{"Decimation", "GPS_L1_CA_PCPS_Acquisition",
+                {{"decimation_factor", "4"}}, 4000000, 0.25},
+        // Four coherent integrations accumulated before the decision
+        AcquisitionValidationCase{"Noncoherent", "GPS_L1_CA_PCPS_Acquisition",
+                {{"noncoherent_dwells", "4"}, {"pfa", "0.0001"}}, 4000000, 0.50},
+        // Doppler bins searched by the workers of the thread pool
+        AcquisitionValidationCase{"Multithread", "GPS_L1_CA_PCPS_Multithread_Acquisition",
+                {}, 4000000, 0.50},
+        AcquisitionValidationCase{"MultithreadNoncoherent", "GPS_L1_CA_PCPS_Multithread_Acquisition",
+                {{"noncoherent_dwells", "4"}, {"pfa", "0.0001"}}, 4000000, 0.50},
+        // One block serves every channel, here a single one
+        AcquisitionValidationCase{"BatchMultiPrn", "GPS_L1_CA_PCPS_Batch_Acquisition",
+                {}, 4000000, 0.50},
+        // Coarse 1 ms search on the 250 Hz grid, refined on 4 ms around the best candidates
+        AcquisitionValidationCase{"HierarchicalCoarseToFine", "GPS_L1_CA_PCPS_Hierarchical_Acquisition",
+                {{"fine_coherent_integration_time_ms", "4"}, {"candidates", "4"}}, 4000000, 0.50}));
+
+TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, FastFftSizeKeepsDetection)
+{
+    // 4092 samples per code period, searched with a 4092-point FFT and
+    // zero-padded to an 8192-point FFT
+    const unsigned int fs_in_hz = 4092000;
+    run_validation(AcquisitionValidationCase{"UnpaddedFft", "GPS_L1_CA_PCPS_Acquisition",
+            {}, fs_in_hz, 0.50});
+    int unpadded_message = acquired_message;
+    double unpadded_delay_samples = acquired_delay_samples;
+    double unpadded_doppler_hz = acquired_doppler_hz;
+    unsigned int unpadded_time_us = acquired_time_us;
+
+    top_block = gr::make_top_block("Acquisition test");
+    run_validation(AcquisitionValidationCase{"FastFftSize", "GPS_L1_CA_PCPS_Acquisition",
+            {{"fast_fft_size", "true"}}, fs_in_hz, 0.50});
+
+    std::cout << "Mean acq time [us]: " << unpadded_time_us << " (4092-point FFT), "
+              << acquired_time_us << " (8192-point FFT)" << std::endl;
+
+    EXPECT_EQ(unpadded_message, acquired_message) << "Zero padding changed the detection.";
+    EXPECT_EQ(unpadded_doppler_hz, acquired_doppler_hz) << "Zero padding changed the Doppler estimation.";
+    EXPECT_EQ(unpadded_delay_samples, acquired_delay_samples) << "Zero padding changed the code phase estimation.";
+}
+
 TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResultsProbabilities)
 {
     config_2();
@@ -69,10 +69,22 @@ using google::LogMessage;
 
 DECLARE_string(log_dir);
 
+#include "arithmetic/code_nco_test.cc"
 #include "arithmetic/complex_carrier_test.cc"
 #include "arithmetic/conjugate_test.cc"
 #include "arithmetic/magnitude_squared_test.cc"
 #include "arithmetic/multiply_test.cc"
+#include "arithmetic/multicorrelator_test.cc"
+#include "arithmetic/multicorrelator_int16_test.cc"
+#include "arithmetic/lock_detector_test.cc"
+#include "arithmetic/tracking_state_bank_test.cc"
+#include "arithmetic/bit_synchronizer_test.cc"
+#include "arithmetic/vector_estimator_test.cc"
+#include "arithmetic/lock_history_test.cc"
+#include "arithmetic/overload_controller_test.cc"
+#include "arithmetic/dump_writer_test.cc"
+#include "arithmetic/thread_pool_test.cc"
+#include "arithmetic/fft_plan_cache_test.cc"
 #include "configuration/file_configuration_test.cc"
 #include "configuration/in_memory_configuration_test.cc"
 #include "control_thread/control_message_factory_test.cc"
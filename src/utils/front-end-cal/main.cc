@@ -56,6 +56,7 @@
 #include "gnss_signal.h"
 #include "gnss_synchro.h"
 #include "gnss_block_factory.h"
+#include "gnss_fft_plan_cache.h"
 #include "gps_navigation_message.h"
 #include "gps_ephemeris.h"
 #include "gps_almanac.h"
@@ -304,6 +305,12 @@ int main(int argc, char** argv)
 
     long fs_in_ = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
 
+    // Reuse the FFT plans measured by the receiver
+    std::string wisdom_filename = configuration->property("GNSS-SDR.fftw_wisdom_filename",
+            Gnss_Fft_Plan_Cache::instance().wisdom_filename());
+    std::string fftw_planner = configuration->property("GNSS-SDR.fftw_planner", std::string("measure"));
+    Gnss_Fft_Plan_Cache::instance().configure(wisdom_filename, fftw_planner);
+
     GNSSBlockFactory block_factory;
     acquisition = new GpsL1CaPcpsAcquisitionFineDoppler(configuration.get(), "Acquisition", 1, 1, queue);
 
@@ -384,6 +391,7 @@ int main(int argc, char** argv)
             std::cout.flush();
         }
     std::cout << "]" << std::endl;
+    Gnss_Fft_Plan_Cache::instance().save_wisdom();
 
     // report the elapsed time
     gettimeofday(&tv, NULL);
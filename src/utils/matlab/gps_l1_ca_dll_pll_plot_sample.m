@@ -35,7 +35,7 @@ path='/home/javier/workspace/gnss-sdr/trunk/install/';
 clear PRN_absolute_sample_start;
 for N=1:1:channels
     tracking_log_path=[path 'tracking_ch_' num2str(N-1) '.dat'];
-    GNSS_tracking(N)= gps_l1_ca_dll_pll_read_tracking_dump(tracking_log_path);   
+    GNSS_tracking(N)= gps_l1_ca_dll_pll_read_tracking_dump_64bits(tracking_log_path);   
 end
 
 % GNSS-SDR format conversion to MATLAB GPS receiver
@@ -53,6 +53,7 @@ function [GNSS_tracking] = galileo_e1_dll_pll_veml_read_tracking_dump (filename,
   f = fopen (filename, 'rb');
   if (f < 0)
   else
+    bytes_shift = gnss_sdr_read_dump_header (f); % skip the header of the newer dumps
     v1 = fread (f, count, 'float',skip_bytes_each_read-float_size_bytes);
         bytes_shift=bytes_shift+float_size_bytes;
     fseek(f,bytes_shift,'bof'); % move to next interleaved float
@@ -0,0 +1,52 @@
+% /*!
+%  * \file gnss_sdr_read_dump_header.m
+%  * \brief Skips the text header that GNSS-SDR writes at the start of its
+%  * binary dump files.
+%  * -------------------------------------------------------------------------
+%  *
+%  * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+%  *
+%  * GNSS-SDR is a software defined Global Navigation
+%  *          Satellite Systems receiver
+%  *
+%  * This file is part of GNSS-SDR.
+%  *
+%  * GNSS-SDR is free software: you can redistribute it and/or modify
+%  * it under the terms of the GNU General Public License as published by
+%  * the Free Software Foundation, either version 3 of the License, or
+%  * at your option) any later version.
+%  *
+%  * GNSS-SDR is distributed in the hope that it will be useful,
+%  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  * GNU General Public License for more details.
+%  *
+%  * You should have received a copy of the GNU General Public License
+%  * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+%  *
+%  * -------------------------------------------------------------------------
+%  */
+function [header_bytes, record_bytes] = gnss_sdr_read_dump_header (f)
+
+  %% usage: [header_bytes, record_bytes] = gnss_sdr_read_dump_header (f)
+  %%
+  %% reads the header of an open GNSS-SDR dump file and leaves the file
+  %% at the first record. Files without header (older dumps) return 0.
+  %%
+
+  header_bytes = 0;
+  record_bytes = 0;
+  fseek(f,0,'bof');
+  line = fgetl(f);
+  if (~ischar(line) || ~strcmp(line, 'GNSS-SDR dump 1'))
+    fseek(f,0,'bof');
+    return;
+  end
+  while ischar(line) && ~strcmp(line, 'end_header')
+    fields = strsplit(line, ' ');
+    if (strcmp(fields{1}, 'record_bytes'))
+      record_bytes = str2double(fields{2});
+    end
+    line = fgetl(f);
+  end
+  header_bytes = ftell(f);
@@ -22,6 +22,7 @@ function [observables] = gps_l1_ca_dll_pll_read_observables_dump (channels, file
   f = fopen (filename, 'rb');
   if (f < 0)
   else
+    bytes_shift = gnss_sdr_read_dump_header (f); % skip the header of the newer dumps
     for N=1:1:channels
         observables.preamble_delay_ms(N,:) = fread (f, count, 'float64',skip_bytes_each_read-double_size_bytes);
         bytes_shift=bytes_shift+double_size_bytes;
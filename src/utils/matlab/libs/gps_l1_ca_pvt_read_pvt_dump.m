@@ -75,6 +75,7 @@ function [navSolutions] = gps_l1_ca_pvt_read_pvt_dump (filename, count)
   f = fopen (filename, 'rb');
   if (f < 0)
   else
+    bytes_shift = gnss_sdr_read_dump_header (f); % skip the header of the newer dumps
         GPS_current_time = fread (f, count, 'float64',skip_bytes_each_read-double_size_bytes);
         bytes_shift=bytes_shift+double_size_bytes;
         fseek(f,bytes_shift,'bof'); % move to next interleaved